@@ -83,7 +83,7 @@ namespace K3b {
          * cdrecord, cdrdao, growisofs, mkisofs, dvd+rw-format, readcd
          *
          * If you need other programs you have to add them manually like this:
-         * <pre>externalBinManager()->addProgram( new NormalizeProgram() );</pre>
+         * <pre>externalBinManager()->addProgram( new MovixProgram() );</pre>
          */
         ExternalBinManager* externalBinManager() const;
         PluginManager* pluginManager() const;
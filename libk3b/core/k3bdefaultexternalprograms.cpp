@@ -420,12 +420,6 @@ QString K3b::VcdbuilderProgram::versionIdentifier( const ExternalBin& /*bin*/ )
 }
 
 
-K3b::NormalizeProgram::NormalizeProgram()
-    : K3b::SimpleExternalProgram( "normalize" )
-{
-}
-
-
 K3b::GrowisofsProgram::GrowisofsProgram()
     : K3b::SimpleExternalProgram( "growisofs" )
 {
@@ -95,6 +95,9 @@ namespace K3b {
         // no user parameters (yet)
         bool supportsUserParameters() const override { return false; }
 
+        // the features depend on the installed transcode modules
+        bool cacheable() const override { return false; }
+
     protected:
         QString versionIdentifier( const ExternalBin& bin ) const override;
         bool scanFeatures( ExternalBin& bin ) const override;
@@ -111,13 +114,6 @@ namespace K3b {
     };
 
 
-    class LIBK3B_EXPORT NormalizeProgram : public SimpleExternalProgram
-    {
-    public:
-        NormalizeProgram();
-    };
-
-
     class LIBK3B_EXPORT GrowisofsProgram : public SimpleExternalProgram
     {
     public:
@@ -8,16 +8,24 @@
 
 #include "k3bexternalbinmanager.h"
 #include "k3bglobals.h"
+#include "config-k3b.h"
 
 #include <KConfigGroup>
 #include <KProcess>
 
+#include <QDataStream>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
 #include <QFile>
+#include <QHash>
+#include <QMutex>
 #include <QtGlobal>
 #include <QRegExp>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
 
 #ifndef Q_OS_WIN32
 #include <unistd.h>
@@ -34,6 +42,193 @@ namespace {
     }
 
     const int EXECUTE_TIMEOUT = 5000; // in seconds
+
+    const quint32 CACHE_MAGIC = 0x4B334542; // "K3EB"
+    const quint32 CACHE_VERSION = 1;
+
+    // probing mostly waits for the programs, not for the cpu
+    const int MAX_PROBE_THREADS = 8;
+
+    /**
+     * The result of probing one bin together with the state of its file
+     * at that time.
+     */
+    struct ProbeResult
+    {
+        ProbeResult() : inode( 0 ), size( 0 ), modificationTime( 0 ), changeTime( 0 ), found( false ) {}
+
+        bool sameFile( const ProbeResult& other ) const {
+            return( inode == other.inode &&
+                    size == other.size &&
+                    modificationTime == other.modificationTime &&
+                    changeTime == other.changeTime );
+        }
+
+        quint64 inode;
+        qint64 size;
+        qint64 modificationTime;
+        // changes with the permissions, too
+        qint64 changeTime;
+
+        bool found;
+        QString version;
+        QString copyright;
+        QStringList features;
+    };
+
+    QDataStream& operator<<( QDataStream& s, const ProbeResult& r )
+    {
+        return s << r.inode << r.size << r.modificationTime << r.changeTime
+                 << r.found << r.version << r.copyright << r.features;
+    }
+
+    QDataStream& operator>>( QDataStream& s, ProbeResult& r )
+    {
+        return s >> r.inode >> r.size >> r.modificationTime >> r.changeTime
+                 >> r.found >> r.version >> r.copyright >> r.features;
+    }
+
+    bool readFileState( const QString& path, ProbeResult& r )
+    {
+        QFileInfo info( path );
+        if( !info.exists() )
+            return false;
+
+        r.size = info.size();
+        r.modificationTime = info.lastModified().toMSecsSinceEpoch();
+#ifndef Q_OS_WIN32
+        struct stat st;
+        if( ::stat( QFile::encodeName( path ), &st ) )
+            return false;
+        r.inode = st.st_ino;
+        r.changeTime = st.st_ctime;
+#endif
+        return true;
+    }
+
+    // probes run in several threads, thus no getgrgid()
+    QString groupName( gid_t gid )
+    {
+        long size = ::sysconf( _SC_GETGR_R_SIZE_MAX );
+        QByteArray buffer( size > 0 ? int( size ) : 16384, 0 );
+        struct group grp;
+        struct group* result = 0;
+        if( ::getgrgid_r( gid, &grp, buffer.data(), buffer.size(), &result ) == 0 && result )
+            return QString::fromLocal8Bit( result->gr_name );
+        else
+            return QString();
+    }
+
+    QString cacheKey( const K3b::ExternalProgram* program, const QString& path )
+    {
+        return program->name() + QLatin1Char( '\n' ) + path;
+    }
+
+    QHash<QString, ProbeResult> loadProbeCache( const QString& filename )
+    {
+        QHash<QString, ProbeResult> cache;
+
+        QFile file( filename );
+        if( filename.isEmpty() || !file.open( QIODevice::ReadOnly ) )
+            return cache;
+
+        QDataStream s( &file );
+        s.setVersion( QDataStream::Qt_5_0 );
+
+        // the probing changes with K3b itself
+        quint32 magic = 0;
+        quint32 version = 0;
+        QString k3bVersion;
+        qint32 count = 0;
+        s >> magic >> version >> k3bVersion >> count;
+        if( magic != CACHE_MAGIC || version != CACHE_VERSION || k3bVersion != QLatin1String( K3B_VERSION_STRING ) ) {
+            qDebug() << "(K3b::ExternalBinManager) ignoring" << filename;
+            return cache;
+        }
+
+        for( int i = 0; i < count && s.status() == QDataStream::Ok; ++i ) {
+            QString key;
+            ProbeResult r;
+            s >> key >> r;
+            cache.insert( key, r );
+        }
+
+        if( s.status() != QDataStream::Ok ) {
+            qDebug() << "(K3b::ExternalBinManager) broken cache" << filename;
+            cache.clear();
+        }
+
+        return cache;
+    }
+
+    bool saveProbeCache( const QString& filename, const QHash<QString, ProbeResult>& cache )
+    {
+        if( !QDir().mkpath( QFileInfo( filename ).absolutePath() ) ) {
+            qDebug() << "(K3b::ExternalBinManager) unable to create the folder of" << filename;
+            return false;
+        }
+
+        QSaveFile file( filename );
+        if( !file.open( QIODevice::WriteOnly ) ) {
+            qDebug() << "(K3b::ExternalBinManager) could not open" << filename;
+            return false;
+        }
+
+        QDataStream s( &file );
+        s.setVersion( QDataStream::Qt_5_0 );
+
+        s << CACHE_MAGIC << CACHE_VERSION << QString( QLatin1String( K3B_VERSION_STRING ) ) << qint32( cache.count() );
+        for( QHash<QString, ProbeResult>::const_iterator it = cache.constBegin(); it != cache.constEnd(); ++it )
+            s << it.key() << it.value();
+
+        return file.commit();
+    }
+
+    /**
+     * One bin which has been found during the search.
+     */
+    struct Probe
+    {
+        Probe() : program( 0 ), bin( 0 ), fileStateRead( false ), cached( false ) {}
+
+        K3b::SimpleExternalProgram* program;
+        QString path;
+        ProbeResult result;
+        K3b::ExternalBin* bin;
+        bool fileStateRead;
+        bool cached;
+    };
+
+    /**
+     * Probes bins until none are left. Several threads share one list.
+     */
+    class ProbeThread : public QThread
+    {
+    public:
+        ProbeThread( QList<Probe*>& probes, int& next, QMutex& mutex )
+            : m_probes( probes ),
+              m_next( next ),
+              m_mutex( mutex ) {
+        }
+
+        void run() override {
+            Q_FOREVER {
+                m_mutex.lock();
+                Probe* probe = m_next < m_probes.count() ? m_probes[m_next++] : 0;
+                m_mutex.unlock();
+
+                if( !probe )
+                    break;
+
+                probe->bin = probe->program->probe( probe->path );
+            }
+        }
+
+    private:
+        QList<Probe*>& m_probes;
+        int& m_next;
+        QMutex& m_mutex;
+    };
 }
 
 
@@ -332,18 +527,12 @@ QString K3b::SimpleExternalProgram::getProgramPath( const QString& dir ) const
 
 bool K3b::SimpleExternalProgram::scan( const QString& p )
 {
-    if( p.isEmpty() )
-        return false;
+    QString path = programPath( p );
 
-    QString path = getProgramPath( p );
-
-    if ( QFile::exists( path ) ) {
-        K3b::ExternalBin* bin = new ExternalBin( *this, path );
-
-        if ( ( !scanVersion( *bin ) || !scanFeatures( *bin ) ) && bin->needGroup().isEmpty() )  {
-            delete bin;
+    if ( !path.isEmpty() ) {
+        K3b::ExternalBin* bin = probe( path );
+        if ( !bin )
             return false;
-        }
 
         addBin( bin );
         return true;
@@ -354,6 +543,32 @@ bool K3b::SimpleExternalProgram::scan( const QString& p )
 }
 
 
+QString K3b::SimpleExternalProgram::programPath( const QString& dir ) const
+{
+    if( dir.isEmpty() )
+        return QString();
+
+    QString path = getProgramPath( dir );
+    if ( !path.isEmpty() && QFile::exists( path ) )
+        return path;
+    else
+        return QString();
+}
+
+
+K3b::ExternalBin* K3b::SimpleExternalProgram::probe( const QString& path )
+{
+    K3b::ExternalBin* bin = new ExternalBin( *this, path );
+
+    if ( ( !scanVersion( *bin ) || !scanFeatures( *bin ) ) && bin->needGroup().isEmpty() )  {
+        delete bin;
+        return 0;
+    }
+
+    return bin;
+}
+
+
 bool K3b::SimpleExternalProgram::scanVersion( ExternalBin& bin ) const
 {
     // probe version
@@ -367,7 +582,7 @@ bool K3b::SimpleExternalProgram::scanVersion( ExternalBin& bin ) const
             // K3b::SystemProblemDialog::checkSystem work
             struct stat st;
             if( !::stat( QFile::encodeName(bin.path()), &st ) ) {
-                QString group( getgrgid( st.st_gid )->gr_name );
+                QString group( groupName( st.st_gid ) );
                 qDebug() << "Should be member of \"" << group << "\"";
                 bin.setNeedGroup( group.isEmpty() ? "N/A" : group );
             } else
@@ -475,6 +690,7 @@ class K3b::ExternalBinManager::Private
 public:
     QMap<QString, ExternalProgram*> programs;
     QStringList searchPath;
+    QString cacheFileName;
 
     static QString noPath;  // used for binPath() to return const string
 
@@ -489,6 +705,7 @@ K3b::ExternalBinManager::ExternalBinManager( QObject* parent )
     : QObject( parent ),
       d( new Private )
 {
+    d->cacheFileName = QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) + "/externalbins";
 }
 
 
@@ -604,7 +821,7 @@ void K3b::ExternalBinManager::clear()
 }
 
 
-void K3b::ExternalBinManager::search()
+void K3b::ExternalBinManager::search( bool useCache )
 {
     if( d->searchPath.isEmpty() )
         loadDefaultSearchPath();
@@ -631,11 +848,117 @@ void K3b::ExternalBinManager::search()
             paths.append(p);
     }
 
+    const QHash<QString, ProbeResult> cache = loadProbeCache( useCache ? d->cacheFileName : QString() );
+
+    //
+    // Collect the bins in the order the old serial search found them since
+    // the order decides about the default bin. Bins which did not change
+    // since they were cached are not started again.
+    //
+    QList<Probe*> probes;
+    QList<Probe*> pending;
+    QList<QPair<K3b::ExternalProgram*, QString> > otherScans;
     Q_FOREACH( const QString& path, paths ) {
         Q_FOREACH( K3b::ExternalProgram* program, d->programs ) {
-            program->scan( path );
+            K3b::SimpleExternalProgram* simpleProgram = dynamic_cast<K3b::SimpleExternalProgram*>( program );
+            if( !simpleProgram ) {
+                otherScans.append( qMakePair( program, path ) );
+                continue;
+            }
+
+            const QString binPath = simpleProgram->programPath( path );
+            if( binPath.isEmpty() )
+                continue;
+
+            Probe* probe = new Probe();
+            probe->program = simpleProgram;
+            probe->path = binPath;
+            probe->fileStateRead = ( simpleProgram->cacheable() && readFileState( binPath, probe->result ) );
+            if( probe->fileStateRead ) {
+                QHash<QString, ProbeResult>::const_iterator it = cache.constFind( cacheKey( program, binPath ) );
+                if( it != cache.constEnd() && it->found && it->sameFile( probe->result ) ) {
+                    probe->result = *it;
+                    probe->cached = true;
+                }
+            }
+            probes.append( probe );
+            if( !probe->cached )
+                pending.append( probe );
+        }
+    }
+
+    //
+    // Every probe starts at least one process and waits for it. Thus we
+    // probe in parallel while this thread takes care of the programs
+    // which do their own scanning.
+    //
+    QList<ProbeThread*> threads;
+    QMutex mutex;
+    int next = 0;
+    const int threadCount = qMin( qBound( 1, QThread::idealThreadCount(), MAX_PROBE_THREADS ), pending.count() );
+    for( int i = 0; i < threadCount; ++i ) {
+        ProbeThread* thread = new ProbeThread( pending, next, mutex );
+        thread->start();
+        threads.append( thread );
+    }
+
+    for( int i = 0; i < otherScans.count(); ++i )
+        otherScans[i].first->scan( otherScans[i].second );
+
+    Q_FOREACH( ProbeThread* thread, threads ) {
+        thread->wait();
+        delete thread;
+    }
+
+    QHash<QString, ProbeResult> newCache;
+    bool cacheChanged = false;
+    Q_FOREACH( Probe* probe, probes ) {
+        if( probe->cached ) {
+            if( probe->result.found ) {
+                probe->bin = new ExternalBin( *probe->program, probe->path );
+                probe->bin->setVersion( Version( probe->result.version ) );
+                probe->bin->setCopyright( probe->result.copyright );
+                probe->bin->setNeedGroup( "" );
+                Q_FOREACH( const QString& feature, probe->result.features ) {
+                    probe->bin->addFeature( feature );
+                }
+            }
+        }
+        else if( probe->bin ) {
+            probe->result.found = true;
+            probe->result.version = probe->bin->version().versionString();
+            probe->result.copyright = probe->bin->copyright();
+            probe->result.features = probe->bin->features();
+        }
+
+        if( probe->bin )
+            probe->program->addBin( probe->bin );
+
+        // Only working bins are cached. A failed probe may have hit a
+        // timeout or a busy system and the user might be added to the group
+        // the bin needs.
+        if( probe->fileStateRead && probe->bin && probe->bin->needGroup().isEmpty() ) {
+            newCache.insert( cacheKey( probe->program, probe->path ), probe->result );
+            cacheChanged = ( cacheChanged || !probe->cached );
         }
     }
+
+    if( !d->cacheFileName.isEmpty() && ( cacheChanged || newCache.count() != cache.count() ) )
+        saveProbeCache( d->cacheFileName, newCache );
+
+    qDeleteAll( probes );
+}
+
+
+void K3b::ExternalBinManager::setCacheFileName( const QString& filename )
+{
+    d->cacheFileName = filename;
+}
+
+
+QString K3b::ExternalBinManager::cacheFileName() const
+{
+    return d->cacheFileName;
 }
 
 
@@ -126,6 +126,32 @@ namespace K3b {
 
         bool scan( const QString& path ) override;
 
+        /**
+         * \return The path of the program in the folder \p dir or an empty
+         *         string if it is not there.
+         */
+        QString programPath( const QString& dir ) const;
+
+        /**
+         * Scans the program at \p path like scan() but does not add it.
+         * The program itself is not changed which allows ExternalBinManager
+         * to probe several paths at once.
+         *
+         * \return A new bin owned by the caller or 0 if the program at
+         *         \p path cannot be used.
+         */
+        ExternalBin* probe( const QString& path );
+
+        /**
+         * ExternalBinManager remembers the results of probe() as long as the
+         * program file does not change.
+         *
+         * \return false if the results also depend on other files, then
+         *         the program is probed on every search. The default
+         *         implementation returns true.
+         */
+        virtual bool cacheable() const { return true; }
+
         /**
          * Parses a version starting at \p pos by looking for the first digit
          * followed by the first space char.
@@ -191,7 +217,22 @@ namespace K3b {
         explicit ExternalBinManager( QObject* parent = 0 );
         ~ExternalBinManager() override;
 
-        void search();
+        /**
+         * Searches all programs in the search path and in PATH.
+         *
+         * The probe results of SimpleExternalProgram bins are cached in
+         * cacheFileName(). A bin is only probed again if its file changed
+         * or \p useCache is false. The remaining bins are probed in
+         * parallel.
+         */
+        void search( bool useCache = true );
+
+        /**
+         * Defaults to externalbins in the user's cache folder. An empty
+         * name disables the cache.
+         */
+        void setCacheFileName( const QString& );
+        QString cacheFileName() const;
 
         /**
          * read config and add changes to current map.
@@ -30,6 +30,7 @@
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QMimeDatabase>
 #include <QStandardPaths>
 #include <QUrl>
 #include <QStorageInfo>
@@ -370,6 +371,18 @@ QString K3b::resolveLink( const QString& file )
 }
 
 
+QMimeType K3b::mimeTypeForFile( const QString& path )
+{
+    // QMimeDatabase is thread-safe so one instance is shared by all callers
+    static const QMimeDatabase s_mimeDatabase;
+
+    QMimeType mimeType = s_mimeDatabase.mimeTypeForFile( path, QMimeDatabase::MatchExtension );
+    if( mimeType.isDefault() )
+        mimeType = s_mimeDatabase.mimeTypeForFile( path );
+    return mimeType;
+}
+
+
 QUrl K3b::convertToLocalUrl( const QUrl& url )
 {
     if( !url.isLocalFile() ) {
@@ -550,7 +563,9 @@ bool K3b::eject( K3b::Device::Device* dev )
     if( K3b::isMounted( dev ) )
         K3b::unmount( dev );
 
-    if ( dev->solidDevice().as<Solid::OpticalDrive>()->eject() ||
+    // simulated devices are unknown to Solid
+    Solid::OpticalDrive* drive = dev->solidDevice().as<Solid::OpticalDrive>();
+    if ( ( drive && drive->eject() ) ||
          dev->eject() ) {
         // to be on the safe side, especially with respect to the EmptyDiscWaiter
         // we reset the device in the cache.
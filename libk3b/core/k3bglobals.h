@@ -14,6 +14,7 @@
 #include <KIO/Global>
 
 #include <QFile>
+#include <QMimeType>
 #include <QString>
 #include <QUrl>
 
@@ -185,6 +186,14 @@ namespace K3b {
      */
     LIBK3B_EXPORT QString resolveLink( const QString& );
 
+    /**
+     * Determines the mimetype of a local file. The filename is matched first and
+     * the file contents are only read if the name does not give a result.
+     *
+     * This method is thread-safe.
+     */
+    LIBK3B_EXPORT QMimeType mimeTypeForFile( const QString& path );
+
     LIBK3B_EXPORT Version kernelVersion();
 
     /**
@@ -18,6 +18,7 @@ K3b::GlobalSettings::GlobalSettings()
       m_overburn(false),
       m_useManualBufferSize(false),
       m_bufferSize(4),
+      m_audioReadAheadBufferSize(64),
       m_force(false)
 {
 }
@@ -35,6 +36,7 @@ void K3b::GlobalSettings::readSettings( const KConfigGroup& c )
     m_overburn = c.readEntry( "Allow overburning", false );
     m_useManualBufferSize = c.readEntry( "Manual buffer size", false );
     m_bufferSize = c.readEntry( "Fifo buffer", 4 );
+    m_audioReadAheadBufferSize = c.readEntry( "Audio read-ahead buffer", 64 );
     m_force = c.readEntry( "Force unsafe operations", false );
 	m_defaultTempPath = c.readPathEntry("Temp Dir",
             QStandardPaths::writableLocation(QStandardPaths::MoviesLocation));
@@ -53,6 +55,7 @@ void K3b::GlobalSettings::saveSettings( KConfigGroup c )
     c.writeEntry( "Allow overburning", m_overburn );
     c.writeEntry( "Manual buffer size", m_useManualBufferSize );
     c.writeEntry( "Fifo buffer", m_bufferSize );
+    c.writeEntry( "Audio read-ahead buffer", m_audioReadAheadBufferSize );
     c.writeEntry( "Force unsafe operations", m_force );
     c.writeEntry( "Temp Dir", m_defaultTempPath );
 }
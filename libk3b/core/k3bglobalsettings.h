@@ -40,6 +40,12 @@ namespace K3b {
         bool useManualBufferSize() const { return m_useManualBufferSize; }
         int bufferSize() const { return m_bufferSize; }
 
+        /**
+         * The size in MB of the buffer audio tracks are decoded into ahead of
+         * time when writing on-the-fly. 0 disables the buffer.
+         */
+        int audioReadAheadBufferSize() const { return m_audioReadAheadBufferSize; }
+
         /**
          * If force is set to true K3b will continue in certain "unsafe" situations.
          * The most common being a medium not suitable for the writer in terms of
@@ -58,6 +64,7 @@ namespace K3b {
         void setOverburn( bool b ) { m_overburn = b; }
         void setUseManualBufferSize( bool b ) { m_useManualBufferSize = b; }
         void setBufferSize( int size ) { m_bufferSize = size; }
+        void setAudioReadAheadBufferSize( int size ) { m_audioReadAheadBufferSize = size; }
         void setForce( bool b ) { m_force = b; }
         void setDefaultTempPath( const QString& s ) { m_defaultTempPath = s; }
 
@@ -68,6 +75,7 @@ namespace K3b {
         bool m_overburn;
         bool m_useManualBufferSize;
         int m_bufferSize;
+        int m_audioReadAheadBufferSize;
         bool m_force;
         QString m_defaultTempPath;
     };
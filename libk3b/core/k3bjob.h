@@ -297,6 +297,12 @@ namespace K3b {
 
         void deviceBuffer( int );
 
+        /**
+         * The fill level of the buffer the data is decoded into ahead of
+         * the writer, only emitted by jobs which decode audio on-the-fly.
+         */
+        void readAheadBufferStatus( int );
+
         /**
          * @param speed current writing speed in Kb
          * @param multiplicator use 150 for CDs and 1380 for DVDs
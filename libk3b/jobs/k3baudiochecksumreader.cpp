@@ -0,0 +1,359 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3baudiochecksumreader.h"
+
+#include "k3bdevice.h"
+#include "k3bcore.h"
+#include "k3b_i18n.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QtEndian>
+
+#include <cstring>
+
+
+namespace {
+    // the sectors read from an image at once
+    const int READ_SECTORS = 26;
+    const int SECTOR_SIZE = 2352;
+
+    qint64 floorDiv( qint64 a, qint64 b )
+    {
+        return a >= 0 ? a / b : -( ( -a + b - 1 ) / b );
+    }
+
+    /**
+     * \return The position of the sample data in a wave file
+     *         or -1 if the file is not a wave file.
+     */
+    qint64 waveDataOffset( QFile& file, qint64* dataSize )
+    {
+        char header[12];
+        if( !file.seek( 0 ) ||
+            file.read( header, 12 ) != 12 ||
+            ::memcmp( header, "RIFF", 4 ) ||
+            ::memcmp( header+8, "WAVE", 4 ) )
+            return -1;
+
+        char chunk[8];
+        while( file.read( chunk, 8 ) == 8 ) {
+            const qint64 chunkSize = qFromLittleEndian<quint32>( reinterpret_cast<const uchar*>( chunk+4 ) );
+            if( !::memcmp( chunk, "data", 4 ) ) {
+                *dataSize = chunkSize;
+                return file.pos();
+            }
+            // chunks are word aligned
+            if( !file.seek( file.pos() + chunkSize + ( chunkSize & 1 ) ) )
+                break;
+        }
+
+        return -1;
+    }
+}
+
+
+class K3b::AudioChecksumReader::Private
+{
+public:
+    Private()
+        : device( 0 ),
+          readOffset( 0 ),
+          detectReadOffset( false ),
+          readOffsetDetected( false ),
+          imageDataOffset( 0 ) {
+    }
+
+    Device::Device* device;
+    QString imagePath;
+    Msf lastSector;
+
+    Msf firstSector;
+    AudioChecksum reference;
+    AudioChecksum checksum;
+
+    int readOffset;
+    bool detectReadOffset;
+    bool readOffsetDetected;
+
+    QFile image;
+    qint64 imageDataOffset;
+
+    int readSectors() const {
+        return device ? device->maxReadSectors( SECTOR_SIZE ) : READ_SECTORS;
+    }
+};
+
+
+K3b::AudioChecksumReader::AudioChecksumReader( K3b::JobHandler* jh, QObject* parent )
+    : K3b::ThreadJob( jh, parent ),
+      d( new Private() )
+{
+}
+
+
+K3b::AudioChecksumReader::~AudioChecksumReader()
+{
+    delete d;
+}
+
+
+void K3b::AudioChecksumReader::setDevice( K3b::Device::Device* dev )
+{
+    d->device = dev;
+    d->imagePath.clear();
+}
+
+
+void K3b::AudioChecksumReader::setImagePath( const QString& path )
+{
+    d->imagePath = path;
+    d->device = 0;
+}
+
+
+void K3b::AudioChecksumReader::setLastSector( const K3b::Msf& sector )
+{
+    d->lastSector = sector;
+}
+
+
+void K3b::AudioChecksumReader::setTrack( const K3b::Msf& firstSector, const K3b::AudioChecksum& reference )
+{
+    d->firstSector = firstSector;
+    d->reference = reference;
+}
+
+
+void K3b::AudioChecksumReader::setReadOffset( int offset )
+{
+    d->readOffset = offset;
+}
+
+
+void K3b::AudioChecksumReader::setDetectReadOffset( bool b )
+{
+    d->detectReadOffset = b;
+}
+
+
+int K3b::AudioChecksumReader::readOffset() const
+{
+    return d->readOffset;
+}
+
+
+bool K3b::AudioChecksumReader::readOffsetDetected() const
+{
+    return d->readOffsetDetected;
+}
+
+
+K3b::AudioChecksum K3b::AudioChecksumReader::checksum() const
+{
+    return d->checksum;
+}
+
+
+bool K3b::AudioChecksumReader::openSource()
+{
+    d->readOffsetDetected = false;
+
+    if( d->device ) {
+        if( !d->device->open() ) {
+            emit infoMessage( i18n("Could not open device %1", d->device->blockDeviceName()), K3b::Job::MessageError );
+            return false;
+        }
+        return true;
+    }
+
+    d->image.setFileName( d->imagePath );
+    if( !d->image.open( QIODevice::ReadOnly ) ) {
+        emit infoMessage( i18n("Could not open file %1", d->imagePath), K3b::Job::MessageError );
+        return false;
+    }
+
+    // everything which is not a wave file is treated as raw image
+    qint64 dataSize = d->image.size();
+    d->imageDataOffset = waveDataOffset( d->image, &dataSize );
+    if( d->imageDataOffset < 0 ) {
+        d->imageDataOffset = 0;
+        dataSize = d->image.size();
+    }
+    dataSize = qMin( dataSize, d->image.size() - d->imageDataOffset );
+    d->lastSector = int( dataSize / SECTOR_SIZE ) - 1;
+
+    return true;
+}
+
+
+void K3b::AudioChecksumReader::closeSource()
+{
+    if( d->device )
+        d->device->close();
+    else
+        d->image.close();
+}
+
+
+bool K3b::AudioChecksumReader::readSectors( char* buffer, long sector, int sectors )
+{
+    while( sectors > 0 ) {
+        // the lead-in and the lead-out are read as silence
+        if( sector < 0 || sector > d->lastSector.lba() ) {
+            ::memset( buffer, 0, SECTOR_SIZE );
+            buffer += SECTOR_SIZE;
+            ++sector;
+            --sectors;
+            continue;
+        }
+
+        const int len = qMin( qMin( sectors, d->readSectors() ), int( d->lastSector.lba() - sector + 1 ) );
+
+        if( d->device ) {
+            // we try twice just to be sure
+            bool success = false;
+            for( int i = 0; i < 2 && !success; ++i ) {
+                success = d->device->readCd( reinterpret_cast<unsigned char*>( buffer ),
+                                             len*SECTOR_SIZE,
+                                             1,     // CD-DA
+                                             false, // no dap
+                                             sector,
+                                             len,
+                                             false, // no sync
+                                             false, // no header
+                                             false, // no subheader
+                                             true,  // user data
+                                             false, // no edc/ecc
+                                             0,     // no c2 error info
+                                             0 );   // no subchannel data
+            }
+            if( !success ) {
+                emit infoMessage( i18n("Error while reading sector %1.", sector), K3b::Job::MessageError );
+                return false;
+            }
+        }
+        else {
+            qint64 read = -1;
+            if( d->image.seek( d->imageDataOffset + qint64( sector )*SECTOR_SIZE ) )
+                read = d->image.read( buffer, len*SECTOR_SIZE );
+            if( read < 0 ) {
+                emit infoMessage( i18n("Error while reading sector %1.", sector), K3b::Job::MessageError );
+                return false;
+            }
+            ::memset( buffer + read, 0, len*SECTOR_SIZE - read );
+        }
+
+        buffer += len*SECTOR_SIZE;
+        sector += len;
+        sectors -= len;
+    }
+
+    return true;
+}
+
+
+bool K3b::AudioChecksumReader::readSamples( char* buffer, qint64 firstSample, qint64 samples )
+{
+    const qint64 firstSector = floorDiv( firstSample, AudioChecksum::SAMPLES_PER_SECTOR );
+    const qint64 lastSector = floorDiv( firstSample + samples - 1, AudioChecksum::SAMPLES_PER_SECTOR );
+
+    QByteArray sectors( ( lastSector - firstSector + 1 )*SECTOR_SIZE, Qt::Uninitialized );
+    if( !readSectors( sectors.data(), firstSector, lastSector - firstSector + 1 ) )
+        return false;
+
+    ::memcpy( buffer,
+              sectors.constData() + ( firstSample - firstSector*AudioChecksum::SAMPLES_PER_SECTOR )*4,
+              samples*4 );
+    return true;
+}
+
+
+bool K3b::AudioChecksumReader::detectReadOffset()
+{
+    const QByteArray probe = d->reference.probe();
+    if( probe.isEmpty() )
+        return false;
+
+    // read the region where the probe is expected with a drive offset of 0 plus the highest offset on both sides
+    const qint64 samples = AudioChecksum::PROBE_SAMPLES + 2*MAX_READ_OFFSET;
+    const qint64 firstSample = qint64( d->firstSector.lba() )*AudioChecksum::SAMPLES_PER_SECTOR
+                               + d->reference.probePosition() - MAX_READ_OFFSET;
+
+    QByteArray buffer( samples*4, Qt::Uninitialized );
+    if( !readSamples( buffer.data(), firstSample, samples ) )
+        return false;
+
+    qint64 pos = 0;
+    if( !AudioChecksum::findProbe( probe, buffer.constData(), samples, MAX_READ_OFFSET, &pos ) )
+        return false;
+
+    d->readOffset = pos - MAX_READ_OFFSET;
+    d->readOffsetDetected = true;
+    qDebug() << "(K3b::AudioChecksumReader) detected read offset:" << d->readOffset;
+
+    return true;
+}
+
+
+bool K3b::AudioChecksumReader::calculateChecksum()
+{
+    d->checksum = AudioChecksum( d->reference.length(), d->reference.firstTrack(), d->reference.lastTrack() );
+
+    const qint64 totalSamples = qint64( d->reference.length().lba() )*AudioChecksum::SAMPLES_PER_SECTOR;
+    const qint64 firstSample = qint64( d->firstSector.lba() )*AudioChecksum::SAMPLES_PER_SECTOR + d->readOffset;
+    const qint64 bufferSamples = qint64( d->readSectors() )*AudioChecksum::SAMPLES_PER_SECTOR;
+
+    QByteArray buffer( bufferSamples*4, Qt::Uninitialized );
+    int lastPercent = 0;
+    for( qint64 done = 0; done < totalSamples; ) {
+        if( canceled() )
+            return false;
+
+        const qint64 samples = qMin( bufferSamples, totalSamples - done );
+        if( !readSamples( buffer.data(), firstSample + done, samples ) )
+            return false;
+
+        d->checksum.update( buffer.constData(), samples*4, AudioChecksum::LittleEndian );
+        done += samples;
+
+        const int currentPercent = 100LL * done / totalSamples;
+        if( currentPercent > lastPercent ) {
+            lastPercent = currentPercent;
+            emit percent( currentPercent );
+        }
+    }
+
+    return true;
+}
+
+
+bool K3b::AudioChecksumReader::run()
+{
+    if( !openSource() )
+        return false;
+
+    if( d->device ) {
+        k3bcore->blockDevice( d->device );
+        d->device->block( true );
+    }
+
+    if( d->detectReadOffset && !detectReadOffset() ) {
+        emit infoMessage( i18n("Unable to determine the read offset. Using an offset of %1 samples.", d->readOffset),
+                          K3b::Job::MessageWarning );
+    }
+
+    const bool success = calculateChecksum();
+
+    if( d->device ) {
+        d->device->block( false );
+        k3bcore->unblockDevice( d->device );
+    }
+    closeSource();
+
+    return success && !canceled();
+}
@@ -0,0 +1,112 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_AUDIO_CHECKSUM_READER_H_
+#define _K3B_AUDIO_CHECKSUM_READER_H_
+
+#include "k3bthreadjob.h"
+
+#include "k3baudiochecksum.h"
+#include "k3bmsf.h"
+
+#include "k3b_export.h"
+
+
+namespace K3b {
+    namespace Device {
+        class Device;
+    }
+
+    /**
+     * Reads an audio track from a CD and calculates its AudioChecksum.
+     *
+     * The audio sectors are read with Device::readCd. Since drives return
+     * the audio data shifted by their read offset (and writers by their
+     * write offset) the reader can search the probe of the reference
+     * checksum in the data read to determine the combined offset first.
+     *
+     * Instead of a device the reader can use a raw (BIN) or wave image of
+     * the complete disc which is treated as a simulated medium starting
+     * at sector 0.
+     */
+    class LIBK3B_EXPORT AudioChecksumReader : public ThreadJob
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * The highest offset in samples which is searched.
+         */
+        static const int MAX_READ_OFFSET = 5*AudioChecksum::SAMPLES_PER_SECTOR - 1;
+
+        explicit AudioChecksumReader( JobHandler*, QObject* parent = 0 );
+        ~AudioChecksumReader() override;
+
+        void setDevice( Device::Device* dev );
+
+        /**
+         * Read from an image file instead of a device.
+         */
+        void setImagePath( const QString& path );
+
+        /**
+         * The last sector of the medium. Samples behind it are treated
+         * as silence. Only used when reading from a device.
+         */
+        void setLastSector( const Msf& sector );
+
+        /**
+         * \param firstSector The first sector of the track on the medium.
+         * \param reference The expected checksum. Its length and disc position
+         *        are used for the calculation and its probe for the offset detection.
+         */
+        void setTrack( const Msf& firstSector, const AudioChecksum& reference );
+
+        /**
+         * The offset in samples to apply when reading. Ignored if the
+         * offset detection is enabled.
+         */
+        void setReadOffset( int offset );
+
+        void setDetectReadOffset( bool b );
+
+        /**
+         * \return The used read offset. After the job finished this is
+         *         the detected offset if the detection succeeded.
+         */
+        int readOffset() const;
+
+        /**
+         * \return true if the read offset has been detected.
+         */
+        bool readOffsetDetected() const;
+
+        /**
+         * \return The checksum of the data read.
+         */
+        AudioChecksum checksum() const;
+
+        /**
+         * The following methods are used by the job. They are public
+         * to allow verifying an image without starting a thread.
+         */
+        bool openSource();
+        void closeSource();
+        bool detectReadOffset();
+        bool calculateChecksum();
+
+    private:
+        bool run() override;
+
+        bool readSamples( char* buffer, qint64 firstSample, qint64 samples );
+        bool readSectors( char* buffer, long sector, int sectors );
+
+        class Private;
+        Private* const d;
+    };
+}
+
+#endif
@@ -77,6 +77,7 @@ K3b::AudioCueFileWritingJob::AudioCueFileWritingJob( K3b::JobHandler* jh, QObjec
     connect( d->audioJob, SIGNAL(burning(bool)), this, SIGNAL(burning(bool)) );
     connect( d->audioJob, SIGNAL(bufferStatus(int)), this, SIGNAL(bufferStatus(int)) );
     connect( d->audioJob, SIGNAL(deviceBuffer(int)), this, SIGNAL(deviceBuffer(int)) );
+    connect( d->audioJob, SIGNAL(readAheadBufferStatus(int)), this, SIGNAL(readAheadBufferStatus(int)) );
     connect( d->audioJob, SIGNAL(writeSpeed(int,K3b::Device::SpeedMultiplicator)), this, SIGNAL(writeSpeed(int,K3b::Device::SpeedMultiplicator)) );
 
     d->canceled = false;
@@ -0,0 +1,220 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3baudiofileanalyzerpool.h"
+#include "k3baudiodecoder.h"
+
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+
+
+namespace {
+    struct Item
+    {
+        K3b::AudioFileAnalyzerPool::DecoderCreator* creator;
+        K3b::AudioDecoder* decoder;
+        bool done;
+        bool success;
+    };
+}
+
+
+class K3b::AudioFileAnalyzerPool::Private
+{
+public:
+    Private()
+        : maxThreads( qMax( 1, QThread::idealThreadCount() ) ),
+          workers( 0 ) {
+    }
+
+    int maxThreads;
+
+    // all items which have not been reported yet in the order they were added
+    QList<Item*> items;
+
+    // the items which wait for a worker
+    QQueue<Item*> waiting;
+
+    // the number of workers which still take items
+    int workers;
+    QList<QThread*> threads;
+
+    void enqueue( Item* item, AudioFileAnalyzerPool* pool );
+
+    // protects waiting, workers and the state of the items
+    QMutex mutex;
+};
+
+
+void K3b::AudioFileAnalyzerPool::Private::enqueue( Item* item, AudioFileAnalyzerPool* pool )
+{
+    // get rid of the workers which ran out of items
+    for( QList<QThread*>::iterator it = threads.begin(); it != threads.end(); ) {
+        if( (*it)->isFinished() ) {
+            delete *it;
+            it = threads.erase( it );
+        }
+        else {
+            ++it;
+        }
+    }
+
+    QMutexLocker locker( &mutex );
+    items.append( item );
+    if( item->done ) {
+        QMetaObject::invokeMethod( pool, "slotReportAnalysed", Qt::QueuedConnection );
+    }
+    else {
+        waiting.enqueue( item );
+        if( workers < maxThreads ) {
+            ++workers;
+            QThread* thread = QThread::create( [pool]() { pool->runWorker(); } );
+            threads.append( thread );
+            thread->start();
+        }
+    }
+}
+
+
+K3b::AudioFileAnalyzerPool::DecoderCreator::~DecoderCreator()
+{
+}
+
+
+K3b::AudioFileAnalyzerPool::AudioFileAnalyzerPool( QObject* parent )
+    : QObject( parent ),
+      d( new Private() )
+{
+}
+
+
+K3b::AudioFileAnalyzerPool::~AudioFileAnalyzerPool()
+{
+    cancel();
+    delete d;
+}
+
+
+void K3b::AudioFileAnalyzerPool::setMaxThreads( int threads )
+{
+    d->maxThreads = qMax( 1, threads );
+}
+
+
+int K3b::AudioFileAnalyzerPool::maxThreads() const
+{
+    return d->maxThreads;
+}
+
+
+void K3b::AudioFileAnalyzerPool::add( K3b::AudioDecoder* decoder, bool analyse )
+{
+    Item* item = new Item;
+    item->creator = 0;
+    item->decoder = decoder;
+    item->done = !( decoder && analyse );
+    item->success = true;
+    d->enqueue( item, this );
+}
+
+
+void K3b::AudioFileAnalyzerPool::add( DecoderCreator* creator )
+{
+    Item* item = new Item;
+    item->creator = creator;
+    item->decoder = 0;
+    item->done = false;
+    item->success = true;
+    d->enqueue( item, this );
+}
+
+
+int K3b::AudioFileAnalyzerPool::pending() const
+{
+    return d->items.count();
+}
+
+
+QList<K3b::AudioDecoder*> K3b::AudioFileAnalyzerPool::cancel()
+{
+    d->mutex.lock();
+    d->waiting.clear();
+    d->mutex.unlock();
+
+    Q_FOREACH( QThread* thread, d->threads ) {
+        thread->wait();
+        delete thread;
+    }
+    d->threads.clear();
+
+    QList<AudioDecoder*> decoders;
+    Q_FOREACH( Item* item, d->items ) {
+        if( item->decoder )
+            decoders.append( item->decoder );
+        delete item;
+    }
+    d->items.clear();
+
+    return decoders;
+}
+
+
+void K3b::AudioFileAnalyzerPool::runWorker()
+{
+    forever {
+        Item* item = 0;
+        {
+            QMutexLocker locker( &d->mutex );
+            if( d->waiting.isEmpty() ) {
+                --d->workers;
+                return;
+            }
+            item = d->waiting.dequeue();
+        }
+
+        // nobody touches a dequeued item until it is done
+        AudioDecoder* decoder = item->decoder;
+        bool analyse = true;
+        if( item->creator )
+            decoder = item->creator->createDecoder( analyse );
+
+        const bool success = ( decoder && analyse ) ? decoder->analyseFile() : true;
+
+        {
+            QMutexLocker locker( &d->mutex );
+            item->decoder = decoder;
+            item->success = success;
+            item->done = true;
+        }
+        QMetaObject::invokeMethod( this, "slotReportAnalysed", Qt::QueuedConnection );
+    }
+}
+
+
+void K3b::AudioFileAnalyzerPool::slotReportAnalysed()
+{
+    bool reported = false;
+    forever {
+        Item* item = 0;
+        {
+            QMutexLocker locker( &d->mutex );
+            if( d->items.isEmpty() || !d->items.first()->done )
+                break;
+            item = d->items.takeFirst();
+        }
+
+        AudioDecoder* decoder = item->decoder;
+        const bool success = item->success;
+        delete item;
+
+        reported = true;
+        emit analysed( decoder, success );
+    }
+
+    if( reported && d->items.isEmpty() )
+        emit finished();
+}
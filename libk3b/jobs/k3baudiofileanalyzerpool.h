@@ -0,0 +1,126 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_AUDIO_FILE_ANALYZER_POOL_H_
+#define _K3B_AUDIO_FILE_ANALYZER_POOL_H_
+
+#include "k3b_export.h"
+
+#include <QList>
+#include <QObject>
+
+namespace K3b {
+    class AudioDecoder;
+
+    /**
+     * Runs AudioDecoder::analyseFile for several decoders at once with
+     * a bounded number of threads.
+     *
+     * The results are reported in the order the decoders were added,
+     * regardless of the order in which the analyses finish. Thus the
+     * caller can add the files to a project as if they were analysed
+     * one after the other.
+     *
+     * The pool does not take ownership of the decoders.
+     */
+    class LIBK3B_EXPORT AudioFileAnalyzerPool : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * Creates the decoder of a queued file in a worker thread. Use this
+         * if finding the decoder needs to read the file, like parsing cue
+         * files or probing the decoder plugins does.
+         */
+        class LIBK3B_EXPORT DecoderCreator
+        {
+        public:
+            virtual ~DecoderCreator();
+
+            /**
+             * Called from a worker thread.
+             *
+             * \param analyse Set to false if the returned decoder does not
+             *        need to be analysed. Defaults to true.
+             * \return The decoder or 0 if there is none. 0 is reported
+             *        without analysis.
+             */
+            virtual AudioDecoder* createDecoder( bool& analyse ) = 0;
+        };
+
+        explicit AudioFileAnalyzerPool( QObject* parent = 0 );
+
+        /**
+         * Cancels all analyses. Use cancel() to get the decoders
+         * which have not been reported yet.
+         */
+        ~AudioFileAnalyzerPool() override;
+
+        /**
+         * The number of decoders analysed at once. Defaults to
+         * the number of cores.
+         */
+        void setMaxThreads( int threads );
+        int maxThreads() const;
+
+        /**
+         * Queue a decoder.
+         *
+         * \param decoder The decoder to report. May be 0 to keep a
+         *        place in the order of the results.
+         * \param analyse If false the decoder is reported without analysis,
+         *        for example since it has already been analysed.
+         */
+        void add( AudioDecoder* decoder, bool analyse = true );
+
+        /**
+         * Queue a file whose decoder is created by \p creator in a worker
+         * thread before it is analysed. The pool does not take ownership
+         * of \p creator which has to exist until the decoder has been
+         * reported or the pool has been canceled.
+         */
+        void add( DecoderCreator* creator );
+
+        /**
+         * \return The number of decoders which have not been reported yet.
+         */
+        int pending() const;
+
+        /**
+         * Stops the analysis. Decoders which are being analysed are waited
+         * for, the others are not touched anymore.
+         *
+         * \return All decoders which have not been reported. This includes
+         *         the ones created by a DecoderCreator.
+         */
+        QList<AudioDecoder*> cancel();
+
+    Q_SIGNALS:
+        /**
+         * Emitted once for every added decoder in the order they were added.
+         * \param success The result of AudioDecoder::analyseFile. Always true
+         *        for decoders added without analysis.
+         */
+        void analysed( K3b::AudioDecoder* decoder, bool success );
+
+        /**
+         * Emitted once all added decoders have been reported.
+         */
+        void finished();
+
+    private Q_SLOTS:
+        void slotReportAnalysed();
+
+    private:
+        void runWorker();
+
+        class Private;
+        Private* const d;
+    };
+}
+
+#endif
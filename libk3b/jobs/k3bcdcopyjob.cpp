@@ -41,7 +41,6 @@
 #include <QVector>
 #include <QApplication>
 
-#include <KCDDB/Client>
 #include <KCDDB/CDInfo>
 
 
@@ -56,8 +55,7 @@ public:
           dataTrackReader(0),
           audioSessionReader(0),
           cdrecordWriter(0),
-          infFileWriter(0),
-          cddb(0) {
+          infFileWriter(0) {
     }
 
     bool canceled;
@@ -94,7 +92,6 @@ public:
     // indicates if we created a dir or not
     bool deleteTempDir;
 
-    KCDDB::Client* cddb;
     KCDDB::CDInfo cddbInfo;
 
     bool haveCddb;
@@ -399,51 +396,33 @@ void K3b::CdCopyJob::queryCddb()
 
     d->haveCddb = false;
 
-    if( !d->cddb ) {
-        d->cddb = new KCDDB::Client();
-        d->cddb->setBlockingMode( false );
-        connect( d->cddb, SIGNAL(finished(KCDDB::Result)),
-                 this, SLOT(slotCddbQueryFinished(KCDDB::Result)) );
-    }
-
-    d->cddb->config().load();
-    d->cddb->lookup( K3b::CDDB::createTrackOffsetList( d->toc ) );
+    // the job answers from the local disc id index and stores new entries in it
+    K3b::CDDB::CDDBJob* job = K3b::CDDB::CDDBJob::queryCddb( d->toc );
+    connect( job, SIGNAL(result(KJob*)),
+             this, SLOT(slotCddbQueryFinished(KJob*)) );
 }
 
 
-void K3b::CdCopyJob::slotCddbQueryFinished( KCDDB::Result result )
+void K3b::CdCopyJob::slotCddbQueryFinished( KJob* job )
 {
-    if( result == KCDDB::Success ) {
-        d->cddbInfo = d->cddb->lookupResponse().first();
-        d->haveCddb = true;
-        emit infoMessage( i18n("Found CDDB entry (%1 - %2).",
-                               d->cddbInfo.get( KCDDB::Artist ).toString(),
-                               d->cddbInfo.get( KCDDB::Title ).toString() ),
-                          MessageSuccess );
-
-        // save the entry locally
-        d->cddb->store( d->cddbInfo, K3b::CDDB::createTrackOffsetList( d->toc ) );
-    }
-    else if ( result == KCDDB::MultipleRecordFound ) {
-        KCDDB::CDInfoList results = d->cddb->lookupResponse();
-        int i = K3b::CDDB::MultiEntriesDialog::selectCddbEntry( results, qApp->activeWindow() );
-        if ( i >= 0 ) {
-            d->haveCddb = true;
-            d->cddbInfo = results[i];
-
-            // save the entry locally
-            d->cddb->store( d->cddbInfo, K3b::CDDB::createTrackOffsetList( d->toc ) );
-        }
-        else {
-            d->haveCddb = false;
-        }
+    K3b::CDDB::CDDBJob* cddbJob = static_cast<K3b::CDDB::CDDBJob*>( job );
+
+    if( !job->error() ) {
+        // an empty result means the user did not pick one of multiple entries
+        d->cddbInfo = cddbJob->cddbResult();
+        d->haveCddb = d->cddbInfo.isValid();
+        if( d->haveCddb )
+            emit infoMessage( i18n("Found CDDB entry (%1 - %2).",
+                                   d->cddbInfo.get( KCDDB::Artist ).toString(),
+                                   d->cddbInfo.get( KCDDB::Title ).toString() ),
+                              MessageSuccess );
     }
-    else if( result == KCDDB::NoRecordFound ) {
+    else if( cddbJob->queryResult() == KCDDB::NoRecordFound ) {
         emit infoMessage( i18n("No CDDB entry found."), MessageWarning );
     }
     else {
         emit infoMessage( i18n("CDDB error (%1).",
-                               KCDDB::resultToString( result ) ),
+                               job->errorText() ),
                           MessageError );
     }
 
@@ -70,7 +70,7 @@ namespace K3b {
         void slotDiskInfoReady( K3b::Device::DeviceHandler* );
         void slotCdTextReady( K3b::Device::DeviceHandler* );
         void slotMediaReloadedForNextSession( K3b::Device::DeviceHandler* dh );
-        void slotCddbQueryFinished( KCDDB::Result );
+        void slotCddbQueryFinished( KJob* );
         void slotWritingNextTrack( int t, int tt );
         void slotReadingNextTrack( int t, int tt );
         void slotSessionReaderFinished( bool success );
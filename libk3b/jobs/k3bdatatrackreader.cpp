@@ -7,6 +7,7 @@
 #include "k3blibdvdcss.h"
 #include "k3bdevice.h"
 #include "k3bdeviceglobals.h"
+#include "k3breadqueue.h"
 #include "k3btrack.h"
 #include "k3bthread.h"
 #include "k3bcore.h"
@@ -18,10 +19,10 @@
 #include <unistd.h>
 
 
-
-// FIXME: determine max DMA buffer size
-static int s_bufferSizeSectors = 10;
-
+namespace {
+    // The number of reads queued while the previous data is written
+    const int s_queueDepth = 3;
+}
 
 class K3b::DataTrackReader::Private
 {
@@ -29,6 +30,24 @@ public:
     Private();
     ~Private();
 
+    /**
+     * Lets the read queue read like DataTrackReader::read()
+     */
+    class QueueReader : public K3b::Device::ReadQueue::Reader
+    {
+    public:
+        explicit QueueReader( K3b::DataTrackReader* reader )
+            : m_reader( reader ) {
+        }
+
+        bool read( unsigned char* buffer, unsigned long sector, unsigned int sectors ) override {
+            return m_reader->read( buffer, sector, sectors ) >= 0;
+        }
+
+    private:
+        K3b::DataTrackReader* m_reader;
+    };
+
     bool ignoreReadErrors;
     bool noCorrection;
     int retries;
@@ -245,30 +264,22 @@ bool K3b::DataTrackReader::run()
     //
     d->device->setSpeed( 0xffff, 0xffff );
 
-#ifdef Q_OS_NETBSD
-    s_bufferSizeSectors = 31;
-#else
-    s_bufferSizeSectors = 128;
-#endif
-    unsigned char* buffer = new unsigned char[d->usedSectorSize*s_bufferSizeSectors];
-    while( s_bufferSizeSectors > 0 && read( buffer, d->firstSector.lba(), s_bufferSizeSectors ) < 0 ) {
-        qDebug() << "(K3b::DataTrackReader) determine max read sectors: "
-                 << s_bufferSizeSectors << " too high." << Qt::endl;
-        s_bufferSizeSectors /= 2;
-    }
-    qDebug() << "(K3b::DataTrackReader) determine max read sectors: "
-             << s_bufferSizeSectors << " is max." << Qt::endl;
-
-    //    s_bufferSizeSectors = K3b::Device::determineMaxReadingBufferSize( d->device, d->firstSector );
-    if( s_bufferSizeSectors <= 0 ) {
-        emit infoMessage( i18n("Error while reading sector %1.",d->firstSector.lba()), K3b::Job::MessageError );
-        d->device->block( false );
-        k3bcore->unblockDevice( d->device );
-        return false;
-    }
+    //
+    // Read as much as the device transfers with one command. In case the drive
+    // rejects the first read we try smaller ones. Since a read error or a drive
+    // which is not ready yet looks the same the device only remembers the
+    // smaller size if the rejected one failed a second time and all sectors
+    // could be read.
+    //
+    const int deviceSectors = d->device->maxReadSectors( d->usedSectorSize );
+    int bufferSectors = deviceSectors;
+    bool transferLengthChecked = false;
+    bool transferLengthConfirmed = false;
+    bool retried = false;
+    unsigned char* buffer = new unsigned char[d->usedSectorSize*deviceSectors];
 
-    qDebug() << "(K3b::DataTrackReader) using buffer size of " << s_bufferSizeSectors << " blocks.";
-    emit debuggingOutput( "K3b::DataTrackReader", QString("using buffer size of %1 blocks.").arg( s_bufferSizeSectors ) );
+    qDebug() << "(K3b::DataTrackReader) using buffer size of " << bufferSectors << " blocks.";
+    emit debuggingOutput( "K3b::DataTrackReader", QString("using buffer size of %1 blocks.").arg( bufferSectors ) );
 
     // 2. get it on
     K3b::Msf currentSector = d->firstSector;
@@ -279,15 +290,60 @@ bool K3b::DataTrackReader::run()
     bool readError = false;
     int lastPercent = 0;
     unsigned long lastReadMb = 0;
-    int bufferLen = s_bufferSizeSectors*d->usedSectorSize;
+    //
+    // Once the transfer length is known the following sectors are read through
+    // a queue which keeps the drive busy while we write the data.
+    //
+    K3b::Device::ReadQueue* queue = 0;
+    K3b::Msf nextQueuedSector;
     while( !canceled() && currentSector <= d->lastSector ) {
 
-        int maxReadSectors = qMin( bufferLen/d->usedSectorSize, d->lastSector.lba()-currentSector.lba()+1 );
+        int maxReadSectors = qMin( bufferSectors, d->lastSector.lba()-currentSector.lba()+1 );
+        int readSectors = -1;
+        const unsigned char* data = buffer;
+
+        if( queue ) {
+            if( queue->pending() == 0 )
+                nextQueuedSector = currentSector;
+            while( nextQueuedSector <= d->lastSector ) {
+                int sectors = qMin( bufferSectors, d->lastSector.lba()-nextQueuedSector.lba()+1 );
+                if( !queue->submit( nextQueuedSector.lba(), sectors ) )
+                    break;
+                nextQueuedSector += sectors;
+            }
 
-        int readSectors = read( buffer,
+            K3b::Device::ReadQueue::Request request;
+            queue->complete( request );
+            maxReadSectors = request.sectors;
+            if( request.success ) {
+                readSectors = request.sectors;
+                data = request.data;
+            }
+            else {
+                // retryRead() reads synchronously
+                queue->cancel();
+            }
+        }
+        else {
+            readSectors = read( buffer,
                                 currentSector.lba(),
                                 maxReadSectors );
+        }
+
         if( readSectors < 0 ) {
+            if( !transferLengthChecked && maxReadSectors > 1 ) {
+                qDebug() << "(K3b::DataTrackReader) reading " << maxReadSectors << " sectors failed. Trying less.";
+                bufferSectors = maxReadSectors/2;
+                continue;
+            }
+
+            // not the transfer length but a read error
+            if( !transferLengthChecked ) {
+                transferLengthChecked = true;
+                bufferSectors = deviceSectors;
+            }
+            retried = true;
+
             if( !retryRead( buffer,
                             currentSector.lba(),
                             maxReadSectors ) ) {
@@ -297,13 +353,38 @@ bool K3b::DataTrackReader::run()
             else
                 readSectors = maxReadSectors;
         }
+        else if( !transferLengthChecked ) {
+            transferLengthChecked = true;
+            if( bufferSectors < deviceSectors ) {
+                // read the same sectors with the rejected size once more. A
+                // buffer of its own keeps the data we already got intact.
+                const int rejectedSectors = qMin( 2*bufferSectors, deviceSectors );
+                if( rejectedSectors <= d->lastSector.lba()-currentSector.lba()+1 ) {
+                    unsigned char* confirmBuffer = new unsigned char[d->usedSectorSize*rejectedSectors];
+                    if( read( confirmBuffer, currentSector.lba(), rejectedSectors ) == rejectedSectors ) {
+                        qDebug() << "(K3b::DataTrackReader) reading " << rejectedSectors << " sectors failed only once.";
+                        bufferSectors = rejectedSectors;
+                    }
+                    else {
+                        transferLengthConfirmed = true;
+                    }
+                    delete [] confirmBuffer;
+                }
+
+                qDebug() << "(K3b::DataTrackReader) max read sectors: " << bufferSectors;
+                emit debuggingOutput( "K3b::DataTrackReader", QString("using buffer size of %1 blocks.").arg( bufferSectors ) );
+            }
+        }
+
+        if( transferLengthChecked && !queue )
+            queue = new K3b::Device::ReadQueue( new Private::QueueReader( this ), d->usedSectorSize, bufferSectors, s_queueDepth );
 
         totalReadSectors += readSectors;
 
         int readBytes = readSectors * d->usedSectorSize;
 
         if( d->ioDevice ) {
-            if( d->ioDevice->write( reinterpret_cast<char*>(buffer ), readBytes ) != readBytes ) {
+            if( d->ioDevice->write( reinterpret_cast<const char*>(data), readBytes ) != readBytes ) {
                 qDebug() << "(K3b::DataTrackReader::WorkThread) error while writing to dev " << d->ioDevice
                          << " current sector: " << (currentSector.lba()-d->firstSector.lba()) << Qt::endl;
                 emit debuggingOutput( "K3b::DataTrackReader",
@@ -314,7 +395,7 @@ bool K3b::DataTrackReader::run()
             }
         }
         else {
-            if( file.write( reinterpret_cast<char*>(buffer), readBytes ) != readBytes ) {
+            if( file.write( reinterpret_cast<const char*>(data), readBytes ) != readBytes ) {
                 qDebug() << "(K3b::DataTrackReader::WorkThread) error while writing to file " << d->imagePath
                          << " current sector: " << (currentSector.lba()-d->firstSector.lba()) << Qt::endl;
                 emit debuggingOutput( "K3b::DataTrackReader",
@@ -342,10 +423,16 @@ bool K3b::DataTrackReader::run()
         }
     }
 
+    // waits for a read still running
+    delete queue;
+
     if( d->errorSectorCount > 0 )
         emit infoMessage( i18np("Ignored %1 erroneous sector.", "Ignored a total of %1 erroneous sectors.", d->errorSectorCount ),
                           K3b::Job::MessageError );
 
+    if( transferLengthConfirmed && !readError && !retried && !canceled() )
+        d->device->setMaxTransferLength( bufferSectors*d->usedSectorSize );
+
     // reset the error recovery mode
     setErrorRecovery( d->device, d->oldErrorRecoveryMode );
 
@@ -23,6 +23,7 @@
 #include "k3biso9660.h"
 #include "k3bfilesplitter.h"
 #include "k3bchecksumpipe.h"
+#include "k3bchecksummanifest.h"
 #include "k3bverificationjob.h"
 #include "k3bglobalsettings.h"
 #include "k3b_i18n.h"
@@ -47,6 +48,9 @@ public:
           verificationJob(0),
           usedWritingMode(K3b::WritingModeAuto),
           verifyData(false) {
+        // DVD images are large, move them in big chunks
+        inPipe.setBufferSize( 1024*1024 );
+        outPipe.setBufferSize( 1024*1024 );
         outPipe.readFrom( &imageFile, true );
     }
 
@@ -449,6 +453,7 @@ void K3b::DvdCopyJob::prepareReader()
     else
         d->inPipe.writeTo( &d->imageFile, true );
 
+    d->inPipe.setBlockSize( K3b::ChecksumManifest::DEFAULT_BLOCK_SIZE );
     d->inPipe.open( true );
     d->dataTrackReader->writeTo( &d->inPipe );
 }
@@ -642,6 +647,12 @@ void K3b::DvdCopyJob::slotWriterFinished( bool success )
         d->running = false;
     }
 
+    // the writer does not notice if it got less data than expected
+    if( success && !m_onTheFly && !d->outPipe.transferError().isEmpty() ) {
+        emit infoMessage( i18n("Error while passing the data to the writer: %1", d->outPipe.transferError()), MessageError );
+        success = false;
+    }
+
     if( success ) {
         emit infoMessage( i18n("Successfully written copy %1.",d->doneCopies+1), MessageInfo );
 
@@ -663,7 +674,7 @@ void K3b::DvdCopyJob::slotWriterFinished( bool success )
 
             }
             d->verificationJob->setDevice( m_writerDevice );
-            d->verificationJob->addTrack( 1, d->inPipe.checksum(), d->lastSector+1 );
+            d->verificationJob->addTrack( 1, d->inPipe.manifest(), d->lastSector+1 );
 
             if( m_copies > 1 )
                 emit newTask( i18n("Verifying copy %1",d->doneCopies+1) );
@@ -8,6 +8,7 @@
 
 #include "k3biso9660imagewritingjob.h"
 #include "k3bverificationjob.h"
+#include "k3bchecksummanifest.h"
 #include "k3bmetawriter.h"
 
 #include "k3bdevice.h"
@@ -35,6 +36,9 @@ public:
     K3b::ChecksumPipe checksumPipe;
     K3b::FileSplitter imageFile;
 
+    // the checksums saved when the image was created, if any
+    K3b::ChecksumManifest savedManifest;
+
     bool isDvdImage;
     int currentCopy;
     bool canceled;
@@ -91,6 +95,14 @@ void K3b::Iso9660ImageWritingJob::start()
     // very rough test but since most dvd images are 4,x or 8,x GB it should be enough
     d->isDvdImage = ( mb > 900ULL );
 
+    const QString manifestFile = K3b::ChecksumManifest::manifestFileName( m_imagePath );
+    d->savedManifest = K3b::ChecksumManifest();
+    if( QFile::exists( manifestFile ) ) {
+        d->savedManifest = K3b::ChecksumManifest::load( manifestFile );
+        if( !d->savedManifest.isValid() )
+            emit infoMessage( i18n("Could not read the checksums saved in %1", manifestFile), K3b::Job::MessageWarning );
+    }
+
     startWriting();
 }
 
@@ -107,6 +119,14 @@ void K3b::Iso9660ImageWritingJob::slotWriterJobFinished( bool success )
     d->checksumPipe.close();
 
     if( success ) {
+        // the image was read while writing, compare it against the checksums saved when it was created
+        const K3b::ChecksumManifest writtenManifest = d->checksumPipe.manifest();
+        if( d->savedManifest.isValid() &&
+            ( d->savedManifest.size() != writtenManifest.size() ||
+              d->savedManifest.checksum() != writtenManifest.checksum() ) ) {
+            emit infoMessage( i18n("The image %1 has changed since its checksums were saved.", m_imagePath), K3b::Job::MessageWarning );
+        }
+
         if( !m_simulate && m_verifyData ) {
             emit burning(false);
 
@@ -124,7 +144,7 @@ void K3b::Iso9660ImageWritingJob::slotWriterJobFinished( bool success )
             }
             d->verifyJob->setDevice( m_device );
             d->verifyJob->clear();
-            d->verifyJob->addTrack( 1, d->checksumPipe.checksum(), K3b::imageFilesize( QUrl::fromLocalFile(m_imagePath) )/2048 );
+            d->verifyJob->addTrack( 1, writtenManifest, K3b::imageFilesize( QUrl::fromLocalFile(m_imagePath) )/2048 );
 
             if( m_copies == 1 )
                 emit newTask( i18n("Verifying written data") );
@@ -270,6 +290,7 @@ void K3b::Iso9660ImageWritingJob::startWriting()
     d->imageFile.setName( m_imagePath );
     d->imageFile.open( QIODevice::ReadOnly );
     d->checksumPipe.close();
+    d->checksumPipe.setBufferSize( 1024*1024 );
     d->checksumPipe.readFrom( &d->imageFile, true );
 
     if( prepareWriter() ) {
@@ -279,7 +300,14 @@ void K3b::Iso9660ImageWritingJob::startWriting()
 #warning Growisofs needs stdin to be closed in order to exit gracefully. Cdrecord does not. However,  if closed with cdrecord we loose parts of stderr. Why?
 #endif
         d->checksumPipe.writeTo( d->writer->ioDevice(), d->writer->usedWritingApp() == K3b::WritingAppGrowisofs );
-        d->checksumPipe.open( K3b::ChecksumPipe::MD5, true );
+        if( d->savedManifest.isValid() ) {
+            d->checksumPipe.setBlockSize( d->savedManifest.blockSize() );
+            d->checksumPipe.open( d->savedManifest.type(), true );
+        }
+        else {
+            d->checksumPipe.setBlockSize( K3b::ChecksumManifest::DEFAULT_BLOCK_SIZE );
+            d->checksumPipe.open( K3b::ChecksumPipe::MD5, true );
+        }
     }
     else {
         d->finished = true;
@@ -12,12 +12,15 @@
 #include "k3bdevicehandler.h"
 #include "k3bglobals.h"
 #include "k3bdatatrackreader.h"
+#include "k3baudiochecksumreader.h"
 #include "k3bchecksumpipe.h"
+#include "k3bchecksummanifest.h"
 #include "k3biso9660.h"
 #include "k3b_i18n.h"
 
 #include <QDebug>
 #include <QList>
+#include <QStringList>
 
 
 namespace {
@@ -34,20 +37,110 @@ namespace {
               length(msf) {
         }
 
+        TrackEntry( int tn, const K3b::ChecksumManifest& m, const K3b::Msf& msf )
+            : trackNumber(tn),
+              checksum(m.checksum()),
+              manifest(m),
+              length(msf) {
+        }
+
+        TrackEntry( int tn, const K3b::AudioChecksum& cs )
+            : trackNumber(tn),
+              audioChecksum(cs) {
+        }
+
         int trackNumber;
         QByteArray checksum;
+        K3b::ChecksumManifest manifest;
+        K3b::AudioChecksum audioChecksum;
         mutable K3b::Msf length; // it's a cache, let's make it modifiable
     };
 
     typedef QList<TrackEntry> TrackEntries;
 
-    class NullSinkChecksumPipe : public K3b::ChecksumPipe
+    /**
+     * Calculates the checksum of the data read and compares
+     * it block by block against a manifest if one is set.
+     * The block checksums are the ones calculated by the
+     * ChecksumPipe anyway.
+     */
+    class VerificationPipe : public K3b::ChecksumPipe
     {
+    public:
+        VerificationPipe( K3b::VerificationJob* job )
+            : m_job( job ),
+              m_checkedBlocks( 0 ),
+              m_stopOnDifference( false ),
+              m_differenceReported( false ) {
+        }
+
+        void open( const K3b::ChecksumManifest& manifest, bool stopOnDifference ) {
+            m_manifest = manifest;
+            m_stopOnDifference = stopOnDifference;
+            m_checkedBlocks = 0;
+            m_differenceReported = false;
+            if( m_manifest.isValid() ) {
+                setBlockSize( m_manifest.blockSize() );
+                ChecksumPipe::open( m_manifest.type() );
+            }
+            else {
+                setBlockSize( 0 );
+                ChecksumPipe::open();
+            }
+        }
+
+        /**
+         * Compares the block checksums calculated so far against the manifest.
+         *
+         * \param complete If true all data has been read and the checksums
+         *        have been finished. Blocks which have not been read count
+         *        as differing then.
+         * \return The indices of all differing blocks.
+         */
+        QList<int> differingBlocks( bool complete ) const {
+            QList<int> blocks;
+            if( m_manifest.isValid() ) {
+                const QList<QByteArray> expected = m_manifest.blockChecksums();
+                const QList<QByteArray> read = blockChecksums();
+                for( int i = 0; i < read.count(); ++i ) {
+                    if( i >= expected.count() || read[i] != expected[i] )
+                        blocks.append( i );
+                }
+                if( complete ) {
+                    for( int i = read.count(); i < expected.count(); ++i )
+                        blocks.append( i );
+                }
+            }
+            return blocks;
+        }
+
     protected:
         qint64 writeData( const char* data, qint64 max ) override {
+            // there is no sink, the data only needs to be hashed
             ChecksumPipe::writeData( data, max );
+
+            // the blocks are hashed in the background, check the ones finished since the last call
+            if( m_stopOnDifference && !m_differenceReported && m_manifest.isValid() ) {
+                const QList<QByteArray> expected = m_manifest.blockChecksums();
+                const QList<QByteArray> read = blockChecksums();
+                for( ; m_checkedBlocks < read.count(); ++m_checkedBlocks ) {
+                    if( m_checkedBlocks >= expected.count() || read[m_checkedBlocks] != expected[m_checkedBlocks] ) {
+                        m_differenceReported = true;
+                        QMetaObject::invokeMethod( m_job, "slotDifferenceFound", Qt::QueuedConnection );
+                        break;
+                    }
+                }
+            }
+
             return max;
         }
+
+    private:
+        K3b::VerificationJob* m_job;
+        K3b::ChecksumManifest m_manifest;
+        int m_checkedBlocks;
+        bool m_stopOnDifference;
+        bool m_differenceReported;
     };
 }
 
@@ -58,11 +151,16 @@ public:
     Private( VerificationJob* job )
         : device(0),
           dataTrackReader(0),
+          audioChecksumReader(0),
+          pipe(job),
+          stopOnFirstDifference(false),
+          differenceFound(false),
           q(job){
     }
 
     void reloadMedium();
     Msf trackLength( const TrackEntry& trackEntry );
+    QString sectorRanges( const QList<int>& blocks ) const;
 
     bool canceled;
     K3b::Device::Device* device;
@@ -76,12 +174,20 @@ public:
     K3b::Device::Toc toc;
 
     K3b::DataTrackReader* dataTrackReader;
+    K3b::AudioChecksumReader* audioChecksumReader;
+
+    int readOffset;
+    bool readOffsetDetected;
 
     K3b::Msf currentTrackSize;
     K3b::Msf totalSectors;
     K3b::Msf alreadyReadSectors;
 
-    NullSinkChecksumPipe pipe;
+    VerificationPipe pipe;
+    K3b::Msf currentFirstSector;
+
+    bool stopOnFirstDifference;
+    bool differenceFound;
 
     bool readSuccessful;
 
@@ -151,6 +257,39 @@ K3b::Msf K3b::VerificationJob::Private::trackLength( const TrackEntry& trackEntr
 }
 
 
+QString K3b::VerificationJob::Private::sectorRanges( const QList<int>& blocks ) const
+{
+    // only list the first ranges, the message would be unreadable otherwise
+    const int maxRanges = 10;
+
+    const ChecksumManifest& manifest = currentTrackEntry->manifest;
+    const qint64 sectorsPerBlock = manifest.blockSize() / 2048;
+    const qint64 totalSectors = ( manifest.size() + 2047 ) / 2048;
+
+    QStringList ranges;
+    int i = 0;
+    while( i < blocks.count() && ranges.count() < maxRanges ) {
+        int j = i;
+        while( j+1 < blocks.count() && blocks[j+1] == blocks[j]+1 )
+            ++j;
+
+        const qint64 first = currentFirstSector.lba() + blocks[i]*sectorsPerBlock;
+        // blocks beyond the end of the manifest are read from the medium only
+        const qint64 last = qMax( first, currentFirstSector.lba() + qMin( ( blocks[j]+1 )*sectorsPerBlock, totalSectors ) - 1 );
+        if( first == last )
+            ranges.append( QString::number( first ) );
+        else
+            ranges.append( QString::fromLatin1( "%1-%2" ).arg( first ).arg( last ) );
+
+        i = j+1;
+    }
+    if( i < blocks.count() )
+        ranges.append( QLatin1String( "..." ) );
+
+    return ranges.join( QLatin1String( ", " ) );
+}
+
+
 K3b::VerificationJob::VerificationJob( K3b::JobHandler* hdl, QObject* parent )
     : K3b::Job( hdl, parent )
 {
@@ -171,6 +310,9 @@ void K3b::VerificationJob::cancel()
     if( d->dataTrackReader && d->dataTrackReader->active() ) {
         d->dataTrackReader->cancel();
     }
+    else if( d->audioChecksumReader && d->audioChecksumReader->active() ) {
+        d->audioChecksumReader->cancel();
+    }
     else if( active() ) {
         emit canceled();
         jobFinished( false );
@@ -184,6 +326,24 @@ void K3b::VerificationJob::addTrack( int trackNum, const QByteArray& checksum, c
 }
 
 
+void K3b::VerificationJob::addTrack( int trackNum, const K3b::ChecksumManifest& manifest, const K3b::Msf& length )
+{
+    d->trackEntries.append( TrackEntry( trackNum, manifest, length ) );
+}
+
+
+void K3b::VerificationJob::addTrack( int trackNum, const K3b::AudioChecksum& checksum )
+{
+    d->trackEntries.append( TrackEntry( trackNum, checksum ) );
+}
+
+
+void K3b::VerificationJob::setStopOnFirstDifference( bool stop )
+{
+    d->stopOnFirstDifference = stop;
+}
+
+
 void K3b::VerificationJob::clear()
 {
     d->trackEntries.clear();
@@ -209,6 +369,8 @@ void K3b::VerificationJob::start()
 
     d->canceled = false;
     d->alreadyReadSectors = 0;
+    d->readOffset = 0;
+    d->readOffsetDetected = false;
 
     waitForMedium( d->device,
                    K3b::Device::STATE_COMPLETE|K3b::Device::STATE_INCOMPLETE,
@@ -313,6 +475,7 @@ void K3b::VerificationJob::readTrack()
     }
 
     d->readSuccessful = true;
+    d->differenceFound = false;
 
     d->currentTrackSize = d->trackLength( *d->currentTrackEntry );
     if( d->currentTrackSize == 0 ) {
@@ -324,9 +487,9 @@ void K3b::VerificationJob::readTrack()
 
     K3b::Device::Track& track = d->toc[ d->currentTrackEntry->trackNumber-1 ];
 
-    d->pipe.open();
-
     if( track.type() == K3b::Device::Track::TYPE_DATA ) {
+        d->pipe.open( d->currentTrackEntry->manifest, d->stopOnFirstDifference );
+
         if( !d->dataTrackReader ) {
             d->dataTrackReader = new K3b::DataTrackReader( this );
             connect( d->dataTrackReader, SIGNAL(percent(int)), this, SLOT(slotReaderProgress(int)) );
@@ -348,6 +511,7 @@ void K3b::VerificationJob::readTrack()
             K3b::Iso9660 isoF( d->device );
             if( isoF.open() ) {
                 int firstSector = isoF.primaryDescriptor().volumeSpaceSize - d->grownSessionSize.lba();
+                d->currentFirstSector = firstSector;
                 d->dataTrackReader->setSectorRange( firstSector,
                                                     isoF.primaryDescriptor().volumeSpaceSize -1 );
             }
@@ -357,15 +521,39 @@ void K3b::VerificationJob::readTrack()
                 return;
             }
         }
-        else
+        else {
+            d->currentFirstSector = track.firstSector();
             d->dataTrackReader->setSectorRange( track.firstSector(),
                                                 track.firstSector() + d->currentTrackSize -1 );
+        }
 
-        d->pipe.open();
         d->dataTrackReader->start();
     }
     else {
-        // FIXME: handle audio tracks
+        if( !d->currentTrackEntry->audioChecksum.isValid() ) {
+            emit infoMessage( i18n("Internal Error: Verification job improperly initialized (%1)",
+                                   i18n("no checksum for audio track %1", d->currentTrackEntry->trackNumber) ), MessageError );
+            jobFinished( false );
+            return;
+        }
+
+        if( !d->audioChecksumReader ) {
+            d->audioChecksumReader = new K3b::AudioChecksumReader( this, this );
+            connect( d->audioChecksumReader, SIGNAL(percent(int)), this, SLOT(slotReaderProgress(int)) );
+            connect( d->audioChecksumReader, SIGNAL(finished(bool)), this, SLOT(slotAudioReaderFinished(bool)) );
+            connect( d->audioChecksumReader, SIGNAL(infoMessage(QString,int)), this, SIGNAL(infoMessage(QString,int)) );
+            connect( d->audioChecksumReader, SIGNAL(debuggingOutput(QString,QString)),
+                     this, SIGNAL(debuggingOutput(QString,QString)) );
+        }
+
+        // the offset is the same for all tracks, thus we only search it once
+        d->audioChecksumReader->setDevice( d->device );
+        d->audioChecksumReader->setLastSector( d->toc.lastSector() );
+        d->audioChecksumReader->setTrack( track.firstSector(), d->currentTrackEntry->audioChecksum );
+        d->audioChecksumReader->setDetectReadOffset( !d->readOffsetDetected );
+        d->audioChecksumReader->setReadOffset( d->readOffset );
+
+        d->audioChecksumReader->start();
     }
 }
 
@@ -378,16 +566,79 @@ void K3b::VerificationJob::slotReaderProgress( int p )
 }
 
 
+void K3b::VerificationJob::slotAudioReaderFinished( bool success )
+{
+    if( success && !d->canceled ) {
+        d->alreadyReadSectors += d->trackLength( *d->currentTrackEntry );
+
+        if( d->audioChecksumReader->readOffsetDetected() ) {
+            d->readOffsetDetected = true;
+            d->readOffset = d->audioChecksumReader->readOffset();
+            emit infoMessage( i18n("Detected an offset of %1 samples.", d->readOffset), MessageInfo );
+        }
+
+        // audio tracks do not contain error correction data. Thus we only warn.
+        const K3b::AudioChecksum checksum = d->audioChecksumReader->checksum();
+        const K3b::AudioChecksum& expected = d->currentTrackEntry->audioChecksum;
+        if( checksum != expected ) {
+            emit infoMessage( i18n("Written audio data in track %1 differs from original (CRC32 %2, expected %3).",
+                                   d->currentTrackEntry->trackNumber,
+                                   QString::number( checksum.crc32(), 16 ).rightJustified( 8, '0' ).toUpper(),
+                                   QString::number( expected.crc32(), 16 ).rightJustified( 8, '0' ).toUpper() ),
+                              MessageWarning );
+        }
+        else {
+            emit infoMessage( i18n("Written audio data in track %1 verified.", d->currentTrackEntry->trackNumber), MessageSuccess );
+        }
+
+        ++d->currentTrackEntry;
+        if( d->currentTrackEntry != d->trackEntries.constEnd() )
+            readTrack();
+        else
+            jobFinished(true);
+    }
+    else {
+        jobFinished( false );
+    }
+}
+
+
+void K3b::VerificationJob::slotDifferenceFound()
+{
+    if( d->dataTrackReader && d->dataTrackReader->active() ) {
+        d->differenceFound = true;
+        d->dataTrackReader->cancel();
+    }
+}
+
+
 void K3b::VerificationJob::slotReaderFinished( bool success )
 {
     d->readSuccessful = success;
-    if( d->readSuccessful && !d->canceled ) {
+    if( d->differenceFound && !d->canceled ) {
+        d->pipe.close();
+        emit infoMessage( i18n("Written data in track %1 differs from original in sectors %2.",
+                               d->currentTrackEntry->trackNumber,
+                               d->sectorRanges( d->pipe.differingBlocks( false ) ) ), MessageError );
+        jobFinished(false);
+    }
+    else if( d->readSuccessful && !d->canceled ) {
         d->alreadyReadSectors += d->trackLength( *d->currentTrackEntry );
 
         d->pipe.close();
 
+        // finishes the calculation of all checksums
+        const QByteArray checksum = d->pipe.checksum();
+        const QList<int> differingBlocks = d->pipe.differingBlocks( true );
+
         // compare the two sums
-        if( d->currentTrackEntry->checksum != d->pipe.checksum() ) {
+        if( !differingBlocks.isEmpty() ) {
+            emit infoMessage( i18n("Written data in track %1 differs from original in sectors %2.",
+                                   d->currentTrackEntry->trackNumber,
+                                   d->sectorRanges( differingBlocks ) ), MessageError );
+            jobFinished(false);
+        }
+        else if( d->currentTrackEntry->checksum != checksum ) {
             emit infoMessage( i18n("Written data in track %1 differs from original.", d->currentTrackEntry->trackNumber), MessageError );
             jobFinished(false);
         }
@@ -15,6 +15,9 @@ namespace K3b {
         class DeviceHandler;
     }
 
+    class AudioChecksum;
+    class ChecksumManifest;
+
 
     /**
      * Generic verification job. Add tracks to be verified via addTrack.
@@ -24,7 +27,9 @@ namespace K3b {
      * \li Data/DVD tracks: Read the track with a 2048 bytes sector size.
      *     Tracks length on DVD+RW media will be read from the iso9660
      *     descriptor.
-     * \li Audio tracks: Rip the track with a 2352 bytes sector size.
+     * \li Audio tracks: Rip the track with a 2352 bytes sector size and compare
+     *     its AudioChecksum. The combined read and write offset is detected
+     *     with the first audio track and used for all following ones.
      *     In the case of audio tracks the job will not fail if the checksums
      *     differ because audio CD tracks do not contain error correction data.
      *     In this case only a warning will be emitted.
@@ -33,6 +38,9 @@ namespace K3b {
      * i.e. Video CDs cannot be verified.
      *
      * TAO written tracks have two run-out sectors that are not read.
+     *
+     * If a track is added with a ChecksumManifest the data is compared block
+     * by block and the sector ranges which differ are reported.
      */
     class VerificationJob : public Job
     {
@@ -59,6 +67,24 @@ namespace K3b {
          */
         void addTrack( int tracknum, const QByteArray& checksum, const Msf& length = Msf() );
 
+        /**
+         * Add a track to be verified block by block against \a manifest.
+         * \sa addTrack(int, const QByteArray&, const Msf&)
+         */
+        void addTrack( int tracknum, const ChecksumManifest& manifest, const Msf& length = Msf() );
+
+        /**
+         * Add an audio track to be verified against \a checksum.
+         */
+        void addTrack( int tracknum, const AudioChecksum& checksum );
+
+        /**
+         * If enabled reading a track stops as soon as the first differing
+         * block has been found. Only has an effect for tracks added
+         * with a ChecksumManifest. Defaults to false.
+         */
+        void setStopOnFirstDifference( bool stop );
+
         /**
          * Handle the special case of iso session growing
          */
@@ -70,6 +96,8 @@ namespace K3b {
         void readTrack();
         void slotReaderProgress( int p );
         void slotReaderFinished( bool success );
+        void slotDifferenceFound();
+        void slotAudioReaderFinished( bool success );
 
     private:
         class Private;
@@ -2,11 +2,11 @@
     SPDX-FileCopyrightText: 1998-2009 Sebastian Trueg <trueg@k3b.org>
     SPDX-License-Identifier: GPL-2.0-or-later
 */
-#include <config-libk3b.h>
-
 #include "k3bcore.h"
 #include "k3baudiodecoder.h"
+#include "k3baudiodecodercache.h"
 #include "k3bpluginmanager.h"
+#include "k3bsampleconversion.h"
 #include "k3b_i18n.h"
 
 #include <KFileMetaData/ExtractionResult>
@@ -19,15 +19,8 @@
 #include <QMimeDatabase>
 #include <QMimeType>
 
-#include <math.h>
-
 #include <samplerate.h>
 
-#if !(HAVE_LRINT && HAVE_LRINTF)
-#define lrint(dbl)              ((int) (dbl+0.5))
-#define lrintf(flt)             ((int) (flt+0.5))
-#endif
-
 // use a one second buffer
 static const int DECODING_BUFFER_SIZE = 75*2352;
 
@@ -88,10 +81,13 @@ public:
           inBufferPos(0),
           inBufferFill(0),
           outBuffer(0),
+          samplerate(0),
+          channels(0),
           monoBuffer(0),
           decodingBufferPos(0),
           decodingBufferFill(0),
-          valid(true) {
+          valid(true),
+          factory(0) {
     }
 
     // the current position of the decoder
@@ -140,6 +136,9 @@ public:
     MetaInfoMap metaInfoMap;
 
     bool valid;
+
+    // the factory which created the decoder
+    const K3b::AudioDecoderFactory* factory;
 };
 
 
@@ -181,6 +180,18 @@ bool K3b::AudioDecoder::isValid() const
 }
 
 
+int K3b::AudioDecoder::samplerate() const
+{
+    return d->samplerate;
+}
+
+
+int K3b::AudioDecoder::channels() const
+{
+    return d->channels;
+}
+
+
 bool K3b::AudioDecoder::analyseFile()
 {
     d->technicalInfoMap.clear();
@@ -189,9 +200,45 @@ bool K3b::AudioDecoder::analyseFile()
 
     cleanup();
 
-    bool ret = analyseFileInternal( m_length, d->samplerate, d->channels );
+    // the cache is shared by all decoders, so the entries are kept apart by decoder type
+    AudioDecoderCache* cache = AudioDecoderCache::instance();
+    const QString decoderName = QString::fromLatin1( metaObject()->className() );
+
+    AudioDecoderCache::Entry entry;
+    bool cached = false;
+    bool ret = false;
+    if( cache->lookup( decoderName, m_fileName, entry ) && restoreAnalysisData( entry.decoderData ) ) {
+        qDebug() << "(K3b::AudioDecoder) using cached analysis of" << m_fileName;
+        m_length = entry.length;
+        d->samplerate = entry.samplerate;
+        d->channels = entry.channels;
+        d->technicalInfoMap = entry.technicalInfo;
+        for( QMap<int, QString>::const_iterator it = entry.metaInfo.constBegin();
+             it != entry.metaInfo.constEnd(); ++it )
+            d->metaInfoMap.insert( static_cast<MetaDataField>( it.key() ), it.value() );
+        cached = ret = true;
+    }
+    else {
+        ret = analyseFileInternal( m_length, d->samplerate, d->channels );
+    }
+
     if( ret && ( d->channels == 1 || d->channels == 2 ) && m_length > 0 ) {
         d->valid = initDecoder();
+        if( d->valid && !cached ) {
+            entry = AudioDecoderCache::Entry();
+            entry.length = m_length;
+            entry.samplerate = d->samplerate;
+            entry.channels = d->channels;
+            entry.technicalInfo = d->technicalInfoMap;
+            for( MetaInfoMap::const_iterator it = d->metaInfoMap.constBegin();
+                 it != d->metaInfoMap.constEnd(); ++it )
+                entry.metaInfo.insert( it.key(), it.value() );
+            entry.decoderData = analysisData();
+            cache->store( decoderName, m_fileName, entry );
+        }
+        else if( !d->valid && cached ) {
+            cache->remove( decoderName, m_fileName );
+        }
         return d->valid;
     }
     else {
@@ -286,12 +333,10 @@ int K3b::AudioDecoder::decode( char* _data, int maxLen )
                 if( (read = decodeInternal( d->monoBuffer, DECODING_BUFFER_SIZE/2 )) == 0 )
                     d->decoderFinished = true;
 
-                for( int i = 0; i < read; i+=2 ) {
-                    d->decodingBuffer[2*i] = d->decodingBuffer[2*i+2] = d->monoBuffer[i];
-                    d->decodingBuffer[2*i+1] = d->decodingBuffer[2*i+3] = d->monoBuffer[i+1];
+                if( read > 0 ) {
+                    K3b::SampleConversion::monoToStereo16( d->monoBuffer, d->decodingBuffer, read/2 );
+                    read *= 2;
                 }
-
-                read *= 2;
             }
             else {
                 if( (read = decodeInternal( d->decodingBuffer, DECODING_BUFFER_SIZE )) == 0 )
@@ -387,12 +432,14 @@ int K3b::AudioDecoder::resample( char* data, int maxLen )
     }
 
     if( d->channels == 2 )
-        fromFloatTo16BitBeSigned( d->outBuffer, data, d->resampleData->output_frames_gen*d->channels );
+        K3b::SampleConversion::fromFloatTo16BitBe( d->outBuffer, data, d->resampleData->output_frames_gen*d->channels );
     else {
-        for( int i = 0; i < d->resampleData->output_frames_gen; ++i ) {
-            fromFloatTo16BitBeSigned( &d->outBuffer[i], &data[4*i], 1 );
-            fromFloatTo16BitBeSigned( &d->outBuffer[i], &data[4*i+2], 1 );
+        // convert into the mono buffer first and duplicate the samples afterwards
+        if( !d->monoBuffer ) {
+            d->monoBuffer = new char[DECODING_BUFFER_SIZE/2];
         }
+        K3b::SampleConversion::fromFloatTo16BitBe( d->outBuffer, d->monoBuffer, d->resampleData->output_frames_gen );
+        K3b::SampleConversion::monoToStereo16( d->monoBuffer, data, d->resampleData->output_frames_gen );
     }
 
     d->inBufferPos += d->resampleData->input_frames_used*d->channels;
@@ -410,54 +457,19 @@ int K3b::AudioDecoder::resample( char* data, int maxLen )
 
 void K3b::AudioDecoder::from16bitBeSignedToFloat( char* src, float* dest, int samples )
 {
-    while( samples ) {
-        samples--;
-        dest[samples] = static_cast<float>( qint16(((src[2*samples]<<8)&0xff00)|(src[2*samples+1]&0x00ff)) / 32768.0 );
-    }
+    K3b::SampleConversion::from16BitBeToFloat( src, dest, samples );
 }
 
 
 void K3b::AudioDecoder::fromFloatTo16BitBeSigned( float* src, char* dest, int samples )
 {
-    while( samples ) {
-        samples--;
-
-        float scaled = src[samples] * 32768.0;
-        qint16 val = 0;
-
-        // clipping
-        if( scaled >= ( 1.0 * 0x7FFF ) )
-            val = 32767;
-        else if( scaled <= ( -8.0 * 0x1000 ) )
-            val = -32768;
-        else
-            val = lrintf(scaled);
-
-        dest[2*samples]   = val>>8;
-        dest[2*samples+1] = val;
-    }
+    K3b::SampleConversion::fromFloatTo16BitBe( src, dest, samples );
 }
 
 
 void K3b::AudioDecoder::from8BitTo16BitBeSigned( char* src, char* dest, int samples )
 {
-    while( samples ) {
-        samples--;
-
-        float scaled = static_cast<float>(quint8(src[samples])-128) / 128.0 * 32768.0;
-        qint16 val = 0;
-
-        // clipping
-        if( scaled >= ( 1.0 * 0x7FFF ) )
-            val = 32767;
-        else if( scaled <= ( -8.0 * 0x1000 ) )
-            val = -32768;
-        else
-            val = lrintf(scaled);
-
-        dest[2*samples]   = val>>8;
-        dest[2*samples+1] = val;
-    }
+    K3b::SampleConversion::from8BitTo16BitBe( src, dest, samples );
 }
 
 
@@ -608,14 +620,22 @@ K3b::AudioDecoder* K3b::AudioDecoderFactory::createDecoder( const QUrl& url )
     Q_FOREACH( K3b::Plugin* plugin, fl ) {
         K3b::AudioDecoderFactory* f = dynamic_cast<K3b::AudioDecoderFactory*>( plugin );
         if( f && !f->multiFormatDecoder() && f->canDecode( url ) ) {
-            qDebug() << "1"; return f->createDecoder();}
+            qDebug() << "1";
+            K3b::AudioDecoder* decoder = f->createDecoder();
+            decoder->d->factory = f;
+            return decoder;
+        }
     }
 
     // no single format decoder. Search for a multi format decoder
     Q_FOREACH( K3b::Plugin* plugin, fl ) {
         K3b::AudioDecoderFactory* f = dynamic_cast<K3b::AudioDecoderFactory*>( plugin );
         if( f && f->multiFormatDecoder() && f->canDecode( url ) ) {
-            qDebug() << "2"; return f->createDecoder();}
+            qDebug() << "2";
+            K3b::AudioDecoder* decoder = f->createDecoder();
+            decoder->d->factory = f;
+            return decoder;
+        }
     }
 
     qDebug() << "(K3b::AudioDecoderFactory::createDecoder( " << url.toLocalFile() << " ) no success";
@@ -625,6 +645,18 @@ K3b::AudioDecoder* K3b::AudioDecoderFactory::createDecoder( const QUrl& url )
 }
 
 
+K3b::AudioDecoder* K3b::AudioDecoderFactory::duplicateDecoder( const K3b::AudioDecoder* decoder )
+{
+    if( !decoder->d->factory )
+        return 0;
+
+    K3b::AudioDecoder* dup = decoder->d->factory->createDecoder();
+    dup->d->factory = decoder->d->factory;
+    dup->setFilename( decoder->filename() );
+    return dup;
+}
+
+
 QString K3b::AudioDecoderFactory::categoryName() const
 {
     return i18nc( "plugin type", "Audio Decoder" );
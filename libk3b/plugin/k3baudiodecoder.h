@@ -39,6 +39,10 @@ namespace K3b {
          * Since this may take a while depending on the filetype it is best
          * to run it in a separate thread.
          *
+         * The results are stored in the AudioDecoderCache. As long as the file
+         * does not change later calls restore them instead of analysing the
+         * file again.
+         *
          * This method will also call initDecoder().
          *
          * \sa AudioFielAnalyzerJob
@@ -135,6 +139,14 @@ namespace K3b {
          */
         virtual Msf length() const { return m_length; }
 
+        /**
+         * The samplerate and the number of channels of the file
+         * before it is converted to CD audio. Only valid after
+         * analyseFile() has been called.
+         */
+        int samplerate() const;
+        int channels() const;
+
         const QString& filename() const { return m_fileName; }
 
         // some helper methods
@@ -179,9 +191,29 @@ namespace K3b {
 
         virtual bool seekInternal( const Msf& ) { return false; }
 
+        /**
+         * Reimplement to store data determined by analyseFileInternal() which
+         * is needed later on, like a seek index, in the AudioDecoderCache.
+         *
+         * Meta and technical infos set via @p addMetaInfo and @p addTechnicalInfo
+         * are stored anyway.
+         */
+        virtual QByteArray analysisData() const { return QByteArray(); }
+
+        /**
+         * Called instead of analyseFileInternal() if the results of an earlier
+         * analysis of the unchanged file have been found in the cache.
+         *
+         * @param data The data returned by analysisData().
+         * @return false if the data cannot be used. The file is analysed again in that case.
+         */
+        virtual bool restoreAnalysisData( const QByteArray& data ) { Q_UNUSED( data ); return true; }
+
     private:
         int resample( char* data, int maxLen );
 
+        friend class AudioDecoderFactory;
+
         QString m_fileName;
         Msf m_length;
 
@@ -241,6 +273,17 @@ namespace K3b {
          * @returns a newly created decoder on success and 0 when no decoder could be found.
          */
         static AudioDecoder* createDecoder( const QUrl& url );
+
+        /**
+         * Creates another decoder for the file of @p decoder which is of the same
+         * type. The new decoder still needs to be analysed.
+         *
+         * Unlike createDecoder( const QUrl& ) this may be used from any thread.
+         *
+         * @returns a newly created decoder or 0 if @p decoder has not been
+         *          created by createDecoder( const QUrl& ).
+         */
+        static AudioDecoder* duplicateDecoder( const AudioDecoder* decoder );
     };
 }
 
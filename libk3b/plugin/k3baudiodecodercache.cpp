@@ -0,0 +1,236 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3baudiodecodercache.h"
+#include "k3bglobals.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+
+namespace {
+    const quint32 CACHE_MAGIC = 0x4B334443; // "K3DC"
+    const quint32 CACHE_VERSION = 1;
+
+    /**
+     * Identifies the state of a file. Any change to the file
+     * changes at least one of the values.
+     */
+    struct FileKey
+    {
+        qint64 size;
+        qint64 mtime;
+        quint64 inode;
+        quint64 device;
+
+        bool operator==( const FileKey& other ) const {
+            return( size == other.size &&
+                    mtime == other.mtime &&
+                    inode == other.inode &&
+                    device == other.device );
+        }
+    };
+
+    bool fileKey( const QString& filename, FileKey& key )
+    {
+        k3b_struct_stat statBuf;
+        if( k3b_stat( QFile::encodeName( filename ), &statBuf ) != 0 )
+            return false;
+
+        key.size = statBuf.st_size;
+        key.mtime = QFileInfo( filename ).lastModified().toMSecsSinceEpoch();
+        key.inode = statBuf.st_ino;
+        key.device = statBuf.st_dev;
+        return true;
+    }
+
+    QDataStream& operator<<( QDataStream& s, const FileKey& key )
+    {
+        return s << key.size << key.mtime << key.inode << key.device;
+    }
+
+    QDataStream& operator>>( QDataStream& s, FileKey& key )
+    {
+        return s >> key.size >> key.mtime >> key.inode >> key.device;
+    }
+}
+
+
+K3b::AudioDecoderCache::AudioDecoderCache( const QString& path )
+    : m_path( path )
+{
+}
+
+
+K3b::AudioDecoderCache::~AudioDecoderCache()
+{
+}
+
+
+K3b::AudioDecoderCache* K3b::AudioDecoderCache::instance()
+{
+    static AudioDecoderCache s_cache( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) + "/audiodecoder" );
+    return &s_cache;
+}
+
+
+QString K3b::AudioDecoderCache::entryFileName( const QString& decoder, const QString& filename ) const
+{
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    hash.addData( decoder.toUtf8() );
+    hash.addData( "\n", 1 );
+    hash.addData( QFile::encodeName( QFileInfo( filename ).absoluteFilePath() ) );
+    return QDir( m_path ).filePath( QString::fromLatin1( hash.result().toHex() ) );
+}
+
+
+bool K3b::AudioDecoderCache::lookup( const QString& decoder, const QString& filename, Entry& entry ) const
+{
+    FileKey key;
+    if( !fileKey( filename, key ) )
+        return false;
+
+    const QString cacheFile = entryFileName( decoder, filename );
+    QFile file( cacheFile );
+    if( !file.open( QIODevice::ReadOnly ) )
+        return false;
+
+    QDataStream s( &file );
+    s.setVersion( QDataStream::Qt_5_0 );
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString entryDecoder;
+    QString entryPath;
+    FileKey entryKey;
+    s >> magic >> version;
+    if( magic != CACHE_MAGIC || version != CACHE_VERSION ) {
+        file.remove();
+        return false;
+    }
+
+    s >> entryDecoder >> entryPath >> entryKey;
+    if( s.status() != QDataStream::Ok ||
+        entryDecoder != decoder ||
+        entryPath != QFileInfo( filename ).absoluteFilePath() ) {
+        // a hash collision or a broken entry
+        return false;
+    }
+
+    if( !( entryKey == key ) ) {
+        qDebug() << "(K3b::AudioDecoderCache) removing stale entry for" << filename;
+        file.remove();
+        return false;
+    }
+
+    qint32 frames = 0;
+    Entry result;
+    s >> frames >> result.samplerate >> result.channels
+      >> result.technicalInfo >> result.metaInfo >> result.decoderData;
+    if( s.status() != QDataStream::Ok ) {
+        file.remove();
+        return false;
+    }
+
+    result.length = frames;
+    entry = result;
+    return true;
+}
+
+
+bool K3b::AudioDecoderCache::store( const QString& decoder, const QString& filename, const Entry& entry ) const
+{
+    FileKey key;
+    if( !fileKey( filename, key ) )
+        return false;
+
+    if( !QDir().mkpath( m_path ) ) {
+        qDebug() << "(K3b::AudioDecoderCache) unable to create" << m_path;
+        return false;
+    }
+
+    QSaveFile file( entryFileName( decoder, filename ) );
+    if( !file.open( QIODevice::WriteOnly ) ) {
+        qDebug() << "(K3b::AudioDecoderCache) could not open" << file.fileName();
+        return false;
+    }
+
+    QDataStream s( &file );
+    s.setVersion( QDataStream::Qt_5_0 );
+    s << CACHE_MAGIC << CACHE_VERSION
+      << decoder << QFileInfo( filename ).absoluteFilePath() << key
+      << qint32( entry.length.lba() ) << entry.samplerate << entry.channels
+      << entry.technicalInfo << entry.metaInfo << entry.decoderData;
+
+    return( s.status() == QDataStream::Ok && file.commit() );
+}
+
+
+void K3b::AudioDecoderCache::remove( const QString& decoder, const QString& filename ) const
+{
+    QFile::remove( entryFileName( decoder, filename ) );
+}
+
+
+QByteArray K3b::AudioDecoderCache::packSeekIndex( const QVector<quint64>& positions )
+{
+    QByteArray data;
+    data.reserve( positions.count()*2 );
+
+    quint64 last = 0;
+    Q_FOREACH( quint64 pos, positions ) {
+        // LEB128 encoded difference to the previous position
+        quint64 diff = pos - last;
+        last = pos;
+        do {
+            char byte = diff & 0x7F;
+            diff >>= 7;
+            if( diff )
+                byte |= 0x80;
+            data.append( byte );
+        } while( diff );
+    }
+
+    return data;
+}
+
+
+bool K3b::AudioDecoderCache::unpackSeekIndex( const QByteArray& data, QVector<quint64>& positions )
+{
+    QVector<quint64> result;
+    result.reserve( data.size()/2 );
+
+    quint64 last = 0;
+    quint64 diff = 0;
+    int shift = 0;
+    for( int i = 0; i < data.size(); ++i ) {
+        const uchar byte = data[i];
+        if( shift > 63 )
+            return false;
+        diff |= quint64( byte & 0x7F ) << shift;
+        shift += 7;
+        if( !( byte & 0x80 ) ) {
+            last += diff;
+            result.append( last );
+            diff = 0;
+            shift = 0;
+        }
+    }
+
+    // the last position is incomplete
+    if( shift > 0 )
+        return false;
+
+    positions = result;
+    return true;
+}
@@ -0,0 +1,90 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_AUDIO_DECODER_CACHE_H_
+#define _K3B_AUDIO_DECODER_CACHE_H_
+
+#include "k3bmsf.h"
+
+#include "k3b_export.h"
+
+#include <QByteArray>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+
+namespace K3b {
+    /**
+     * On-disk cache for the results of AudioDecoder::analyseFile().
+     *
+     * Entries are identified by the decoder and the absolute path of the
+     * file. Each entry remembers the size, the modification time and the
+     * inode of the file it was created for and is removed on lookup once
+     * the file changed.
+     *
+     * Every entry is stored in a file of its own which is replaced atomically.
+     * Thus the cache may be used by several threads and K3b instances at once.
+     */
+    class LIBK3B_EXPORT AudioDecoderCache
+    {
+    public:
+        struct Entry {
+            Entry() : samplerate( 0 ), channels( 0 ) {}
+
+            Msf length;
+            int samplerate;
+            int channels;
+            QMap<QString, QString> technicalInfo;
+            QMap<int, QString> metaInfo;
+
+            /**
+             * Decoder specific data like a seek index.
+             */
+            QByteArray decoderData;
+        };
+
+        /**
+         * \param path The folder the entries are stored in.
+         */
+        explicit AudioDecoderCache( const QString& path );
+        ~AudioDecoderCache();
+
+        /**
+         * The cache in the user's cache folder used by all decoders.
+         */
+        static AudioDecoderCache* instance();
+
+        QString path() const { return m_path; }
+
+        /**
+         * \return true if an entry for the unchanged file was found.
+         */
+        bool lookup( const QString& decoder, const QString& filename, Entry& entry ) const;
+
+        bool store( const QString& decoder, const QString& filename, const Entry& entry ) const;
+
+        void remove( const QString& decoder, const QString& filename ) const;
+
+        /**
+         * Encodes an ascending list of file positions as variable length
+         * differences which mostly take one or two bytes per position.
+         */
+        static QByteArray packSeekIndex( const QVector<quint64>& positions );
+
+        /**
+         * \return false if \p data is no valid seek index.
+         */
+        static bool unpackSeekIndex( const QByteArray& data, QVector<quint64>& positions );
+
+    private:
+        QString entryFileName( const QString& decoder, const QString& filename ) const;
+
+        QString m_path;
+    };
+}
+
+#endif
@@ -46,6 +46,17 @@ QString K3b::AudioEncoder::categoryName() const
 }
 
 
+K3b::AudioEncoder* K3b::AudioEncoder::createInstance() const
+{
+    KPluginFactory::Result<K3b::AudioEncoder> result = KPluginFactory::instantiatePlugin<K3b::AudioEncoder>( pluginMetaData() );
+    if( !result ) {
+        qDebug() << "(K3b::AudioEncoder) unable to create instance of" << pluginMetaData().pluginId() << result.errorString;
+        return 0;
+    }
+    return result.plugin;
+}
+
+
 bool K3b::AudioEncoder::openFile( const QString& extension, const QString& filename, const K3b::Msf& length, const MetaData& metaData )
 {
     closeFile();
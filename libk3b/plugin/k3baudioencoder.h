@@ -72,6 +72,21 @@ namespace K3b {
          */
         virtual long long fileSize( const QString&, const Msf& ) const { return -1; }
 
+        /**
+         * Returns true if several instances of the encoder may encode at the
+         * same time in different threads. Such encoders are used to encode
+         * several tracks in parallel.
+         * The default implementation returns false.
+         */
+        virtual bool isReentrant() const { return false; }
+
+        /**
+         * Creates a new instance of this encoder plugin. The caller
+         * takes ownership.
+         * \return 0 if the plugin could not be instantiated.
+         */
+        AudioEncoder* createInstance() const;
+
         enum MetaDataField {
             META_TRACK_TITLE,
             META_TRACK_ARTIST,
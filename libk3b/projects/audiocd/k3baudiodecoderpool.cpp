@@ -0,0 +1,214 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3baudiodecoderpool.h"
+#include "k3baudiodecoder.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+
+
+namespace {
+    // AudioDecoder::seek decodes up to the position if it is less than
+    // this ahead, anything else needs the decoder plugin to seek
+    const qint64 SEEK_WINDOW = K3b::Msf( 0, 10, 0 ).audioBytes();
+
+    struct IdleDecoder
+    {
+        IdleDecoder( K3b::AudioDecoder* d = 0, qint64 p = 0, quint64 r = 0 )
+            : decoder( d ),
+              pos( p ),
+              released( r ) {
+        }
+
+        K3b::AudioDecoder* decoder;
+
+        // in bytes, it may be in the middle of a sector
+        qint64 pos;
+
+        // the number of the release(), a lower one was released earlier
+        quint64 released;
+    };
+}
+
+
+class K3b::AudioDecoderPool::Private
+{
+public:
+    int maxIdleDecoders;
+    int maxTotalIdleDecoders;
+
+    int totalIdleDecoders;
+    quint64 releaseCount;
+
+    // the unused decoders by filename, the most recently used first.
+    // Only files which have not been removed have an entry.
+    QHash<QString, QList<IdleDecoder> > idle;
+
+    mutable QMutex mutex;
+
+    /**
+     * Takes the decoder of any file which has been released first.
+     */
+    AudioDecoder* takeLeastRecentlyUsed();
+};
+
+
+K3b::AudioDecoder* K3b::AudioDecoderPool::Private::takeLeastRecentlyUsed()
+{
+    QHash<QString, QList<IdleDecoder> >::iterator oldest = idle.end();
+    for( QHash<QString, QList<IdleDecoder> >::iterator it = idle.begin(); it != idle.end(); ++it ) {
+        if( !it->isEmpty() && ( oldest == idle.end() || it->last().released < oldest->last().released ) )
+            oldest = it;
+    }
+
+    if( oldest == idle.end() )
+        return 0;
+
+    --totalIdleDecoders;
+    return oldest->takeLast().decoder;
+}
+
+
+K3b::AudioDecoderPool::AudioDecoderPool( int maxIdleDecoders, int maxTotalIdleDecoders )
+    : d( new Private() )
+{
+    d->maxIdleDecoders = qMax( 1, maxIdleDecoders );
+    d->maxTotalIdleDecoders = qMax( d->maxIdleDecoders, maxTotalIdleDecoders );
+    d->totalIdleDecoders = 0;
+    d->releaseCount = 0;
+}
+
+
+K3b::AudioDecoderPool::~AudioDecoderPool()
+{
+    for( QHash<QString, QList<IdleDecoder> >::const_iterator it = d->idle.constBegin(); it != d->idle.constEnd(); ++it ) {
+        Q_FOREACH( const IdleDecoder& idle, it.value() )
+            delete idle.decoder;
+    }
+    delete d;
+}
+
+
+K3b::AudioDecoder* K3b::AudioDecoderPool::acquire( const AudioDecoder* decoder, const Msf& pos )
+{
+    const QString filename = decoder->filename();
+    const qint64 bytes = pos.audioBytes();
+    AudioDecoder* dec = 0;
+
+    {
+        QMutexLocker locker( &d->mutex );
+        QList<IdleDecoder>& idle = d->idle[filename];
+
+        // the decoder which is the closest before the position. One which
+        // stopped within the sector would have to seek back.
+        int best = -1;
+        for( int i = 0; i < idle.count(); ++i ) {
+            if( idle[i].pos <= bytes && bytes - idle[i].pos < SEEK_WINDOW &&
+                ( best < 0 || idle[i].pos > idle[best].pos ) )
+                best = i;
+        }
+        if( best >= 0 ) {
+            qDebug() << "(K3b::AudioDecoderPool) reusing decoder at byte" << idle[best].pos
+                     << "for" << pos.toString() << "of" << filename;
+            dec = idle.takeAt( best ).decoder;
+            --d->totalIdleDecoders;
+        }
+    }
+
+    if( !dec ) {
+        // all the other decoders of the file would have to seek, thus we
+        // rather keep their positions for other readers
+        dec = duplicateDecoder( decoder );
+        if( dec && !dec->analyseFile() ) {
+            qDebug() << "(K3b::AudioDecoderPool) could not create a decoder for" << filename;
+            delete dec;
+            dec = 0;
+        }
+
+        if( !dec ) {
+            QMutexLocker locker( &d->mutex );
+            QList<IdleDecoder>& idle = d->idle[filename];
+            if( !idle.isEmpty() ) {
+                dec = idle.takeLast().decoder;
+                --d->totalIdleDecoders;
+            }
+        }
+    }
+
+    if( dec && !dec->seek( pos ) ) {
+        qDebug() << "(K3b::AudioDecoderPool) seeking to" << pos.toString() << "in" << filename << "failed";
+        delete dec;
+        dec = 0;
+    }
+
+    return dec;
+}
+
+
+void K3b::AudioDecoderPool::release( AudioDecoder* decoder, qint64 pos, bool reusable )
+{
+    AudioDecoder* evicted = decoder;
+
+    if( reusable ) {
+        QMutexLocker locker( &d->mutex );
+        QHash<QString, QList<IdleDecoder> >::iterator it = d->idle.find( decoder->filename() );
+        if( it != d->idle.end() ) {
+            it->prepend( IdleDecoder( decoder, pos, ++d->releaseCount ) );
+            ++d->totalIdleDecoders;
+            if( it->count() > d->maxIdleDecoders ) {
+                evicted = it->takeLast().decoder;
+                --d->totalIdleDecoders;
+            }
+            else if( d->totalIdleDecoders > d->maxTotalIdleDecoders ) {
+                evicted = d->takeLeastRecentlyUsed();
+            }
+            else {
+                evicted = 0;
+            }
+        }
+    }
+
+    delete evicted;
+}
+
+
+void K3b::AudioDecoderPool::remove( const QString& filename )
+{
+    QList<IdleDecoder> idle;
+
+    {
+        QMutexLocker locker( &d->mutex );
+        idle = d->idle.take( filename );
+        d->totalIdleDecoders -= idle.count();
+    }
+
+    Q_FOREACH( const IdleDecoder& i, idle )
+        delete i.decoder;
+}
+
+
+int K3b::AudioDecoderPool::idleDecoders( const QString& filename ) const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->idle.value( filename ).count();
+}
+
+
+int K3b::AudioDecoderPool::idleDecoders() const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->totalIdleDecoders;
+}
+
+
+K3b::AudioDecoder* K3b::AudioDecoderPool::duplicateDecoder( const AudioDecoder* decoder )
+{
+    return AudioDecoderFactory::duplicateDecoder( decoder );
+}
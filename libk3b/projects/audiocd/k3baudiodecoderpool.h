@@ -0,0 +1,97 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_AUDIO_DECODER_POOL_H_
+#define _K3B_AUDIO_DECODER_POOL_H_
+
+#include "k3bmsf.h"
+#include "k3b_export.h"
+
+#include <QString>
+
+namespace K3b {
+    class AudioDecoder;
+
+    /**
+     * Hands out decoders to the readers of audio files.
+     *
+     * Several sources may use the same file, most prominently the tracks
+     * of an image split by a cue file. The pool creates decoders of its own
+     * for every file and keeps a few of them which are not in use together
+     * with the position they stopped at. A reader gets the decoder which
+     * needs the least decoding to reach its start position. So reading the
+     * tracks in another than their natural order does not make a single
+     * decoder seek back and forth. The decoders which have not been used
+     * for the longest time are deleted first.
+     *
+     * The decoders of the AudioDoc are used by the GUI, they are never
+     * handed out.
+     *
+     * The pool may be used by several threads at once.
+     */
+    class LIBK3B_EXPORT AudioDecoderPool
+    {
+    public:
+        /**
+         * \param maxIdleDecoders The number of decoders kept per file
+         *                        while they are not in use.
+         * \param maxTotalIdleDecoders The number of decoders kept for all
+         *                             files together.
+         */
+        explicit AudioDecoderPool( int maxIdleDecoders = 3, int maxTotalIdleDecoders = 8 );
+        virtual ~AudioDecoderPool();
+
+        /**
+         * \return A decoder for the file of \p decoder positioned at \p pos
+         *         or 0 if none could be created or positioned. It has to be
+         *         given back with release().
+         */
+        AudioDecoder* acquire( const AudioDecoder* decoder, const Msf& pos );
+
+        /**
+         * Gives back a decoder returned by acquire(). \p pos is the
+         * position in bytes the decoder has been read up to. Readers
+         * may stop in the middle of a sector, then the decoder is only
+         * reused for positions after that sector.
+         *
+         * \param reusable false if no reader will start after \p pos,
+         *                 e.g. at the end of a file. The decoder is
+         *                 deleted then.
+         */
+        void release( AudioDecoder* decoder, qint64 pos, bool reusable = true );
+
+        /**
+         * Deletes the unused decoders of \p filename. Decoders in use are
+         * deleted once they are released.
+         */
+        void remove( const QString& filename );
+
+        /**
+         * The number of decoders of \p filename which are not in use.
+         */
+        int idleDecoders( const QString& filename ) const;
+
+        /**
+         * The number of decoders of all files which are not in use.
+         */
+        int idleDecoders() const;
+
+    protected:
+        /**
+         * Creates a new decoder for the file of \p decoder. The default
+         * implementation uses AudioDecoderFactory::duplicateDecoder().
+         */
+        virtual AudioDecoder* duplicateDecoder( const AudioDecoder* decoder );
+
+    private:
+        class Private;
+        Private* const d;
+
+        Q_DISABLE_COPY( AudioDecoderPool )
+    };
+}
+
+#endif
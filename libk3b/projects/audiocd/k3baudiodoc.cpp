@@ -19,6 +19,7 @@
 #include "k3bcdtextvalidator.h"
 #include "k3bcore.h"
 #include "k3baudiodecoder.h"
+#include "k3baudiodecoderpool.h"
 #include "k3b_i18n.h"
 
 #include <KConfig>
@@ -54,6 +55,7 @@ public:
 
     bool hideFirstTrack;
     bool normalize;
+    bool verifyData;
 
     // CD-Text
     // --------------------------------------------------
@@ -73,6 +75,8 @@ public:
     QMap<AudioDecoder*, int> decoderUsageCounterMap;
     // used to check if we already have a decoder for a specific file
     QMap<QString, AudioDecoder*> decoderPresenceMap;
+    // the decoders the readers of the files decode with
+    AudioDecoderPool decoderPool;
 
     K3b::CdTextValidator* cdTextValidator;
 };
@@ -103,6 +107,7 @@ bool K3b::AudioDoc::newDocument()
 {
     clear();
     d->normalize = false;
+    d->verifyData = false;
     d->hideFirstTrack = false;
     d->cdText = false;
     d->cdTextData.clear();
@@ -454,6 +459,12 @@ K3b::AudioDecoder* K3b::AudioDoc::getDecoderForUrl( const QUrl& url, bool* reuse
 }
 
 
+K3b::AudioDecoderPool* K3b::AudioDoc::decoderPool() const
+{
+    return &d->decoderPool;
+}
+
+
 K3b::AudioFile* K3b::AudioDoc::createAudioFile( const QUrl& url )
 {
     if( !QFile::exists( url.toLocalFile() ) ) {
@@ -557,6 +568,12 @@ void K3b::AudioDoc::setNormalize( bool b )
 }
 
 
+void K3b::AudioDoc::setVerifyData( bool b )
+{
+    d->verifyData = b;
+}
+
+
 void K3b::AudioDoc::writeCdText( bool b )
 {
     d->cdText = b;
@@ -587,6 +604,9 @@ bool K3b::AudioDoc::loadDocumentData( QDomElement* root )
         else if( e.nodeName() == "normalize" )
             setNormalize( e.text() == "yes" );
 
+        else if( e.nodeName() == "verify_data" )
+            setVerifyData( e.text() == "yes" );
+
         else if( e.nodeName() == "hide_first_track" )
             setHideFirstTrack( e.text() == "yes" );
 
@@ -792,6 +812,11 @@ bool K3b::AudioDoc::saveDocumentData( QDomElement* docElem )
     normalizeElem.appendChild( doc.createTextNode( normalize() ? "yes" : "no" ) );
     docElem->appendChild( normalizeElem );
 
+    // add verify data
+    QDomElement verifyDataElem = doc.createElement( "verify_data" );
+    verifyDataElem.appendChild( doc.createTextNode( verifyData() ? "yes" : "no" ) );
+    docElem->appendChild( verifyDataElem );
+
     // add hide track
     QDomElement hideFirstTrackElem = doc.createElement( "hide_first_track" );
     hideFirstTrackElem.appendChild( doc.createTextNode( hideFirstTrack() ? "yes" : "no" ) );
@@ -997,6 +1022,12 @@ bool K3b::AudioDoc::normalize() const
 }
 
 
+bool K3b::AudioDoc::verifyData() const
+{
+    return d->verifyData;
+}
+
+
 K3b::BurnJob* K3b::AudioDoc::newBurnJob( K3b::JobHandler* hdl, QObject* parent )
 {
     return new K3b::AudioJob( this, hdl, parent );
@@ -1046,6 +1077,7 @@ void K3b::AudioDoc::decreaseDecoderUsage( K3b::AudioDecoder* decoder )
     if( d->decoderUsageCounterMap[decoder] <= 0 ) {
         d->decoderUsageCounterMap.remove(decoder);
         d->decoderPresenceMap.remove(decoder->filename());
+        d->decoderPool.remove(decoder->filename());
         delete decoder;
     }
 }
@@ -23,6 +23,7 @@ namespace K3b {
     class AudioTrack;
     class AudioDataSource;
     class AudioDecoder;
+    class AudioDecoderPool;
     class AudioFile;
 
     /**
@@ -56,6 +57,7 @@ namespace K3b {
         int numOfTracks() const override;
 
         bool normalize() const;
+        bool verifyData() const;
 
         AudioTrack* firstTrack() const;
         AudioTrack* lastTrack() const;
@@ -129,6 +131,12 @@ namespace K3b {
          */
         AudioDecoder* getDecoderForUrl( const QUrl& url, bool* reused = 0 );
 
+        /**
+         * The decoders used to read the audio files of the project. The decoders
+         * returned by getDecoderForUrl() are only used for the file information.
+         */
+        AudioDecoderPool* decoderPool() const;
+
         /**
          * Transforms given url list into flat file list.
          * Each directory and M3U playlist is expanded into the files.
@@ -156,6 +164,7 @@ namespace K3b {
 
         void setHideFirstTrack( bool b );
         void setNormalize( bool b );
+        void setVerifyData( bool b );
 
         // CD-Text
         void writeCdText( bool b );
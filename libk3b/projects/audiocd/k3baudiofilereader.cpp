@@ -9,6 +9,9 @@
 #include "k3baudiofilereader.h"
 #include "k3baudiofile.h"
 #include "k3baudiodecoder.h"
+#include "k3baudiodecoderpool.h"
+#include "k3baudiodoc.h"
+#include "k3baudiotrack.h"
 
 
 namespace K3b {
@@ -18,14 +21,73 @@ class AudioFileReader::Private
 public:
     Private( AudioFile& s )
     :
-        source( s )
+        source( s ),
+        decoder( 0 ),
+        pooled( false ),
+        decoderPos( 0 )
     {
     }
 
+    bool acquireDecoder( qint64 pos );
+    void releaseDecoder();
+    bool decoderReusable() const;
+
     AudioFile& source;
+
+    // the decoder we are reading with, either one of the doc's decoder
+    // pool or the decoder of the source if the pool could not provide one
+    AudioDecoder* decoder;
+    bool pooled;
+
+    // the number of bytes decoded from the start of the source. The
+    // QIODevice buffer may hold some of them, thus pos() can be less.
+    qint64 decoderPos;
 };
 
 
+bool AudioFileReader::Private::acquireDecoder( qint64 pos )
+{
+    const Msf start = source.startOffset() + Msf::fromAudioBytes( pos );
+    decoder = source.doc()->decoderPool()->acquire( source.decoder(), start );
+    pooled = ( decoder != 0 );
+    if( !decoder && source.decoder()->seek( start ) )
+        decoder = source.decoder();
+    decoderPos = pos;
+    return decoder != 0;
+}
+
+
+void AudioFileReader::Private::releaseDecoder()
+{
+    if( decoder && pooled )
+        source.doc()->decoderPool()->release( decoder, source.startOffset().audioBytes() + decoderPos, decoderReusable() );
+    decoder = 0;
+    pooled = false;
+}
+
+
+bool AudioFileReader::Private::decoderReusable() const
+{
+    // only a decoder at the end of the source may be of no use to anyone
+    const Msf nearEnd( 0, 1, 0 );
+    if( source.length().audioBytes() - decoderPos > nearEnd.audioBytes() )
+        return true;
+
+    // the next track of a split file may start there
+    const qint64 pos = source.startOffset().audioBytes() + decoderPos;
+    for( AudioTrack* track = source.doc()->firstTrack(); track; track = track->next() ) {
+        for( AudioDataSource* s = track->firstSource(); s; s = s->next() ) {
+            AudioFile* file = dynamic_cast<AudioFile*>( s );
+            if( file && file != &source && file->filename() == source.filename() &&
+                file->startOffset().audioBytes() >= pos &&
+                file->startOffset().audioBytes() - pos <= nearEnd.audioBytes() )
+                return true;
+        }
+    }
+    return false;
+}
+
+
 AudioFileReader::AudioFileReader( AudioFile& source, QObject* parent )
     : QIODevice( parent ),
       d( new Private( source ) )
@@ -52,6 +114,7 @@ bool AudioFileReader::open( OpenMode mode )
 
 void AudioFileReader::close()
 {
+    d->releaseDecoder();
     QIODevice::close();
 }
 
@@ -72,8 +135,10 @@ bool AudioFileReader::seek( qint64 pos )
 {
     Msf msf = Msf::fromAudioBytes( pos );
     // this is valid once the decoder has been initialized.
-    if( d->source.startOffset() + msf <= d->source.lastSector() &&
-        d->source.decoder()->seek( d->source.startOffset() + msf ) ) {
+    if( d->source.startOffset() + msf <= d->source.lastSector() ) {
+        // the decoder is positioned once we read. Until then other readers
+        // may use it.
+        d->releaseDecoder();
         return QIODevice::seek( pos );
     }
     else {
@@ -95,10 +160,19 @@ qint64 AudioFileReader::readData( char* data, qint64 maxlen )
     if( maxlen + pos() > size() )
         maxlen = size() - pos();
 
-    qint64 read = d->source.decoder()->decode( data, maxlen );
+    if( maxlen <= 0 || ( !d->decoder && !d->acquireDecoder( pos() ) ) )
+        return -1;
+
+    qint64 read = d->decoder->decode( data, maxlen );
 
-    if( read > 0 )
+    if( read > 0 ) {
+        d->decoderPos += read;
+
+        // the decoder is at the start of the next track of split files
+        if( d->decoderPos >= size() )
+            d->releaseDecoder();
         return read;
+    }
     else
         return -1;
 }
@@ -11,13 +11,16 @@
 #include "k3baudiotrack.h"
 #include "k3baudiotrackreader.h"
 #include "k3baudiodatasource.h"
+#include "k3baudiochecksum.h"
 #include "k3bthread.h"
+#include "k3breadaheadbuffer.h"
 #include "k3bwavefilewriter.h"
 #include "k3b_i18n.h"
 
 #include <QDebug>
 #include <QIODevice>
 #include <QFile>
+#include <QThread>
 
 #include <unistd.h>
 
@@ -26,13 +29,22 @@ class K3b::AudioImager::Private
 {
 public:
     Private()
-        : ioDev(0) {
+        : ioDev(0),
+          readAheadBufferSize(0),
+          decodingFailed(false) {
     }
 
     QIODevice* ioDev;
+    qint64 readAheadBufferSize;
+    QList<double> trackGains;
     AudioImager::ErrorType lastError;
     AudioDoc* doc;
     AudioJobTempData* tempData;
+    QList<AudioChecksum> checksums;
+
+    // set by the decoding thread if decoding fails
+    QString decodingError;
+    bool decodingFailed;
 };
 
 
@@ -58,15 +70,37 @@ void K3b::AudioImager::writeTo( QIODevice* dev )
 }
 
 
+void K3b::AudioImager::setReadAheadBufferSize( qint64 bytes )
+{
+    d->readAheadBufferSize = bytes;
+}
+
+
+void K3b::AudioImager::setTrackGains( const QList<double>& gains )
+{
+    d->trackGains = gains;
+}
+
+
 K3b::AudioImager::ErrorType K3b::AudioImager::lastErrorType() const
 {
     return d->lastError;
 }
 
 
+QList<K3b::AudioChecksum> K3b::AudioImager::checksums() const
+{
+    return d->checksums;
+}
+
+
 bool K3b::AudioImager::run()
 {
     d->lastError = K3b::AudioImager::ERROR_UNKNOWN;
+    d->checksums.clear();
+
+    if( d->ioDev && d->readAheadBufferSize > 0 )
+        return writeWithReadAhead();
 
     K3b::WaveFileWriter waveFileWriter;
 
@@ -82,11 +116,14 @@ bool K3b::AudioImager::run()
         // Create track reader
         //
         AudioTrackReader trackReader( *track );
+        trackReader.setGain( d->trackGains.value( track->trackNumber()-1 ) );
         if( !trackReader.open() ) {
             emit infoMessage( i18n("Unable to read track %1.", track->trackNumber()), K3b::Job::MessageError );
             return false;
         }
 
+        AudioChecksum checksum( track->length(), track->prev() == 0, track->next() == 0 );
+
         //
         // Initialize the reading
         //
@@ -108,6 +145,8 @@ bool K3b::AudioImager::run()
         // Read data from the track
         //
         while( !trackReader.atEnd() && (read = trackReader.read( buffer, sizeof(buffer) )) > 0 ) {
+            checksum.update( buffer, read, K3b::AudioChecksum::BigEndian );
+
             if( !d->ioDev ) {
                 waveFileWriter.write( buffer, read, K3b::WaveFileWriter::BigEndian );
             }
@@ -143,9 +182,147 @@ bool K3b::AudioImager::run()
             d->lastError = K3b::AudioImager::ERROR_DECODING_TRACK;
             return false;
         }
+
+        d->checksums.append( checksum );
     }
 
     return true;
 }
 
 
+bool K3b::AudioImager::writeWithReadAhead()
+{
+    d->decodingFailed = false;
+    d->decodingError.clear();
+
+    ReadAheadBuffer buffer( d->readAheadBufferSize );
+    QThread* decodingThread = QThread::create( [this, &buffer]() { decodeTracks( &buffer ); } );
+    decodingThread->start();
+
+    qint64 totalSize = d->doc->length().audioBytes();
+    qint64 totalRead = 0;
+    // a low fill level means the writer had to wait for the decoders
+    int lowestFillLevel = 100;
+    int lastFillLevel = -1;
+    char data[2352 * 10];
+
+    bool success = true;
+    for( AudioTrack* track = d->doc->firstTrack(); success && track != 0; track = track->next() ) {
+
+        emit nextTrack( track->trackNumber(), d->doc->numOfTracks() );
+
+        //
+        // The decoding thread writes all tracks one after the other
+        // into the buffer. Each track is exactly as long as its length.
+        //
+        const qint64 trackSize = track->length().audioBytes();
+        qint64 trackRead = 0;
+        while( trackRead < trackSize ) {
+            qint64 read = buffer.read( data, qMin<qint64>( sizeof(data), trackSize - trackRead ) );
+            if( read < 0 ) {
+                // decoding failed
+                success = false;
+                break;
+            }
+            else if( read == 0 ) {
+                // the decoders delivered less data than expected
+                emit infoMessage( i18n("Track %1 is shorter than expected.", track->trackNumber()), K3b::Job::MessageError );
+                d->lastError = K3b::AudioImager::ERROR_DECODING_TRACK;
+                success = false;
+                break;
+            }
+
+            qint64 w = d->ioDev->write( data, read );
+            if ( w != read ) {
+                qDebug() << "(K3b::AudioImager::WorkThread) writing to device" << d->ioDev << "failed:" << read << w;
+                d->lastError = K3b::AudioImager::ERROR_FD_WRITE;
+                success = false;
+                break;
+            }
+
+            if( canceled() ) {
+                success = false;
+                break;
+            }
+
+            //
+            // Emit progress
+            //
+            totalRead += read;
+            trackRead += read;
+
+            emit subPercent( 100LL*trackRead/trackSize );
+            emit percent( 100LL*totalRead/totalSize );
+            emit processedSubSize( trackRead/1024LL/1024LL, trackSize/1024LL/1024LL );
+            emit processedSize( totalRead/1024LL/1024LL, totalSize/1024LL/1024LL );
+
+            const int fillLevel = buffer.fillLevel();
+            lowestFillLevel = qMin( lowestFillLevel, fillLevel );
+            if( fillLevel != lastFillLevel ) {
+                emit readAheadBufferStatus( fillLevel );
+                lastFillLevel = fillLevel;
+            }
+        }
+    }
+
+    // stops the decoding thread in case we did not read all the data
+    buffer.cancel();
+    decodingThread->wait();
+    delete decodingThread;
+
+    emit debuggingOutput( QLatin1String( "K3b::AudioImager" ),
+                          QString( "Lowest read-ahead buffer fill level: %1%" ).arg( lowestFillLevel ) );
+
+    if( d->decodingFailed ) {
+        emit infoMessage( d->decodingError, K3b::Job::MessageError );
+        d->lastError = K3b::AudioImager::ERROR_DECODING_TRACK;
+        return false;
+    }
+
+    return success;
+}
+
+
+void K3b::AudioImager::decodeTracks( ReadAheadBuffer* buffer )
+{
+    char data[2352 * 10];
+
+    for( AudioTrack* track = d->doc->firstTrack(); track != 0; track = track->next() ) {
+
+        AudioTrackReader trackReader( *track );
+        trackReader.setGain( d->trackGains.value( track->trackNumber()-1 ) );
+        if( !trackReader.open() ) {
+            d->decodingError = i18n("Unable to read track %1.", track->trackNumber());
+            d->decodingFailed = true;
+            buffer->cancel();
+            return;
+        }
+
+        AudioChecksum checksum( track->length(), track->prev() == 0, track->next() == 0 );
+
+        qint64 read = 0;
+        qint64 trackRead = 0;
+        while( !trackReader.atEnd() && (read = trackReader.read( data, sizeof(data) )) > 0 ) {
+            checksum.update( data, read, K3b::AudioChecksum::BigEndian );
+
+            // the buffer is canceled once writing stops
+            if( !buffer->write( data, read ) || canceled() )
+                return;
+
+            trackRead += read;
+        }
+
+        if( read < 0 ) {
+            qDebug() << "(K3b::AudioImager::WorkThread) read error on track " << track->trackNumber()
+                     << " at pos " << K3b::Msf(trackRead/2352) << Qt::endl;
+            d->decodingError = i18n("Error while decoding track %1.", track->trackNumber());
+            d->decodingFailed = true;
+            buffer->cancel();
+            return;
+        }
+
+        d->checksums.append( checksum );
+    }
+
+    buffer->close();
+}
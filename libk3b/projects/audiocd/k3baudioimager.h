@@ -8,11 +8,15 @@
 
 #include "k3bthreadjob.h"
 
+#include <QList>
+
 class QIODevice;
 
 namespace K3b {
+    class AudioChecksum;
     class AudioDoc;
     class AudioJobTempData;
+    class ReadAheadBuffer;
 
     class AudioImager : public ThreadJob
     {
@@ -29,6 +33,22 @@ namespace K3b {
          */
         void writeTo( QIODevice* dev );
 
+        /**
+         * When writing to a device the tracks are decoded in a separate
+         * thread into a buffer of this size. This keeps the writer busy
+         * while decoding is slow for a moment, for example when seeking.
+         * Defaults to 0 which disables the buffer.
+         */
+        void setReadAheadBufferSize( qint64 bytes );
+
+        /**
+         * The gains in dB applied to the tracks in track order, for example
+         * to normalize their loudness. The checksums are calculated from
+         * the data with the gain applied. Tracks without a gain are written
+         * unchanged.
+         */
+        void setTrackGains( const QList<double>& gains );
+
         enum ErrorType {
             ERROR_FD_WRITE,
             ERROR_DECODING_TRACK,
@@ -37,8 +57,24 @@ namespace K3b {
 
         ErrorType lastErrorType() const;
 
+        /**
+         * The checksums of the decoded tracks in track order. They are
+         * calculated while imaging and are used by AudioJob and MixedJob to
+         * verify the written tracks.
+         */
+        QList<AudioChecksum> checksums() const;
+
+    Q_SIGNALS:
+        /**
+         * The fill level of the read-ahead buffer in percent. Emitted
+         * while writing to a device with a read-ahead buffer.
+         */
+        void readAheadBufferStatus( int );
+
     private:
         bool run() override;
+        bool writeWithReadAhead();
+        void decodeTracks( ReadAheadBuffer* buffer );
 
         class Private;
         Private* const d;
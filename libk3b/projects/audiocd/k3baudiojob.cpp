@@ -15,6 +15,8 @@
 #include "k3baudiomaxspeedjob.h"
 #include "k3baudiocdtracksource.h"
 #include "k3baudiofile.h"
+#include "k3baudiochecksum.h"
+#include "k3bverificationjob.h"
 #include "k3bdevicemanager.h"
 #include "k3bdevicehandler.h"
 #include "k3bdevice.h"
@@ -75,6 +77,7 @@ public:
 
     bool useCdText;
     bool maxSpeed;
+    bool verifyData;
 
     bool zeroPregap;
     bool less4Sec;
@@ -85,7 +88,8 @@ K3b::AudioJob::AudioJob( K3b::AudioDoc* doc, K3b::JobHandler* hdl, QObject* pare
     : K3b::BurnJob( hdl, parent ),
       m_doc( doc ),
       m_normalizeJob(0),
-      m_maxSpeedJob(0)
+      m_maxSpeedJob(0),
+      m_verificationJob(0)
 {
     d = new Private;
 
@@ -101,6 +105,10 @@ K3b::AudioJob::AudioJob( K3b::AudioDoc* doc, K3b::JobHandler* hdl, QObject* pare
              this, SLOT(slotAudioDecoderFinished(bool)) );
     connect( m_audioImager, SIGNAL(nextTrack(int,int)),
              this, SLOT(slotAudioDecoderNextTrack(int,int)) );
+    connect( m_audioImager, SIGNAL(debuggingOutput(QString,QString)),
+             this, SIGNAL(debuggingOutput(QString,QString)) );
+    connect( m_audioImager, SIGNAL(readAheadBufferStatus(int)),
+             this, SIGNAL(readAheadBufferStatus(int)) );
 
     m_writer = 0;
 }
@@ -139,10 +147,14 @@ void K3b::AudioJob::start()
     d->useCdText = m_doc->cdText();
     d->usedSpeed = m_doc->speed();
     d->maxSpeed = false;
+    d->verifyData = m_doc->verifyData() && !m_doc->dummy() && !m_doc->onlyCreateImages();
 
     if( m_doc->dummy() )
         d->copies = 1;
 
+    m_audioImager->setReadAheadBufferSize( qint64( k3bcore->globalSettings()->audioReadAheadBufferSize() )*1024LL*1024LL );
+    m_audioImager->setTrackGains( QList<double>() );
+
     emit newTask( i18n("Preparing data") );
     const K3b::ExternalBin* cdrecordBin = k3bcore->externalBinManager()->binObject("cdrecord");
     //
@@ -296,7 +308,16 @@ void K3b::AudioJob::start()
         }
     }
 
+    // the gains are applied while decoding, so the loudness has to be known first
+    if( m_doc->normalize() )
+        normalizeFiles();
+    else
+        startImaging();
+}
+
 
+void K3b::AudioJob::startImaging()
+{
     if( !m_doc->onlyCreateImages() && m_doc->onTheFly() ) {
         if( m_doc->speed() == 0 ) {
             // try to determine the max possible speed
@@ -308,6 +329,7 @@ void K3b::AudioJob::start()
                 connect( m_maxSpeedJob, SIGNAL(finished(bool)),
                          this, SLOT(slotMaxSpeedJobFinished(bool)) );
             }
+            m_maxSpeedJob->setReadAheadBufferSize( qint64( k3bcore->globalSettings()->audioReadAheadBufferSize() )*1024LL*1024LL );
             m_maxSpeedJob->start();
             return;
         }
@@ -369,9 +391,15 @@ void K3b::AudioJob::cancel()
 {
     m_canceled = true;
 
+    if( m_normalizeJob )
+        m_normalizeJob->cancel();
+
     if( m_maxSpeedJob )
         m_maxSpeedJob->cancel();
 
+    if( m_verificationJob && m_verificationJob->active() )
+        m_verificationJob->cancel();
+
     if( m_writer )
         m_writer->cancel();
 
@@ -393,34 +421,112 @@ void K3b::AudioJob::slotWriterFinished( bool success )
         jobFinished(false);
         return;
     }
+    else if( d->verifyData ) {
+        verifyCopy();
+    }
     else {
-        d->copiesDone++;
+        finishCopy();
+    }
+}
 
-        if( d->copiesDone == d->copies ) {
-            if( m_doc->onTheFly() || m_doc->removeImages() )
-                removeBufferFiles();
 
-            if ( k3bcore->globalSettings()->ejectMedia() ) {
-                K3b::Device::eject( m_doc->burner() );
-            }
+void K3b::AudioJob::verifyCopy()
+{
+    if( !m_verificationJob ) {
+        m_verificationJob = new K3b::VerificationJob( this, this );
+        connect( m_verificationJob, SIGNAL(infoMessage(QString,int)),
+                 this, SIGNAL(infoMessage(QString,int)) );
+        connect( m_verificationJob, SIGNAL(newTask(QString)),
+                 this, SIGNAL(newSubTask(QString)) );
+        connect( m_verificationJob, SIGNAL(newSubTask(QString)),
+                 this, SIGNAL(newSubTask(QString)) );
+        connect( m_verificationJob, SIGNAL(percent(int)),
+                 this, SLOT(slotVerificationProgress(int)) );
+        connect( m_verificationJob, SIGNAL(percent(int)),
+                 this, SIGNAL(subPercent(int)) );
+        connect( m_verificationJob, SIGNAL(finished(bool)),
+                 this, SLOT(slotVerificationFinished(bool)) );
+        connect( m_verificationJob, SIGNAL(debuggingOutput(QString,QString)),
+                 this, SIGNAL(debuggingOutput(QString,QString)) );
+    }
 
-            jobFinished(true);
+    m_verificationJob->clear();
+    m_verificationJob->setDevice( m_doc->burner() );
+
+    // the hidden first track is part of the first track's pregap
+    const QList<K3b::AudioChecksum> checksums = m_audioImager->checksums();
+    const int firstTrack = m_doc->hideFirstTrack() ? 1 : 0;
+    for( int i = firstTrack; i < checksums.count(); ++i )
+        m_verificationJob->addTrack( i - firstTrack + 1, checksums[i] );
+
+    emit burning(false);
+
+    emit newTask( i18n("Verifying written data") );
+
+    m_verificationJob->start();
+}
+
+
+void K3b::AudioJob::slotVerificationProgress( int p )
+{
+    double totalTasks = d->copies*2;
+    double tasksDone = d->copiesDone*2 + 1; // the writing of the current copy has already been finished
+    if( m_doc->normalize() ) {
+        totalTasks+=1.0;
+        tasksDone+=1.0;
+    }
+    if( !m_doc->onTheFly() ) {
+        totalTasks+=1.0;
+        tasksDone+=1.0;
+    }
+
+    emit percent( (int)((100.0*tasksDone + (double)p) / totalTasks) );
+}
+
+
+void K3b::AudioJob::slotVerificationFinished( bool success )
+{
+    if( m_canceled )
+        return;
+
+    if( !success ) {
+        cleanupAfterError();
+        jobFinished(false);
+    }
+    else {
+        finishCopy();
+    }
+}
+
+
+void K3b::AudioJob::finishCopy()
+{
+    d->copiesDone++;
+
+    if( d->copiesDone == d->copies ) {
+        if( m_doc->onTheFly() || m_doc->removeImages() )
+            removeBufferFiles();
+
+        if ( k3bcore->globalSettings()->ejectMedia() ) {
+            K3b::Device::eject( m_doc->burner() );
         }
-        else {
-            if( !K3b::eject( m_doc->burner() ) ) {
-                blockingInformation( i18n("K3b was unable to eject the written disk. Please do so manually.") );
-            }
 
-            if( startWriting() ) {
-                if( m_doc->onTheFly() ) {
-                    // now the writer is running and we can get it's stdin
-                    // we only use this method when writing on-the-fly since
-                    // we cannot easily change the audioDecode fd while it's working
-                    // which we would need to do since we write into several
-                    // image files.
-                    m_audioImager->writeTo( m_writer->ioDevice() );
-                    m_audioImager->start();
-                }
+        jobFinished(true);
+    }
+    else {
+        if( !K3b::eject( m_doc->burner() ) ) {
+            blockingInformation( i18n("K3b was unable to eject the written disk. Please do so manually.") );
+        }
+
+        if( startWriting() ) {
+            if( m_doc->onTheFly() ) {
+                // now the writer is running and we can get it's stdin
+                // we only use this method when writing on-the-fly since
+                // we cannot easily change the audioDecode fd while it's working
+                // which we would need to do since we write into several
+                // image files.
+                m_audioImager->writeTo( m_writer->ioDevice() );
+                m_audioImager->start();
             }
         }
     }
@@ -448,10 +554,7 @@ void K3b::AudioJob::slotAudioDecoderFinished( bool success )
 
         emit infoMessage( i18n("Successfully decoded all tracks."), MessageSuccess );
 
-        if( m_doc->normalize() ) {
-            normalizeFiles();
-        }
-        else if( !m_doc->onlyCreateImages() ) {
+        if( !m_doc->onlyCreateImages() ) {
             if( !prepareWriter() ) {
                 cleanupAfterError();
                 jobFinished(false);
@@ -591,6 +694,10 @@ void K3b::AudioJob::slotWriterJobPercent( int p )
 {
     double totalTasks = d->copies;
     double tasksDone = d->copiesDone;
+    if( d->verifyData ) {
+        totalTasks*=2;
+        tasksDone*=2;
+    }
     if( m_doc->normalize() ) {
         totalTasks+=1.0;
         tasksDone+=1.0;
@@ -608,15 +715,20 @@ void K3b::AudioJob::slotAudioDecoderPercent( int p )
 {
     if( m_doc->onlyCreateImages() ) {
         if( m_doc->normalize() )
-            emit percent( p/2 );
+            emit percent( 50 + p/2 );
         else
             emit percent( p );
     }
     else if( !m_doc->onTheFly() ) {
         double totalTasks = d->copies;
         double tasksDone = d->copiesDone; // =0 when creating an image
+        if( d->verifyData ) {
+            totalTasks*=2;
+            tasksDone*=2;
+        }
         if( m_doc->normalize() ) {
             totalTasks+=1.0;
+            tasksDone+=1.0;
         }
         if( !m_doc->onTheFly() ) {
             totalTasks+=1.0;
@@ -695,29 +807,18 @@ void K3b::AudioJob::removeBufferFiles()
 void K3b::AudioJob::normalizeFiles()
 {
     if( !m_normalizeJob ) {
-        m_normalizeJob = new K3b::AudioNormalizeJob( this, this );
+        m_normalizeJob = new K3b::AudioNormalizeJob( m_doc, this, this );
 
         connect( m_normalizeJob, SIGNAL(infoMessage(QString,int)),
                  this, SIGNAL(infoMessage(QString,int)) );
         connect( m_normalizeJob, SIGNAL(percent(int)), this, SLOT(slotNormalizeProgress(int)) );
-        connect( m_normalizeJob, SIGNAL(subPercent(int)), this, SLOT(slotNormalizeSubProgress(int)) );
+        connect( m_normalizeJob, SIGNAL(percent(int)), this, SLOT(slotNormalizeSubProgress(int)) );
         connect( m_normalizeJob, SIGNAL(finished(bool)), this, SLOT(slotNormalizeJobFinished(bool)) );
-        connect( m_normalizeJob, SIGNAL(newTask(QString)), this, SIGNAL(newSubTask(QString)) );
+        connect( m_normalizeJob, SIGNAL(newSubTask(QString)), this, SIGNAL(newSubTask(QString)) );
         connect( m_normalizeJob, SIGNAL(debuggingOutput(QString,QString)),
                  this, SIGNAL(debuggingOutput(QString,QString)) );
     }
 
-    // add all the files
-    // TODO: we may need to split the wave files and put them back together!
-    QList<QString> files;
-    K3b::AudioTrack* track = m_doc->firstTrack();
-    while( track ) {
-        files.append( m_tempData->bufferFileName(track) );
-        track = track->next();
-    }
-
-    m_normalizeJob->setFilesToNormalize( files );
-
     emit newTask( i18n("Normalizing volume levels") );
     m_normalizeJob->start();
 }
@@ -728,18 +829,8 @@ void K3b::AudioJob::slotNormalizeJobFinished( bool success )
         return;
 
     if( success ) {
-        if( m_doc->onlyCreateImages() ) {
-            jobFinished(true);
-        }
-        else {
-            // start the writing
-            if( !prepareWriter() ) {
-                cleanupAfterError();
-                jobFinished(false);
-            }
-            else
-                startWriting();
-        }
+        m_audioImager->setTrackGains( m_normalizeJob->gains() );
+        startImaging();
     }
     else {
         cleanupAfterError();
@@ -749,10 +840,17 @@ void K3b::AudioJob::slotNormalizeJobFinished( bool success )
 
 void K3b::AudioJob::slotNormalizeProgress( int p )
 {
-    double totalTasks = d->copies+2.0;
-    double tasksDone = 1; // the decoding has been finished
+    // normalizing is the first task, followed by decoding and writing all copies
+    double totalTasks = 2.0;
+    if( !m_doc->onlyCreateImages() ) {
+        totalTasks = d->copies + 1.0;
+        if( d->verifyData )
+            totalTasks += d->copies;
+        if( !m_doc->onTheFly() )
+            totalTasks += 1.0;
+    }
 
-    emit percent( (int)((100.0*tasksDone + (double)p) / totalTasks) );
+    emit percent( (int)((double)p / totalTasks) );
 }
 
 
@@ -17,6 +17,7 @@ namespace K3b {
     class AudioNormalizeJob;
     class AudioJobTempData;
     class AudioMaxSpeedJob;
+    class VerificationJob;
     class Doc;
 
     /**
@@ -60,15 +61,22 @@ namespace K3b {
         // max speed
         void slotMaxSpeedJobFinished( bool );
 
+        // verification
+        void slotVerificationProgress( int );
+        void slotVerificationFinished( bool );
+
     private:
         bool prepareWriter();
         bool startWriting();
+        void startImaging();
         void cleanupAfterError();
         void removeBufferFiles();
         void normalizeFiles();
         bool writeTocFile();
         bool writeInfFiles();
         bool checkAudioSources();
+        void verifyCopy();
+        void finishCopy();
 
         AudioDoc* m_doc;
         AudioImager* m_audioImager;
@@ -76,6 +84,7 @@ namespace K3b {
         AudioNormalizeJob* m_normalizeJob;
         AudioJobTempData* m_tempData;
         AudioMaxSpeedJob* m_maxSpeedJob;
+        VerificationJob* m_verificationJob;
 
         QTemporaryFile* m_tocFile;
 
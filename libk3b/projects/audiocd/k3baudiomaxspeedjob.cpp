@@ -4,80 +4,135 @@
 */
 
 #include "k3baudiomaxspeedjob.h"
+#include "k3baudiothroughputprofile.h"
 #include "k3baudiotrack.h"
 #include "k3baudiodatasource.h"
 #include "k3baudiodoc.h"
 #include "k3baudiocdtracksource.h"
 #include "k3baudiodatasourceiterator.h"
+#include "k3bcore.h"
 #include "k3bdevice.h"
+#include "k3bglobalsettings.h"
 #include "k3bthread.h"
 #include "k3b_i18n.h"
 
 #include <QDateTime>
 #include <QDebug>
+#include <QHash>
 #include <QIODevice>
+#include <QMutex>
 #include <QScopedPointer>
 #include <QElapsedTimer>
+#include <QThread>
+
+
+namespace {
+    /**
+     * A source to measure and the result
+     */
+    struct Measurement
+    {
+        Measurement()
+            : source( 0 ),
+              success( false ),
+              throughput( 0 ),
+              startupTime( 0 ) {
+        }
+
+        K3b::AudioDataSource* source;
+        QString key;
+        bool success;
+        qint64 throughput;
+        int startupTime;
+    };
+
+    // the amount of data decoded to measure the throughput, five seconds of audio
+    const qint64 MEASUREMENT_SIZE = 2352*75*5;
+}
 
 
 class K3b::AudioMaxSpeedJob::Private
 {
 public:
-    int speedTest( K3b::AudioDataSource* source, QIODevice& sourceReader );
+    Private()
+        : maxSpeed( 175*1000 ),
+          readAheadBufferSize( 0 ),
+          nextMeasurement( 0 ),
+          measurementsDone( 0 ) {
+    }
+
+    bool measure( Measurement* m, AudioMaxSpeedJob* job );
     int maxSpeedByMedia() const;
 
     int maxSpeed;
+    qint64 readAheadBufferSize;
     K3b::AudioDoc* doc;
-    char* buffer;
+
+    // the measurements in the order they are taken. The audio CD
+    // is always measured first to give it time to spin up.
+    QList<Measurement*> measurements;
+    int nextMeasurement;
+    int measurementsDone;
+    QMutex mutex;
 };
 
 
-// returns the amount of data read from this source
-int K3b::AudioMaxSpeedJob::Private::speedTest( K3b::AudioDataSource* source, QIODevice& sourceReader )
+bool K3b::AudioMaxSpeedJob::Private::measure( Measurement* m, AudioMaxSpeedJob* job )
 {
     //
     // in case of an audio track source we only test when the cd is inserted since asking the user would
     // confuse him a lot.
     //
-    // FIXME: there is still the problem of the spin up time.
-    //
-    if( K3b::AudioCdTrackSource* cdts = dynamic_cast<K3b::AudioCdTrackSource*>( source ) ) {
+    if( K3b::AudioCdTrackSource* cdts = dynamic_cast<K3b::AudioCdTrackSource*>( m->source ) ) {
         if( K3b::Device::Device* dev = cdts->searchForAudioCD() ) {
             cdts->setDevice( dev );
         }
         else {
             qDebug() << "(K3b::AudioMaxSpeedJob) ignoring audio cd track source.";
-            return 0;
+            return true;
         }
     }
 
     QElapsedTimer t;
-    qint64 dataRead = 0;
-    qint64 r = 0;
-
-    // start the timer
     t.start();
 
-    // read ten seconds of audio data. This is some value which seemed about right. :)
-    while( dataRead < 2352*75*10 && (r = sourceReader.read( buffer, 2352LL*10LL )) > 0 ) {
+    QScopedPointer<QIODevice> sourceReader( m->source->createReader() );
+    if( !sourceReader->open( QIODevice::ReadOnly ) ) {
+        qDebug() << "Cannot open source reader!";
+        return false;
+    }
+
+    //
+    // The first data includes opening the file, seeking to the start offset
+    // and spinning up the CD. That is measured separately since it is paid
+    // for every source.
+    //
+    char buffer[2352*10];
+    qint64 r = sourceReader->read( buffer, sizeof(buffer) );
+    m->startupTime = t.elapsed();
+
+    qint64 dataRead = 0;
+    t.restart();
+    while( r > 0 && dataRead < MEASUREMENT_SIZE && !job->canceled() &&
+           (r = sourceReader->read( buffer, sizeof(buffer) )) > 0 ) {
         dataRead += r;
     }
 
-    // elapsed millisec
-    int usedT = t.elapsed();
+    const qint64 usedT = t.nsecsElapsed();
 
     if( r < 0 ) {
         qDebug() << "(K3b::AudioMaxSpeedJob) read failure.";
-        return -1;
+        return false;
     }
 
-    // KB/sec (add 1 millisecond to avoid division by 0)
-    int throughput = (dataRead*1000+usedT)/(usedT+1)/1024;
-    qDebug() << "(K3b::AudioMaxSpeedJob) throughput: " << throughput
-             << " (" << dataRead << "/" << usedT << ")" << Qt::endl;
+    // bytes/sec, 0 if the source is too short to tell
+    if( dataRead > 0 )
+        m->throughput = dataRead*1000000000LL/qMax<qint64>( 1, usedT );
 
+    qDebug() << "(K3b::AudioMaxSpeedJob)" << m->key << "throughput:" << m->throughput/1024
+             << "KB/s startup:" << m->startupTime << "ms";
 
-    return throughput;
+    return true;
 }
 
 
@@ -110,13 +165,11 @@ K3b::AudioMaxSpeedJob::AudioMaxSpeedJob( K3b::AudioDoc* doc, K3b::JobHandler* jh
       d( new Private() )
 {
     d->doc = doc;
-    d->buffer = new char[2352*10];
 }
 
 
 K3b::AudioMaxSpeedJob::~AudioMaxSpeedJob()
 {
-    delete [] d->buffer;
     delete d;
 }
 
@@ -127,59 +180,134 @@ int K3b::AudioMaxSpeedJob::maxSpeed() const
 }
 
 
-bool K3b::AudioMaxSpeedJob::run()
+void K3b::AudioMaxSpeedJob::setReadAheadBufferSize( qint64 bytes )
 {
-    qDebug();
+    d->readAheadBufferSize = bytes;
+}
 
-    K3b::AudioDataSourceIterator it( d->doc );
 
-    // count sources for minimal progress info
-    int numSources = 0;
-    int sourcesDone = 0;
-    while( it.current() ) {
-        ++numSources;
-        it.next();
-    }
-
-    bool success = true;
-    d->maxSpeed = 175*1000;
-    it.first();
+bool K3b::AudioMaxSpeedJob::run()
+{
+    qDebug();
 
-    while( it.current() && !canceled() ) {
-        QScopedPointer<QIODevice> sourceReader( it.current()->createReader() );
+    AudioThroughputProfile* profile = AudioThroughputProfile::instance();
 
-        if( !sourceReader->open( QIODevice::ReadOnly ) ) {
-            qDebug() << "Cannot open source reader!";
-            success = false;
-            break;
+    //
+    // Measure the kinds of sources which have not been profiled yet. We
+    // use the longest source of each kind to get the most data.
+    //
+    Measurement* cdMeasurement = 0;
+    QHash<QString, Measurement*> fileMeasurements;
+    for( K3b::AudioDataSourceIterator it( d->doc ); it.current(); it.next() ) {
+        AudioDataSource* source = it.current();
+        const QString key = AudioThroughputProfile::key( source );
+        if( dynamic_cast<AudioCdTrackSource*>( source ) ) {
+            if( !cdMeasurement ) {
+                cdMeasurement = new Measurement();
+                cdMeasurement->source = source;
+            }
         }
+        else if( !key.isEmpty() && profile->needsMeasurement( key ) ) {
+            Measurement*& m = fileMeasurements[key];
+            if( !m ) {
+                m = new Measurement();
+                m->key = key;
+            }
+            if( !m->source || m->source->length() < source->length() )
+                m->source = source;
+        }
+    }
 
-        // read some data
-        int speed = d->speedTest( it.current(), *sourceReader );
-
-        ++sourcesDone;
-        emit percent( 100*numSources/sourcesDone );
+    qDeleteAll( d->measurements );
+    d->measurements.clear();
+    if( cdMeasurement )
+        d->measurements.append( cdMeasurement );
+    d->measurements.append( fileMeasurements.values() );
+    d->nextMeasurement = 0;
+    d->measurementsDone = 0;
+
+    // CD reading and decoding do not compete for the same resources and
+    // each worker only uses one core
+    const int numWorkers = qMin( d->measurements.count(), qMax( 1, QThread::idealThreadCount() ) );
+    QList<QThread*> workers;
+    for( int i = 0; i < numWorkers; ++i ) {
+        QThread* thread = QThread::create( [this]() { runMeasurementWorker(); } );
+        workers.append( thread );
+        thread->start();
+    }
+    Q_FOREACH( QThread* thread, workers ) {
+        thread->wait();
+        delete thread;
+    }
 
-        if( speed < 0 ) {
+    bool success = !canceled();
+    Q_FOREACH( Measurement* m, d->measurements ) {
+        if( !m->success )
             success = false;
-            break;
-        }
-        else if( speed > 0 ) {
-            // update the max speed
-            d->maxSpeed = qMin( d->maxSpeed, speed );
+        else if( !m->key.isEmpty() && m->throughput > 0 )
+            profile->addMeasurement( m->key, m->throughput, m->startupTime );
+    }
+    if( !fileMeasurements.isEmpty() )
+        profile->save();
+
+    if( success ) {
+        //
+        // Decode the project in our mind
+        //
+        QList<AudioThroughputProfile::Segment> segments;
+        bool cdStarted = false;
+        for( K3b::AudioDataSourceIterator it( d->doc ); it.current(); it.next() ) {
+            AudioDataSource* source = it.current();
+            AudioThroughputProfile::Segment segment( source->length().audioBytes() );
+            AudioThroughputProfile::Entry entry;
+            if( dynamic_cast<AudioCdTrackSource*>( source ) ) {
+                segment.throughput = cdMeasurement->throughput;
+                // only the first track needs the drive to spin up
+                if( !cdStarted )
+                    segment.startupTime = cdMeasurement->startupTime;
+                cdStarted = true;
+            }
+            else if( profile->lookup( AudioThroughputProfile::key( source ), entry ) ) {
+                segment.throughput = entry.throughput;
+                segment.startupTime = entry.startupTime;
+            }
+            segments.append( segment );
         }
 
-        it.next();
-    }
+        // the fifo of the writing application is filled before writing starts
+        const qint64 fifoSize = 1024LL*1024LL*( k3bcore->globalSettings()->useManualBufferSize()
+                                                ? k3bcore->globalSettings()->bufferSize()
+                                                : 4 );
 
-    if( canceled() ) {
-        success = false;
+        d->maxSpeed = AudioThroughputProfile::maxSpeed( segments, fifoSize, fifoSize + d->readAheadBufferSize );
+        qDebug() << "(K3b::AudioMaxSpeedJob) max speed: " << d->maxSpeed;
     }
 
-    if( success )
-        qDebug() << "(K3b::AudioMaxSpeedJob) max speed: " << d->maxSpeed;
+    qDeleteAll( d->measurements );
+    d->measurements.clear();
 
     return success;
 }
 
 
+void K3b::AudioMaxSpeedJob::runMeasurementWorker()
+{
+    forever {
+        Measurement* m = 0;
+        {
+            QMutexLocker locker( &d->mutex );
+            if( canceled() || d->nextMeasurement >= d->measurements.count() )
+                return;
+            m = d->measurements[d->nextMeasurement++];
+        }
+
+        m->success = d->measure( m, this );
+
+        int done = 0;
+        {
+            QMutexLocker locker( &d->mutex );
+            done = ++d->measurementsDone;
+        }
+        emit percent( 100*done/d->measurements.count() );
+    }
+}
@@ -11,6 +11,14 @@
 namespace K3b {
     class AudioDoc;
 
+    /**
+     * Predicts the highest speed at which an audio project can be written
+     * on-the-fly.
+     *
+     * The prediction is based on the AudioThroughputProfile. Only kinds of
+     * sources which have not been profiled yet are measured, in parallel
+     * with one thread per core.
+     */
     class AudioMaxSpeedJob : public ThreadJob
     {
         Q_OBJECT
@@ -25,8 +33,17 @@ namespace K3b {
          */
         int maxSpeed() const;
 
+        /**
+         * The size of the read-ahead buffer the tracks are decoded into
+         * when writing. It allows sources which are decoded slower than
+         * they are written as long as the sources before them have been
+         * decoded fast enough. Defaults to 0.
+         */
+        void setReadAheadBufferSize( qint64 bytes );
+
     private:
         bool run() override;
+        void runMeasurementWorker();
 
         class Private;
         Private* const d;
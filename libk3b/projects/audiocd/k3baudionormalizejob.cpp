@@ -4,190 +4,299 @@
 */
 
 #include "k3baudionormalizejob.h"
-#include "k3bexternalbinmanager.h"
-#include "k3bprocess.h"
-#include "k3bcore.h"
+#include "k3baudiodoc.h"
+#include "k3baudiotrack.h"
+#include "k3baudiodatasource.h"
+#include "k3baudiofile.h"
+#include "k3baudiocdtracksource.h"
+#include "k3baudiozerodata.h"
+#include "k3baudiodecoder.h"
+#include "k3baudiodecodercache.h"
+#include "k3bloudnessanalyzer.h"
 #include "k3b_i18n.h"
 
+#include <QDataStream>
 #include <QDebug>
+#include <QHash>
+#include <QIODevice>
+#include <QMutex>
+#include <QScopedPointer>
+#include <QStandardPaths>
+#include <QThread>
+
+
+namespace {
+    /**
+     * The loudness data of one source
+     */
+    struct Analysis
+    {
+        Analysis()
+            : peak( 0 ),
+              success( false ) {
+        }
 
+        QVector<float> blocks;
+        float peak;
+        bool success;
+    };
 
-K3b::AudioNormalizeJob::AudioNormalizeJob( K3b::JobHandler* hdl, QObject* parent )
-    : K3b::Job( hdl, parent ),
-      m_process(0)
-{
-}
-
+    const int CACHE_VERSION = 1;
 
-K3b::AudioNormalizeJob::~AudioNormalizeJob()
-{
-    delete m_process;
-}
+    K3b::AudioDecoderCache* loudnessCache()
+    {
+        static K3b::AudioDecoderCache s_cache( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) + "/loudness" );
+        return &s_cache;
+    }
 
+    /**
+     * Sources of the same file may start at different positions.
+     * Thus the offsets are part of the key.
+     */
+    QString cacheKey( K3b::AudioFile* file )
+    {
+        return QString( "%1 %2-%3" )
+            .arg( QString::fromLatin1( file->decoder()->metaObject()->className() ) )
+            .arg( file->startOffset().lba() )
+            .arg( file->lastSector().lba() );
+    }
 
-void K3b::AudioNormalizeJob::start()
-{
-    m_canceled = false;
-    m_currentAction = COMPUTING_LEVELS;
-    m_currentTrack = 1;
+    bool lookupAnalysis( K3b::AudioFile* file, Analysis& analysis )
+    {
+        K3b::AudioDecoderCache::Entry entry;
+        if( !loudnessCache()->lookup( cacheKey( file ), file->filename(), entry ) )
+            return false;
+
+        QDataStream s( entry.decoderData );
+        s.setVersion( QDataStream::Qt_5_0 );
+        s.setFloatingPointPrecision( QDataStream::SinglePrecision );
+        qint32 version = 0;
+        s >> version >> analysis.peak >> analysis.blocks;
+        analysis.success = ( s.status() == QDataStream::Ok && version == CACHE_VERSION );
+        return analysis.success;
+    }
 
-    jobStarted();
+    void storeAnalysis( K3b::AudioFile* file, const Analysis& analysis )
+    {
+        K3b::AudioDecoderCache::Entry entry;
+        entry.length = file->length();
+        entry.samplerate = 44100;
+        entry.channels = 2;
 
-    if( m_process )
-        delete m_process;
+        QDataStream s( &entry.decoderData, QIODevice::WriteOnly );
+        s.setVersion( QDataStream::Qt_5_0 );
+        s.setFloatingPointPrecision( QDataStream::SinglePrecision );
+        s << qint32( CACHE_VERSION ) << analysis.peak << analysis.blocks;
 
-    m_process = new K3b::Process();
-    connect( m_process, SIGNAL(stderrLine(QString)), this, SLOT(slotStdLine(QString)) );
-    connect( m_process, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(slotProcessExited(int,QProcess::ExitStatus)) );
+        if( !loudnessCache()->store( cacheKey( file ), file->filename(), entry ) )
+            qDebug() << "(K3b::AudioNormalizeJob) could not cache the loudness of" << file->filename();
+    }
+}
 
-    const K3b::ExternalBin* bin = k3bcore->externalBinManager()->binObject( "normalize" );
 
-    if( !bin ) {
-        emit infoMessage( i18n("Could not find normalize executable."), MessageError );
-        jobFinished(false);
-        return;
+class K3b::AudioNormalizeJob::Private
+{
+public:
+    Private()
+        : nextGroup( 0 ),
+          totalSize( 0 ),
+          processedSize( 0 ) {
     }
 
-    if( !bin->copyright().isEmpty() )
-        emit infoMessage( i18n("Using %1 %2 – Copyright © %3",bin->name(),bin->version(),bin->copyright()), MessageInfo );
+    bool analyse( AudioDataSource* source, Analysis& analysis, AudioNormalizeJob* job );
 
-    // create the commandline
-    *m_process << bin;
+    AudioDoc* doc;
+    QList<double> gains;
 
-    // additional user parameters from config
-    const QStringList& params = bin->userParameters();
-    for( QStringList::const_iterator it = params.begin(); it != params.end(); ++it )
-        *m_process << *it;
+    // sources which share a decoder or a drive have to be read one
+    // after the other and form a group. The groups are analysed in parallel.
+    QList<QList<AudioDataSource*> > groups;
+    int nextGroup;
 
-    // end the options
-    *m_process << "--";
+    QHash<AudioDataSource*, Analysis> analyses;
+    qint64 totalSize;
+    qint64 processedSize;
 
-    // add the files
-    for( int i = 0; i < m_files.count(); ++i )
-        *m_process << m_files[i];
+    // protects nextGroup, analyses and processedSize
+    QMutex mutex;
+};
 
-    // now start the process
-    if( !m_process->start( KProcess::OnlyStderrChannel ) ) {
-        // something went wrong when starting the program
-        // it "should" be the executable
-        qDebug() << "(K3b::AudioNormalizeJob) could not start normalize";
-        emit infoMessage( i18n("Could not start normalize."), K3b::Job::MessageError );
-        jobFinished(false);
+
+bool K3b::AudioNormalizeJob::Private::analyse( AudioDataSource* source, Analysis& analysis, AudioNormalizeJob* job )
+{
+    QScopedPointer<QIODevice> reader( source->createReader() );
+    if( !reader->open( QIODevice::ReadOnly ) || !reader->seek( 0 ) ) {
+        qDebug() << "(K3b::AudioNormalizeJob) cannot open source reader.";
+        return false;
     }
+
+    LoudnessAnalyzer analyzer;
+    char buffer[2352*10];
+    qint64 read = 0;
+    while( reader->pos() < reader->size() &&
+           (read = reader->read( buffer, sizeof(buffer) )) > 0 ) {
+        analyzer.update( buffer, read );
+
+        if( job->canceled() )
+            return false;
+
+        int p = 0;
+        {
+            QMutexLocker locker( &mutex );
+            processedSize += read;
+            p = 100LL*processedSize/qMax<qint64>( 1, totalSize );
+        }
+        emit job->percent( p );
+    }
+
+    if( reader->pos() < reader->size() ) {
+        qDebug() << "(K3b::AudioNormalizeJob) read error at" << reader->pos() << "of" << reader->size();
+        return false;
+    }
+
+    analysis.blocks = analyzer.blocks();
+    analysis.peak = analyzer.peak();
+    return true;
 }
 
 
-void K3b::AudioNormalizeJob::cancel()
+K3b::AudioNormalizeJob::AudioNormalizeJob( AudioDoc* doc, K3b::JobHandler* hdl, QObject* parent )
+    : K3b::ThreadJob( hdl, parent ),
+      d( new Private() )
 {
-    m_canceled = true;
+    d->doc = doc;
+}
 
-    if( m_process )
-        if( m_process->isRunning() ) {
-            m_process->kill();
-        }
+
+K3b::AudioNormalizeJob::~AudioNormalizeJob()
+{
+    delete d;
 }
 
 
-void K3b::AudioNormalizeJob::slotStdLine( const QString& line )
+QList<double> K3b::AudioNormalizeJob::gains() const
 {
-    // percent, subPercent, newTask (compute level and adjust)
+    return d->gains;
+}
 
-    //  emit newSubTask( i18n("Normalizing track %1 of %2 (%3)",t,tt,m_files.at(t-1)) );
 
-    emit debuggingOutput( "normalize", line );
+bool K3b::AudioNormalizeJob::run()
+{
+    d->gains.clear();
+    d->groups.clear();
+    d->analyses.clear();
+    d->nextGroup = 0;
+    d->totalSize = 0;
+    d->processedSize = 0;
+
+    //
+    // Collect the sources which have to be decoded. Audio files sharing a decoder
+    // (for example the tracks of a cue file) go into one group, all tracks of
+    // audio CDs into another since reading them in parallel would only make the
+    // drive seek.
+    //
+    QHash<AudioDecoder*, int> decoderGroups;
+    int cdGroup = -1;
+    for( AudioTrack* track = d->doc->firstTrack(); track != 0; track = track->next() ) {
+        for( AudioDataSource* source = track->firstSource(); source != 0; source = source->next() ) {
+            if( dynamic_cast<AudioZeroData*>( source ) ) {
+                // silence does not count for the loudness
+                d->analyses[source].success = true;
+                continue;
+            }
 
-    // wenn "% done" drin:
-    //    wenn ein --% drin ist, so beginnt ein neuer track
-    //    sonst prozent parsen "batch xxx" ist der fortschritt der action
-    //                         also ev. den batch fortschritt * 1/2
+            int group = -1;
+            if( AudioFile* file = dynamic_cast<AudioFile*>( source ) ) {
+                Analysis analysis;
+                if( lookupAnalysis( file, analysis ) ) {
+                    d->analyses[source] = analysis;
+                    continue;
+                }
+                group = decoderGroups.value( file->decoder(), -1 );
+                if( group < 0 ) {
+                    group = d->groups.count();
+                    decoderGroups.insert( file->decoder(), group );
+                }
+            }
+            else if( dynamic_cast<AudioCdTrackSource*>( source ) ) {
+                if( cdGroup < 0 )
+                    cdGroup = d->groups.count();
+                group = cdGroup;
+            }
 
-    if( line.startsWith( "Applying adjustment" ) ) {
-        if( m_currentAction == COMPUTING_LEVELS ) {
-            // starting the adjustment with track 1
-            m_currentTrack = 1;
-            m_currentAction = ADJUSTING_LEVELS;
+            if( group < 0 || group == d->groups.count() )
+                d->groups.append( QList<AudioDataSource*>() );
+            d->groups[group < 0 ? d->groups.count()-1 : group].append( source );
+            d->totalSize += source->length().audioBytes();
         }
     }
 
-    else if( line.contains( "already normalized" ) ) {
-        // no normalization necessary for the current track
-        emit infoMessage( i18n("Track %1 is already normalized.",m_currentTrack), MessageInfo );
-        m_currentTrack++;
+    emit newSubTask( i18n("Analyzing the loudness of the tracks") );
+
+    const int numWorkers = qMin( d->groups.count(), qMax( 1, QThread::idealThreadCount() ) );
+    QList<QThread*> workers;
+    for( int i = 0; i < numWorkers; ++i ) {
+        QThread* thread = QThread::create( [this]() { runAnalysisWorker(); } );
+        workers.append( thread );
+        thread->start();
+    }
+    Q_FOREACH( QThread* thread, workers ) {
+        thread->wait();
+        delete thread;
     }
 
-    else if( line.contains( "--% done") ) {
-        if( m_currentAction == ADJUSTING_LEVELS ) {
-            emit newTask( i18n("Adjusting volume level for track %1 of %2",m_currentTrack,m_files.count()) );
-            qDebug() << "(K3b::AudioNormalizeJob) adjusting level for track "
-                     << m_currentTrack
-                     << " "
-                     << m_files.at(m_currentTrack-1)
-                     << Qt::endl;
-        }
-        else {
-            emit newTask( i18n("Computing level for track %1 of %2",m_currentTrack,m_files.count()) );
-            qDebug() << "(K3b::AudioNormalizeJob) computing level for track "
-                     << m_currentTrack
-                     << " "
-                     << m_files.at(m_currentTrack-1)
-                     << Qt::endl;
+    if( canceled() )
+        return false;
+
+    //
+    // The loudness of a track is measured over all of its sources
+    //
+    for( AudioTrack* track = d->doc->firstTrack(); track != 0; track = track->next() ) {
+        QVector<float> blocks;
+        float peak = 0;
+        for( AudioDataSource* source = track->firstSource(); source != 0; source = source->next() ) {
+            const Analysis& analysis = d->analyses[source];
+            if( !analysis.success ) {
+                emit infoMessage( i18n("Error while analyzing track %1.", track->trackNumber()), MessageError );
+                return false;
+            }
+            blocks += analysis.blocks;
+            peak = qMax( peak, analysis.peak );
         }
 
-        m_currentTrack++;
+        const double loudness = LoudnessAnalyzer::integratedLoudness( blocks );
+        const double gain = LoudnessAnalyzer::gain( loudness, peak );
+        qDebug() << "(K3b::AudioNormalizeJob) track" << track->trackNumber()
+                 << "loudness:" << loudness << "LUFS peak:" << peak << "gain:" << gain << "dB";
+        d->gains.append( gain );
     }
 
-    else if( int pos = line.indexOf( "% done" ) > 0 ) {
-        // parse progress: "XXX% done" and "batch XXX% done"
-        pos -= 3;
-        bool ok;
-        // TODO: do not use fixed values
-        // track progress starts at position 19 in version 0.7.6
-        int p = line.mid( 19, 3 ).toInt(&ok);
-        if( ok )
-            emit subPercent( p );
-        else
-            qDebug() << "(K3b::AudioNormalizeJob) subPercent parsing error at pos "
-                     << 19 << " in line '" << line.mid( 19, 3 ) << "'" << Qt::endl;
-
-        // batch progress starts at position 50 in version 0.7.6
-        p = line.mid( 50, 3 ).toInt(&ok);
-        if( ok && m_currentAction == COMPUTING_LEVELS )
-            emit percent( (int)((double)p/2.0) );
-        else if( ok && m_currentAction == ADJUSTING_LEVELS )
-            emit percent( 50 + (int)((double)p/2.0) );
-        else
-            qDebug() << "(K3b::AudioNormalizeJob) percent parsing error at pos "
-                     << 50 << " in line '" << line.mid( 50, 3 ) << "'" << Qt::endl;
-
-    }
+    emit infoMessage( i18n("Successfully analyzed the loudness of all tracks."), MessageSuccess );
+    return true;
 }
 
 
-void K3b::AudioNormalizeJob::slotProcessExited( int exitCode, QProcess::ExitStatus exitStatus )
+void K3b::AudioNormalizeJob::runAnalysisWorker()
 {
-    if( exitStatus == QProcess::NormalExit ) {
-        switch( exitCode ) {
-        case 0:
-            emit infoMessage( i18n("Successfully normalized all tracks."), MessageSuccess );
-            jobFinished(true);
-            break;
-        default:
-            if( !m_canceled ) {
-                emit infoMessage( i18n("%1 returned an unknown error (code %2).",QString("normalize"), exitCode),
-                                  K3b::Job::MessageError );
-                emit infoMessage( i18n("Please send me an email with the last output."), K3b::Job::MessageError );
-                emit infoMessage( i18n("Error while normalizing tracks."), MessageError );
+    forever {
+        QList<AudioDataSource*> group;
+        {
+            QMutexLocker locker( &d->mutex );
+            if( canceled() || d->nextGroup >= d->groups.count() )
+                return;
+            group = d->groups[d->nextGroup++];
+        }
+
+        Q_FOREACH( AudioDataSource* source, group ) {
+            Analysis analysis;
+            analysis.success = d->analyse( source, analysis, this );
+            if( analysis.success ) {
+                if( AudioFile* file = dynamic_cast<AudioFile*>( source ) )
+                    storeAnalysis( file, analysis );
             }
-            else
-                emit canceled();
-            jobFinished(false);
-            break;
+
+            QMutexLocker locker( &d->mutex );
+            d->analyses[source] = analysis;
         }
     }
-    else {
-        emit infoMessage( i18n("%1 did not exit cleanly.",QString("Normalize")), K3b::Job::MessageError );
-        jobFinished( false );
-    }
 }
-
-
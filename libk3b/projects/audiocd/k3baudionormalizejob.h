@@ -8,45 +8,43 @@
 #define _K3B_AUDIO_NORMALIZE_JOB_H_
 
 
-#include "k3bjob.h"
+#include "k3bthreadjob.h"
 
 #include <QList>
-#include <QProcess>
 
 namespace K3b {
-    class Process;
-
-    class AudioNormalizeJob : public Job
+    class AudioDoc;
+
+    /**
+     * Measures the loudness of all tracks of an audio project and
+     * calculates the gain which normalizes them to
+     * LoudnessAnalyzer::TARGET_LOUDNESS.
+     *
+     * The sources are decoded in parallel as far as they do not share
+     * a decoder. The loudness of audio files is cached so analysing
+     * the same project again is cheap. The data itself is not changed,
+     * the gains are applied by the AudioImager while decoding.
+     */
+    class AudioNormalizeJob : public ThreadJob
     {
         Q_OBJECT
 
     public:
-        explicit AudioNormalizeJob( JobHandler*, QObject* parent = 0 );
+        AudioNormalizeJob( AudioDoc* doc, JobHandler*, QObject* parent = 0 );
         ~AudioNormalizeJob() override;
 
-    public Q_SLOTS:
-        void start() override;
-        void cancel() override;
-
-        void setFilesToNormalize( const QList<QString>& files ) { m_files = files; }
-
-    private Q_SLOTS:
-        void slotStdLine( const QString& line );
-        void slotProcessExited( int exitCode, QProcess::ExitStatus exitStatus );
+        /**
+         * The gain in dB for every track in track order.
+         * Only valid if the job finished successfully.
+         */
+        QList<double> gains() const;
 
     private:
-        Process* m_process;
-
-        QList<QString> m_files;
-        bool m_canceled;
-
-        enum Action {
-            COMPUTING_LEVELS,
-            ADJUSTING_LEVELS
-        };
+        bool run() override;
+        void runAnalysisWorker();
 
-        int m_currentAction;
-        int m_currentTrack;
+        class Private;
+        Private* const d;
     };
 }
 
@@ -0,0 +1,225 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3baudiothroughputprofile.h"
+#include "k3baudiofile.h"
+#include "k3brawaudiodatasource.h"
+#include "k3baudiodecoder.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+
+namespace {
+    const quint32 PROFILE_MAGIC = 0x4B335450; // "K3TP"
+    const quint32 PROFILE_VERSION = 1;
+
+    // the weight of the earlier measurements is limited to let the profile
+    // follow changes of the system
+    const int MAX_WEIGHT = 4;
+
+    // the highest speed we ever report, 1000x
+    const int MAX_SPEED = 175*1000;
+
+    bool sustainable( const QList<K3b::AudioThroughputProfile::Segment>& segments,
+                      qint64 prefilled, qint64 bufferSize, int speed )
+    {
+        const double rate = speed*1024.0;
+        double level = prefilled;
+
+        Q_FOREACH( const K3b::AudioThroughputProfile::Segment& segment, segments ) {
+            // the writer keeps going while we seek
+            level -= rate*segment.startupTime/1000.0;
+            if( level < 0 )
+                return false;
+
+            if( segment.throughput <= 0 ) {
+                level += segment.bytes;
+            }
+            else {
+                // for slow sources the level drops until the end of the segment
+                const double time = double( segment.bytes )/double( segment.throughput );
+                level += segment.bytes - rate*time;
+                if( level < 0 )
+                    return false;
+            }
+
+            // decoding blocks once the buffers are full
+            level = qMin( level, double( bufferSize ) );
+        }
+
+        return true;
+    }
+}
+
+
+class K3b::AudioThroughputProfile::Private
+{
+public:
+    QString fileName;
+    QHash<QString, Entry> entries;
+    mutable QMutex mutex;
+};
+
+
+K3b::AudioThroughputProfile::AudioThroughputProfile( const QString& filename )
+    : d( new Private() )
+{
+    d->fileName = filename;
+
+    QFile file( filename );
+    if( !file.open( QIODevice::ReadOnly ) )
+        return;
+
+    QDataStream s( &file );
+    s.setVersion( QDataStream::Qt_5_0 );
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 count = 0;
+    s >> magic >> version >> count;
+    if( magic != PROFILE_MAGIC || version != PROFILE_VERSION ) {
+        qDebug() << "(K3b::AudioThroughputProfile) ignoring" << filename;
+        return;
+    }
+
+    QHash<QString, Entry> entries;
+    for( int i = 0; i < count && s.status() == QDataStream::Ok; ++i ) {
+        QString key;
+        Entry entry;
+        s >> key >> entry.throughput >> entry.startupTime >> entry.measurements >> entry.lastMeasurement;
+        entries.insert( key, entry );
+    }
+
+    if( s.status() == QDataStream::Ok )
+        d->entries = entries;
+    else
+        qDebug() << "(K3b::AudioThroughputProfile) broken profile" << filename;
+}
+
+
+K3b::AudioThroughputProfile::~AudioThroughputProfile()
+{
+    delete d;
+}
+
+
+K3b::AudioThroughputProfile* K3b::AudioThroughputProfile::instance()
+{
+    static AudioThroughputProfile s_profile( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) + "/audiothroughput" );
+    return &s_profile;
+}
+
+
+QString K3b::AudioThroughputProfile::fileName() const
+{
+    return d->fileName;
+}
+
+
+QString K3b::AudioThroughputProfile::key( AudioDataSource* source )
+{
+    if( AudioFile* file = dynamic_cast<AudioFile*>( source ) ) {
+        const AudioDecoder* decoder = file->decoder();
+        return QString( "%1/%2/%3" )
+            .arg( QString::fromLatin1( decoder->metaObject()->className() ) )
+            .arg( decoder->samplerate() )
+            .arg( decoder->channels() );
+    }
+    else if( dynamic_cast<RawAudioDataSource*>( source ) ) {
+        return QLatin1String( "raw" );
+    }
+    else {
+        return QString();
+    }
+}
+
+
+bool K3b::AudioThroughputProfile::lookup( const QString& key, Entry& entry ) const
+{
+    QMutexLocker locker( &d->mutex );
+    QHash<QString, Entry>::const_iterator it = d->entries.constFind( key );
+    if( it == d->entries.constEnd() )
+        return false;
+    entry = *it;
+    return true;
+}
+
+
+bool K3b::AudioThroughputProfile::needsMeasurement( const QString& key ) const
+{
+    Entry entry;
+    return( !lookup( key, entry ) ||
+            !entry.lastMeasurement.isValid() ||
+            entry.lastMeasurement.daysTo( QDateTime::currentDateTime() ) > MAX_AGE );
+}
+
+
+void K3b::AudioThroughputProfile::addMeasurement( const QString& key, qint64 throughput, int startupTime )
+{
+    QMutexLocker locker( &d->mutex );
+    Entry& entry = d->entries[key];
+
+    const int weight = qMin( entry.measurements, MAX_WEIGHT );
+    entry.throughput = ( entry.throughput*weight + throughput )/( weight + 1 );
+    entry.startupTime = ( entry.startupTime*weight + startupTime )/( weight + 1 );
+    ++entry.measurements;
+    entry.lastMeasurement = QDateTime::currentDateTime();
+}
+
+
+bool K3b::AudioThroughputProfile::save() const
+{
+    if( !QDir().mkpath( QFileInfo( d->fileName ).absolutePath() ) ) {
+        qDebug() << "(K3b::AudioThroughputProfile) unable to create the folder of" << d->fileName;
+        return false;
+    }
+
+    QSaveFile file( d->fileName );
+    if( !file.open( QIODevice::WriteOnly ) ) {
+        qDebug() << "(K3b::AudioThroughputProfile) could not open" << d->fileName;
+        return false;
+    }
+
+    QDataStream s( &file );
+    s.setVersion( QDataStream::Qt_5_0 );
+
+    QMutexLocker locker( &d->mutex );
+    s << PROFILE_MAGIC << PROFILE_VERSION << qint32( d->entries.count() );
+    for( QHash<QString, Entry>::const_iterator it = d->entries.constBegin();
+         it != d->entries.constEnd(); ++it ) {
+        s << it.key() << it->throughput << it->startupTime << it->measurements << it->lastMeasurement;
+    }
+
+    return( s.status() == QDataStream::Ok && file.commit() );
+}
+
+
+int K3b::AudioThroughputProfile::maxSpeed( const QList<Segment>& segments, qint64 prefilled, qint64 bufferSize )
+{
+    if( !sustainable( segments, prefilled, bufferSize, 1 ) )
+        return 0;
+
+    // the highest sustainable speed in KB/s
+    int low = 1;
+    int high = MAX_SPEED;
+    while( low < high ) {
+        const int speed = low + ( high - low + 1 )/2;
+        if( sustainable( segments, prefilled, bufferSize, speed ) )
+            low = speed;
+        else
+            high = speed - 1;
+    }
+
+    return low;
+}
@@ -0,0 +1,135 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_AUDIO_THROUGHPUT_PROFILE_H_
+#define _K3B_AUDIO_THROUGHPUT_PROFILE_H_
+
+#include "k3b_export.h"
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+
+
+namespace K3b {
+    class AudioDataSource;
+
+    /**
+     * Remembers how fast audio sources can be decoded on this system.
+     *
+     * Files are decoded at very different speeds depending on the decoder,
+     * the samplerate (resampling) and the number of channels. Thus the
+     * throughput is stored per combination of the three and shared by all
+     * files which match it. The profile is stored in the user's cache
+     * folder, so a combination only has to be measured once in a while.
+     *
+     * The profile is used to predict the writing speed which can be
+     * sustained when writing an audio project on-the-fly.
+     */
+    class LIBK3B_EXPORT AudioThroughputProfile
+    {
+    public:
+        struct Entry {
+            Entry() : throughput( 0 ), startupTime( 0 ), measurements( 0 ) {}
+
+            /**
+             * Decoded CD audio in bytes per second.
+             */
+            qint64 throughput;
+
+            /**
+             * Milliseconds from opening a source until its first data
+             * has been decoded, including the seek to its start offset.
+             */
+            int startupTime;
+
+            int measurements;
+            QDateTime lastMeasurement;
+        };
+
+        /**
+         * A source as it is decoded when writing.
+         */
+        struct Segment {
+            Segment( qint64 b = 0, qint64 t = 0, int s = 0 )
+                : bytes( b ), throughput( t ), startupTime( s ) {}
+
+            qint64 bytes;
+
+            /**
+             * 0 if the source is available at any speed like silence.
+             */
+            qint64 throughput;
+
+            int startupTime;
+        };
+
+        /**
+         * Measurements older than this many days are repeated.
+         */
+        static const int MAX_AGE = 30;
+
+        /**
+         * Reads the profile from \p filename if it exists.
+         */
+        explicit AudioThroughputProfile( const QString& filename );
+        ~AudioThroughputProfile();
+
+        /**
+         * The profile in the user's cache folder.
+         */
+        static AudioThroughputProfile* instance();
+
+        QString fileName() const;
+
+        /**
+         * \return The key under which the throughput of \p source is stored
+         *         or an empty string for sources which are not profiled like
+         *         silence or tracks on an audio CD.
+         */
+        static QString key( AudioDataSource* source );
+
+        bool lookup( const QString& key, Entry& entry ) const;
+
+        /**
+         * \return true if there is no entry for \p key or it is too old.
+         */
+        bool needsMeasurement( const QString& key ) const;
+
+        /**
+         * Adds a measurement to the entry of \p key. Earlier measurements are
+         * taken into account to even out measurements on a busy system.
+         */
+        void addMeasurement( const QString& key, qint64 throughput, int startupTime );
+
+        bool save() const;
+
+        /**
+         * Predicts the highest writing speed at which the data of \p segments
+         * is decoded fast enough.
+         *
+         * While the writer waits for a seek or a slow decoder it lives on the
+         * data buffered so far. Sources which are decoded faster than they are
+         * written fill the buffers again.
+         *
+         * \param prefilled The amount of data buffered when writing starts,
+         *        usually the fifo of the writing application.
+         * \param bufferSize The amount of data which can be buffered at most,
+         *        including a read-ahead buffer.
+         *
+         * \return The speed in KB/s.
+         */
+        static int maxSpeed( const QList<Segment>& segments, qint64 prefilled, qint64 bufferSize );
+
+    private:
+        class Private;
+        Private* const d;
+
+        Q_DISABLE_COPY( AudioThroughputProfile )
+    };
+}
+
+#endif
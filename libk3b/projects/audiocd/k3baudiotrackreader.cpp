@@ -9,11 +9,14 @@
 #include "k3baudiotrackreader.h"
 #include "k3baudiodatasource.h"
 #include "k3baudiotrack.h"
+#include "k3bsampleconversion.h"
 
 #include <QList>
 #include <QMutex>
 #include <QMutexLocker>
 
+#include <cmath>
+
 namespace K3b {
 
 namespace {
@@ -31,6 +34,8 @@ public:
     AudioTrack& track;
     IODevices readers;
     int current;
+    double gain;
+    float gainFactor;
 
     // used to make sure that no seek and read operation occur in parallel
     QMutex mutex;
@@ -41,7 +46,9 @@ AudioTrackReader::Private::Private( AudioTrackReader& audioTrackReader, AudioTra
 :
     q( audioTrackReader ),
     track( t ),
-    current( -1 )
+    current( -1 ),
+    gain( 0.0 ),
+    gainFactor( 1.0f )
 {
 }
 
@@ -107,6 +114,20 @@ AudioTrack& AudioTrackReader::track()
 }
 
 
+void AudioTrackReader::setGain( double gain )
+{
+    QMutexLocker locker( &d->mutex );
+    d->gain = gain;
+    d->gainFactor = std::pow( 10.0, gain/20.0 );
+}
+
+
+double AudioTrackReader::gain() const
+{
+    return d->gain;
+}
+
+
 bool AudioTrackReader::open( QIODevice::OpenMode mode )
 {
     if( !mode.testFlag( QIODevice::WriteOnly ) && d->readers.empty() && d->track.numberSources() > 0 ) {
@@ -190,6 +211,8 @@ qint64 AudioTrackReader::readData( char* data, qint64 maxlen )
         qint64 readData = d->readers.at( d->current )->read( data, maxlen );
 
         if( readData >= 0 ) {
+            if( d->gain != 0.0 )
+                SampleConversion::applyGain16BitBe( data, readData/2, d->gainFactor );
             return readData;
         }
         else {
@@ -28,6 +28,13 @@ namespace K3b {
         const AudioTrack& track() const;
         AudioTrack& track();
 
+        /**
+         * A gain in dB which is applied to the data of the track, for
+         * example to normalize its loudness. Defaults to 0.
+         */
+        void setGain( double gain );
+        double gain() const;
+
         bool open( OpenMode mode = QIODevice::ReadOnly ) override;
         void close() override;
         bool isSequential() const override;
@@ -0,0 +1,288 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3baudiowaveformloader.h"
+#include "k3baudiotrack.h"
+#include "k3baudiodatasource.h"
+#include "k3baudiofile.h"
+#include "k3brawaudiodatasource.h"
+#include "k3baudiodecoder.h"
+#include "k3baudiodecodercache.h"
+#include "k3bwaveformpeaks.h"
+
+#include <QAtomicInt>
+#include <QDebug>
+#include <QHash>
+#include <QIODevice>
+#include <QStandardPaths>
+#include <QThread>
+#include <QUrl>
+
+
+namespace {
+    /**
+     * One source of the track
+     */
+    struct Part
+    {
+        Part()
+            : reader( 0 ),
+              first( 0 ),
+              count( 0 ) {
+        }
+
+        // set for audio files
+        QString filename;
+
+        // set for raw audio files
+        QIODevice* reader;
+
+        // the sectors of the source. Other sources are silence.
+        int first;
+        int count;
+    };
+
+    K3b::AudioDecoderCache* waveformCache()
+    {
+        static K3b::AudioDecoderCache s_cache( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) + "/waveform" );
+        return &s_cache;
+    }
+}
+
+
+class K3b::AudioWaveformLoader::Private
+{
+public:
+    Private()
+        : thread( 0 ),
+          generation( 0 ),
+          success( false ) {
+    }
+
+    QList<Part> parts;
+
+    // the peaks of the files by filename, either from the cache or decoded
+    QHash<QString, WaveformPeaks> files;
+
+    // the files which need to be decoded and the name of the decoder
+    // the project uses for the cache
+    QHash<QString, AudioDecoder*> decoders;
+    QHash<QString, QString> decoderNames;
+
+    WaveformPeaks peaks;
+
+    QThread* thread;
+    int generation;
+    QAtomicInt canceled;
+    bool success;
+};
+
+
+K3b::AudioWaveformLoader::AudioWaveformLoader( QObject* parent )
+    : QObject( parent ),
+      d( new Private() )
+{
+}
+
+
+K3b::AudioWaveformLoader::~AudioWaveformLoader()
+{
+    cancel();
+    delete d;
+}
+
+
+void K3b::AudioWaveformLoader::load( AudioTrack* track )
+{
+    cancel();
+
+    d->canceled = 0;
+    d->success = false;
+    d->peaks.clear();
+
+    for( AudioDataSource* source = track->firstSource(); source != 0; source = source->next() ) {
+        Part part;
+        part.count = source->length().lba();
+
+        if( AudioFile* file = dynamic_cast<AudioFile*>( source ) ) {
+            part.filename = file->filename();
+            part.first = file->startOffset().lba();
+
+            const QString decoderName = QString::fromLatin1( file->decoder()->metaObject()->className() );
+            if( !d->files.contains( part.filename ) && !d->decoders.contains( part.filename ) ) {
+                AudioDecoderCache::Entry entry;
+                WaveformPeaks peaks;
+                if( waveformCache()->lookup( decoderName, part.filename, entry ) &&
+                    peaks.fromByteArray( entry.decoderData ) ) {
+                    d->files.insert( part.filename, peaks );
+                }
+                else if( AudioDecoder* decoder = AudioDecoderFactory::createDecoder( QUrl::fromLocalFile( part.filename ) ) ) {
+                    // the project's decoder may be in use, thus we decode with our own
+                    decoder->setFilename( part.filename );
+                    d->decoders.insert( part.filename, decoder );
+                    d->decoderNames.insert( part.filename, decoderName );
+                }
+            }
+        }
+        else if( dynamic_cast<RawAudioDataSource*>( source ) ) {
+            part.reader = source->createReader();
+            if( !part.reader->open( QIODevice::ReadOnly ) ) {
+                delete part.reader;
+                part.reader = 0;
+            }
+        }
+
+        d->parts.append( part );
+    }
+
+    const int generation = ++d->generation;
+    d->thread = QThread::create( [this, generation]() {
+        run();
+        QMetaObject::invokeMethod( this, "slotWorkerFinished", Qt::QueuedConnection, Q_ARG( int, generation ) );
+    } );
+    d->thread->start();
+}
+
+
+void K3b::AudioWaveformLoader::cancel()
+{
+    d->canceled = 1;
+    cleanup();
+}
+
+
+bool K3b::AudioWaveformLoader::isRunning() const
+{
+    return d->thread != 0;
+}
+
+
+K3b::WaveformPeaks K3b::AudioWaveformLoader::peaks() const
+{
+    return d->peaks;
+}
+
+
+void K3b::AudioWaveformLoader::run()
+{
+    // the length of the files is known once they have been analysed
+    QHash<QString, bool> analysed;
+    qint64 totalSize = 0;
+    for( QHash<QString, AudioDecoder*>::const_iterator it = d->decoders.constBegin(); it != d->decoders.constEnd(); ++it ) {
+        analysed[it.key()] = it.value()->analyseFile();
+        totalSize += it.value()->length().audioBytes();
+        if( d->canceled )
+            return;
+    }
+    Q_FOREACH( const Part& part, d->parts ) {
+        if( part.reader )
+            totalSize += part.reader->size();
+    }
+
+    qint64 processed = 0;
+    int lastPercent = -1;
+    char buffer[2352*10];
+
+    //
+    // Decode the files completely, each one only once
+    //
+    for( QHash<QString, AudioDecoder*>::const_iterator it = d->decoders.constBegin(); it != d->decoders.constEnd(); ++it ) {
+        AudioDecoder* decoder = it.value();
+        WaveformPeaks peaks;
+        int read = -1;
+        if( analysed[it.key()] ) {
+            while( !d->canceled && (read = decoder->decode( buffer, sizeof(buffer) )) > 0 ) {
+                peaks.update( buffer, read );
+
+                processed += read;
+                const int p = 100LL*processed/qMax<qint64>( 1, totalSize );
+                if( p != lastPercent ) {
+                    lastPercent = p;
+                    emit percent( p );
+                }
+            }
+        }
+
+        if( d->canceled )
+            return;
+
+        peaks.finish();
+        if( read == 0 ) {
+            AudioDecoderCache::Entry entry;
+            entry.length = decoder->length();
+            entry.samplerate = 44100;
+            entry.channels = 2;
+            entry.decoderData = peaks.toByteArray();
+            if( !waveformCache()->store( d->decoderNames[it.key()], it.key(), entry ) )
+                qDebug() << "(K3b::AudioWaveformLoader) could not cache the peaks of" << it.key();
+        }
+        else {
+            // show what we got so far
+            qDebug() << "(K3b::AudioWaveformLoader) failed to decode" << it.key();
+        }
+
+        d->files.insert( it.key(), peaks );
+    }
+
+    //
+    // Put the track together
+    //
+    Q_FOREACH( const Part& part, d->parts ) {
+        if( !part.filename.isEmpty() ) {
+            d->peaks.append( d->files.value( part.filename ), part.first, part.count );
+        }
+        else if( part.reader && part.reader->seek( 0 ) ) {
+            WaveformPeaks peaks;
+            qint64 read = 0;
+            while( !d->canceled && (read = part.reader->read( buffer, sizeof(buffer) )) > 0 ) {
+                peaks.update( buffer, read );
+                processed += read;
+                emit percent( 100LL*processed/qMax<qint64>( 1, totalSize ) );
+            }
+            peaks.finish();
+            d->peaks.append( peaks, 0, part.count );
+        }
+        else {
+            d->peaks.appendSilence( part.count );
+        }
+
+        if( d->canceled )
+            return;
+    }
+
+    d->peaks.finish();
+    d->success = true;
+}
+
+
+void K3b::AudioWaveformLoader::slotWorkerFinished( int generation )
+{
+    // a load which has been canceled in the meantime
+    if( generation != d->generation || !d->thread )
+        return;
+
+    cleanup();
+    emit finished( d->success );
+}
+
+
+void K3b::AudioWaveformLoader::cleanup()
+{
+    if( d->thread ) {
+        d->thread->wait();
+        delete d->thread;
+        d->thread = 0;
+    }
+
+    qDeleteAll( d->decoders );
+    d->decoders.clear();
+    d->decoderNames.clear();
+    d->files.clear();
+
+    Q_FOREACH( const Part& part, d->parts )
+        delete part.reader;
+    d->parts.clear();
+}
@@ -0,0 +1,74 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_AUDIO_WAVEFORM_LOADER_H_
+#define _K3B_AUDIO_WAVEFORM_LOADER_H_
+
+#include "k3b_export.h"
+
+#include <QObject>
+
+namespace K3b {
+    class AudioTrack;
+    class WaveformPeaks;
+
+    /**
+     * Calculates the WaveformPeaks of an audio track in a background thread.
+     *
+     * Audio files are decoded with decoders of their own, so the project
+     * can be used meanwhile. The peaks of every file are cached on disk,
+     * loading the same file again only reads the cache. Sources from audio
+     * CDs are shown as silence since reading them would keep the drive busy.
+     */
+    class LIBK3B_EXPORT AudioWaveformLoader : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit AudioWaveformLoader( QObject* parent = 0 );
+
+        /**
+         * Cancels loading.
+         */
+        ~AudioWaveformLoader() override;
+
+        /**
+         * Start loading the peaks of \p track. The sources of the track are
+         * read right away, changes to the track afterwards are not taken
+         * into account. A running load is canceled.
+         */
+        void load( AudioTrack* track );
+
+        /**
+         * Stops loading without emitting finished().
+         */
+        void cancel();
+
+        bool isRunning() const;
+
+        /**
+         * The peaks of the track, one sector per sector of the track.
+         * Only valid once finished() has been emitted with success.
+         */
+        WaveformPeaks peaks() const;
+
+    Q_SIGNALS:
+        void percent( int );
+        void finished( bool success );
+
+    private Q_SLOTS:
+        void slotWorkerFinished( int generation );
+
+    private:
+        void run();
+        void cleanup();
+
+        class Private;
+        Private* const d;
+    };
+}
+
+#endif
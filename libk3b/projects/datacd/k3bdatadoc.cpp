@@ -38,9 +38,14 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QStringList>
+#include <QAtomicInt>
+#include <QThread>
 #include <QTimer>
 #include <QApplication>
 #include <QDomElement>
+#include <QVector>
+
+#include <algorithm>
 
 #include <string.h>
 #include <stdlib.h>
@@ -56,6 +61,8 @@ public:
         root( 0 ),
         dataMode( 0 ),
         verifyData( false ),
+        stopVerifyingOnFirstDifference( false ),
+        saveChecksums( false ),
         importedSession( -1 ),
         bootCataloge( 0 ),
         bExistingItemsReplaceAll( false ),
@@ -85,6 +92,8 @@ public:
     int dataMode;
 
     bool verifyData;
+    bool stopVerifyingOnFirstDifference;
+    bool saveChecksums;
 
     IsoOptions isoOptions;
 
@@ -101,9 +110,54 @@ public:
 
     bool needToCutFilenames;
     QList<DataItem*> needToCutFilenameItems;
+
+    // reverse lookup of the local files in the project
+    QMultiHash<QString, DataItem*> localPathIndex;
+    QMultiHash<FileItem::Id, FileItem*> localIdIndex;
+
+    void addToLocalIndex( DataItem* item );
+    void removeFromLocalIndex( DataItem* item );
 };
 
 
+void K3b::DataDoc::Private::addToLocalIndex( DataItem* item )
+{
+    const QString path = item->localPath();
+    if( !path.isEmpty() )
+        localPathIndex.insert( QDir::cleanPath( path ), item );
+
+    if( item->isFile() ) {
+        FileItem* fileItem = static_cast<FileItem*>( item );
+        const FileItem::Id id = fileItem->localId( false );
+        if( id.inode != 0 || id.device != 0 )
+            localIdIndex.insert( id, fileItem );
+    }
+    else if( item->isDir() ) {
+        Q_FOREACH( DataItem* child, static_cast<DirItem*>( item )->children() ) {
+            addToLocalIndex( child );
+        }
+    }
+}
+
+
+void K3b::DataDoc::Private::removeFromLocalIndex( DataItem* item )
+{
+    const QString path = item->localPath();
+    if( !path.isEmpty() )
+        localPathIndex.remove( QDir::cleanPath( path ), item );
+
+    if( item->isFile() ) {
+        FileItem* fileItem = static_cast<FileItem*>( item );
+        localIdIndex.remove( fileItem->localId( false ), fileItem );
+    }
+    else if( item->isDir() ) {
+        Q_FOREACH( DataItem* child, static_cast<DirItem*>( item )->children() ) {
+            removeFromLocalIndex( child );
+        }
+    }
+}
+
+
 /**
  * There are two ways to fill a data project with files and folders:
  * \li Use the addUrl and addUrlsT methods
@@ -151,6 +205,8 @@ void K3b::DataDoc::clear()
             removeItem( d->root->children().first() );
     }
     d->sizeHandler->clear();
+    d->localPathIndex.clear();
+    d->localIdIndex.clear();
     emit importedSessionChanged( importedSession() );
 }
 
@@ -505,8 +561,13 @@ bool K3b::DataDoc::loadDocumentDataOptions( QDomElement elem )
                 setMultiSessionMode( AUTO );
         }
 
-        else if( e.nodeName() == "verify_data" )
+        else if( e.nodeName() == "verify_data" ) {
             setVerifyData( e.attributeNode( "activated" ).value() == "yes" );
+            setStopVerifyingOnFirstDifference( e.attributeNode( "stop_on_difference" ).value() == "yes" );
+        }
+
+        else if( e.nodeName() == "save_checksums" )
+            setSaveChecksums( e.attributeNode( "activated" ).value() == "yes" );
 
         else
             qDebug() << "(K3b::DataDoc) unknown option entry: " << e.nodeName();
@@ -833,6 +894,11 @@ void K3b::DataDoc::saveDocumentDataOptions( QDomElement& optionsElem )
 
     topElem = doc.createElement( "verify_data" );
     topElem.setAttribute( "activated", verifyData() ? "yes" : "no" );
+    topElem.setAttribute( "stop_on_difference", stopVerifyingOnFirstDifference() ? "yes" : "no" );
+    optionsElem.appendChild( topElem );
+
+    topElem = doc.createElement( "save_checksums" );
+    topElem.setAttribute( "activated", saveChecksums() ? "yes" : "no" );
     optionsElem.appendChild( topElem );
     // ----------------------------------------------------------------------
 }
@@ -972,6 +1038,8 @@ void K3b::DataDoc::endInsertItems( DirItem* parent, int start, int end )
         // update the boot item list
         if( item->isBootItem() )
             d->bootImages.append( static_cast<K3b::BootItem*>( item ) );
+
+        d->addToLocalIndex( item );
     }
 
     emit itemsInserted( parent, start, end );
@@ -997,6 +1065,8 @@ void K3b::DataDoc::beginRemoveItems( DirItem* parent, int start, int end )
                 d->bootCataloge = 0;
             }
         }
+
+        d->removeFromLocalIndex( item );
     }
 }
 
@@ -1090,9 +1160,23 @@ QString K3b::DataDoc::treatWhitespace( const QString& path )
 }
 
 
+namespace {
+    struct WrittenNameItem
+    {
+        QString name;
+        K3b::DataItem* item;
+
+        bool operator<( const WrittenNameItem& other ) const { return name < other.name; }
+    };
+
+    // Projects with less files and directories in total are handled in one
+    // thread. Larger ones are split among the subdirectories of the root item.
+    const long s_parallelPrepareFilenamesThreshold = 10000;
+}
+
+
 void K3b::DataDoc::prepareFilenames()
 {
-    d->needToCutFilenames = false;
     d->needToCutFilenameItems.clear();
 
     //
@@ -1103,78 +1187,125 @@ void K3b::DataDoc::prepareFilenames()
     // it to mkisofs for now since handling all the options to alter the ISO9660 standard it just
     // too much.
     //
+    // The subdirectories of the root item do not depend on each other so they are
+    // handled in parallel for large projects.
+    //
+    const DirItem::Children& children = root()->children();
+    QVector<QList<DataItem*> > subDirCutItems( children.count() );
+    if( root()->numFiles() + root()->numDirs() > s_parallelPrepareFilenamesThreshold ) {
+        QAtomicInt nextChild( 0 );
+        auto worker = [&]() {
+            int i = 0;
+            while( ( i = nextChild.fetchAndAddRelaxed( 1 ) ) < children.count() ) {
+                if( children.at( i )->isDir() )
+                    prepareFilenamesInDir( static_cast<DirItem*>( children.at( i ) ), subDirCutItems[i] );
+            }
+        };
 
-    K3b::DataItem* item = root();
-    int maxlen = ( isoOptions().jolietLong() ? 103 : 64 );
-    while( (item = item->nextSibling()) ) {
-        item->setWrittenName( treatWhitespace( item->k3bName() ) );
-
-        if( isoOptions().createJoliet() && item->writtenName().length() > maxlen ) {
-            d->needToCutFilenames = true;
-            item->setWrittenName( K3b::cutFilename( item->writtenName(), maxlen ) );
-            d->needToCutFilenameItems.append( item );
+        QList<QThread*> threads;
+        for( int i = 1; i < QThread::idealThreadCount(); ++i ) {
+            QThread* thread = QThread::create( worker );
+            thread->start();
+            threads.append( thread );
+        }
+        worker();
+        Q_FOREACH( QThread* thread, threads ) {
+            thread->wait();
+            delete thread;
+        }
+    }
+    else {
+        for( int i = 0; i < children.count(); ++i ) {
+            if( children.at( i )->isDir() )
+                prepareFilenamesInDir( static_cast<DirItem*>( children.at( i ) ), subDirCutItems[i] );
         }
+    }
 
-        // TODO: check the Joliet charset
+    // keep the items in the order of the project tree
+    for( int i = 0; i < children.count(); ++i ) {
+        if( prepareWrittenName( children.at( i ) ) )
+            d->needToCutFilenameItems.append( children.at( i ) );
+        d->needToCutFilenameItems.append( subDirCutItems.at( i ) );
     }
 
     //
     // 3. check if a directory contains items with the same name
     //
-    prepareFilenamesInDir( root() );
+    renameSameNameItems( root() );
+
+    d->needToCutFilenames = !d->needToCutFilenameItems.isEmpty();
 }
 
 
-void K3b::DataDoc::prepareFilenamesInDir( K3b::DirItem* dir )
+void K3b::DataDoc::prepareFilenamesInDir( K3b::DirItem* dir, QList<K3b::DataItem*>& cutItems )
 {
-    if( !dir )
-        return;
-
-    QList<K3b::DataItem*> sortedChildren;
-    QList<K3b::DataItem*> children( dir->children() );
-    QList<K3b::DataItem*>::const_iterator it = children.constEnd();
-    while ( it != children.constBegin() ) {
-        --it;
-        K3b::DataItem* item = *it;
+    Q_FOREACH( K3b::DataItem* item, dir->children() ) {
+        if( prepareWrittenName( item ) )
+            cutItems.append( item );
 
         if( item->isDir() )
-            prepareFilenamesInDir( dynamic_cast<K3b::DirItem*>( item ) );
+            prepareFilenamesInDir( static_cast<K3b::DirItem*>( item ), cutItems );
+    }
+
+    renameSameNameItems( dir );
+}
 
-        // insertion sort
-        int i = 0;
-        while( i < sortedChildren.count() && item->writtenName() > sortedChildren.at(i)->writtenName() )
-            ++i;
 
-        sortedChildren.insert( i, item );
+bool K3b::DataDoc::prepareWrittenName( K3b::DataItem* item )
+{
+    QString name = treatWhitespace( item->k3bName() );
+
+    bool cut = false;
+    const int maxlen = ( isoOptions().jolietLong() ? 103 : 64 );
+    if( isoOptions().createJoliet() && name.length() > maxlen ) {
+        name = K3b::cutFilename( name, maxlen );
+        cut = true;
     }
 
-    if( isoOptions().createJoliet() || isoOptions().createRockRidge() ) {
-        QList<K3b::DataItem*> sameNameList;
-        while( !sortedChildren.isEmpty() ) {
-
-            sameNameList.clear();
-
-            do {
-                sameNameList.append( sortedChildren.takeFirst() );
-            } while( !sortedChildren.isEmpty() &&
-                     sortedChildren.first()->writtenName() == sameNameList.first()->writtenName() );
-
-            if( sameNameList.count() > 1 ) {
-                // now we need to rename the items
-                unsigned int maxlen = 255;
-                if( isoOptions().createJoliet() ) {
-                    if( isoOptions().jolietLong() )
-                        maxlen = 103;
-                    else
-                        maxlen = 64;
-                }
+    // TODO: check the Joliet charset
 
-                int cnt = 1;
-                Q_FOREACH( K3b::DataItem* item, sameNameList ) {
-                    item->setWrittenName( K3b::appendNumberToFilename( item->writtenName(), cnt++, maxlen ) );
-                }
+    item->setWrittenName( name );
+    return cut;
+}
+
+
+void K3b::DataDoc::renameSameNameItems( K3b::DirItem* dir )
+{
+    if( !isoOptions().createJoliet() && !isoOptions().createRockRidge() )
+        return;
+
+    // a stable sort keeps items with the same name in the order of the project
+    QVector<WrittenNameItem> sortedChildren;
+    sortedChildren.reserve( dir->children().count() );
+    Q_FOREACH( K3b::DataItem* item, dir->children() ) {
+        WrittenNameItem entry = { item->writtenName(), item };
+        sortedChildren.append( entry );
+    }
+    std::stable_sort( sortedChildren.begin(), sortedChildren.end() );
+
+    unsigned int maxlen = 255;
+    if( isoOptions().createJoliet() ) {
+        if( isoOptions().jolietLong() )
+            maxlen = 103;
+        else
+            maxlen = 64;
+    }
+
+    QVector<WrittenNameItem>::const_iterator it = sortedChildren.constBegin();
+    while( it != sortedChildren.constEnd() ) {
+        QVector<WrittenNameItem>::const_iterator sameNameEnd = it + 1;
+        while( sameNameEnd != sortedChildren.constEnd() && sameNameEnd->name == it->name )
+            ++sameNameEnd;
+
+        if( sameNameEnd - it > 1 ) {
+            // now we need to rename the items
+            int cnt = 1;
+            for( ; it != sameNameEnd; ++it ) {
+                it->item->setWrittenName( K3b::appendNumberToFilename( it->name, cnt++, maxlen ) );
             }
         }
+
+        it = sameNameEnd;
     }
 }
 
@@ -1247,6 +1378,30 @@ bool K3b::DataDoc::verifyData() const
 }
 
 
+void K3b::DataDoc::setStopVerifyingOnFirstDifference( bool b )
+{
+    d->stopVerifyingOnFirstDifference = b;
+}
+
+
+bool K3b::DataDoc::stopVerifyingOnFirstDifference() const
+{
+    return d->stopVerifyingOnFirstDifference;
+}
+
+
+void K3b::DataDoc::setSaveChecksums( bool b )
+{
+    d->saveChecksums = b;
+}
+
+
+bool K3b::DataDoc::saveChecksums() const
+{
+    return d->saveChecksums;
+}
+
+
 bool K3b::DataDoc::importSession( K3b::Device::Device* device, int session )
 {
     K3b::Device::DiskInfo diskInfo = device->diskInfo();
@@ -1494,8 +1649,13 @@ K3b::DataItem* K3b::DataDoc::createBootCatalogeItem( K3b::DirItem* dir )
 
 QList<K3b::DataItem*> K3b::DataDoc::findItemByLocalPath( const QString& path ) const
 {
-    Q_UNUSED( path );
-    return QList<K3b::DataItem*>();
+    return d->localPathIndex.values( QDir::cleanPath( path ) );
+}
+
+
+QList<K3b::FileItem*> K3b::DataDoc::findItemsByLocalId( const FileItem::Id& id ) const
+{
+    return d->localIdIndex.values( id );
 }
 
 
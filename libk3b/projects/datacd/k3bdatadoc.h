@@ -11,6 +11,7 @@
 #define K3BDATADOC_H
 
 #include "k3bdoc.h"
+#include "k3bfileitem.h"
 
 #include "k3b_export.h"
 
@@ -114,6 +115,23 @@ namespace K3b {
         void setVerifyData( bool b );
         bool verifyData() const;
 
+        /**
+         * Stop verifying the written data at the first block which differs
+         * instead of reading the whole track to report all differing sectors.
+         * Only used if verifyData() is set. Defaults to false.
+         */
+        void setStopVerifyingOnFirstDifference( bool b );
+        bool stopVerifyingOnFirstDifference() const;
+
+        /**
+         * Save the checksums of the blocks of a created image next to it
+         * (see ChecksumManifest::manifestFileName()) so the image and media
+         * written from it can be checked later on. Only used when only
+         * creating the image. Defaults to false.
+         */
+        void setSaveChecksums( bool b );
+        bool saveChecksums() const;
+
         static bool nameAlreadyInDir( const QString&, DirItem* );
 
         /**
@@ -193,12 +211,21 @@ namespace K3b {
         /**
          * Searches for an item by it's local path.
          *
-         * NOT IMPLEMENTED YET!
+         * The lookup uses an index which is updated whenever items are added to
+         * or removed from the project.
          *
          * \return The items that correspond to the specified local path.
          */
         QList<DataItem*> findItemByLocalPath( const QString& path ) const;
 
+        /**
+         * Searches for file items by the device and inode of their local file.
+         * This also finds hard links to the same file.
+         *
+         * \return The file items whose FileItem::localId(false) equals \p id.
+         */
+        QList<FileItem*> findItemsByLocalId( const FileItem::Id& id ) const;
+
     public Q_SLOTS:
         void addUrls( const QList<QUrl>& urls ) override;
 
@@ -237,7 +264,18 @@ namespace K3b {
         bool loadDocumentDataHeader( QDomElement optionsElem );
 
     private:
-        void prepareFilenamesInDir( DirItem* dir );
+        void prepareFilenamesInDir( DirItem* dir, QList<DataItem*>& cutItems );
+
+        /**
+         * Sets the written name of the item and cuts it for Joliet if necessary.
+         * \return true if the name had to be cut.
+         */
+        bool prepareWrittenName( DataItem* item );
+
+        /**
+         * Appends numbers to the written names of items in dir which share the same name.
+         */
+        void renameSameNameItems( DirItem* dir );
         void createSessionImportItems( const Iso9660Directory*, DirItem* parent );
 
         /**
@@ -153,8 +153,12 @@ void K3b::DataItem::setK3bName( const QString& name ) {
             }
         }
 
+        const QString oldName = m_k3bName;
         m_k3bName = name;
 
+        if( parent() )
+            parent()->childRenamed( this, oldName );
+
         if( DataDoc* doc = getDoc() ) {
             doc->setModified();
         }
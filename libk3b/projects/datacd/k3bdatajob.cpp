@@ -8,6 +8,7 @@
 #include "k3bisoimager.h"
 #include "k3bdatamultisessionparameterjob.h"
 #include "k3bchecksumpipe.h"
+#include "k3bchecksummanifest.h"
 #include "k3bcore.h"
 #include "k3bglobals.h"
 #include "k3bversion.h"
@@ -72,7 +73,7 @@ public:
 
     K3b::DataMultiSessionParameterJob* multiSessionParameterJob;
 
-    QByteArray checksumCache;
+    K3b::ChecksumManifest checksumCache;
 };
 
 
@@ -226,10 +227,18 @@ void K3b::DataJob::startPipe()
     // Open the active pipe which does the streaming
     //
     delete d->pipe;
-    if ( d->imageFinished || !d->doc->verifyData() )
+    // the block checksums are needed for the verification and, if requested,
+    // saved next to created images for later audits
+    const bool saveChecksums = d->doc->onlyCreateImages() && d->doc->saveChecksums();
+    if ( d->imageFinished || ( !d->doc->verifyData() && !saveChecksums ) ) {
         d->pipe = new K3b::ActivePipe();
-    else
-        d->pipe = new K3b::ChecksumPipe();
+    }
+    else {
+        K3b::ChecksumPipe* checksumPipe = new K3b::ChecksumPipe();
+        checksumPipe->setBlockSize( K3b::ChecksumManifest::DEFAULT_BLOCK_SIZE );
+        d->pipe = checksumPipe;
+    }
+    d->pipe->setBufferSize( 1024*1024 );
 
 #ifdef __GNUC__
 #warning Growisofs needs stdin to be closed in order to exit gracefully. Cdrecord does not. However,  if closed with cdrecord we loose parts of stderr. Why?
@@ -364,16 +373,26 @@ void K3b::DataJob::slotIsoImagerFinished( bool success )
     else {
         // cache the calculated checksum since the ChecksumPipe may be deleted below
         if ( ChecksumPipe* cp = qobject_cast<ChecksumPipe*>( d->pipe ) )
-            d->checksumCache = cp->checksum();
+            d->checksumCache = cp->manifest();
 
         if( !d->doc->onTheFly() ||
             d->doc->onlyCreateImages() ) {
 
+            if( success && !d->pipe->transferError().isEmpty() ) {
+                emit infoMessage( i18n("Error while writing the image file: %1", d->pipe->transferError()), MessageError );
+                success = false;
+            }
+
             if( success ) {
                 emit infoMessage( i18n("Image successfully created in %1", d->doc->tempDir()), K3b::Job::MessageSuccess );
                 d->imageFinished = true;
 
                 if( d->doc->onlyCreateImages() ) {
+                    if( d->doc->saveChecksums() &&
+                        d->checksumCache.isValid() &&
+                        !d->checksumCache.save( K3b::ChecksumManifest::manifestFileName( d->doc->tempDir() ) ) ) {
+                        emit infoMessage( i18n("Could not save the checksums of the image next to %1", d->doc->tempDir() ), MessageWarning );
+                    }
                     jobFinished( true );
                 }
                 else if( !d->imageFile.open( QIODevice::ReadOnly ) ) {
@@ -463,6 +482,12 @@ void K3b::DataJob::slotWriterJobFinished( bool success )
 {
     qDebug();
 
+    // the writer does not notice if it got less data than expected
+    if( success && d->pipe && !d->pipe->transferError().isEmpty() ) {
+        emit infoMessage( i18n("Error while passing the data to the writer: %1", d->pipe->transferError()), MessageError );
+        success = false;
+    }
+
     if( success ) {
         if ( !d->doc->onTheFly() ||
              !m_isoImager->active() ) {
@@ -504,6 +529,7 @@ void K3b::DataJob::finishCopy()
         d->verificationJob->clear();
         d->verificationJob->setDevice( d->doc->burner() );
         d->verificationJob->setGrownSessionSize( m_isoImager->size() );
+        d->verificationJob->setStopOnFirstDifference( d->doc->stopVerifyingOnFirstDifference() );
         d->verificationJob->addTrack( 0, d->checksumCache, m_isoImager->size() );
 
         emit burning(false);
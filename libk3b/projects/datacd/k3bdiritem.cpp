@@ -54,7 +54,8 @@ K3b::DirItem::~DirItem()
     while( !m_children.isEmpty() ) {
         // it is important to use takeDataItem here to be sure
         // the size gets updated properly
-        K3b::DataItem* item = m_children.first();
+        // (take from the back so the list does not have to be shifted)
+        K3b::DataItem* item = m_children.last();
         takeDataItem( item );
         delete item;
     }
@@ -179,6 +180,7 @@ K3b::DirItem::Children K3b::DirItem::takeDataItems( int start, int count )
             else
                 updateFiles( -1, 0 );
 
+            m_childIndex.remove( item->k3bName(), item );
             item->setParentDir( 0 );
 
             // unset OLD_SESSION flag if it was the last child from previous sessions
@@ -243,11 +245,18 @@ bool K3b::DirItem::alreadyInDirectory( const QString& filename ) const
 
 K3b::DataItem* K3b::DirItem::find( const QString& filename ) const
 {
-    Q_FOREACH( K3b::DataItem* item, m_children ) {
-        if( item->k3bName() == filename )
-            return item;
+    QMultiHash<QString, DataItem*>::const_iterator it = m_childIndex.constFind( filename );
+    if( it == m_childIndex.constEnd() )
+        return 0;
+
+    // in the rare case of several items with the same name
+    // return the first one in the list like before
+    DataItem* item = it.value();
+    for( ++it; it != m_childIndex.constEnd() && it.key() == filename; ++it ) {
+        if( m_children.indexOf( it.value() ) < m_children.indexOf( item ) )
+            item = it.value();
     }
-    return 0;
+    return item;
 }
 
 
@@ -438,7 +447,7 @@ bool K3b::DirItem::canAddDataItem( DataItem* item ) const
     if( dirItem && dirItem->isSubItem( this ) ) {
         qDebug() << "(K3b::DirItem) trying to move a dir item down in it's own tree.";
         return false;
-    } else if( !item || m_children.contains( item ) ) {
+    } else if( !item || item->parent() == this ) {
         return false;
     } else {
         return true;
@@ -475,6 +484,7 @@ void K3b::DirItem::addDataItemImpl( DataItem* item )
     }
 
     m_children.append( item );
+    m_childIndex.insert( item->k3bName(), item );
     updateSize( item, false );
     if( item->isDir() )
         updateFiles( ((DirItem*)item)->numFiles(), ((DirItem*)item)->numDirs()+1 );
@@ -490,6 +500,13 @@ void K3b::DirItem::addDataItemImpl( DataItem* item )
 }
 
 
+void K3b::DirItem::childRenamed( DataItem* item, const QString& oldName )
+{
+    m_childIndex.remove( oldName, item );
+    m_childIndex.insert( item->k3bName(), item );
+}
+
+
 K3b::RootItem::RootItem( K3b::DataDoc& doc )
     : K3b::DirItem( "root" ),
       m_doc( doc )
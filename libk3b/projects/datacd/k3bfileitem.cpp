@@ -15,7 +15,6 @@
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
-#include <QMimeDatabase>
 #include <QRegExp>
 #include <QString>
 #include <QStringList>
@@ -118,6 +117,8 @@ K3b::DataItem* K3b::FileItem::copy() const
 
 QMimeType K3b::FileItem::mimeType() const
 {
+    if( !m_mimeType.isValid() )
+        m_mimeType = K3b::mimeTypeForFile( m_localPath );
     return m_mimeType;
 }
 
@@ -295,8 +296,6 @@ void K3b::FileItem::init( const QString& filePath,
         m_idFollowed = m_id;
     }
 
-    m_mimeType = QMimeDatabase().mimeTypeForFile( filePath );
-
     // add automagically like a qlistviewitem
     if( parent() )
         parent()->addDataItem( this );
@@ -13,6 +13,7 @@
 #include "k3bglobals.h"
 
 #include <KIO/Global>
+#include <QHash>
 #include <QString>
 
 #include "k3b_export.h"
@@ -110,10 +111,12 @@ namespace K3b {
 
         QString m_localPath;
 
-        QMimeType m_mimeType;
+        // resolved on first use in mimeType()
+        mutable QMimeType m_mimeType;
     };
 
     bool operator==( const FileItem::Id&, const FileItem::Id& );
+    inline uint qHash( const FileItem::Id& id, uint seed = 0 ) { return ::qHash( quint64( id.inode ), seed ) ^ uint( id.device ); }
     bool operator<( const FileItem::Id&, const FileItem::Id& );
     bool operator>( const FileItem::Id&, const FileItem::Id& );
 }
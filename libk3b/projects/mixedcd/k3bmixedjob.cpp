@@ -31,6 +31,8 @@
 #include "k3binffilewriter.h"
 #include "k3bglobalsettings.h"
 #include "k3baudiofile.h"
+#include "k3baudiochecksum.h"
+#include "k3bverificationjob.h"
 #include "k3b_i18n.h"
 
 #include <KStringHandler>
@@ -73,6 +75,7 @@ class K3b::MixedJob::Private
 public:
     Private()
         : maxSpeedJob(0) {
+        pipe.setBufferSize( 1024*1024 );
     }
 
 
@@ -82,6 +85,9 @@ public:
     K3b::AudioMaxSpeedJob* maxSpeedJob;
     bool maxSpeed;
 
+    // only the audio tracks are verified, there are no checksums of the data track
+    bool verifyData;
+
     ActivePipe pipe;
 
     FileSplitter dataImageFile;
@@ -91,7 +97,8 @@ public:
 K3b::MixedJob::MixedJob( K3b::MixedDoc* doc, K3b::JobHandler* hdl, QObject* parent )
     : K3b::BurnJob( hdl, parent ),
       m_doc( doc ),
-      m_normalizeJob(0)
+      m_normalizeJob(0),
+      m_verificationJob(0)
 {
     d = new Private;
 
@@ -110,6 +117,10 @@ K3b::MixedJob::MixedJob( K3b::MixedDoc* doc, K3b::JobHandler* hdl, QObject* pare
     connect( m_audioImager, SIGNAL(subPercent(int)), this, SLOT(slotAudioDecoderSubPercent(int)) );
     connect( m_audioImager, SIGNAL(finished(bool)), this, SLOT(slotAudioDecoderFinished(bool)) );
     connect( m_audioImager, SIGNAL(nextTrack(int,int)), this, SLOT(slotAudioDecoderNextTrack(int,int)) );
+    connect( m_audioImager, SIGNAL(debuggingOutput(QString,QString)),
+             this, SIGNAL(debuggingOutput(QString,QString)) );
+    connect( m_audioImager, SIGNAL(readAheadBufferStatus(int)),
+             this, SIGNAL(readAheadBufferStatus(int)) );
 
     m_msInfoFetcher = new K3b::MsInfoFetcher( this, this );
     connect( m_msInfoFetcher, SIGNAL(finished(bool)), this, SLOT(slotMsInfoFetched(bool)) );
@@ -152,10 +163,14 @@ void K3b::MixedJob::start()
     d->copies = m_doc->copies();
     m_currentAction = PREPARING_DATA;
     d->maxSpeed = false;
+    d->verifyData = m_doc->audioDoc()->verifyData() && !m_doc->dummy() && !m_doc->onlyCreateImages();
 
     if( m_doc->dummy() )
         d->copies = 1;
 
+    m_audioImager->setReadAheadBufferSize( qint64( k3bcore->globalSettings()->audioReadAheadBufferSize() )*1024LL*1024LL );
+    m_audioImager->setTrackGains( QList<double>() );
+
     prepareProgressInformation();
 
     //
@@ -249,6 +264,7 @@ void K3b::MixedJob::startFirstCopy()
                 connect( d->maxSpeedJob, SIGNAL(finished(bool)),
                          this, SLOT(slotMaxSpeedJobFinished(bool)) );
             }
+            d->maxSpeedJob->setReadAheadBufferSize( qint64( k3bcore->globalSettings()->audioReadAheadBufferSize() )*1024LL*1024LL );
             d->maxSpeedJob->start();
         }
         else if( m_doc->mixedType() != K3b::MixedDoc::DATA_SECOND_SESSION ) {
@@ -350,9 +366,15 @@ void K3b::MixedJob::cancel()
 {
     m_canceled = true;
 
+    if( m_normalizeJob )
+        m_normalizeJob->cancel();
+
     if( d->maxSpeedJob )
         d->maxSpeedJob->cancel();
 
+    if( m_verificationJob && m_verificationJob->active() )
+        m_verificationJob->cancel();
+
     if( m_writer && m_writer->active() )
         m_writer->cancel();
     if ( m_isoImager->active() )
@@ -419,7 +441,11 @@ void K3b::MixedJob::slotIsoImagerFinished( bool success )
             if( m_doc->mixedType() == K3b::MixedDoc::DATA_SECOND_SESSION )
                 m_projectSize += 11400; // the session gap
 
-            startFirstCopy();
+            // the gains are applied while decoding, so the loudness has to be known first
+            if( m_doc->audioDoc()->normalize() )
+                normalizeFiles();
+            else
+                startFirstCopy();
         }
         else {
             cleanupAfterError();
@@ -464,6 +490,11 @@ void K3b::MixedJob::slotIsoImagerFinished( bool success )
     // Image creation finished
     //
     else {
+        if( success && !d->pipe.transferError().isEmpty() ) {
+            emit infoMessage( i18n("Error while passing the ISO image data: %1", d->pipe.transferError()), MessageError );
+            success = false;
+        }
+
         if( !success ) {
             emit infoMessage( i18n("Error while creating ISO image."), MessageError );
             cleanupAfterError();
@@ -505,6 +536,12 @@ void K3b::MixedJob::slotWriterFinished( bool success )
     if( m_canceled || m_errorOccuredAndAlreadyReported )
         return;
 
+    // the writer does not notice if it got less data than expected
+    if( success && !d->pipe.transferError().isEmpty() ) {
+        emit infoMessage( i18n("Error while passing the data to the writer: %1", d->pipe.transferError()), MessageError );
+        success = false;
+    }
+
     if( !success ) {
         cleanupAfterError();
         jobFinished(false);
@@ -526,24 +563,100 @@ void K3b::MixedJob::slotWriterFinished( bool success )
             startSecondSession();
         }
     }
+    else if( d->verifyData ) {
+        verifyCopy();
+    }
     else {
-        d->copiesDone++;
-        if( d->copiesDone < d->copies ) {
-            if( !K3b::eject( m_doc->burner() ) ) {
-                blockingInformation( i18n("K3b was unable to eject the written disk. Please do so manually.") );
-            }
-            writeNextCopy();
-        }
-        else {
-            if( !m_doc->onTheFly() && m_doc->removeImages() )
-                removeBufferFiles();
+        finishCopy();
+    }
+}
 
-            if ( k3bcore->globalSettings()->ejectMedia() ) {
-                K3b::Device::eject( m_doc->burner() );
-            }
 
-            jobFinished(true);
+void K3b::MixedJob::verifyCopy()
+{
+    if( !m_verificationJob ) {
+        m_verificationJob = new K3b::VerificationJob( this, this );
+        connect( m_verificationJob, SIGNAL(infoMessage(QString,int)),
+                 this, SIGNAL(infoMessage(QString,int)) );
+        connect( m_verificationJob, SIGNAL(newTask(QString)),
+                 this, SIGNAL(newSubTask(QString)) );
+        connect( m_verificationJob, SIGNAL(newSubTask(QString)),
+                 this, SIGNAL(newSubTask(QString)) );
+        connect( m_verificationJob, SIGNAL(percent(int)),
+                 this, SLOT(slotVerificationProgress(int)) );
+        connect( m_verificationJob, SIGNAL(percent(int)),
+                 this, SIGNAL(subPercent(int)) );
+        connect( m_verificationJob, SIGNAL(finished(bool)),
+                 this, SLOT(slotVerificationFinished(bool)) );
+        connect( m_verificationJob, SIGNAL(debuggingOutput(QString,QString)),
+                 this, SIGNAL(debuggingOutput(QString,QString)) );
+    }
+
+    m_verificationJob->clear();
+    m_verificationJob->setDevice( m_doc->burner() );
+
+    // the data track precedes the audio tracks only in this mode
+    const QList<K3b::AudioChecksum> checksums = m_audioImager->checksums();
+    const int firstTrack = ( m_doc->mixedType() == K3b::MixedDoc::DATA_FIRST_TRACK ? 2 : 1 );
+    for( int i = 0; i < checksums.count(); ++i )
+        m_verificationJob->addTrack( firstTrack + i, checksums[i] );
+
+    emit newTask( i18n("Verifying written audio tracks") );
+
+    m_verificationJob->start();
+}
+
+
+void K3b::MixedJob::slotVerificationProgress( int p )
+{
+    double totalTasks = d->copies*2;
+    double tasksDone = d->copiesDone*2 + 1; // the writing of the current copy has already been finished
+    if( m_doc->audioDoc()->normalize() ) {
+        totalTasks+=1.0;
+        tasksDone+=1.0;
+    }
+    if( !m_doc->onTheFly() ) {
+        totalTasks+=1.0;
+        tasksDone+=1.0;
+    }
+
+    emit percent( (int)((100.0*tasksDone + (double)p) / totalTasks) );
+}
+
+
+void K3b::MixedJob::slotVerificationFinished( bool success )
+{
+    if( m_canceled )
+        return;
+
+    if( !success ) {
+        cleanupAfterError();
+        jobFinished(false);
+    }
+    else {
+        finishCopy();
+    }
+}
+
+
+void K3b::MixedJob::finishCopy()
+{
+    d->copiesDone++;
+    if( d->copiesDone < d->copies ) {
+        if( !K3b::eject( m_doc->burner() ) ) {
+            blockingInformation( i18n("K3b was unable to eject the written disk. Please do so manually.") );
+        }
+        writeNextCopy();
+    }
+    else {
+        if( !m_doc->onTheFly() && m_doc->removeImages() )
+            removeBufferFiles();
+
+        if ( k3bcore->globalSettings()->ejectMedia() ) {
+            K3b::Device::eject( m_doc->burner() );
         }
+
+        jobFinished(true);
     }
 }
 
@@ -583,19 +696,14 @@ void K3b::MixedJob::slotAudioDecoderFinished( bool success )
     else {
         emit infoMessage( i18n("Audio images successfully created."), MessageSuccess );
 
-        if( m_doc->audioDoc()->normalize() ) {
-            normalizeFiles();
-        }
-        else {
-            if( m_doc->mixedType() == K3b::MixedDoc::DATA_FIRST_TRACK )
-                m_currentAction = WRITING_ISO_IMAGE;
-            else
-                m_currentAction = WRITING_AUDIO_IMAGE;
+        if( m_doc->mixedType() == K3b::MixedDoc::DATA_FIRST_TRACK )
+            m_currentAction = WRITING_ISO_IMAGE;
+        else
+            m_currentAction = WRITING_AUDIO_IMAGE;
 
-            if( !prepareWriter() || !startWriting() ) {
-                cleanupAfterError();
-                jobFinished(false);
-            }
+        if( !prepareWriter() || !startWriting() ) {
+            cleanupAfterError();
+            jobFinished(false);
         }
     }
 }
@@ -807,8 +915,7 @@ void K3b::MixedJob::addAudioTracks( K3b::CdrecordWriter* writer )
 
     writer->addArgument( "-audio" );
 
-    // we always pad because although K3b makes sure all tracks' length are multiples of 2352
-    // it seems that normalize sometimes corrupts these lengths
+    // we always pad to be on the safe side although K3b makes sure all tracks' length are multiples of 2352
     // FIXME: see K3b::AudioJob for the whole less4secs and zeroPregap handling
     writer->addArgument( "-pad" );
 
@@ -885,6 +992,10 @@ void K3b::MixedJob::slotWriterJobPercent( int p )
 {
     double totalTasks = d->copies;
     double tasksDone = d->copiesDone;
+    if( d->verifyData ) {
+        totalTasks*=2;
+        tasksDone*=2;
+    }
     if( m_doc->audioDoc()->normalize() ) {
         totalTasks+=1.0;
         tasksDone+=1.0;
@@ -924,15 +1035,21 @@ void K3b::MixedJob::slotAudioDecoderPercent( int p )
     // the only thing finished here might be the isoimager which is part of this task
     if( !m_doc->onTheFly() ) {
         double totalTasks = d->copies+1;
-        if( m_doc->audioDoc()->normalize() )
+        double tasksDone = 0;
+        if( d->verifyData )
+            totalTasks += d->copies;
+        if( m_doc->audioDoc()->normalize() ) {
             totalTasks+=1.0;
+            // the normalizer finished
+            tasksDone+=1.0;
+        }
 
         if( m_doc->mixedType() == K3b::MixedDoc::DATA_SECOND_SESSION )
             p = (int)((double)p*m_audioDocPartOfProcess);
         else
             p = (int)(100.0*(1.0-m_audioDocPartOfProcess) + (double)p*m_audioDocPartOfProcess);
 
-        emit percent( (int)((double)p / totalTasks) );
+        emit percent( (int)((100.0*tasksDone + (double)p) / totalTasks) );
     }
 }
 
@@ -953,6 +1070,10 @@ void K3b::MixedJob::slotIsoImagerPercent( int p )
 
             double totalTasks = d->copies+1.0;
             double tasksDone = d->copiesDone;
+            if( d->verifyData ) {
+                totalTasks += d->copies;
+                tasksDone += d->copiesDone;
+            }
             if( m_doc->audioDoc()->normalize() ) {
                 totalTasks+=1.0;
                 // the normalizer finished
@@ -969,10 +1090,16 @@ void K3b::MixedJob::slotIsoImagerPercent( int p )
         }
         else {
             double totalTasks = d->copies+1.0;
-            if( m_doc->audioDoc()->normalize() )
+            double tasksDone = 0;
+            if( d->verifyData )
+                totalTasks += d->copies;
+            if( m_doc->audioDoc()->normalize() ) {
                 totalTasks+=1.0;
+                // the normalizer finished
+                tasksDone+=1.0;
+            }
 
-            emit percent( (int)((double)(p*(1.0-m_audioDocPartOfProcess)) / totalTasks) );
+            emit percent( (int)((100.0*tasksDone + (double)(p*(1.0-m_audioDocPartOfProcess))) / totalTasks) );
         }
     }
 }
@@ -1242,28 +1369,18 @@ void K3b::MixedJob::determineWritingMode()
 void K3b::MixedJob::normalizeFiles()
 {
     if( !m_normalizeJob ) {
-        m_normalizeJob = new K3b::AudioNormalizeJob( this, this );
+        m_normalizeJob = new K3b::AudioNormalizeJob( m_doc->audioDoc(), this, this );
 
         connect( m_normalizeJob, SIGNAL(infoMessage(QString,int)),
                  this, SIGNAL(infoMessage(QString,int)) );
         connect( m_normalizeJob, SIGNAL(percent(int)), this, SLOT(slotNormalizeProgress(int)) );
-        connect( m_normalizeJob, SIGNAL(subPercent(int)), this, SLOT(slotNormalizeSubProgress(int)) );
+        connect( m_normalizeJob, SIGNAL(percent(int)), this, SLOT(slotNormalizeSubProgress(int)) );
         connect( m_normalizeJob, SIGNAL(finished(bool)), this, SLOT(slotNormalizeJobFinished(bool)) );
-        connect( m_normalizeJob, SIGNAL(newTask(QString)), this, SIGNAL(newSubTask(QString)) );
+        connect( m_normalizeJob, SIGNAL(newSubTask(QString)), this, SIGNAL(newSubTask(QString)) );
         connect( m_normalizeJob, SIGNAL(debuggingOutput(QString,QString)),
                  this, SIGNAL(debuggingOutput(QString,QString)) );
     }
 
-    // add all the files
-    QList<QString> files;
-    K3b::AudioTrack* track = m_doc->audioDoc()->firstTrack();
-    while( track ) {
-        files.append( m_tempData->bufferFileName(track) );
-        track = track->next();
-    }
-
-    m_normalizeJob->setFilesToNormalize( files );
-
     emit newTask( i18n("Normalizing volume levels") );
     m_normalizeJob->start();
 }
@@ -1274,15 +1391,8 @@ void K3b::MixedJob::slotNormalizeJobFinished( bool success )
         return;
 
     if( success ) {
-        if( m_doc->mixedType() == K3b::MixedDoc::DATA_FIRST_TRACK )
-            m_currentAction = WRITING_ISO_IMAGE;
-        else
-            m_currentAction = WRITING_AUDIO_IMAGE;
-
-        if( !prepareWriter() || !startWriting() ) {
-            cleanupAfterError();
-            jobFinished(false);
-        }
+        m_audioImager->setTrackGains( m_normalizeJob->gains() );
+        startFirstCopy();
     }
     else {
         cleanupAfterError();
@@ -1292,21 +1402,14 @@ void K3b::MixedJob::slotNormalizeJobFinished( bool success )
 
 void K3b::MixedJob::slotNormalizeProgress( int p )
 {
-    double totalTasks = d->copies+2.0;
-    double tasksDone = 0;
-
-    if( m_doc->mixedType() == K3b::MixedDoc::DATA_SECOND_SESSION ) {
-        // the audio imager finished (m_audioDocPartOfProcess*1 task)
-        // plus the normalize progress
-        tasksDone = m_audioDocPartOfProcess;
-    }
-    else {
-        // the iso and audio imagers already finished (one task)
-        // plus the normalize progress
-        tasksDone = 1.0;
-    }
+    // normalizing is the first task, followed by creating the images and writing all copies
+    double totalTasks = d->copies+1.0;
+    if( d->verifyData )
+        totalTasks += d->copies;
+    if( !m_doc->onTheFly() )
+        totalTasks+=1.0;
 
-    emit percent( (int)((100.0*tasksDone + (double)p) / totalTasks) );
+    emit percent( (int)((double)p / totalTasks) );
 }
 
 
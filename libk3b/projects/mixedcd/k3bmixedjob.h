@@ -24,6 +24,7 @@ namespace K3b {
     class MsInfoFetcher;
     class AudioNormalizeJob;
     class AudioJobTempData;
+    class VerificationJob;
     class Doc;
 
     class MixedJob : public BurnJob
@@ -68,6 +69,10 @@ namespace K3b {
         void slotNormalizeProgress( int );
         void slotNormalizeSubProgress( int );
 
+        // verification slots
+        void slotVerificationProgress( int );
+        void slotVerificationFinished( bool );
+
         // misc slots
         void slotMediaReloadedForSecondSession( K3b::Device::DeviceHandler* dh );
         void slotMaxSpeedJobFinished( bool );
@@ -88,6 +93,8 @@ namespace K3b {
         void normalizeFiles();
         void prepareProgressInformation();
         void writeNextCopy();
+        void verifyCopy();
+        void finishCopy();
         void determinePreliminaryDataImageSize();
 
         MixedDoc* m_doc;
@@ -98,6 +105,7 @@ namespace K3b {
         AbstractWriter* m_writer;
         MsInfoFetcher* m_msInfoFetcher;
         AudioNormalizeJob* m_normalizeJob;
+        VerificationJob* m_verificationJob;
 
         QString m_isoImageFilePath;
 
@@ -6,11 +6,23 @@
 */
 
 #include "k3bactivepipe.h"
+#include "k3bqprocess.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QFileDevice>
 #include <QIODevice>
+#include <QMutex>
 #include <QThread>
 
+#ifdef Q_OS_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 class K3b::ActivePipe::Private : public QThread
 {
@@ -20,29 +32,71 @@ public:
         sourceIODevice(0),
         sinkIODevice(0),
         closeSinkIODevice( false ),
-        closeSourceIODevice( false ) {
+        closeSourceIODevice( false ),
+        bufferSize( 10*2048 ),
+        bytesRead( 0 ),
+        bytesWritten( 0 ),
+        duration( 0 ),
+        pumping( false ) {
     }
 
     void run() override {
         qDebug() << "(K3b::ActivePipe) writing from" << sourceIODevice << "to" << sinkIODevice;
 
+        statsMutex.lock();
         bytesRead = bytesWritten = 0;
-        buffer.resize( 10*2048 );
+        error.clear();
+        pumping = true;
+        timer.start();
+        statsMutex.unlock();
+
+#ifdef Q_OS_LINUX
+        // pipes which process the data need the buffered copy
+        if( m_pipe->hasDataFilter() || !transferDirectly() )
+            copy();
+#else
+        copy();
+#endif
+
+        QMutexLocker locker( &statsMutex );
+        duration = timer.elapsed();
+        pumping = false;
+    }
+
+    void addRead( qint64 bytes ) {
+        QMutexLocker locker( &statsMutex );
+        bytesRead += bytes;
+    }
+
+    void addWritten( qint64 bytes ) {
+        QMutexLocker locker( &statsMutex );
+        bytesWritten += bytes;
+    }
+
+    void setError( const QString& message ) {
+        qDebug() << "(K3b::ActivePipe) transfer failed:" << message;
+        QMutexLocker locker( &statsMutex );
+        if( error.isEmpty() )
+            error = message;
+    }
+
+    void copy() {
+        buffer.resize( bufferSize );
 
         bool fail = false;
         qint64 r = 0;
         while( !fail && ( r = m_pipe->readData( buffer.data(), buffer.size() ) ) > 0 ) {
-            bytesRead += r;
+            addRead( r );
 
             ssize_t w = 0;
             ssize_t ww = 0;
             while( w < r ) {
                 if( ( ww = m_pipe->write( buffer.data()+w, r-w ) ) > 0 ) {
                     w += ww;
-                    bytesWritten += ww;
+                    addWritten( ww );
                 }
                 else {
-                    qDebug() << "write failed." << sinkIODevice->errorString();
+                    setError( sinkIODevice->errorString() );
                     fail = true;
                     break;
                 }
@@ -50,15 +104,171 @@ public:
         }
 
         if ( r < 0 ) {
-            qDebug() << "Read failed:" << sourceIODevice->errorString();
+            setError( sourceIODevice->errorString() );
         }
 
         qDebug() << "Done:"
                  << ( fail ? QLatin1String( "write failed" ) : QLatin1String( "write success" ) )
-                 << ( r != 0 ? QLatin1String( "read failed" ) : QLatin1String( "read success" ) )
-                 << "(total bytes read/written:" << bytesRead << "/" << bytesWritten << ")";
+                 << ( r < 0 ? QLatin1String( "read failed" ) : QLatin1String( "read success" ) )
+                 << "(total bytes read/written:" << m_pipe->bytesRead() << "/" << m_pipe->bytesWritten() << ")";
+    }
+
+#ifdef Q_OS_LINUX
+    static int fileDescriptor( QIODevice* dev, bool source ) {
+        if( QFileDevice* file = qobject_cast<QFileDevice*>( dev ) )
+            return file->handle();
+        else if( K3bQProcess* process = qobject_cast<K3bQProcess*>( dev ) )
+            return source ? process->stdoutFd() : process->stdinFd();
+        else
+            return -1;
+    }
+
+    /**
+     * Raises the capacity of the pipe \p fd to \p size. Pipes default to
+     * 64 KiB, smaller sizes would only slow down the transfer.
+     */
+    static void growPipe( int fd, int size ) {
+        const int current = ::fcntl( fd, F_GETPIPE_SZ );
+        if( current >= 0 && current < size && ::fcntl( fd, F_SETPIPE_SZ, size ) < 0 )
+            qDebug() << "(K3b::ActivePipe) could not raise the capacity of fd" << fd << "to" << size << "bytes";
     }
 
+    /**
+     * Moves the data inside the kernel.
+     *
+     * \return false if the devices are not supported. Nothing has been
+     * transferred in that case.
+     */
+    bool transferDirectly() {
+        const int in = fileDescriptor( sourceIODevice, true );
+        const int out = fileDescriptor( sinkIODevice, false );
+        struct stat inStat, outStat;
+        if( in < 0 || out < 0 || ::fstat( in, &inStat ) != 0 || ::fstat( out, &outStat ) != 0 )
+            return false;
+
+        const bool inPipe = S_ISFIFO( inStat.st_mode );
+        const bool outPipe = S_ISFIFO( outStat.st_mode );
+        if( ( !inPipe && !S_ISREG( inStat.st_mode ) ) ||
+            ( !outPipe && !S_ISREG( outStat.st_mode ) ) )
+            return false;
+
+        // Files are accessed at the position of the QIODevice which may
+        // differ from the file descriptor's position due to buffering.
+        QFileDevice* inFile = qobject_cast<QFileDevice*>( sourceIODevice );
+        QFileDevice* outFile = qobject_cast<QFileDevice*>( sinkIODevice );
+        loff_t inOffset = 0;
+        loff_t outOffset = 0;
+        loff_t* inOffsetPtr = 0;
+        loff_t* outOffsetPtr = 0;
+        if( inFile && !inPipe ) {
+            inOffset = inFile->pos();
+            inOffsetPtr = &inOffset;
+        }
+        if( outFile && !outPipe ) {
+            outFile->flush();
+            outOffset = outFile->pos();
+            outOffsetPtr = &outOffset;
+        }
+
+        if( inPipe )
+            growPipe( in, bufferSize );
+        if( outPipe )
+            growPipe( out, bufferSize );
+
+        // splice() needs a pipe on one side, files are connected through an intermediate one
+        int intermediatePipe[2] = { -1, -1 };
+        bool useCopyFileRange = ( !inPipe && !outPipe );
+#if !defined(__GLIBC__) || __GLIBC__ < 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ < 27 )
+        useCopyFileRange = false;
+#endif
+        if( !inPipe && !outPipe && !useCopyFileRange ) {
+            if( ::pipe( intermediatePipe ) != 0 )
+                return false;
+            growPipe( intermediatePipe[1], bufferSize );
+        }
+
+        qDebug() << "(K3b::ActivePipe) moving data directly from fd" << in << "to fd" << out;
+
+        ssize_t r = 0;
+        Q_FOREVER {
+            if( useCopyFileRange ) {
+#if defined(__GLIBC__) && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 27 ) )
+                r = ::copy_file_range( in, inOffsetPtr, out, outOffsetPtr, bufferSize, 0 );
+#endif
+                if( r < 0 && m_pipe->bytesWritten() == 0 && errno != EINTR ) {
+                    // not supported for these files (for example across file systems)
+                    useCopyFileRange = false;
+                    if( ::pipe( intermediatePipe ) != 0 )
+                        return false;
+                    growPipe( intermediatePipe[1], bufferSize );
+                    continue;
+                }
+                if( r > 0 ) {
+                    addRead( r );
+                    addWritten( r );
+                }
+            }
+            else if( intermediatePipe[0] == -1 ) {
+                r = ::splice( in, inOffsetPtr, out, outOffsetPtr, bufferSize, SPLICE_F_MOVE|SPLICE_F_MORE );
+                if( r < 0 && errno == EINVAL && m_pipe->bytesWritten() == 0 )
+                    return false;
+                if( r > 0 ) {
+                    addRead( r );
+                    addWritten( r );
+                }
+            }
+            else {
+                r = ::splice( in, inOffsetPtr, intermediatePipe[1], 0, bufferSize, SPLICE_F_MOVE|SPLICE_F_MORE );
+                if( r > 0 ) {
+                    addRead( r );
+                    ssize_t w = 0;
+                    while( w < r ) {
+                        ssize_t ww = ::splice( intermediatePipe[0], 0, out, outOffsetPtr, r-w, SPLICE_F_MOVE|SPLICE_F_MORE );
+                        if( ww > 0 ) {
+                            w += ww;
+                            addWritten( ww );
+                        }
+                        else if( ww < 0 && errno == EINTR ) {
+                            continue;
+                        }
+                        else {
+                            // keep the errno of the failed write
+                            if( ww == 0 )
+                                errno = EIO;
+                            r = -1;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if( r < 0 && errno == EINTR )
+                continue;
+            else if( r <= 0 )
+                break;
+        }
+
+        if( r < 0 )
+            setError( QString::fromLocal8Bit( ::strerror( errno ) ) );
+
+        if( intermediatePipe[0] != -1 ) {
+            ::close( intermediatePipe[0] );
+            ::close( intermediatePipe[1] );
+        }
+
+        // keep the QIODevices in sync with the file positions
+        if( inOffsetPtr )
+            inFile->seek( inOffset );
+        if( outOffsetPtr )
+            outFile->seek( outOffset );
+
+        qDebug() << "Done:"
+                 << ( r == 0 ? QLatin1String( "success" ) : QLatin1String( "failed" ) )
+                 << "(total bytes read/written:" << m_pipe->bytesRead() << "/" << m_pipe->bytesWritten() << ")";
+        return true;
+    }
+#endif
+
     void _k3b_close() {
         qDebug();
         if ( closeWhenDone )
@@ -77,9 +287,17 @@ public:
     bool closeSourceIODevice;
 
     QByteArray buffer;
+    int bufferSize;
 
+    // the statistics are read from other threads while pumping
+    mutable QMutex statsMutex;
     quint64 bytesRead;
     quint64 bytesWritten;
+    QString error;
+
+    QElapsedTimer timer;
+    qint64 duration;
+    bool pumping;
 };
 
 
@@ -182,13 +400,55 @@ qint64 K3b::ActivePipe::writeData( const char* data, qint64 max )
 
 quint64 K3b::ActivePipe::bytesRead() const
 {
+    QMutexLocker locker( &d->statsMutex );
     return d->bytesRead;
 }
 
 
 quint64 K3b::ActivePipe::bytesWritten() const
 {
+    QMutexLocker locker( &d->statsMutex );
     return d->bytesWritten;
 }
 
+
+quint64 K3b::ActivePipe::bytesPerSecond() const
+{
+    QMutexLocker locker( &d->statsMutex );
+    qint64 msecs = d->duration;
+    if( d->pumping )
+        msecs = d->timer.elapsed();
+
+    if( msecs > 0 )
+        return d->bytesWritten * 1000 / msecs;
+    else
+        return 0;
+}
+
+
+QString K3b::ActivePipe::transferError() const
+{
+    QMutexLocker locker( &d->statsMutex );
+    return d->error;
+}
+
+
+void K3b::ActivePipe::waitForFinished() const
+{
+    d->wait();
+}
+
+
+bool K3b::ActivePipe::hasDataFilter() const
+{
+    return false;
+}
+
+
+void K3b::ActivePipe::setBufferSize( int size )
+{
+    if( size > 0 )
+        d->bufferSize = size;
+}
+
 #include "moc_k3bactivepipe.cpp"
@@ -20,6 +20,12 @@ namespace K3b {
      * QIODevices are set. Otherwise the pipe only serves as a conduit for
      * data streams. The latter is mostly interesting when using the ChecksumPipe
      * in combination with a Job that can only push data (like the DataTrackReader).
+     *
+     * On Linux the ActivePipe moves the data without copying it through user
+     * space (using splice() or copy_file_range()) if the source and the sink are
+     * files, pipes, or the raw stdin/stdout of a K3b::Process. Subclasses which
+     * process the data (like the ChecksumPipe) reimplement hasDataFilter() to
+     * always use the buffered copy.
      */
     class LIBK3B_EXPORT ActivePipe : public QIODevice
     {
@@ -71,7 +77,43 @@ namespace K3b {
          */
         quint64 bytesWritten() const;
 
+        /**
+         * The average number of bytes written per second since the
+         * pumping started.
+         */
+        quint64 bytesPerSecond() const;
+
+        /**
+         * The reason why moving the data from the source to the sink
+         * failed or an empty string if it did not fail. Jobs should check
+         * this once the pumping is done since the sink may not notice that
+         * it got less data than expected.
+         */
+        QString transferError() const;
+
+        /**
+         * Blocks until all data has been moved from the source to the sink.
+         * Returns immediately if the pipe only serves as a conduit.
+         */
+        void waitForFinished() const;
+
+        /**
+         * Set the number of bytes that are moved in one go. If the data is
+         * transferred through a pipe with a smaller capacity it is raised to
+         * this size, too. Defaults to 20 KiB. Has to be set before calling
+         * open().
+         */
+        void setBufferSize( int size );
+
     protected:
+        /**
+         * Subclasses which process the data in readData() or writeData()
+         * have to return true here. Otherwise the data may be moved from the
+         * source to the sink directly. The default implementation returns
+         * false.
+         */
+        virtual bool hasDataFilter() const;
+
         /**
          * Reads the data from the source.
          * The default implementation reads from the file desc
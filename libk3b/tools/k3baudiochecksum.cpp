@@ -0,0 +1,188 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3baudiochecksum.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+
+namespace {
+    const quint32 HASH_BASE = 0x01000193;
+
+    class Crc32Table
+    {
+    public:
+        Crc32Table() {
+            for( quint32 i = 0; i < 256; ++i ) {
+                quint32 c = i;
+                for( int k = 0; k < 8; ++k )
+                    c = ( c & 1 ) ? 0xEDB88320 ^ ( c >> 1 ) : ( c >> 1 );
+                table[i] = c;
+            }
+        }
+
+        quint32 table[256];
+    };
+
+    const Crc32Table& crc32Table()
+    {
+        static const Crc32Table s_table;
+        return s_table;
+    }
+
+    inline quint32 sampleAt( const char* data, qint64 i )
+    {
+        return qFromLittleEndian<quint32>( reinterpret_cast<const uchar*>( data + 4*i ) );
+    }
+}
+
+
+K3b::AudioChecksum::AudioChecksum()
+    : m_samples( 0 ),
+      m_firstTrack( false ),
+      m_lastTrack( false ),
+      m_firstChecked( 0 ),
+      m_lastChecked( -1 ),
+      m_position( 0 ),
+      m_crc( 0xFFFFFFFF ),
+      m_accurateRip( 0 ),
+      m_partialLen( 0 ),
+      m_probePosition( 0 ),
+      m_probeSilent( true )
+{
+}
+
+
+K3b::AudioChecksum::AudioChecksum( const K3b::Msf& length, bool firstTrack, bool lastTrack )
+    : m_samples( qint64( length.lba() ) * SAMPLES_PER_SECTOR ),
+      m_firstTrack( firstTrack ),
+      m_lastTrack( lastTrack ),
+      m_firstChecked( firstTrack ? 5*SAMPLES_PER_SECTOR - 1 : 0 ),
+      m_lastChecked( lastTrack ? m_samples - 5*SAMPLES_PER_SECTOR - 1 : m_samples - 1 ),
+      m_position( 0 ),
+      m_crc( 0xFFFFFFFF ),
+      m_accurateRip( 0 ),
+      m_partialLen( 0 ),
+      m_probePosition( m_firstChecked ),
+      m_probeSilent( true )
+{
+}
+
+
+void K3b::AudioChecksum::update( const char* data, qint64 len, ByteOrder order )
+{
+    while( len > 0 && m_position < m_samples ) {
+        m_partial[m_partialLen++] = *data++;
+        --len;
+        if( m_partialLen == 4 ) {
+            const uchar* p = reinterpret_cast<const uchar*>( m_partial );
+            if( order == BigEndian )
+                addSample( quint32( p[1] | p[0] << 8 ) | quint32( p[3] | p[2] << 8 ) << 16 );
+            else
+                addSample( qFromLittleEndian<quint32>( p ) );
+            m_partialLen = 0;
+        }
+    }
+}
+
+
+void K3b::AudioChecksum::addSample( quint32 sample )
+{
+    if( m_position >= m_firstChecked && m_position <= m_lastChecked ) {
+        const Crc32Table& crc = crc32Table();
+        for( int i = 0; i < 4; ++i )
+            m_crc = crc.table[( m_crc ^ ( sample >> ( 8*i ) ) ) & 0xFF] ^ ( m_crc >> 8 );
+
+        m_accurateRip += sample * quint32( m_position + 1 );
+
+        // remember the first non-silent window as probe
+        if( m_probe.size() < PROBE_SAMPLES*4 || m_probeSilent ) {
+            if( m_probe.size() == PROBE_SAMPLES*4 ) {
+                m_probe.clear();
+                m_probePosition = m_position;
+            }
+            if( m_probePosition + PROBE_SAMPLES - 1 <= m_lastChecked ) {
+                char buf[4];
+                qToLittleEndian<quint32>( sample, reinterpret_cast<uchar*>( buf ) );
+                m_probe.append( buf, 4 );
+                m_probeSilent = m_probeSilent && sample == 0;
+            }
+        }
+    }
+
+    ++m_position;
+}
+
+
+bool K3b::AudioChecksum::isComplete() const
+{
+    return isValid() && m_position == m_samples;
+}
+
+
+K3b::Msf K3b::AudioChecksum::length() const
+{
+    return int( m_samples / SAMPLES_PER_SECTOR );
+}
+
+
+quint32 K3b::AudioChecksum::crc32() const
+{
+    return m_crc ^ 0xFFFFFFFF;
+}
+
+
+QByteArray K3b::AudioChecksum::probe() const
+{
+    if( m_probeSilent || m_probe.size() < PROBE_SAMPLES*4 )
+        return QByteArray();
+    else
+        return m_probe;
+}
+
+
+bool K3b::AudioChecksum::operator==( const AudioChecksum& other ) const
+{
+    return( m_samples == other.m_samples &&
+            crc32() == other.crc32() &&
+            m_accurateRip == other.m_accurateRip );
+}
+
+
+bool K3b::AudioChecksum::findProbe( const QByteArray& probe,
+                                    const char* data, qint64 samples,
+                                    qint64 expected,
+                                    qint64* pos )
+{
+    const qint64 n = probe.size() / 4;
+    if( n == 0 || samples < n )
+        return false;
+
+    quint32 probeHash = 0;
+    quint32 hash = 0;
+    quint32 highestPower = 1;
+    for( qint64 i = 0; i < n; ++i ) {
+        probeHash = probeHash*HASH_BASE + sampleAt( probe.constData(), i );
+        hash = hash*HASH_BASE + sampleAt( data, i );
+        highestPower *= HASH_BASE;
+    }
+
+    bool found = false;
+    for( qint64 i = 0; i + n <= samples; ++i ) {
+        if( hash == probeHash &&
+            ::memcmp( data + 4*i, probe.constData(), 4*n ) == 0 &&
+            ( !found || qAbs( i - expected ) < qAbs( *pos - expected ) ) ) {
+            found = true;
+            *pos = i;
+        }
+        if( i + n < samples )
+            hash = hash*HASH_BASE + sampleAt( data, i + n ) - sampleAt( data, i )*highestPower;
+    }
+
+    return found;
+}
@@ -0,0 +1,136 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_AUDIO_CHECKSUM_H_
+#define _K3B_AUDIO_CHECKSUM_H_
+
+#include "k3bmsf.h"
+
+#include "k3b_export.h"
+
+#include <QByteArray>
+
+
+namespace K3b {
+    /**
+     * Calculates the CRC32 and the AccurateRip (v1) checksum of an audio
+     * CD track. The data is expected as 16 bit stereo samples.
+     *
+     * Like AccurateRip the first five sectors of the first track and the
+     * last five sectors of the last track on the disc are excluded since
+     * they cannot be read reliably with a drive read offset applied. Both
+     * checksums cover the same samples.
+     *
+     * In addition a short window of non-silent samples, the probe, is
+     * remembered. It is used to find the combined read and write offset
+     * of the data on the medium with findProbe().
+     */
+    class LIBK3B_EXPORT AudioChecksum
+    {
+    public:
+        enum ByteOrder {
+            LittleEndian,
+            BigEndian
+        };
+
+        /**
+         * 588 samples per sector
+         */
+        static const int SAMPLES_PER_SECTOR = 588;
+
+        /**
+         * The number of samples in the probe. One sector.
+         */
+        static const int PROBE_SAMPLES = SAMPLES_PER_SECTOR;
+
+        /**
+         * Creates an invalid checksum.
+         */
+        AudioChecksum();
+
+        /**
+         * \param length The length of the track.
+         * \param firstTrack If true the track is the first track on the disc.
+         * \param lastTrack If true the track is the last track on the disc.
+         */
+        AudioChecksum( const Msf& length, bool firstTrack, bool lastTrack );
+
+        bool isValid() const { return m_samples > 0; }
+
+        /**
+         * Add data. The samples may be split over several calls.
+         * Data beyond the track length is ignored.
+         */
+        void update( const char* data, qint64 len, ByteOrder order );
+
+        /**
+         * \return true once all samples of the track have been added.
+         */
+        bool isComplete() const;
+
+        Msf length() const;
+        bool firstTrack() const { return m_firstTrack; }
+        bool lastTrack() const { return m_lastTrack; }
+
+        quint32 crc32() const;
+        quint32 accurateRip() const { return m_accurateRip; }
+
+        /**
+         * The first window of PROBE_SAMPLES samples which are not silent
+         * in little endian byte order. Empty if the track is completely silent.
+         */
+        QByteArray probe() const;
+
+        /**
+         * The position of the probe in samples relative to the beginning of the track.
+         */
+        qint64 probePosition() const { return m_probePosition; }
+
+        /**
+         * Compares the length and both checksums.
+         */
+        bool operator==( const AudioChecksum& other ) const;
+        bool operator!=( const AudioChecksum& other ) const { return !operator==( other ); }
+
+        /**
+         * Searches \p probe in \p data with a rolling hash.
+         *
+         * \param data Little endian samples.
+         * \param samples The number of samples in \p data.
+         * \param expected The position at which the probe is expected. If the probe
+         *        is found several times the position closest to it is used.
+         * \param pos Set to the sample position of the probe in \p data.
+         *
+         * \return true if the probe has been found.
+         */
+        static bool findProbe( const QByteArray& probe,
+                               const char* data, qint64 samples,
+                               qint64 expected,
+                               qint64* pos );
+
+    private:
+        void addSample( quint32 sample );
+
+        qint64 m_samples;
+        bool m_firstTrack;
+        bool m_lastTrack;
+        qint64 m_firstChecked;
+        qint64 m_lastChecked;
+
+        qint64 m_position;
+        quint32 m_crc;
+        quint32 m_accurateRip;
+
+        char m_partial[4];
+        int m_partialLen;
+
+        QByteArray m_probe;
+        qint64 m_probePosition;
+        bool m_probeSilent;
+    };
+}
+
+#endif
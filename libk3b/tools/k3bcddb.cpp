@@ -6,11 +6,13 @@
 */
 
 #include "k3bcddb.h"
+#include "k3bcddbindex.h"
 #include "k3bmedium.h"
 #include "k3btoc.h"
 #include "k3b_i18n.h"
 
 #include <QApplication>
+#include <QThread>
 #include <QDialog>
 #include <QDialogButtonBox>
 #include <QVBoxLayout>
@@ -74,25 +76,59 @@ int K3b::CDDB::MultiEntriesDialog::selectCddbEntry( const KCDDB::CDInfoList& ent
 class K3b::CDDB::CDDBJob::Private
 {
 public:
+    Private()
+        : queryResult( KCDDB::Success ),
+          indexThread( 0 ) {
+    }
+
     KCDDB::Client cddbClient;
     K3b::Medium medium;
     K3b::Device::Toc toc;
 
     KCDDB::CDInfo cddbInfo;
+    KCDDB::Result queryResult;
+
+    // the index is searched in this thread since the first lookup reads the whole index
+    QThread* indexThread;
+    KCDDB::CDInfoList indexResults;
 
+    void _k_indexLookupFinished();
     void _k_cddbQueryFinished( KCDDB::Result );
+    void finish( KCDDB::Result, const KCDDB::CDInfoList& results, bool fromIndex );
 
     CDDBJob* q;
 };
 
 
+void K3b::CDDB::CDDBJob::Private::_k_indexLookupFinished()
+{
+    indexThread->wait();
+    delete indexThread;
+    indexThread = 0;
+
+    // discs are inserted again and again, only unknown ones are looked up online
+    if( !indexResults.isEmpty() ) {
+        finish( indexResults.count() == 1 ? KCDDB::Success : KCDDB::MultipleRecordFound, indexResults, true );
+    }
+    else {
+        cddbClient.lookup( createTrackOffsetList( toc ) );
+    }
+}
+
+
 void K3b::CDDB::CDDBJob::Private::_k_cddbQueryFinished( KCDDB::Result result )
 {
+    finish( result, cddbClient.lookupResponse(), false );
+}
+
+
+void K3b::CDDB::CDDBJob::Private::finish( KCDDB::Result result, const KCDDB::CDInfoList& results, bool fromIndex )
+{
+    queryResult = result;
     if( result == KCDDB::Success ) {
-        cddbInfo = cddbClient.lookupResponse().first();
+        cddbInfo = results.first();
     }
     else if ( result == KCDDB::MultipleRecordFound ) {
-        KCDDB::CDInfoList results = cddbClient.lookupResponse();
         int i = K3b::CDDB::MultiEntriesDialog::selectCddbEntry( results, qApp->activeWindow() );
         if ( i >= 0 ) {
             cddbInfo = results[i];
@@ -104,8 +140,9 @@ void K3b::CDDB::CDDBJob::Private::_k_cddbQueryFinished( KCDDB::Result result )
     }
 
     // save the entry locally
-    if ( cddbInfo.isValid() ) {
+    if ( cddbInfo.isValid() && !fromIndex ) {
         cddbClient.store( cddbInfo, K3b::CDDB::createTrackOffsetList( toc ) );
+        DiscIdIndex::instance()->store( toc, cddbInfo );
     }
 
     q->emitResult();
@@ -125,6 +162,10 @@ K3b::CDDB::CDDBJob::CDDBJob( QObject* parent )
 
 K3b::CDDB::CDDBJob::~CDDBJob()
 {
+    if( d->indexThread ) {
+        d->indexThread->wait();
+        delete d->indexThread;
+    }
     delete d;
 }
 
@@ -138,8 +179,17 @@ K3b::Medium K3b::CDDB::CDDBJob::medium() const
 void K3b::CDDB::CDDBJob::start()
 {
     qDebug();
+    if( d->indexThread )
+        return;
+
     d->cddbInfo.clear();
-    d->cddbClient.lookup( createTrackOffsetList( d->toc ) );
+    d->queryResult = KCDDB::Success;
+    d->indexResults.clear();
+
+    Private* p = d;
+    d->indexThread = QThread::create( [p]() { p->indexResults = DiscIdIndex::instance()->lookup( p->toc ); } );
+    connect( d->indexThread, SIGNAL(finished()), this, SLOT(_k_indexLookupFinished()) );
+    d->indexThread->start();
 }
 
 
@@ -149,6 +199,12 @@ KCDDB::CDInfo K3b::CDDB::CDDBJob::cddbResult() const
 }
 
 
+KCDDB::Result K3b::CDDB::CDDBJob::queryResult() const
+{
+    return d->queryResult;
+}
+
+
 K3b::CDDB::CDDBJob* K3b::CDDB::CDDBJob::queryCddb( const K3b::Medium& medium )
 {
     CDDBJob* job = new CDDBJob();
@@ -30,6 +30,11 @@ namespace K3b {
         }
 
 
+        /**
+         * Looks up the CDDB entry of a disc. Discs in the local
+         * DiscIdIndex are answered from it, others are looked up with
+         * KCDDB and added to the index.
+         */
         class LIBK3B_EXPORT CDDBJob : public KJob
         {
             Q_OBJECT
@@ -49,6 +54,12 @@ namespace K3b {
              */
             KCDDB::CDInfo cddbResult() const;
 
+            /**
+             * The result of the lookup. Allows to tell a disc which is
+             * not known from a failed query.
+             */
+            KCDDB::Result queryResult() const;
+
             /**
              * Query cddb for the medium. The returned job is
              * already started.
@@ -68,6 +79,7 @@ namespace K3b {
             class Private;
             Private* const d;
 
+            Q_PRIVATE_SLOT( d, void _k_indexLookupFinished() )
             Q_PRIVATE_SLOT( d, void _k_cddbQueryFinished( KCDDB::Result ) )
         };
 
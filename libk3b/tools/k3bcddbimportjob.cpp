@@ -0,0 +1,72 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bcddbimportjob.h"
+#include "k3bsimplejobhandler.h"
+#include "k3b_i18n.h"
+
+
+K3b::CDDB::FreedbDumpImportJob::FreedbDumpImportJob( DiscIdIndex* index, QObject* parent )
+    : K3b::ThreadJob( new K3b::SimpleJobHandler(), parent ),
+      m_index( index ),
+      m_imported( 0 )
+{
+}
+
+
+K3b::CDDB::FreedbDumpImportJob::~FreedbDumpImportJob()
+{
+    delete jobHandler();
+}
+
+
+void K3b::CDDB::FreedbDumpImportJob::setPath( const QString& path )
+{
+    m_path = path;
+}
+
+
+QString K3b::CDDB::FreedbDumpImportJob::path() const
+{
+    return m_path;
+}
+
+
+int K3b::CDDB::FreedbDumpImportJob::imported() const
+{
+    return m_imported;
+}
+
+
+bool K3b::CDDB::FreedbDumpImportJob::run()
+{
+    emit newTask( i18n("Importing freedb dump") );
+
+    m_imported = m_index->importFreedbDump( m_path, this );
+    if( m_imported < 0 ) {
+        m_imported = 0;
+        emit infoMessage( i18n("Could not import the freedb dump in %1.", m_path), MessageError );
+        return false;
+    }
+
+    if( canceled() )
+        return false;
+
+    emit percent( 100 );
+    return true;
+}
+
+
+void K3b::CDDB::FreedbDumpImportJob::importProgress( int p )
+{
+    emit percent( p );
+}
+
+
+bool K3b::CDDB::FreedbDumpImportJob::importCanceled()
+{
+    return canceled();
+}
@@ -0,0 +1,56 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_CDDB_IMPORT_JOB_H_
+#define _K3B_CDDB_IMPORT_JOB_H_
+
+#include "k3bthreadjob.h"
+#include "k3bcddbindex.h"
+
+#include "k3b_export.h"
+
+#include <QString>
+
+
+namespace K3b {
+    namespace CDDB {
+        /**
+         * Imports an unpacked freedb dump into a DiscIdIndex in a separate
+         * thread. A complete dump contains millions of entries, thus the
+         * import reports its progress and can be canceled. The entries
+         * imported before canceling are kept.
+         *
+         * \sa DiscIdIndex::importFreedbDump()
+         */
+        class LIBK3B_EXPORT FreedbDumpImportJob : public ThreadJob, private DiscIdIndex::ImportObserver
+        {
+            Q_OBJECT
+
+        public:
+            explicit FreedbDumpImportJob( DiscIdIndex* index, QObject* parent = 0 );
+            ~FreedbDumpImportJob() override;
+
+            void setPath( const QString& path );
+            QString path() const;
+
+            /**
+             * The number of imported entries. Only valid once the job finished.
+             */
+            int imported() const;
+
+        private:
+            bool run() override;
+            void importProgress( int percent ) override;
+            bool importCanceled() override;
+
+            DiscIdIndex* m_index;
+            QString m_path;
+            int m_imported;
+        };
+    }
+}
+
+#endif
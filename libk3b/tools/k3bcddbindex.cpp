@@ -0,0 +1,475 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bcddbindex.h"
+#include "k3bcddb.h"
+#include "k3btoc.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QVector>
+
+
+namespace {
+    const quint32 INDEX_MAGIC = 0x4B334349; // "K3CI"
+    const quint32 INDEX_VERSION = 1;
+    const qint64 HEADER_SIZE = 8;
+
+    // the disc id and the size of the data precede every record
+    const qint64 RECORD_HEADER_SIZE = 8;
+
+    // freedb entries are a few KB at most, bigger files are no entries
+    const qint64 MAX_ENTRY_SIZE = 256*1024;
+
+    // the import writes the records in chunks of this size
+    const int IMPORT_CHUNK_SIZE = 1024*1024;
+
+    struct Record
+    {
+        Record() : length( 0 ) {}
+
+        // the track offsets in frames, 150 for the first track of most discs
+        QVector<qint32> offsets;
+
+        // the length of the disc in seconds
+        qint32 length;
+
+        QString category;
+
+        // the entry in the freedb format
+        QString entry;
+    };
+
+    quint32 calculateDiscId( const QVector<qint32>& offsets, qint32 length )
+    {
+        quint32 n = 0;
+        Q_FOREACH( qint32 offset, offsets ) {
+            for( quint32 seconds = offset/75; seconds > 0; seconds /= 10 )
+                n += seconds % 10;
+        }
+        const quint32 t = length - ( offsets.isEmpty() ? 0 : offsets.first()/75 );
+        return ( ( n % 0xff ) << 24 ) | ( t << 8 ) | quint32( offsets.count() );
+    }
+
+    void tocOffsets( const K3b::Device::Toc& toc, QVector<qint32>& offsets, qint32& length )
+    {
+        // the same values the CDDB servers are queried with
+        const KCDDB::TrackOffsetList trackOffsets = K3b::CDDB::createTrackOffsetList( toc );
+        offsets.clear();
+        for( int i = 0; i < trackOffsets.count() - 1; ++i )
+            offsets.append( trackOffsets[i] );
+        length = trackOffsets.last()/75;
+    }
+
+    QByteArray packRecord( const Record& record )
+    {
+        QByteArray data;
+        QDataStream s( &data, QIODevice::WriteOnly );
+        s.setVersion( QDataStream::Qt_5_0 );
+        s << record.offsets << record.length << record.category << record.entry;
+        return data;
+    }
+
+    bool unpackRecord( const QByteArray& data, Record& record )
+    {
+        QDataStream s( data );
+        s.setVersion( QDataStream::Qt_5_0 );
+        s >> record.offsets >> record.length >> record.category >> record.entry;
+        return s.status() == QDataStream::Ok;
+    }
+
+    /**
+     * Reads the track offsets and the disc length from the comments
+     * of a freedb entry.
+     */
+    bool parseFreedbEntry( const QString& entry, Record& record )
+    {
+        static const QRegularExpression s_offsetRx( "^#\\s*(\\d+)\\s*$" );
+        static const QRegularExpression s_lengthRx( "^#\\s*Disc length:\\s*(\\d+)", QRegularExpression::CaseInsensitiveOption );
+
+        bool inOffsets = false;
+        record.offsets.clear();
+        record.length = 0;
+        Q_FOREACH( const QString& line, entry.split( '\n' ) ) {
+            if( inOffsets ) {
+                QRegularExpressionMatch match = s_offsetRx.match( line );
+                if( match.hasMatch() ) {
+                    record.offsets.append( match.captured( 1 ).toInt() );
+                    continue;
+                }
+                inOffsets = false;
+            }
+
+            if( line.contains( "Track frame offsets", Qt::CaseInsensitive ) ) {
+                inOffsets = true;
+            }
+            else {
+                QRegularExpressionMatch match = s_lengthRx.match( line );
+                if( match.hasMatch() ) {
+                    record.length = match.captured( 1 ).toInt();
+                    break;
+                }
+            }
+        }
+
+        record.entry = entry;
+        return !record.offsets.isEmpty() && record.length > 0;
+    }
+
+    QString readFreedbEntry( const QString& filename )
+    {
+        QFile f( filename );
+        if( f.size() > MAX_ENTRY_SIZE || !f.open( QIODevice::ReadOnly ) )
+            return QString();
+
+        // older entries are latin1 encoded
+        const QByteArray data = f.readAll();
+        QString entry = QString::fromUtf8( data );
+        if( entry.contains( QChar::ReplacementCharacter ) )
+            entry = QString::fromLatin1( data );
+        return entry;
+    }
+}
+
+
+class K3b::CDDB::DiscIdIndex::Private
+{
+public:
+    Private()
+        : scannedSize( 0 ),
+          count( 0 ) {
+    }
+
+    bool open( bool create );
+    void scan();
+    bool read( qint64 pos, Record& record );
+    bool append( const QByteArray& records, const QList<QPair<quint32, qint64> >& newPositions );
+
+    QString filename;
+    QFile file;
+
+    // the part of the file which has been indexed
+    qint64 scannedSize;
+
+    // the positions of the records by disc id
+    QHash<quint32, QVector<qint64> > positions;
+    int count;
+
+    mutable QMutex mutex;
+};
+
+
+bool K3b::CDDB::DiscIdIndex::Private::open( bool create )
+{
+    if( file.isOpen() )
+        return true;
+
+    if( !QFile::exists( filename ) ) {
+        if( !create )
+            return false;
+        QDir().mkpath( QFileInfo( filename ).absolutePath() );
+    }
+
+    file.setFileName( filename );
+    if( !file.open( QIODevice::ReadWrite ) ) {
+        qDebug() << "(K3b::CDDB::DiscIdIndex) could not open" << filename << file.errorString();
+        return false;
+    }
+
+    QDataStream s( &file );
+    s.setVersion( QDataStream::Qt_5_0 );
+    quint32 magic = 0;
+    quint32 version = 0;
+    s >> magic >> version;
+    if( s.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != INDEX_VERSION ) {
+        // a new or unusable index is started over
+        if( file.size() > 0 )
+            qDebug() << "(K3b::CDDB::DiscIdIndex) resetting invalid index" << filename;
+        file.resize( 0 );
+        file.seek( 0 );
+        s.resetStatus();
+        s << INDEX_MAGIC << INDEX_VERSION;
+        if( s.status() != QDataStream::Ok || !file.flush() ) {
+            file.close();
+            return false;
+        }
+    }
+
+    scannedSize = HEADER_SIZE;
+    positions.clear();
+    count = 0;
+    return true;
+}
+
+
+void K3b::CDDB::DiscIdIndex::Private::scan()
+{
+    const qint64 size = file.size();
+    if( size <= scannedSize || !file.seek( scannedSize ) )
+        return;
+
+    QDataStream s( &file );
+    s.setVersion( QDataStream::Qt_5_0 );
+    while( scannedSize + RECORD_HEADER_SIZE <= size ) {
+        quint32 id = 0;
+        quint32 len = 0;
+        s >> id >> len;
+
+        // a record which is still being written
+        if( s.status() != QDataStream::Ok || scannedSize + RECORD_HEADER_SIZE + len > size )
+            break;
+
+        positions[id].append( scannedSize );
+        ++count;
+        scannedSize += RECORD_HEADER_SIZE + len;
+        if( s.skipRawData( len ) != int( len ) )
+            break;
+    }
+}
+
+
+bool K3b::CDDB::DiscIdIndex::Private::read( qint64 pos, Record& record )
+{
+    if( !file.seek( pos ) )
+        return false;
+
+    QDataStream s( &file );
+    s.setVersion( QDataStream::Qt_5_0 );
+    quint32 id = 0;
+    quint32 len = 0;
+    s >> id >> len;
+    if( s.status() != QDataStream::Ok )
+        return false;
+
+    const QByteArray data = file.read( len );
+    return data.size() == int( len ) && unpackRecord( data, record );
+}
+
+
+bool K3b::CDDB::DiscIdIndex::Private::append( const QByteArray& records, const QList<QPair<quint32, qint64> >& newPositions )
+{
+    // records from other instances are indexed first. An incomplete
+    // record left behind by a crash is overwritten.
+    scan();
+    if( file.size() != scannedSize && !file.resize( scannedSize ) )
+        return false;
+
+    if( !file.seek( scannedSize ) ||
+        file.write( records ) != records.size() ||
+        !file.flush() ) {
+        qDebug() << "(K3b::CDDB::DiscIdIndex) could not write to" << filename << file.errorString();
+        file.resize( scannedSize );
+        return false;
+    }
+
+    for( int i = 0; i < newPositions.count(); ++i )
+        positions[newPositions[i].first].append( scannedSize + newPositions[i].second );
+    count += newPositions.count();
+    scannedSize += records.size();
+    return true;
+}
+
+
+K3b::CDDB::DiscIdIndex::ImportObserver::~ImportObserver()
+{
+}
+
+
+K3b::CDDB::DiscIdIndex::DiscIdIndex( const QString& filename )
+    : d( new Private() )
+{
+    d->filename = filename;
+}
+
+
+K3b::CDDB::DiscIdIndex::~DiscIdIndex()
+{
+    delete d;
+}
+
+
+K3b::CDDB::DiscIdIndex* K3b::CDDB::DiscIdIndex::instance()
+{
+    static DiscIdIndex s_index( QStandardPaths::writableLocation( QStandardPaths::AppDataLocation ) + "/cddbindex" );
+    return &s_index;
+}
+
+
+QString K3b::CDDB::DiscIdIndex::filename() const
+{
+    return d->filename;
+}
+
+
+int K3b::CDDB::DiscIdIndex::count() const
+{
+    QMutexLocker locker( &d->mutex );
+    if( !d->open( false ) )
+        return 0;
+    d->scan();
+    return d->count;
+}
+
+
+quint32 K3b::CDDB::DiscIdIndex::discId( const Device::Toc& toc )
+{
+    QVector<qint32> offsets;
+    qint32 length = 0;
+    tocOffsets( toc, offsets, length );
+    return calculateDiscId( offsets, length );
+}
+
+
+KCDDB::CDInfoList K3b::CDDB::DiscIdIndex::lookup( const Device::Toc& toc ) const
+{
+    return lookup( QList<Device::Toc>() << toc ).first();
+}
+
+
+QList<KCDDB::CDInfoList> K3b::CDDB::DiscIdIndex::lookup( const QList<Device::Toc>& tocs ) const
+{
+    QList<KCDDB::CDInfoList> results;
+
+    QMutexLocker locker( &d->mutex );
+    const bool isOpen = d->open( false );
+    if( isOpen )
+        d->scan();
+
+    Q_FOREACH( const Device::Toc& toc, tocs ) {
+        KCDDB::CDInfoList infos;
+        if( isOpen && !toc.isEmpty() ) {
+            QVector<qint32> offsets;
+            qint32 length = 0;
+            tocOffsets( toc, offsets, length );
+
+            // the latest record per category
+            QList<Record> records;
+            Q_FOREACH( qint64 pos, d->positions.value( calculateDiscId( offsets, length ) ) ) {
+                Record record;
+                if( !d->read( pos, record ) || record.offsets != offsets || record.length != length )
+                    continue;
+
+                int i = 0;
+                while( i < records.count() && records[i].category != record.category )
+                    ++i;
+                if( i < records.count() )
+                    records[i] = record;
+                else
+                    records.append( record );
+            }
+
+            Q_FOREACH( const Record& record, records ) {
+                KCDDB::CDInfo info;
+                if( info.load( record.entry ) ) {
+                    if( !record.category.isEmpty() )
+                        info.set( KCDDB::Category, record.category );
+                    infos.append( info );
+                }
+            }
+        }
+        results.append( infos );
+    }
+
+    return results;
+}
+
+
+bool K3b::CDDB::DiscIdIndex::store( const Device::Toc& toc, const KCDDB::CDInfo& info )
+{
+    if( toc.isEmpty() || !info.isValid() )
+        return false;
+
+    Record record;
+    tocOffsets( toc, record.offsets, record.length );
+    record.category = info.get( KCDDB::Category ).toString();
+    record.entry = info.toString();
+
+    const quint32 id = calculateDiscId( record.offsets, record.length );
+    const QByteArray data = packRecord( record );
+
+    QByteArray records;
+    QDataStream s( &records, QIODevice::WriteOnly );
+    s << id << quint32( data.size() );
+    s.writeRawData( data.constData(), data.size() );
+
+    QMutexLocker locker( &d->mutex );
+    return d->open( true ) &&
+        d->append( records, QList<QPair<quint32, qint64> >() << qMakePair( id, qint64( 0 ) ) );
+}
+
+
+int K3b::CDDB::DiscIdIndex::importFreedbDump( const QString& path, ImportObserver* observer )
+{
+    QDir root( path );
+    if( !root.exists() )
+        return -1;
+
+    QMutexLocker locker( &d->mutex );
+    if( !d->open( true ) )
+        return -1;
+
+    int imported = 0;
+    QByteArray records;
+    QList<QPair<quint32, qint64> > newPositions;
+    bool canceled = false;
+    const QStringList categories = root.entryList( QDir::Dirs | QDir::NoDotAndDotDot );
+    for( int c = 0; c < categories.count() && !canceled; ++c ) {
+        const QString& category = categories[c];
+        QDir dir( root.filePath( category ) );
+        const QStringList names = dir.entryList( QDir::Files );
+        for( int i = 0; i < names.count(); ++i ) {
+            const QString& name = names[i];
+            if( observer && i % 1000 == 0 ) {
+                if( observer->importCanceled() ) {
+                    canceled = true;
+                    break;
+                }
+                observer->importProgress( 100LL*( qint64( c )*names.count() + i )/( qint64( categories.count() )*names.count() ) );
+            }
+
+            Record record;
+            if( !parseFreedbEntry( readFreedbEntry( dir.filePath( name ) ), record ) ) {
+                qDebug() << "(K3b::CDDB::DiscIdIndex) skipping invalid entry" << dir.filePath( name );
+                continue;
+            }
+            record.category = category;
+
+            // the file name is the id of the entry which may have been
+            // shared by several discs. Thus the id is calculated again.
+            const quint32 id = calculateDiscId( record.offsets, record.length );
+            const QByteArray data = packRecord( record );
+            newPositions.append( qMakePair( id, qint64( records.size() ) ) );
+            QDataStream s( &records, QIODevice::WriteOnly | QIODevice::Append );
+            s << id << quint32( data.size() );
+            s.writeRawData( data.constData(), data.size() );
+
+            if( records.size() >= IMPORT_CHUNK_SIZE ) {
+                if( !d->append( records, newPositions ) )
+                    return -1;
+                imported += newPositions.count();
+                records.clear();
+                newPositions.clear();
+            }
+        }
+    }
+
+    if( !records.isEmpty() ) {
+        if( !d->append( records, newPositions ) )
+            return -1;
+        imported += newPositions.count();
+    }
+
+    qDebug() << "(K3b::CDDB::DiscIdIndex) imported" << imported << "entries from" << path
+             << ( canceled ? "before the import was canceled" : "" );
+    return imported;
+}
@@ -0,0 +1,118 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_CDDB_INDEX_H_
+#define _K3B_CDDB_INDEX_H_
+
+#include <KCDDB/CDInfo>
+
+#include "k3b_export.h"
+
+#include <QList>
+#include <QString>
+
+
+namespace K3b {
+    namespace Device {
+        class Toc;
+    }
+
+    namespace CDDB {
+        /**
+         * A local index of CDDB entries keyed by the freedb disc id.
+         *
+         * CDDBJob answers queries from the index and only asks the CDDB
+         * servers for discs which are not in it. Entries of several discs
+         * may share a disc id, thus the track offsets and the length of
+         * the disc have to match, too.
+         *
+         * All entries are kept in a single file which is only ever appended
+         * to. The positions of the entries are held in memory, so a lookup
+         * reads one entry per matching disc id from the file. Entries
+         * appended by other K3b instances are picked up on the next lookup.
+         *
+         * The index may be used by several threads at once. The first
+         * lookup or count() reads the whole file to collect the positions
+         * of the entries, thus it should not be done in the GUI thread.
+         */
+        class LIBK3B_EXPORT DiscIdIndex
+        {
+        public:
+            /**
+             * Reports the progress of importFreedbDump() and allows to
+             * cancel it. The methods are called from the importing thread.
+             */
+            class LIBK3B_EXPORT ImportObserver
+            {
+            public:
+                virtual ~ImportObserver();
+
+                virtual void importProgress( int percent ) = 0;
+
+                /**
+                 * \return true to stop the import. The entries which have
+                 *         been imported so far are kept.
+                 */
+                virtual bool importCanceled() = 0;
+            };
+
+            /**
+             * \param filename The file the entries are stored in. It is
+             *                 created on the first store.
+             */
+            explicit DiscIdIndex( const QString& filename );
+            ~DiscIdIndex();
+
+            /**
+             * The index in the user's data folder used by CDDBJob.
+             */
+            static DiscIdIndex* instance();
+
+            QString filename() const;
+
+            /**
+             * The number of entries, replaced ones included.
+             */
+            int count() const;
+
+            /**
+             * The freedb disc id as calculated by the CDDB servers.
+             */
+            static quint32 discId( const Device::Toc& toc );
+
+            /**
+             * \return All entries for the disc, empty if it is unknown.
+             *         A later entry of the same category replaces an
+             *         earlier one.
+             */
+            KCDDB::CDInfoList lookup( const Device::Toc& toc ) const;
+
+            /**
+             * Looks up several discs at once.
+             */
+            QList<KCDDB::CDInfoList> lookup( const QList<Device::Toc>& tocs ) const;
+
+            bool store( const Device::Toc& toc, const KCDDB::CDInfo& info );
+
+            /**
+             * Imports an unpacked freedb dump. \p path contains a folder
+             * per category which contains one file per disc as it is
+             * distributed by freedb.org and gnudb.org.
+             *
+             * \return The number of imported entries or -1 on error.
+             */
+            int importFreedbDump( const QString& path, ImportObserver* observer = 0 );
+
+        private:
+            class Private;
+            Private* const d;
+
+            Q_DISABLE_COPY( DiscIdIndex )
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,290 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bchecksumcalculator.h"
+
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+
+namespace {
+    // The size of each of the two buffers handed to the hashing thread
+    const int s_blockSize = 1024*1024;
+
+    const K3b::ChecksumPipe::Type s_allTypes[] = {
+        K3b::ChecksumPipe::MD5,
+        K3b::ChecksumPipe::SHA1,
+        K3b::ChecksumPipe::SHA256,
+        K3b::ChecksumPipe::SHA512,
+        K3b::ChecksumPipe::SHA3_256
+    };
+}
+
+
+class K3b::ChecksumCalculator::Private : public QThread
+{
+public:
+    Private()
+        : blockSize( 0 ),
+          blockHash( 0 ),
+          blockFill( 0 ),
+          size( 0 ),
+          fillIndex( 0 ),
+          pending( false ),
+          stopRequested( false ) {
+        buffers[0].reserve( s_blockSize );
+        buffers[1].reserve( s_blockSize );
+    }
+
+    ~Private() override {
+        stop();
+        qDeleteAll( hashes );
+        delete blockHash;
+    }
+
+    void run() override {
+        Q_FOREVER {
+            mutex.lock();
+            while( !pending && !stopRequested )
+                cond.wait( &mutex );
+            if( !pending ) {
+                mutex.unlock();
+                break;
+            }
+            const QByteArray& block = buffers[1-fillIndex];
+            mutex.unlock();
+
+            // the producer does not touch this buffer until pending is reset
+            Q_FOREACH( QCryptographicHash* hash, hashes ) {
+                hash->addData( block.constData(), block.size() );
+            }
+            if( blockHash )
+                addBlockData( block.constData(), block.size() );
+
+            mutex.lock();
+            pending = false;
+            cond.wakeAll();
+            mutex.unlock();
+        }
+    }
+
+    void addBlockData( const char* data, qint64 len ) {
+        while( len > 0 ) {
+            const qint64 n = qMin( len, blockSize - blockFill );
+            blockHash->addData( data, n );
+            blockFill += n;
+            data += n;
+            len -= n;
+            if( blockFill == blockSize )
+                finishBlock();
+        }
+    }
+
+    void finishBlock() {
+        const QByteArray result = blockHash->result();
+        mutex.lock();
+        blockResults.append( result );
+        mutex.unlock();
+        blockHash->reset();
+        blockFill = 0;
+    }
+
+    /**
+     * Passes the current buffer to the hashing thread and
+     * continues with the other one once it has been hashed.
+     */
+    void handOff() {
+        if( !isRunning() )
+            start();
+
+        mutex.lock();
+        while( pending )
+            cond.wait( &mutex );
+        fillIndex = 1-fillIndex;
+        pending = true;
+        cond.wakeAll();
+        mutex.unlock();
+
+        buffers[fillIndex].resize( 0 );
+    }
+
+    void stop() {
+        if( isRunning() ) {
+            mutex.lock();
+            stopRequested = true;
+            cond.wakeAll();
+            mutex.unlock();
+            wait();
+            stopRequested = false;
+        }
+    }
+
+    ChecksumPipe::Types types;
+    QList<ChecksumPipe::Type> hashTypes;
+    QList<QCryptographicHash*> hashes;
+
+    qint64 blockSize;
+    QCryptographicHash* blockHash;
+    qint64 blockFill;
+    QList<QByteArray> blockResults;
+
+    qint64 size;
+
+    QByteArray buffers[2];
+    int fillIndex;
+    bool pending;
+    bool stopRequested;
+
+    QMutex mutex;
+    QWaitCondition cond;
+};
+
+
+K3b::ChecksumCalculator::ChecksumCalculator( ChecksumPipe::Types types )
+    : d( new Private() )
+{
+    setTypes( types );
+}
+
+
+K3b::ChecksumCalculator::~ChecksumCalculator()
+{
+    delete d;
+}
+
+
+void K3b::ChecksumCalculator::setTypes( ChecksumPipe::Types types )
+{
+    d->stop();
+    qDeleteAll( d->hashes );
+    d->hashes.clear();
+    d->hashTypes.clear();
+
+    d->types = types;
+    for( ChecksumPipe::Type type : s_allTypes ) {
+        if( types & type ) {
+            d->hashTypes.append( type );
+            d->hashes.append( new QCryptographicHash( ChecksumCalculator::algorithm( type ) ) );
+        }
+    }
+
+    setBlockSize( d->blockSize );
+}
+
+
+K3b::ChecksumPipe::Types K3b::ChecksumCalculator::types() const
+{
+    return d->types;
+}
+
+
+void K3b::ChecksumCalculator::setBlockSize( qint64 bytes )
+{
+    d->stop();
+    delete d->blockHash;
+    d->blockHash = 0;
+
+    d->blockSize = bytes;
+    if( bytes > 0 && !d->hashTypes.isEmpty() )
+        d->blockHash = new QCryptographicHash( ChecksumCalculator::algorithm( d->hashTypes.first() ) );
+
+    reset();
+}
+
+
+qint64 K3b::ChecksumCalculator::blockSize() const
+{
+    return d->blockSize;
+}
+
+
+void K3b::ChecksumCalculator::reset()
+{
+    // the thread finishes the pending block before stopping
+    d->stop();
+    d->buffers[0].resize( 0 );
+    d->buffers[1].resize( 0 );
+    Q_FOREACH( QCryptographicHash* hash, d->hashes ) {
+        hash->reset();
+    }
+    if( d->blockHash )
+        d->blockHash->reset();
+    d->blockFill = 0;
+    d->mutex.lock();
+    d->blockResults.clear();
+    d->mutex.unlock();
+    d->size = 0;
+}
+
+
+void K3b::ChecksumCalculator::addData( const char* data, qint64 len )
+{
+    d->size += len;
+    while( len > 0 ) {
+        QByteArray& buffer = d->buffers[d->fillIndex];
+        const int n = static_cast<int>( qMin<qint64>( len, s_blockSize - buffer.size() ) );
+        buffer.append( data, n );
+        data += n;
+        len -= n;
+
+        if( buffer.size() >= s_blockSize )
+            d->handOff();
+    }
+}
+
+
+void K3b::ChecksumCalculator::finish()
+{
+    if( !d->buffers[d->fillIndex].isEmpty() )
+        d->handOff();
+    d->stop();
+
+    if( d->blockFill > 0 )
+        d->finishBlock();
+}
+
+
+QByteArray K3b::ChecksumCalculator::result( ChecksumPipe::Type type ) const
+{
+    const int i = d->hashTypes.indexOf( type );
+    if( i >= 0 )
+        return d->hashes[i]->result();
+    else
+        return QByteArray();
+}
+
+
+QList<QByteArray> K3b::ChecksumCalculator::blockResults() const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->blockResults;
+}
+
+
+qint64 K3b::ChecksumCalculator::size() const
+{
+    return d->size;
+}
+
+
+QCryptographicHash::Algorithm K3b::ChecksumCalculator::algorithm( ChecksumPipe::Type type )
+{
+    switch( type ) {
+    case ChecksumPipe::SHA1:
+        return QCryptographicHash::Sha1;
+    case ChecksumPipe::SHA256:
+        return QCryptographicHash::Sha256;
+    case ChecksumPipe::SHA512:
+        return QCryptographicHash::Sha512;
+    case ChecksumPipe::SHA3_256:
+        return QCryptographicHash::Sha3_256;
+    case ChecksumPipe::MD5:
+    default:
+        return QCryptographicHash::Md5;
+    }
+}
@@ -0,0 +1,92 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_CHECKSUM_CALCULATOR_H_
+#define _K3B_CHECKSUM_CALCULATOR_H_
+
+#include "k3bchecksumpipe.h"
+
+#include "k3b_export.h"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QList>
+
+
+namespace K3b {
+    /**
+     * Calculates one or more checksums of a data stream in one pass.
+     *
+     * The hashing is done in a separate thread: the data passed to
+     * addData() is collected in one of two buffers and handed over to
+     * the hashing thread once it is full while the caller continues to
+     * fill the other one. Thus reading and hashing run in parallel.
+     *
+     * The calculator is not thread-safe itself, i.e. addData() and
+     * finish() need to be called from the same thread.
+     */
+    class LIBK3B_EXPORT ChecksumCalculator
+    {
+    public:
+        explicit ChecksumCalculator( ChecksumPipe::Types types = ChecksumPipe::MD5 );
+        ~ChecksumCalculator();
+
+        /**
+         * Changes the calculated checksums. This implies reset().
+         */
+        void setTypes( ChecksumPipe::Types types );
+        ChecksumPipe::Types types() const;
+
+        /**
+         * Additionally calculate a checksum for each block of \p bytes
+         * bytes. The blocks are hashed with the lowest type set.
+         * 0 (the default) disables the block checksums. This implies reset().
+         */
+        void setBlockSize( qint64 bytes );
+        qint64 blockSize() const;
+
+        /**
+         * Discards all data and resets the checksums.
+         */
+        void reset();
+
+        void addData( const char* data, qint64 len );
+
+        /**
+         * Blocks until all data passed to addData() has been hashed.
+         * Needs to be called before result().
+         */
+        void finish();
+
+        /**
+         * \return The raw checksum of type \p type or an empty array
+         * if it has not been calculated.
+         */
+        QByteArray result( ChecksumPipe::Type type ) const;
+
+        /**
+         * \return The raw checksums of the blocks hashed so far. The
+         * list is complete after finish(), then the last one may cover
+         * less than blockSize() bytes. Can be called from any thread.
+         */
+        QList<QByteArray> blockResults() const;
+
+        /**
+         * The number of bytes passed to addData() since the last reset().
+         */
+        qint64 size() const;
+
+        static QCryptographicHash::Algorithm algorithm( ChecksumPipe::Type type );
+
+    private:
+        class Private;
+        Private* const d;
+
+        Q_DISABLE_COPY( ChecksumCalculator )
+    };
+}
+
+#endif
@@ -0,0 +1,310 @@
+/*
+    SPDX-FileCopyrightText: 1998-2009 Sebastian Trueg <trueg@k3b.org>
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bchecksumjob.h"
+#include "k3bchecksumcalculator.h"
+#include "k3biso9660.h"
+#include "k3bglobals.h"
+#include "k3bdevice.h"
+#include "k3bfilesplitter.h"
+#include "k3b_i18n.h"
+
+#include <QDebug>
+#include <QIODevice>
+#include <QTimer>
+
+
+class K3b::ChecksumJob::Private
+{
+public:
+    Private()
+        : ioDevice(0),
+          device(0),
+          finished(true),
+          data(0),
+          isoFile(0),
+          maxSize(0),
+          readData(0),
+          lastProgress(0),
+          imageSize(0) {
+    }
+
+    K3b::ChecksumCalculator calculator;
+    K3b::FileSplitter file;
+    QTimer timer;
+    QString filename;
+    QIODevice* ioDevice;
+    K3b::Device::Device* device;
+
+    bool finished;
+    char* data;
+    const K3b::Iso9660File* isoFile;
+
+    qint64 maxSize;
+    qint64 readData;
+
+    int lastProgress;
+
+    KIO::filesize_t imageSize;
+
+    static const int BUFFERSIZE = 2048*128;
+};
+
+
+K3b::ChecksumJob::ChecksumJob( K3b::JobHandler* jh, QObject* parent )
+    : K3b::Job( jh, parent ),
+      d( new Private() )
+{
+    d->data = new char[Private::BUFFERSIZE];
+    connect( &d->timer, SIGNAL(timeout()),
+             this, SLOT(slotUpdate()) );
+}
+
+
+K3b::ChecksumJob::~ChecksumJob()
+{
+    delete [] d->data;
+    delete d;
+}
+
+
+void K3b::ChecksumJob::start()
+{
+    cancel();
+
+    jobStarted();
+    d->readData = 0;
+
+    if( d->isoFile ) {
+        d->imageSize = d->isoFile->size();
+    }
+    else if( !d->filename.isEmpty() ) {
+        if( !QFile::exists( d->filename ) ) {
+            emit infoMessage( i18n("Could not find file %1",d->filename), MessageError );
+            jobFinished(false);
+            return;
+        }
+
+        d->file.setName( d->filename );
+        if( !d->file.open( QIODevice::ReadOnly ) ) {
+            emit infoMessage( i18n("Could not open file %1",d->filename), MessageError );
+            jobFinished(false);
+            return;
+        }
+
+        d->imageSize = K3b::filesize( QUrl::fromLocalFile(d->filename) );
+    }
+    else
+        d->imageSize = 0;
+
+    if( d->device ) {
+        //
+        // Let the drive determine the optimal reading speed
+        //
+        d->device->setSpeed( 0xffff, 0xffff );
+    }
+
+    d->calculator.reset();
+    d->finished = false;
+    if( d->ioDevice )
+        connect( d->ioDevice, SIGNAL(readyRead()), this, SLOT(slotUpdate()) );
+    else
+        d->timer.start(0);
+}
+
+
+void K3b::ChecksumJob::cancel()
+{
+    if( !d->finished ) {
+        stopAll();
+
+        emit canceled();
+        jobFinished( false );
+    }
+}
+
+
+void K3b::ChecksumJob::setTypes( ChecksumPipe::Types types )
+{
+    d->calculator.setTypes( types );
+}
+
+
+K3b::ChecksumPipe::Types K3b::ChecksumJob::types() const
+{
+    return d->calculator.types();
+}
+
+
+void K3b::ChecksumJob::setFile( const QString& filename )
+{
+    d->filename = filename;
+    d->isoFile = 0;
+    d->ioDevice = 0;
+    d->device = 0;
+}
+
+
+void K3b::ChecksumJob::setFile( const K3b::Iso9660File* file )
+{
+    d->isoFile = file;
+    d->ioDevice = 0;
+    d->filename.truncate(0);
+    d->device = 0;
+}
+
+
+void K3b::ChecksumJob::setIODevice( QIODevice* dev )
+{
+    d->ioDevice = dev;
+    d->filename.truncate(0);
+    d->isoFile = 0;
+    d->device = 0;
+}
+
+
+void K3b::ChecksumJob::setDevice( K3b::Device::Device* dev )
+{
+    d->device = dev;
+    d->ioDevice = 0;
+    d->filename.truncate(0);
+    d->isoFile = 0;
+}
+
+
+void K3b::ChecksumJob::setMaxReadSize( qint64 size )
+{
+    d->maxSize = size;
+}
+
+
+void K3b::ChecksumJob::slotUpdate()
+{
+    if( !d->finished ) {
+
+        // determine bytes to read
+        qint64 readSize = Private::BUFFERSIZE;
+        if( d->maxSize > 0 )
+            readSize = qMin( readSize, d->maxSize - d->readData );
+
+        if( readSize <= 0 ) {
+            //      qDebug() << "(K3b::ChecksumJob) reached max size of " << d->maxSize << ". Stopping.";
+            emit debuggingOutput( "K3b::ChecksumJob", QString("Reached max read of %1. Stopping after %2 bytes.").arg(d->maxSize).arg(d->readData) );
+            stopAll();
+            emit percent( 100 );
+            jobFinished(true);
+        }
+        else {
+            int read = 0;
+
+            //
+            // read from the iso9660 file
+            //
+            if( d->isoFile ) {
+                read = d->isoFile->read( d->readData, d->data, readSize );
+            }
+
+            //
+            // read from the device
+            //
+            else if( d->device ) {
+                //
+                // when reading from a device we always read multiples of 2048 bytes.
+                // Only the last sector may not be used completely.
+                //
+                readSize = qMin<qint64>( readSize, qint64( d->device->maxReadSectors() )*2048 );
+                qint64 sector = d->readData/2048;
+                qint64 sectorCnt = qMax( readSize/2048, ( qint64 )1 );
+                read = -1;
+                if( d->device->read10( reinterpret_cast<unsigned char*>(d->data),
+                                       sectorCnt*2048,
+                                       sector,
+                                       sectorCnt ) )
+                    read = qMin( readSize, sectorCnt*2048 );
+            }
+
+            //
+            // read from the file
+            //
+            else if( !d->ioDevice ) {
+                read = d->file.read( d->data, readSize );
+            }
+
+            //
+            // reading from the io device
+            //
+            else {
+                read = d->ioDevice->read( d->data, readSize );
+            }
+
+            if( read < 0 ) {
+                emit infoMessage( i18n("Error while reading from file %1", d->filename), MessageError );
+                stopAll();
+                jobFinished(false);
+            }
+            else if( read == 0 ) {
+                //	qDebug() << "(K3b::ChecksumJob) read all data. Total size: " << d->readData << ". Stopping.";
+                emit debuggingOutput( "K3b::ChecksumJob", QString("All data read. Stopping after %1 bytes.").arg(d->readData) );
+                stopAll();
+                emit percent( 100 );
+                jobFinished(true);
+            }
+            else {
+                d->readData += read;
+                d->calculator.addData( d->data, read );
+                int progress = 0;
+                if( d->isoFile || !d->filename.isEmpty() )
+                    progress = (int)((double)d->readData * 100.0 / (double)d->imageSize);
+                else if( d->maxSize > 0 )
+                    progress = (int)((double)d->readData * 100.0 / (double)d->maxSize);
+
+                if( progress != d->lastProgress ) {
+                    d->lastProgress = progress;
+                    emit percent( progress );
+                }
+            }
+        }
+    }
+}
+
+
+QByteArray K3b::ChecksumJob::hexDigest( ChecksumPipe::Type type )
+{
+    if( d->finished )
+        return d->calculator.result( type ).toHex();
+    else
+        return "";
+}
+
+
+QByteArray K3b::ChecksumJob::base64Digest( ChecksumPipe::Type type )
+{
+    if( d->finished )
+        return d->calculator.result( type ).toBase64();
+    else
+        return "";
+}
+
+
+void K3b::ChecksumJob::stop()
+{
+    emit debuggingOutput( "K3b::ChecksumJob", QString("Stopped manually after %1 bytes.").arg(d->readData) );
+    stopAll();
+    jobFinished( true );
+}
+
+
+void K3b::ChecksumJob::stopAll()
+{
+    if( d->ioDevice )
+        disconnect( d->ioDevice, SIGNAL(readyRead()), this, SLOT(slotUpdate()) );
+    if( d->file.isOpen() )
+        d->file.close();
+    d->timer.stop();
+    d->calculator.finish();
+    d->finished = true;
+}
+
+
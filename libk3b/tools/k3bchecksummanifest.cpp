@@ -0,0 +1,159 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bchecksummanifest.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+
+
+namespace {
+    const char s_header[] = "# K3b checksum manifest";
+
+    struct TypeName {
+        K3b::ChecksumPipe::Type type;
+        const char* name;
+    };
+
+    const TypeName s_typeNames[] = {
+        { K3b::ChecksumPipe::MD5, "md5" },
+        { K3b::ChecksumPipe::SHA1, "sha1" },
+        { K3b::ChecksumPipe::SHA256, "sha256" },
+        { K3b::ChecksumPipe::SHA512, "sha512" },
+        { K3b::ChecksumPipe::SHA3_256, "sha3-256" }
+    };
+
+    QByteArray typeName( K3b::ChecksumPipe::Type type )
+    {
+        for( const TypeName& t : s_typeNames ) {
+            if( t.type == type )
+                return t.name;
+        }
+        return QByteArray();
+    }
+
+    bool typeFromName( const QByteArray& name, K3b::ChecksumPipe::Type& type )
+    {
+        for( const TypeName& t : s_typeNames ) {
+            if( name == t.name ) {
+                type = t.type;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+
+K3b::ChecksumManifest::ChecksumManifest()
+    : m_type( ChecksumPipe::MD5 ),
+      m_blockSize( 0 ),
+      m_size( 0 )
+{
+}
+
+
+K3b::ChecksumManifest::ChecksumManifest( ChecksumPipe::Type type,
+                                         qint64 blockSize,
+                                         qint64 size,
+                                         const QByteArray& checksum,
+                                         const QList<QByteArray>& blocks )
+    : m_type( type ),
+      m_blockSize( blockSize ),
+      m_size( size ),
+      m_checksum( checksum ),
+      m_blocks( blocks )
+{
+}
+
+
+bool K3b::ChecksumManifest::isValid() const
+{
+    return( m_blockSize > 0 &&
+            m_blocks.count() == ( m_size + m_blockSize - 1 ) / m_blockSize );
+}
+
+
+bool K3b::ChecksumManifest::save( const QString& filename ) const
+{
+    if( !isValid() )
+        return false;
+
+    QSaveFile file( filename );
+    if( !file.open( QIODevice::WriteOnly ) ) {
+        qDebug() << "(K3b::ChecksumManifest) could not open" << filename;
+        return false;
+    }
+
+    QTextStream s( &file );
+    s << s_header << '\n'
+      << "type " << typeName( m_type ) << '\n'
+      << "blocksize " << m_blockSize << '\n'
+      << "size " << m_size << '\n'
+      << "checksum " << m_checksum << '\n';
+    Q_FOREACH( const QByteArray& block, m_blocks ) {
+        s << block.toHex() << '\n';
+    }
+    s.flush();
+
+    return file.commit();
+}
+
+
+K3b::ChecksumManifest K3b::ChecksumManifest::load( const QString& filename )
+{
+    QFile file( filename );
+    if( !file.open( QIODevice::ReadOnly ) )
+        return ChecksumManifest();
+
+    if( file.readLine().trimmed() != s_header ) {
+        qDebug() << "(K3b::ChecksumManifest)" << filename << "is no checksum manifest.";
+        return ChecksumManifest();
+    }
+
+    ChecksumManifest manifest;
+    while( !file.atEnd() ) {
+        const QByteArray line = file.readLine().trimmed();
+        if( line.isEmpty() || line.startsWith( '#' ) )
+            continue;
+
+        const int space = line.indexOf( ' ' );
+        if( space < 0 ) {
+            manifest.m_blocks.append( QByteArray::fromHex( line ) );
+            continue;
+        }
+
+        const QByteArray key = line.left( space );
+        const QByteArray value = line.mid( space+1 );
+        bool ok = true;
+        if( key == "type" )
+            ok = typeFromName( value, manifest.m_type );
+        else if( key == "blocksize" )
+            manifest.m_blockSize = value.toLongLong( &ok );
+        else if( key == "size" )
+            manifest.m_size = value.toLongLong( &ok );
+        else if( key == "checksum" )
+            manifest.m_checksum = value;
+
+        if( !ok ) {
+            qDebug() << "(K3b::ChecksumManifest) invalid line in" << filename << ":" << line;
+            return ChecksumManifest();
+        }
+    }
+
+    if( !manifest.isValid() )
+        return ChecksumManifest();
+
+    return manifest;
+}
+
+
+QString K3b::ChecksumManifest::manifestFileName( const QString& imagePath )
+{
+    return imagePath + QLatin1String( ".k3bsums" );
+}
@@ -0,0 +1,90 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_CHECKSUM_MANIFEST_H_
+#define _K3B_CHECKSUM_MANIFEST_H_
+
+#include "k3bchecksumpipe.h"
+
+#include "k3b_export.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+
+namespace K3b {
+    /**
+     * A checksum manifest stores the checksum of a complete image
+     * and the checksums of all its blocks. It allows to pinpoint the
+     * regions which differ when verifying written data and can be saved
+     * next to an image for later audits of the written media.
+     */
+    class LIBK3B_EXPORT ChecksumManifest
+    {
+    public:
+        /**
+         * 512 sectors of 2048 bytes
+         */
+        static const qint64 DEFAULT_BLOCK_SIZE = 512*2048;
+
+        /**
+         * Creates an invalid manifest.
+         */
+        ChecksumManifest();
+
+        /**
+         * \param checksum The hex encoded checksum of the complete data.
+         * \param blocks The raw checksums of the blocks.
+         */
+        ChecksumManifest( ChecksumPipe::Type type,
+                          qint64 blockSize,
+                          qint64 size,
+                          const QByteArray& checksum,
+                          const QList<QByteArray>& blocks );
+
+        bool isValid() const;
+
+        ChecksumPipe::Type type() const { return m_type; }
+
+        /**
+         * The size of the blocks in bytes. Only the last block may be smaller.
+         */
+        qint64 blockSize() const { return m_blockSize; }
+
+        /**
+         * The size of the data in bytes.
+         */
+        qint64 size() const { return m_size; }
+
+        /**
+         * The hex encoded checksum of the complete data.
+         */
+        QByteArray checksum() const { return m_checksum; }
+
+        /**
+         * The raw checksums of all blocks.
+         */
+        QList<QByteArray> blockChecksums() const { return m_blocks; }
+
+        bool save( const QString& filename ) const;
+        static ChecksumManifest load( const QString& filename );
+
+        /**
+         * \return The file name of the manifest which belongs to \p imagePath.
+         */
+        static QString manifestFileName( const QString& imagePath );
+
+    private:
+        ChecksumPipe::Type m_type;
+        qint64 m_blockSize;
+        qint64 m_size;
+        QByteArray m_checksum;
+        QList<QByteArray> m_blocks;
+    };
+}
+
+#endif
@@ -6,40 +6,44 @@
 */
 
 #include "k3bchecksumpipe.h"
+#include "k3bchecksumcalculator.h"
+#include "k3bchecksummanifest.h"
 
-#include <KCodecs>
 #include <QDebug>
-#include <QCryptographicHash>
-
-#include <unistd.h>
+#include <QMutex>
 
 
 class K3b::ChecksumPipe::Private
 {
 public:
     Private()
-		: checksumType(MD5), md5(QCryptographicHash::Md5) {
+        : calculator( MD5 ),
+          blockSize( 0 ),
+          finished( true ) {
     }
 
-    void update( const char* in, qint64 len ) {
-        switch( checksumType ) {
-        case MD5:
-			md5.addData( in, len );
-            break;
+    // The calculation is finished by the pumping thread once all data has
+    // been read. When the pipe is only used as a conduit it is finished by
+    // the first request for the results, at which point the thread writing
+    // to the pipe has to be done.
+    void finish() {
+        QMutexLocker locker( &mutex );
+        if( !finished ) {
+            calculator.finish();
+            finished = true;
         }
     }
 
-    void reset() {
-        switch( checksumType ) {
-        case MD5:
-            md5.reset();
-            break;
-        }
+    void addData( const char* data, qint64 len ) {
+        QMutexLocker locker( &mutex );
+        if( !finished )
+            calculator.addData( data, len );
     }
 
-    int checksumType;
-
-	QCryptographicHash md5;
+    ChecksumCalculator calculator;
+    qint64 blockSize;
+    bool finished;
+    QMutex mutex;
 };
 
 
@@ -64,26 +68,89 @@ bool K3b::ChecksumPipe::open( bool closeWhenDone )
 
 bool K3b::ChecksumPipe::open( Type type, bool closeWhenDone )
 {
-    d->reset();
-    d->checksumType = type;
+    return open( Types( type ), closeWhenDone );
+}
+
+
+bool K3b::ChecksumPipe::open( Types types, bool closeWhenDone )
+{
+    d->calculator.setTypes( types );
+    d->calculator.setBlockSize( d->blockSize );
+    d->finished = false;
     return K3b::ActivePipe::open( closeWhenDone );
 }
 
 
 QByteArray K3b::ChecksumPipe::checksum() const
 {
-    switch( d->checksumType ) {
-    case MD5:
-		return d->md5.result().toHex();
+    const Types types = d->calculator.types();
+    for( int type = MD5; type <= SHA3_256; type <<= 1 ) {
+        if( types & type )
+            return checksum( Type( type ) );
     }
 
     return QByteArray();
 }
 
 
+QByteArray K3b::ChecksumPipe::checksum( Type type ) const
+{
+    waitForFinished();
+    d->finish();
+    return d->calculator.result( type ).toHex();
+}
+
+
+void K3b::ChecksumPipe::setBlockSize( qint64 bytes )
+{
+    d->blockSize = bytes;
+}
+
+
+K3b::ChecksumManifest K3b::ChecksumPipe::manifest() const
+{
+    if( d->blockSize <= 0 )
+        return ChecksumManifest();
+
+    const QByteArray sum = checksum();
+    const Types types = d->calculator.types();
+    for( int type = MD5; type <= SHA3_256; type <<= 1 ) {
+        if( types & type )
+            return ChecksumManifest( Type( type ),
+                                     d->blockSize,
+                                     d->calculator.size(),
+                                     sum,
+                                     d->calculator.blockResults() );
+    }
+
+    return ChecksumManifest();
+}
+
+
+QList<QByteArray> K3b::ChecksumPipe::blockChecksums() const
+{
+    return d->calculator.blockResults();
+}
+
+
+bool K3b::ChecksumPipe::hasDataFilter() const
+{
+    return true;
+}
+
+
+qint64 K3b::ChecksumPipe::readData( char* data, qint64 max )
+{
+    const qint64 r = K3b::ActivePipe::readData( data, max );
+    if( r <= 0 )
+        d->finish();
+    return r;
+}
+
+
 qint64 K3b::ChecksumPipe::writeData( const char* data, qint64 max )
 {
-    d->update( data, max );
+    d->addData( data, max );
     return K3b::ActivePipe::writeData( data, max );
 }
 
@@ -92,5 +159,3 @@ bool K3b::ChecksumPipe::open( OpenMode mode )
 {
     return ActivePipe::open( mode );
 }
-
-
@@ -12,11 +12,17 @@
 
 #include "k3b_export.h"
 
+#include <QByteArray>
+#include <QList>
+
 
 namespace K3b {
+    class ChecksumManifest;
+
     /**
      * The checksum pipe calculates the checksum of the data
-     * passed through it.
+     * passed through it. Several checksums can be calculated in
+     * one pass. The hashing runs in its own thread.
      */
     class LIBK3B_EXPORT ChecksumPipe : public ActivePipe
     {
@@ -27,8 +33,13 @@ namespace K3b {
         ~ChecksumPipe() override;
 
         enum Type {
-            MD5
+            MD5 = 0x1,
+            SHA1 = 0x2,
+            SHA256 = 0x4,
+            SHA512 = 0x8,
+            SHA3_256 = 0x10
         };
+        Q_DECLARE_FLAGS( Types, Type )
 
         /**
          * \reimplemented
@@ -46,11 +57,46 @@ namespace K3b {
         bool open( Type type, bool closeWhenDone = false );
 
         /**
-         * Get the calculated checksum
+         * Opens the pipe and starts the calculation of all
+         * checksums in \p types.
+         */
+        bool open( Types types, bool closeWhenDone = false );
+
+        /**
+         * Get the calculated checksum as hex string. If several
+         * checksums are calculated this is the one of the lowest type.
          */
         QByteArray checksum() const;
 
+        /**
+         * Get the calculated checksum of type \p type as hex string.
+         * Returns an empty array if \p type was not calculated.
+         */
+        QByteArray checksum( Type type ) const;
+
+        /**
+         * Additionally calculate the checksums of blocks of \p bytes bytes
+         * which can be retrieved via manifest(). 0 (the default) disables
+         * the block checksums. Has to be set before calling open().
+         */
+        void setBlockSize( qint64 bytes );
+
+        /**
+         * The checksum manifest of the data passed through the pipe.
+         * Only valid if a block size has been set.
+         */
+        ChecksumManifest manifest() const;
+
+        /**
+         * The raw checksums of the blocks which have been hashed so far.
+         * In contrast to manifest() this does not wait for the calculation
+         * to finish and can be called while data is passed through the pipe.
+         */
+        QList<QByteArray> blockChecksums() const;
+
     protected:
+        bool hasDataFilter() const override;
+        qint64 readData( char* data, qint64 max ) override;
         qint64 writeData( const char* data, qint64 max ) override;
 
     private:
@@ -64,4 +110,6 @@ namespace K3b {
     };
 }
 
+Q_DECLARE_OPERATORS_FOR_FLAGS( K3b::ChecksumPipe::Types )
+
 #endif
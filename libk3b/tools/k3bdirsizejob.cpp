@@ -13,6 +13,20 @@
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <unistd.h>
+
+
+namespace {
+    // limits the memory used by the collected entries
+    const int s_maxCollectedEntries = 100000;
+}
 
 
 class K3b::DirSizeJob::Private
@@ -20,19 +34,39 @@ class K3b::DirSizeJob::Private
 public:
     Private()
         : followSymlinks(false),
+          collectEntries(false),
           totalSize(0),
           totalFiles(0),
           totalDirs(0),
-          totalSymlinks(0) {
+          totalSymlinks(0),
+          busyWorkers(0),
+          failed(false) {
+    }
+
+    void storeEntry( const QString& path, const Entry& entry ) {
+        QMutexLocker locker( &entriesMutex );
+        if( entries.count() < s_maxCollectedEntries )
+            entries.insert( QDir::cleanPath( path ), entry );
     }
 
     QList<QUrl> urls;
     bool followSymlinks;
+    bool collectEntries;
 
     KIO::filesize_t totalSize;
     KIO::filesize_t totalFiles;
     KIO::filesize_t totalDirs;
     KIO::filesize_t totalSymlinks;
+
+    // the dirs still to be counted by the worker threads
+    QMutex mutex;
+    QWaitCondition dirAvailable;
+    QQueue< QPair<QString, Entry> > dirQueue;
+    int busyWorkers;
+    bool failed;
+
+    QMutex entriesMutex;
+    QHash<QString, Entry> entries;
 };
 
 
@@ -86,12 +120,34 @@ void K3b::DirSizeJob::setFollowSymlinks( bool b )
     d->followSymlinks = b;
 }
 
+
+void K3b::DirSizeJob::setCollectEntries( bool b )
+{
+    d->collectEntries = b;
+}
+
+
+bool K3b::DirSizeJob::takeEntry( const QString& path, Entry& entry )
+{
+    QMutexLocker locker( &d->entriesMutex );
+    QHash<QString, Entry>::iterator it = d->entries.find( QDir::cleanPath( path ) );
+    if( it == d->entries.end() )
+        return false;
+
+    entry = it.value();
+    d->entries.erase( it );
+    return true;
+}
+
 bool K3b::DirSizeJob::run()
 {
     d->totalSize = 0;
     d->totalFiles = 0;
     d->totalDirs = 0;
     d->totalSymlinks = 0;
+    d->dirQueue.clear();
+    d->busyWorkers = 0;
+    d->failed = false;
 
     QStringList l;
     for( QList<QUrl>::const_iterator it = d->urls.constBegin();
@@ -106,49 +162,142 @@ bool K3b::DirSizeJob::run()
         l.append( url.toLocalFile() );
     }
 
-    return countFiles( l, QString() );
+    if( !countFiles( l, QString() ) )
+        return false;
+
+    // only files, no need for the worker threads
+    if( d->dirQueue.isEmpty() )
+        return !canceled();
+
+    // count the queued dirs in parallel
+    QList<QThread*> threads;
+    for( int i = 1; i < QThread::idealThreadCount(); ++i ) {
+        QThread* thread = QThread::create( [this]() { runWorker(); } );
+        thread->start();
+        threads.append( thread );
+    }
+    runWorker();
+    Q_FOREACH( QThread* thread, threads ) {
+        thread->wait();
+        delete thread;
+    }
+
+    return !d->failed && !canceled();
 }
 
 
-bool K3b::DirSizeJob::countDir( const QString& dir )
+void K3b::DirSizeJob::runWorker()
+{
+    Q_FOREVER {
+        QPair<QString, Entry> dir;
+        {
+            QMutexLocker locker( &d->mutex );
+            while( d->dirQueue.isEmpty() && d->busyWorkers > 0 && !d->failed && !canceled() ) {
+                d->dirAvailable.wait( &d->mutex, 100 );
+            }
+            if( d->dirQueue.isEmpty() || d->failed || canceled() ) {
+                d->dirAvailable.wakeAll();
+                return;
+            }
+            dir = d->dirQueue.dequeue();
+            ++d->busyWorkers;
+        }
+
+        const bool success = countDir( dir.first, dir.second );
+
+        QMutexLocker locker( &d->mutex );
+        --d->busyWorkers;
+        if( !success )
+            d->failed = true;
+        d->dirAvailable.wakeAll();
+    }
+}
+
+
+bool K3b::DirSizeJob::countDir( const QString& dir, Entry& entry )
 {
     QStringList l = QDir(dir).entryList( QDir::AllEntries|QDir::Hidden|QDir::System|QDir::NoDotAndDotDot );
+    if( d->collectEntries ) {
+        entry.children = l;
+        d->storeEntry( dir, entry );
+    }
     return countFiles( l, dir );
 }
 
 
 bool K3b::DirSizeJob::countFiles( const QStringList& l, const QString& dir )
 {
+    KIO::filesize_t totalSize = 0;
+    KIO::filesize_t totalFiles = 0;
+    KIO::filesize_t totalDirs = 0;
+    KIO::filesize_t totalSymlinks = 0;
+    bool success = true;
+
     for( QStringList::const_iterator it = l.begin();
          it != l.end(); ++it ) {
 
-        if( canceled() )
-            return false;
+        if( canceled() ) {
+            success = false;
+            break;
+        }
+
+        const QString path = dir + *it;
+        const QByteArray encodedPath = QFile::encodeName( path );
+
+        Entry entry;
+        entry.followedStatValid = false;
+        entry.readable = true;
 
         k3b_struct_stat s;
-        if( k3b_lstat( QFile::encodeName( dir + *it ), &s ) )
-            return false;
+        if( k3b_lstat( encodedPath, &s ) ) {
+            success = false;
+            break;
+        }
+        entry.stat = s;
 
         if( S_ISLNK( s.st_mode ) ) {
-            ++d->totalSymlinks;
-            if( d->followSymlinks ) {
-                if( k3b_stat( QFile::encodeName( dir + *it ), &s ) )
-                    return false;
+            ++totalSymlinks;
+            if( d->followSymlinks || d->collectEntries ) {
+                k3b_struct_stat followed;
+                entry.followedStatValid = ( k3b_stat( encodedPath, &followed ) == 0 );
+                if( entry.followedStatValid )
+                    entry.followedStat = followed;
+
+                if( d->followSymlinks ) {
+                    if( !entry.followedStatValid ) {
+                        success = false;
+                        break;
+                    }
+                    s = followed;
+                }
             }
         }
+        else if( d->collectEntries ) {
+            entry.readable = ( ::access( encodedPath, R_OK ) == 0 );
+        }
 
         if( S_ISDIR( s.st_mode ) ) {
-            ++d->totalDirs;
-            if( !countDir( dir + *it + '/' ) )
-                return false;
+            ++totalDirs;
+            // the dir entry is stored once it has been listed
+            QMutexLocker locker( &d->mutex );
+            d->dirQueue.enqueue( qMakePair( path + '/', entry ) );
+            d->dirAvailable.wakeOne();
         }
-        else if( !S_ISLNK( s.st_mode ) ) {
-            ++d->totalFiles;
-            d->totalSize += (KIO::filesize_t)s.st_size;
+        else {
+            if( !S_ISLNK( s.st_mode ) ) {
+                ++totalFiles;
+                totalSize += (KIO::filesize_t)s.st_size;
+            }
+            if( d->collectEntries )
+                d->storeEntry( path, entry );
         }
     }
 
-    return true;
-}
-
+    QMutexLocker locker( &d->mutex );
+    d->totalSize += totalSize;
+    d->totalFiles += totalFiles;
+    d->totalDirs += totalDirs;
+    d->totalSymlinks += totalSymlinks;
 
+    return success;
+}
@@ -7,7 +7,9 @@
 #define _K3B_DIR_SIZE_JOB_H_
 
 #include "k3bthreadjob.h"
+#include "k3bglobals.h"
 #include <KIO/Global>
+#include <QStringList>
 #include <QUrl>
 
 #include "k3b_export.h"
@@ -19,6 +21,11 @@ namespace K3b {
      * Additionally it uses threading for enhanced speed.
      *
      * For now DirSizeJob only works on local urls.
+     *
+     * Directories are scanned by several worker threads in parallel.
+     * Optionally the stat results are kept so that users which walk the
+     * same tree afterwards (like the data project url adding) do not need
+     * to stat the files again.
      */
     class LIBK3B_EXPORT DirSizeJob : public ThreadJob
     {
@@ -47,13 +54,43 @@ namespace K3b {
          */
         KIO::filesize_t totalSymlinks() const;
 
+        /**
+         * The stat information collected for one local path.
+         */
+        struct Entry {
+            k3b_struct_stat stat;
+            k3b_struct_stat followedStat; ///< only valid for symlinks with followedStatValid set
+            bool followedStatValid;
+            bool readable;
+            QStringList children;         ///< the entries of directories, without . and ..
+        };
+
+        /**
+         * Retrieve and remove the collected information for \p path.
+         * This method is thread-safe and may be called while the job is running.
+         *
+         * \return false if the path has not been scanned (yet). In that case
+         *         the caller has to stat the path itself.
+         *
+         * \see setCollectEntries()
+         */
+        bool takeEntry( const QString& path, Entry& entry );
+
     public Q_SLOTS:
         void setUrls( const QList<QUrl>& urls );
         void setFollowSymlinks( bool );
 
+        /**
+         * If enabled the job keeps the stat results of all scanned paths which
+         * can then be retrieved via takeEntry(). The number of cached entries
+         * is limited. Defaults to false.
+         */
+        void setCollectEntries( bool );
+
     private:
         bool run() override;
-        bool countDir( const QString& dir );
+        void runWorker();
+        bool countDir( const QString& dir, Entry& entry );
         bool countFiles( const QStringList& l, const QString& dir );
 
         class Private;
@@ -10,10 +10,12 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <string.h>
 
 #include <QFile>
 
 #include "k3bdevice.h"
+#include "k3breadqueue.h"
 
 
 //
@@ -22,7 +24,15 @@
 
 K3b::Iso9660DeviceBackend::Iso9660DeviceBackend( K3b::Device::Device* dev )
     : m_device( dev ),
-      m_isOpen(false)
+      m_isOpen(false),
+      m_readQueue( 0 ),
+      m_queuedData( 0 ),
+      m_queuedDataSector( 0 ),
+      m_queuedDataSectors( 0 ),
+      m_nextQueuedSector( 0 ),
+      m_nextSector( 0 ),
+      m_lastSector( 0 ),
+      m_sequentialSectors( 0 )
 {
 }
 
@@ -40,6 +50,13 @@ bool K3b::Iso9660DeviceBackend::open()
     else if( m_device->open() ) {
         // set optimal reading speed
         m_device->setSpeed( 0xffff, 0xffff );
+
+        // we do not read ahead beyond the end of the medium
+        K3b::Msf lastSector;
+        m_lastSector = m_device->readCapacity( lastSector ) ? lastSector.lba() : 0;
+        m_nextSector = 0;
+        m_sequentialSectors = 0;
+
         m_isOpen = true;
         return true;
     }
@@ -52,6 +69,9 @@ void K3b::Iso9660DeviceBackend::close()
 {
     if( m_isOpen ) {
         m_isOpen = false;
+        delete m_readQueue;
+        m_readQueue = 0;
+        m_queuedData = 0;
         m_device->close();
     }
 }
@@ -59,32 +79,131 @@ void K3b::Iso9660DeviceBackend::close()
 
 int K3b::Iso9660DeviceBackend::read( unsigned int sector, char* data, int len )
 {
-    if( isOpen() ) {
-        //
-        // split the number of sectors to be read
-        // FIXME: use a "real" value, not some arbitrary one
-        //
-        static const int maxReadSectors = 20;
-        int sectorsRead = 0;
-        int retries = 10;  // TODO: no fixed value
-        while( retries ) {
-            int read = qMin(len-sectorsRead, maxReadSectors);
-            if( !m_device->read10( (unsigned char*)(data+sectorsRead*2048),
-                                   read*2048,
-                                   sector+sectorsRead,
-                                   read ) ) {
-                retries--;
-            }
-            else {
-                sectorsRead += read;
-                retries = 10; // new retires for every read part
-                if( sectorsRead == len )
-                    return len;
+    if( !isOpen() )
+        return -1;
+
+    //
+    // Files are mostly read front to back in small pieces. Once more than
+    // one read command worth of sectors has been read that way the following
+    // sectors are read through a queue which keeps the drive busy while the
+    // caller processes the data. Directory lookups also read a few
+    // consecutive sectors now and then, reading ahead for them would only
+    // make the next jump wait for the queue.
+    //
+    const bool sequential = ( m_sequentialSectors > 0 && sector == m_nextSector );
+    if( !sequential ) {
+        dropQueue();
+        m_sequentialSectors = 0;
+    }
+
+    int sectorsRead = 0;
+    if( sequential &&
+        m_sequentialSectors > (unsigned long)m_device->maxReadSectors() &&
+        m_lastSector > 0 ) {
+        if( !m_readQueue )
+            m_readQueue = new K3b::Device::ReadQueue( m_device );
+
+        while( sectorsRead < len ) {
+            const unsigned long current = sector + sectorsRead;
+            if( !m_queuedData ||
+                current < m_queuedDataSector ||
+                current >= m_queuedDataSector + m_queuedDataSectors ) {
+                if( !readQueued( current ) )
+                    break;
             }
+
+            const int n = qMin<unsigned long>( len - sectorsRead, m_queuedDataSector + m_queuedDataSectors - current );
+            ::memcpy( data + sectorsRead*2048, m_queuedData + ( current - m_queuedDataSector )*2048, n*2048 );
+            sectorsRead += n;
         }
+
+        fillQueue();
     }
 
-    return -1;
+    // whatever the queue could not deliver is read directly
+    if( sectorsRead < len &&
+        !readDirect( sector + sectorsRead, data + sectorsRead*2048, len - sectorsRead ) ) {
+        m_sequentialSectors = 0;
+        return -1;
+    }
+
+    m_nextSector = sector + len;
+    m_sequentialSectors += len;
+    return len;
+}
+
+
+bool K3b::Iso9660DeviceBackend::readDirect( unsigned int sector, char* data, int len )
+{
+    //
+    // split the number of sectors to be read
+    //
+    int maxReadSectors = m_device->maxReadSectors();
+    int sectorsRead = 0;
+    int retries = 10;  // TODO: no fixed value
+    while( retries ) {
+        int read = qMin(len-sectorsRead, maxReadSectors);
+        if( !m_device->read10( (unsigned char*)(data+sectorsRead*2048),
+                               read*2048,
+                               sector+sectorsRead,
+                               read ) ) {
+            // maybe the drive does not like the transfer length
+            if( read > 1 )
+                maxReadSectors = read/2;
+            retries--;
+        }
+        else {
+            sectorsRead += read;
+            retries = 10; // new retires for every read part
+            if( sectorsRead == len )
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool K3b::Iso9660DeviceBackend::readQueued( unsigned int sector )
+{
+    m_queuedData = 0;
+
+    if( m_readQueue->pending() == 0 )
+        m_nextQueuedSector = sector;
+    fillQueue();
+
+    K3b::Device::ReadQueue::Request request;
+    if( !m_readQueue->complete( request ) ||
+        !request.success ||
+        request.sector != sector ) {
+        // let readDirect() handle the error
+        m_readQueue->cancel();
+        return false;
+    }
+
+    m_queuedData = request.data;
+    m_queuedDataSector = request.sector;
+    m_queuedDataSectors = request.sectors;
+    return true;
+}
+
+
+void K3b::Iso9660DeviceBackend::fillQueue()
+{
+    while( m_nextQueuedSector <= m_lastSector ) {
+        const unsigned long sectors = qMin<unsigned long>( m_readQueue->maxSectors(), m_lastSector - m_nextQueuedSector + 1 );
+        if( !m_readQueue->submit( m_nextQueuedSector, sectors ) )
+            break;
+        m_nextQueuedSector += sectors;
+    }
+}
+
+
+void K3b::Iso9660DeviceBackend::dropQueue()
+{
+    m_queuedData = 0;
+    if( m_readQueue )
+        m_readQueue->cancel();
 }
 
 
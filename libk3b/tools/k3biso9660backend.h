@@ -15,6 +15,7 @@
 namespace K3b {
     namespace Device {
         class Device;
+        class ReadQueue;
     }
 
     class LibDvdCss;
@@ -43,8 +44,30 @@ namespace K3b {
         int read( unsigned int sector, char* data, int len ) override;
 
     private:
+        bool readDirect( unsigned int sector, char* data, int len );
+        bool readQueued( unsigned int sector );
+        void fillQueue();
+        void dropQueue();
+
         Device::Device* m_device;
         bool m_isOpen;
+
+        /**
+         * Reads ahead once the sectors are read sequentially
+         */
+        Device::ReadQueue* m_readQueue;
+        const unsigned char* m_queuedData;
+        unsigned long m_queuedDataSector;
+        unsigned long m_queuedDataSectors;
+        unsigned long m_nextQueuedSector;
+        unsigned long m_nextSector;
+        unsigned long m_lastSector;
+
+        /**
+         * The number of sectors read up to m_nextSector without a jump,
+         * 0 before the first read.
+         */
+        unsigned long m_sequentialSectors;
     };
 
     class LIBK3B_EXPORT Iso9660FileBackend : public Iso9660Backend
@@ -0,0 +1,236 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bloudnessanalyzer.h"
+
+#include <cmath>
+#include <limits>
+
+
+namespace {
+    const int SAMPLERATE = 44100;
+
+    // blocks of 400 ms start every 100 ms
+    const int HOP_FRAMES = SAMPLERATE/10;
+    const int HOPS_PER_BLOCK = 4;
+
+    const double ABSOLUTE_GATE = -70.0;
+    const double RELATIVE_GATE = -10.0;
+
+    /**
+     * Direct form I biquad
+     */
+    struct Biquad
+    {
+        double b0, b1, b2, a1, a2;
+    };
+
+    struct BiquadState
+    {
+        BiquadState() : x1( 0 ), x2( 0 ), y1( 0 ), y2( 0 ) {}
+
+        double process( const Biquad& f, double x ) {
+            const double y = f.b0*x + f.b1*x1 + f.b2*x2 - f.a1*y1 - f.a2*y2;
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            return y;
+        }
+
+        double x1, x2, y1, y2;
+    };
+
+    //
+    // The K-weighting filter of BS.1770, a high shelf followed by a high pass.
+    // The coefficients are only given for 48 kHz, so they are derived from
+    // the analog prototypes like libebur128 does.
+    //
+    Biquad highShelf()
+    {
+        const double f0 = 1681.974450955533;
+        const double G = 3.999843853973347;
+        const double Q = 0.7071752369554196;
+
+        const double K = std::tan( M_PI*f0/SAMPLERATE );
+        const double Vh = std::pow( 10.0, G/20.0 );
+        const double Vb = std::pow( Vh, 0.4996667741545416 );
+        const double a0 = 1.0 + K/Q + K*K;
+
+        Biquad f;
+        f.b0 = ( Vh + Vb*K/Q + K*K )/a0;
+        f.b1 = 2.0*( K*K - Vh )/a0;
+        f.b2 = ( Vh - Vb*K/Q + K*K )/a0;
+        f.a1 = 2.0*( K*K - 1.0 )/a0;
+        f.a2 = ( 1.0 - K/Q + K*K )/a0;
+        return f;
+    }
+
+    Biquad highPass()
+    {
+        const double f0 = 38.13547087602444;
+        const double Q = 0.5003270373238773;
+
+        const double K = std::tan( M_PI*f0/SAMPLERATE );
+        const double a0 = 1.0 + K/Q + K*K;
+
+        Biquad f;
+        f.b0 = 1.0;
+        f.b1 = -2.0;
+        f.b2 = 1.0;
+        f.a1 = 2.0*( K*K - 1.0 )/a0;
+        f.a2 = ( 1.0 - K/Q + K*K )/a0;
+        return f;
+    }
+
+    double loudness( double meanSquare )
+    {
+        return -0.691 + 10.0*std::log10( meanSquare );
+    }
+}
+
+
+const double K3b::LoudnessAnalyzer::TARGET_LOUDNESS = -18.0;
+
+
+class K3b::LoudnessAnalyzer::Private
+{
+public:
+    Private()
+        : shelf( highShelf() ),
+          pass( highPass() ) {
+    }
+
+    const Biquad shelf;
+    const Biquad pass;
+
+    BiquadState shelfState[2];
+    BiquadState passState[2];
+
+    // the energy of the last hops, the current one included
+    double hops[HOPS_PER_BLOCK];
+    int completeHops;
+    int hopFrames;
+
+    float peak;
+    QVector<float> blocks;
+};
+
+
+K3b::LoudnessAnalyzer::LoudnessAnalyzer()
+    : d( new Private() )
+{
+    reset();
+}
+
+
+K3b::LoudnessAnalyzer::~LoudnessAnalyzer()
+{
+    delete d;
+}
+
+
+void K3b::LoudnessAnalyzer::reset()
+{
+    for( int c = 0; c < 2; ++c ) {
+        d->shelfState[c] = BiquadState();
+        d->passState[c] = BiquadState();
+    }
+    for( int i = 0; i < HOPS_PER_BLOCK; ++i )
+        d->hops[i] = 0.0;
+    d->completeHops = 0;
+    d->hopFrames = 0;
+    d->peak = 0.0;
+    d->blocks.clear();
+}
+
+
+void K3b::LoudnessAnalyzer::update( const char* data, qint64 len )
+{
+    const qint64 frames = len/4;
+    double* current = &d->hops[d->completeHops % HOPS_PER_BLOCK];
+
+    for( qint64 i = 0; i < frames; ++i ) {
+        for( int c = 0; c < 2; ++c ) {
+            const char* p = data + 4*i + 2*c;
+            const qint16 sample = qint16( ( ( p[0] << 8 ) & 0xff00 ) | ( p[1] & 0x00ff ) );
+            const double x = sample/32768.0;
+            d->peak = qMax( d->peak, float( std::fabs( x ) ) );
+
+            const double y = d->passState[c].process( d->pass, d->shelfState[c].process( d->shelf, x ) );
+            *current += y*y;
+        }
+
+        if( ++d->hopFrames == HOP_FRAMES ) {
+            ++d->completeHops;
+            d->hopFrames = 0;
+
+            if( d->completeHops >= HOPS_PER_BLOCK ) {
+                double sum = 0.0;
+                for( int h = 0; h < HOPS_PER_BLOCK; ++h )
+                    sum += d->hops[h];
+                d->blocks.append( sum/( HOPS_PER_BLOCK*HOP_FRAMES ) );
+            }
+
+            current = &d->hops[d->completeHops % HOPS_PER_BLOCK];
+            *current = 0.0;
+        }
+    }
+}
+
+
+QVector<float> K3b::LoudnessAnalyzer::blocks() const
+{
+    return d->blocks;
+}
+
+
+float K3b::LoudnessAnalyzer::peak() const
+{
+    return d->peak;
+}
+
+
+double K3b::LoudnessAnalyzer::integratedLoudness( const QVector<float>& blocks )
+{
+    const double absoluteThreshold = std::pow( 10.0, ( ABSOLUTE_GATE + 0.691 )/10.0 );
+
+    double sum = 0.0;
+    int count = 0;
+    Q_FOREACH( float block, blocks ) {
+        if( block > absoluteThreshold ) {
+            sum += block;
+            ++count;
+        }
+    }
+    if( count == 0 )
+        return -std::numeric_limits<double>::infinity();
+
+    const double relativeThreshold = sum/count*std::pow( 10.0, RELATIVE_GATE/10.0 );
+
+    sum = 0.0;
+    count = 0;
+    Q_FOREACH( float block, blocks ) {
+        if( block > absoluteThreshold && block > relativeThreshold ) {
+            sum += block;
+            ++count;
+        }
+    }
+
+    return loudness( sum/count );
+}
+
+
+double K3b::LoudnessAnalyzer::gain( double loudness, float peak, double target )
+{
+    if( !std::isfinite( loudness ) )
+        return 0.0;
+
+    double g = target - loudness;
+    if( peak > 0.0f )
+        g = qMin( g, -20.0*std::log10( double( peak ) ) );
+    return g;
+}
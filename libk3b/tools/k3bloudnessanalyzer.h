@@ -0,0 +1,78 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_LOUDNESS_ANALYZER_H_
+#define _K3B_LOUDNESS_ANALYZER_H_
+
+#include "k3b_export.h"
+
+#include <QVector>
+
+
+namespace K3b {
+    /**
+     * Measures the loudness of CD audio as defined by ITU-R BS.1770
+     * and EBU R128, the same measure ReplayGain 2.0 is based on.
+     *
+     * The signal is K-weighted and split into blocks of 400 ms which
+     * overlap by 75%. The mean square of every block is kept, so the
+     * blocks of several sources can be combined into the loudness of a
+     * whole track later on.
+     */
+    class LIBK3B_EXPORT LoudnessAnalyzer
+    {
+    public:
+        /**
+         * The loudness tracks are normalized to in LUFS, the reference
+         * level of ReplayGain 2.0.
+         */
+        static const double TARGET_LOUDNESS;
+
+        LoudnessAnalyzer();
+        ~LoudnessAnalyzer();
+
+        void reset();
+
+        /**
+         * Feed 16 bit big endian stereo samples at 44.1 kHz.
+         * \p len has to be a multiple of 4.
+         */
+        void update( const char* data, qint64 len );
+
+        /**
+         * The mean square of the K-weighted signal of every complete block
+         * summed over both channels.
+         */
+        QVector<float> blocks() const;
+
+        /**
+         * The highest absolute sample value in the range [0, 1].
+         */
+        float peak() const;
+
+        /**
+         * The gated loudness of \p blocks in LUFS.
+         *
+         * \return -infinity if all blocks are below the absolute gate of
+         *         -70 LUFS, for example for silence.
+         */
+        static double integratedLoudness( const QVector<float>& blocks );
+
+        /**
+         * The gain in dB which brings audio of the given loudness to
+         * \p target without clipping its peak.
+         */
+        static double gain( double loudness, float peak, double target = TARGET_LOUDNESS );
+
+    private:
+        class Private;
+        Private* const d;
+
+        Q_DISABLE_COPY( LoudnessAnalyzer )
+    };
+}
+
+#endif
@@ -21,13 +21,28 @@
 
 #include <KCDDB/Client>
 
+#include <Solid/Device>
+#include <Solid/DeviceNotifier>
+
+
+namespace {
+    // a new medium usually becomes ready within a few seconds
+    const int MAX_RECHECKS = 10;
+}
+
 
 
 K3b::MediaCache::DeviceEntry::DeviceEntry( K3b::MediaCache* c, K3b::Device::Device* dev )
     : medium(dev),
       blockedId(0),
-      cache(c)
+      cache(c),
+      detector(dev)
 {
+    // the cache listens to Solid for media changes, but only drives Solid
+    // knows are reported. The others are polled until the first notify().
+    if( dev->solidDevice().isValid() )
+        detector.setSystemNotifications( true );
+
     thread = new K3b::MediaCache::PollThread( this );
     connect( thread, SIGNAL(mediumChanged(K3b::Device::Device*)),
              c, SLOT(_k_mediumChanged(K3b::Device::Device*)),
@@ -46,18 +61,19 @@ K3b::MediaCache::DeviceEntry::~DeviceEntry()
 
 void K3b::MediaCache::PollThread::run()
 {
-    while( m_deviceEntry->blockedId == 0 ) {
-        bool unitReady = m_deviceEntry->medium.device()->testUnitReady();
-        bool mediumCached = ( m_deviceEntry->medium.diskInfo().diskState() != K3b::Device::STATE_NO_MEDIA );
+    // read the state of the drive before the medium so we do not miss
+    // changes meanwhile
+    m_deviceEntry->detector.check();
 
-        //
-        // we only get the other information in case the disk state changed or if we have
-        // no info at all (FIXME: there are drives around that are not able to provide a proper
-        // disk state)
-        //
-        if( m_deviceEntry->medium.diskInfo().diskState() == K3b::Device::STATE_UNKNOWN ||
-            unitReady != mediumCached ) {
+    //
+    // we only get the information in case we have no info at all or the
+    // detector found a media change
+    //
+    bool update = ( m_deviceEntry->medium.diskInfo().diskState() == K3b::Device::STATE_UNKNOWN );
+    int rechecks = 0;
 
+    while( m_deviceEntry->blockedId == 0 ) {
+        if( update ) {
             if( m_deviceEntry->blockedId == 0 )
                 emit checkingMedium( m_deviceEntry->medium.device(), QString() );
 
@@ -82,6 +98,17 @@ void K3b::MediaCache::PollThread::run()
             m_deviceEntry->readMutex.unlock();
             m_deviceEntry->writeMutex.unlock();
 
+            // a medium which has just been inserted is not ready right away,
+            // but there is no need to try forever with a broken one
+            if( m_deviceEntry->detector.mediumPresent() &&
+                m.diskInfo().diskState() == K3b::Device::STATE_NO_MEDIA ) {
+                if( rechecks++ < MAX_RECHECKS )
+                    m_deviceEntry->detector.recheck();
+            }
+            else {
+                rechecks = 0;
+            }
+
             //
             // inform the media cache about the media change
             //
@@ -89,8 +116,7 @@ void K3b::MediaCache::PollThread::run()
                 emit mediumChanged( m_deviceEntry->medium.device() );
         }
 
-        if( m_deviceEntry->blockedId == 0 )
-            QThread::sleep( 2 );
+        update = m_deviceEntry->detector.waitForChange();
     }
 }
 
@@ -109,10 +135,15 @@ public:
     QMap<K3b::Device::Device*, DeviceEntry*> deviceMap;
     KCDDB::Client cddbClient;
 
+    // the udis of the media Solid reported with the drive they are in
+    QMap<QString, K3b::Device::Device*> mediumUdis;
+
     K3b::MediaCache* q;
 
     void _k_mediumChanged( K3b::Device::Device* );
     void _k_cddbJobFinished( KJob* job );
+    void _k_solidDeviceAdded( const QString& udi );
+    void _k_solidDeviceRemoved( const QString& udi );
 };
 
 
@@ -151,11 +182,48 @@ void K3b::MediaCache::Private::_k_cddbJobFinished( KJob* job )
 
 
 
+// Solid reports media as devices of their own. The drive checks right away
+// instead of waiting for its next check.
+void K3b::MediaCache::Private::_k_solidDeviceAdded( const QString& udi )
+{
+    Solid::Device solidDev( udi );
+    for( QMap<K3b::Device::Device*, DeviceEntry*>::const_iterator it = deviceMap.constBegin();
+         it != deviceMap.constEnd(); ++it ) {
+        const QString driveUdi = it.key()->solidDevice().udi();
+        if( !driveUdi.isEmpty() && ( driveUdi == udi || driveUdi == solidDev.parentUdi() ) ) {
+            qDebug() << "(K3b::MediaCache) medium" << udi << "added to" << it.key()->blockDeviceName();
+            mediumUdis.insert( udi, it.key() );
+            it.value()->detector.notify();
+        }
+    }
+}
+
+
+void K3b::MediaCache::Private::_k_solidDeviceRemoved( const QString& udi )
+{
+    // the medium is gone already, thus we have to remember its drive
+    K3b::Device::Device* dev = mediumUdis.take( udi );
+    for( QMap<K3b::Device::Device*, DeviceEntry*>::const_iterator it = deviceMap.constBegin();
+         it != deviceMap.constEnd(); ++it ) {
+        if( it.key() == dev || it.key()->solidDevice().udi() == udi ) {
+            qDebug() << "(K3b::MediaCache) medium" << udi << "removed from" << it.key()->blockDeviceName();
+            it.value()->detector.notify();
+        }
+    }
+}
+
+
+
 K3b::MediaCache::MediaCache( QObject* parent )
     : QObject( parent ),
       d( new Private() )
 {
     d->q = this;
+
+    connect( Solid::DeviceNotifier::instance(), SIGNAL(deviceAdded(QString)),
+             this, SLOT(_k_solidDeviceAdded(QString)) );
+    connect( Solid::DeviceNotifier::instance(), SIGNAL(deviceRemoved(QString)),
+             this, SLOT(_k_solidDeviceRemoved(QString)) );
 }
 
 
@@ -184,6 +252,7 @@ int K3b::MediaCache::blockDevice( K3b::Device::Device* dev )
             e->readMutex.unlock();
 
             // wait for the thread to stop
+            e->detector.cancel();
             e->thread->wait();
 
             return e->blockedId;
@@ -204,6 +273,7 @@ bool K3b::MediaCache::unblockDevice( K3b::Device::Device* dev, int id )
         e->medium = K3b::Medium( dev );
 
         // restart the poll thread
+        e->detector.reset();
         e->thread->start();
 
         return true;
@@ -305,6 +375,7 @@ void K3b::MediaCache::clearDeviceList()
     for( QMap<K3b::Device::Device*, DeviceEntry*>::iterator it = d->deviceMap.begin();
          it != d->deviceMap.end(); ++it ) {
         it.value()->blockedId = 1;
+        it.value()->detector.cancel();
     }
 
     // and remove them
@@ -316,6 +387,7 @@ void K3b::MediaCache::clearDeviceList()
     }
 
     d->deviceMap.clear();
+    d->mediumUdis.clear();
 }
 
 
@@ -379,6 +451,7 @@ void K3b::MediaCache::resetDevice( K3b::Device::Device* dev )
         e->readMutex.unlock();
         e->writeMutex.unlock();
         // no need to emit mediumChanged here. The poll thread will act on it soon
+        e->detector.recheck();
     }
 }
 
@@ -35,9 +35,9 @@ namespace K3b {
      * It should be used to get information about media and device status
      * instead of the libk3bdevice methods for faster access.
      *
-     * The Media Cache polls for new information every 2 seconds on all devices
-     * (except for blocked ones) and emits signals in case a device status changed
-     * (for example a media was inserted or removed).
+     * The Media Cache watches all devices (except for blocked ones) for media changes
+     * using media events or by polling (see MediaChangeDetector) and emits signals in
+     * case a device status changed (for example a media was inserted or removed).
      *
      * To start the media caching call buildDeviceList().
      */
@@ -170,6 +170,8 @@ namespace K3b {
 
         Q_PRIVATE_SLOT( d, void _k_mediumChanged( K3b::Device::Device* ) )
         Q_PRIVATE_SLOT( d, void _k_cddbJobFinished( KJob* job ) )
+        Q_PRIVATE_SLOT( d, void _k_solidDeviceAdded( const QString& udi ) )
+        Q_PRIVATE_SLOT( d, void _k_solidDeviceRemoved( const QString& udi ) )
     };
 }
 
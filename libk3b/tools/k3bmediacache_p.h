@@ -10,6 +10,7 @@
 #define _K3B_MEDIA_CACHE_P_H_
 
 #include "k3bmediacache.h"
+#include "k3bmediachangedetector.h"
 
 class K3b::MediaCache::DeviceEntry
 {
@@ -28,6 +29,9 @@ public:
 
     MediaCache* cache;
 
+    // tells the thread about media changes
+    MediaChangeDetector detector;
+
     void clear() {
         medium.reset();
     }
@@ -0,0 +1,237 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bmediachangedetector.h"
+#include "k3bdevice.h"
+
+#include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+
+
+namespace {
+    // media events are cheap, but without the system telling us about
+    // changes we still want to see them quickly
+    const int EVENT_INTERVAL = 2000;
+
+    // the interval once the system reports changes, only to catch the
+    // ones it missed
+    const int NOTIFIED_INTERVAL = 30000;
+
+    // polling drives without media events backs off up to this interval
+    const int MIN_POLL_INTERVAL = 2000;
+    const int MAX_POLL_INTERVAL = 16000;
+
+    const int RECHECK_INTERVAL = 1000;
+
+    class DeviceEventSource : public K3b::MediaChangeDetector::EventSource
+    {
+    public:
+        explicit DeviceEventSource( K3b::Device::Device* dev )
+            : m_device( dev ) {
+        }
+
+        bool mediaEvent( K3b::Device::MediaEvent& event, bool& mediumPresent, bool& unsupported ) override {
+            return m_device->getMediaEventStatus( event, mediumPresent, &unsupported );
+        }
+
+        bool mediumReady() override {
+            return m_device->testUnitReady();
+        }
+
+    private:
+        K3b::Device::Device* m_device;
+    };
+}
+
+
+class K3b::MediaChangeDetector::Private
+{
+public:
+    Private( EventSource* s )
+        : source( s ),
+          eventsSupported( true ),
+          checked( false ),
+          mediumPresent( false ),
+          interval( EVENT_INTERVAL ),
+          notified( false ),
+          notifyPending( false ),
+          recheckPending( false ),
+          canceled( false ) {
+    }
+
+    EventSource* source;
+
+    // only touched by the checking thread
+    bool eventsSupported;
+    bool checked;
+    bool mediumPresent;
+
+    QMutex mutex;
+    QWaitCondition condition;
+
+    int interval;
+
+    // set once the system reports changes
+    bool notified;
+
+    bool notifyPending;
+    bool recheckPending;
+    bool canceled;
+};
+
+
+K3b::MediaChangeDetector::MediaChangeDetector( Device::Device* dev )
+    : d( new Private( new DeviceEventSource( dev ) ) )
+{
+}
+
+
+K3b::MediaChangeDetector::MediaChangeDetector( EventSource* source )
+    : d( new Private( source ) )
+{
+}
+
+
+K3b::MediaChangeDetector::~MediaChangeDetector()
+{
+    delete d->source;
+    delete d;
+}
+
+
+bool K3b::MediaChangeDetector::check()
+{
+    bool changed = false;
+    bool present = false;
+    bool unsupported = false;
+    Device::MediaEvent event = Device::MEDIA_EVENT_NONE;
+    const bool wasSupported = d->eventsSupported;
+
+    if( d->eventsSupported && d->source->mediaEvent( event, present, unsupported ) ) {
+        // the kernel may have taken the event already, thus we also
+        // compare the presence
+        changed = ( event == Device::MEDIA_EVENT_NEW_MEDIA ||
+                    event == Device::MEDIA_EVENT_MEDIA_REMOVAL ||
+                    event == Device::MEDIA_EVENT_MEDIA_CHANGED );
+    }
+    else {
+        // a drive busy with another command or a bus reset does not mean
+        // there are no media events
+        if( unsupported ) {
+            qDebug() << "(K3b::MediaChangeDetector) no media events, polling the drive";
+            d->eventsSupported = false;
+        }
+        present = d->source->mediumReady();
+    }
+
+    changed = ( changed || present != d->mediumPresent );
+    d->mediumPresent = present;
+
+    // the first check only reads the state
+    if( !d->checked ) {
+        d->checked = true;
+        changed = false;
+    }
+
+    QMutexLocker locker( &d->mutex );
+    if( d->eventsSupported ) {
+        d->interval = ( d->notified ? NOTIFIED_INTERVAL : EVENT_INTERVAL );
+    }
+    else if( changed || wasSupported ) {
+        d->interval = MIN_POLL_INTERVAL;
+    }
+    else {
+        d->interval = qMin( 2*d->interval, d->notified ? NOTIFIED_INTERVAL : MAX_POLL_INTERVAL );
+    }
+
+    return changed;
+}
+
+
+bool K3b::MediaChangeDetector::waitForChange()
+{
+    QMutexLocker locker( &d->mutex );
+    while( !d->canceled ) {
+        if( !d->notifyPending ) {
+            d->condition.wait( &d->mutex, d->recheckPending ? RECHECK_INTERVAL : d->interval );
+            if( d->canceled )
+                break;
+        }
+
+        const bool forced = ( d->notifyPending || d->recheckPending );
+        d->notifyPending = false;
+        d->recheckPending = false;
+
+        locker.unlock();
+        const bool changed = check();
+        locker.relock();
+
+        if( changed || forced )
+            return !d->canceled;
+    }
+
+    return false;
+}
+
+
+void K3b::MediaChangeDetector::notify()
+{
+    QMutexLocker locker( &d->mutex );
+    d->notified = true;
+    d->notifyPending = true;
+    d->condition.wakeAll();
+}
+
+
+void K3b::MediaChangeDetector::setSystemNotifications( bool b )
+{
+    QMutexLocker locker( &d->mutex );
+    d->notified = b;
+}
+
+
+void K3b::MediaChangeDetector::recheck()
+{
+    QMutexLocker locker( &d->mutex );
+    d->recheckPending = true;
+    d->condition.wakeAll();
+}
+
+
+void K3b::MediaChangeDetector::cancel()
+{
+    QMutexLocker locker( &d->mutex );
+    d->canceled = true;
+    d->condition.wakeAll();
+}
+
+
+void K3b::MediaChangeDetector::reset()
+{
+    QMutexLocker locker( &d->mutex );
+    d->canceled = false;
+}
+
+
+bool K3b::MediaChangeDetector::eventsSupported() const
+{
+    return d->eventsSupported;
+}
+
+
+bool K3b::MediaChangeDetector::mediumPresent() const
+{
+    return d->mediumPresent;
+}
+
+
+int K3b::MediaChangeDetector::interval() const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->interval;
+}
@@ -0,0 +1,129 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_MEDIA_CHANGE_DETECTOR_H_
+#define _K3B_MEDIA_CHANGE_DETECTOR_H_
+
+#include "k3b_export.h"
+#include "k3bdevicetypes.h"
+
+#include <QtGlobal>
+
+
+namespace K3b {
+    namespace Device {
+        class Device;
+    }
+
+    /**
+     * Detects media changes in a drive for the MediaCache.
+     *
+     * Drives which support media events are asked with GET EVENT STATUS
+     * NOTIFICATION which neither spins up a drive in standby nor keeps it
+     * busy. If the system reports media changes with notify() the drive is
+     * only asked rarely.
+     *
+     * Other drives are polled with TEST UNIT READY. The interval doubles
+     * with every poll which does not find a change.
+     *
+     * waitForChange() is meant to be called from a single thread, notify()
+     * and cancel() may be called from any thread.
+     */
+    class LIBK3B_EXPORT MediaChangeDetector
+    {
+    public:
+        /**
+         * The drive the media state is read from.
+         */
+        class EventSource
+        {
+        public:
+            virtual ~EventSource() {}
+
+            /**
+             * \see Device::Device::getMediaEventStatus()
+             */
+            virtual bool mediaEvent( Device::MediaEvent& event, bool& mediumPresent, bool& unsupported ) = 0;
+
+            /**
+             * \return true if a medium is ready to be used.
+             */
+            virtual bool mediumReady() = 0;
+        };
+
+        explicit MediaChangeDetector( Device::Device* dev );
+
+        /**
+         * Takes ownership of \p source.
+         */
+        explicit MediaChangeDetector( EventSource* source );
+        ~MediaChangeDetector();
+
+        /**
+         * Reads the current state of the drive.
+         *
+         * \return true if the medium changed since the last check.
+         */
+        bool check();
+
+        /**
+         * Blocks until the medium changed.
+         *
+         * \return false if canceled.
+         */
+        bool waitForChange();
+
+        /**
+         * Tells that the system detected a media change in the drive. A
+         * waiting thread checks the drive right away.
+         */
+        void notify();
+
+        /**
+         * Tells that the system reports media changes in the drive with
+         * notify(), for example once a Solid::DeviceNotifier is connected.
+         * Used from the next check() on.
+         */
+        void setSystemNotifications( bool b );
+
+        /**
+         * Makes waitForChange() report a change shortly, for example while
+         * a new medium is not ready yet. A waiting thread does so right away.
+         */
+        void recheck();
+
+        /**
+         * Wakes up the waiting thread and makes waitForChange() return false
+         * until reset() is called.
+         */
+        void cancel();
+        void reset();
+
+        /**
+         * \return true if the drive reports media events.
+         */
+        bool eventsSupported() const;
+
+        /**
+         * \return true if the drive has a medium as of the last check.
+         */
+        bool mediumPresent() const;
+
+        /**
+         * \return The time in milliseconds waitForChange() waits before
+         *         checking the drive.
+         */
+        int interval() const;
+
+    private:
+        class Private;
+        Private* const d;
+
+        Q_DISABLE_COPY( MediaChangeDetector )
+    };
+}
+
+#endif
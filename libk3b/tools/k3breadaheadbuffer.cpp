@@ -0,0 +1,170 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3breadaheadbuffer.h"
+
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <cstring>
+
+
+class K3b::ReadAheadBuffer::Private
+{
+public:
+    Private( qint64 s )
+        : size( qMax<qint64>( 1, s ) ),
+          data( new char[size] ),
+          readPos( 0 ),
+          writePos( 0 ),
+          count( 0 ),
+          closed( false ),
+          canceled( false ) {
+    }
+
+    ~Private() {
+        delete [] data;
+    }
+
+    const qint64 size;
+    char* const data;
+
+    // only touched by the consumer and the producer respectively
+    qint64 readPos;
+    qint64 writePos;
+
+    // protected by mutex
+    qint64 count;
+    bool closed;
+    bool canceled;
+
+    mutable QMutex mutex;
+    QWaitCondition notFull;
+    QWaitCondition notEmpty;
+};
+
+
+K3b::ReadAheadBuffer::ReadAheadBuffer( qint64 size )
+    : d( new Private( size ) )
+{
+}
+
+
+K3b::ReadAheadBuffer::~ReadAheadBuffer()
+{
+    delete d;
+}
+
+
+qint64 K3b::ReadAheadBuffer::size() const
+{
+    return d->size;
+}
+
+
+qint64 K3b::ReadAheadBuffer::available() const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->count;
+}
+
+
+int K3b::ReadAheadBuffer::fillLevel() const
+{
+    return 100LL*available()/d->size;
+}
+
+
+bool K3b::ReadAheadBuffer::write( const char* data, qint64 len )
+{
+    while( len > 0 ) {
+        qint64 free = 0;
+        {
+            QMutexLocker locker( &d->mutex );
+            while( !d->canceled && !d->closed && d->count == d->size )
+                d->notFull.wait( &d->mutex );
+            if( d->canceled || d->closed )
+                return false;
+            free = d->size - d->count;
+        }
+
+        // the consumer does not touch the free part of the buffer
+        const qint64 chunk = qMin( qMin( len, free ), d->size - d->writePos );
+        ::memcpy( d->data + d->writePos, data, chunk );
+        d->writePos = ( d->writePos + chunk ) % d->size;
+        data += chunk;
+        len -= chunk;
+
+        QMutexLocker locker( &d->mutex );
+        if( d->canceled )
+            return false;
+        d->count += chunk;
+        d->notEmpty.wakeAll();
+    }
+
+    return true;
+}
+
+
+void K3b::ReadAheadBuffer::close()
+{
+    QMutexLocker locker( &d->mutex );
+    d->closed = true;
+    d->notEmpty.wakeAll();
+    d->notFull.wakeAll();
+}
+
+
+qint64 K3b::ReadAheadBuffer::read( char* data, qint64 maxlen )
+{
+    if( maxlen <= 0 )
+        return 0;
+
+    qint64 filled = 0;
+    {
+        QMutexLocker locker( &d->mutex );
+        while( !d->canceled && !d->closed && d->count == 0 )
+            d->notEmpty.wait( &d->mutex );
+        if( d->canceled )
+            return -1;
+        if( d->count == 0 )
+            return 0;
+        filled = d->count;
+    }
+
+    // the producer does not touch the filled part of the buffer
+    qint64 read = 0;
+    while( read < maxlen && read < filled ) {
+        const qint64 chunk = qMin( qMin( maxlen - read, filled - read ), d->size - d->readPos );
+        ::memcpy( data + read, d->data + d->readPos, chunk );
+        d->readPos = ( d->readPos + chunk ) % d->size;
+        read += chunk;
+    }
+
+    QMutexLocker locker( &d->mutex );
+    if( d->canceled )
+        return -1;
+    d->count -= read;
+    d->notFull.wakeAll();
+    return read;
+}
+
+
+void K3b::ReadAheadBuffer::cancel()
+{
+    QMutexLocker locker( &d->mutex );
+    d->canceled = true;
+    d->count = 0;
+    d->notEmpty.wakeAll();
+    d->notFull.wakeAll();
+}
+
+
+bool K3b::ReadAheadBuffer::isCanceled() const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->canceled;
+}
@@ -0,0 +1,84 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_READ_AHEAD_BUFFER_H_
+#define _K3B_READ_AHEAD_BUFFER_H_
+
+#include "k3b_export.h"
+
+#include <QtGlobal>
+
+
+namespace K3b {
+    /**
+     * A fixed size ring buffer which decouples a producer thread from
+     * a consumer thread. The producer blocks while the buffer is full,
+     * the consumer blocks while it is empty.
+     *
+     * It is meant for exactly one producer and one consumer. The data is
+     * copied without holding the lock, thus the producer never waits for
+     * the consumer copying data and vice versa.
+     */
+    class LIBK3B_EXPORT ReadAheadBuffer
+    {
+    public:
+        /**
+         * \param size The capacity of the buffer in bytes.
+         */
+        explicit ReadAheadBuffer( qint64 size );
+        ~ReadAheadBuffer();
+
+        qint64 size() const;
+
+        /**
+         * \return The number of bytes which can be read without blocking.
+         */
+        qint64 available() const;
+
+        /**
+         * \return The fill level of the buffer in percent.
+         */
+        int fillLevel() const;
+
+        /**
+         * Stores all of \p data. Blocks until there is enough room.
+         *
+         * \return false if the buffer has been canceled or closed.
+         */
+        bool write( const char* data, qint64 len );
+
+        /**
+         * Called by the producer once all data has been written. The
+         * consumer can still read the remaining data.
+         */
+        void close();
+
+        /**
+         * Blocks until there is data to read or the producer closed
+         * the buffer.
+         *
+         * \return The number of bytes read, 0 once all data has been read
+         *         after close(), or -1 if the buffer has been canceled.
+         */
+        qint64 read( char* data, qint64 maxlen );
+
+        /**
+         * Discards the buffered data and wakes up both sides. All
+         * following calls to write() and read() fail.
+         */
+        void cancel();
+
+        bool isCanceled() const;
+
+    private:
+        class Private;
+        Private* const d;
+
+        Q_DISABLE_COPY( ReadAheadBuffer )
+    };
+}
+
+#endif
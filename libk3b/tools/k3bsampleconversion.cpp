@@ -0,0 +1,193 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <config-libk3b.h>
+
+#include "k3bsampleconversion.h"
+
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if !HAVE_LRINTF
+#define lrintf(flt)             ((int) (flt+0.5))
+#endif
+
+
+namespace {
+    const float SCALE_TO_FLOAT = 1.0f/32768.0f;
+    const float SCALE_FROM_FLOAT = 32768.0f;
+
+    inline qint16 fromBigEndian( const char* p )
+    {
+        return qint16( ( ( p[0] << 8 ) & 0xff00 ) | ( p[1] & 0x00ff ) );
+    }
+
+    inline qint16 clip( float sample )
+    {
+        const float scaled = sample * SCALE_FROM_FLOAT;
+        if( scaled >= ( 1.0 * 0x7FFF ) )
+            return 32767;
+        else if( scaled <= ( -8.0 * 0x1000 ) )
+            return -32768;
+        else
+            return qint16( lrintf( scaled ) );
+    }
+
+#ifdef __SSE2__
+    inline __m128i swap16( __m128i v )
+    {
+        return _mm_or_si128( _mm_slli_epi16( v, 8 ), _mm_srli_epi16( v, 8 ) );
+    }
+
+    inline __m128i toInt32( __m128 v )
+    {
+        // NaN compares unordered and is replaced by 0 like lrintf does on x86
+        v = _mm_and_ps( v, _mm_cmpord_ps( v, v ) );
+        v = _mm_mul_ps( v, _mm_set1_ps( SCALE_FROM_FLOAT ) );
+        v = _mm_min_ps( _mm_max_ps( v, _mm_set1_ps( -32768.0f ) ), _mm_set1_ps( 32767.0f ) );
+        return _mm_cvtps_epi32( v );
+    }
+#endif
+}
+
+
+void K3b::SampleConversion::swapByteOrder16( char* data, qint64 samples )
+{
+    qint64 i = 0;
+#ifdef __SSE2__
+    for( ; i + 8 <= samples; i += 8 ) {
+        __m128i* p = reinterpret_cast<__m128i*>( data + 2*i );
+        _mm_storeu_si128( p, swap16( _mm_loadu_si128( p ) ) );
+    }
+#endif
+    for( ; i < samples; ++i ) {
+        const char b = data[2*i];
+        data[2*i] = data[2*i+1];
+        data[2*i+1] = b;
+    }
+}
+
+
+void K3b::SampleConversion::from16BitBeToFloat( const char* src, float* dest, qint64 samples )
+{
+    qint64 i = 0;
+#ifdef __SSE2__
+    const __m128 scale = _mm_set1_ps( SCALE_TO_FLOAT );
+    for( ; i + 8 <= samples; i += 8 ) {
+        const __m128i v = swap16( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + 2*i ) ) );
+        // sign extend by moving the samples to the upper half first
+        const __m128i lo = _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 );
+        const __m128i hi = _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 );
+        _mm_storeu_ps( dest + i, _mm_mul_ps( _mm_cvtepi32_ps( lo ), scale ) );
+        _mm_storeu_ps( dest + i + 4, _mm_mul_ps( _mm_cvtepi32_ps( hi ), scale ) );
+    }
+#endif
+    for( ; i < samples; ++i )
+        dest[i] = fromBigEndian( src + 2*i ) * SCALE_TO_FLOAT;
+}
+
+
+void K3b::SampleConversion::fromFloatTo16BitBe( const float* src, char* dest, qint64 samples )
+{
+    qint64 i = 0;
+#ifdef __SSE2__
+    for( ; i + 8 <= samples; i += 8 ) {
+        const __m128i lo = toInt32( _mm_loadu_ps( src + i ) );
+        const __m128i hi = toInt32( _mm_loadu_ps( src + i + 4 ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dest + 2*i ), swap16( _mm_packs_epi32( lo, hi ) ) );
+    }
+#endif
+    for( ; i < samples; ++i ) {
+        const qint16 val = clip( src[i] );
+        dest[2*i]   = val>>8;
+        dest[2*i+1] = val;
+    }
+}
+
+
+void K3b::SampleConversion::applyGain16BitBe( char* data, qint64 samples, float factor )
+{
+    qint64 i = 0;
+#ifdef __SSE2__
+    const __m128 scale = _mm_set1_ps( SCALE_TO_FLOAT );
+    const __m128 gain = _mm_set1_ps( factor );
+    for( ; i + 8 <= samples; i += 8 ) {
+        __m128i* p = reinterpret_cast<__m128i*>( data + 2*i );
+        const __m128i v = swap16( _mm_loadu_si128( p ) );
+        const __m128i lo = _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 );
+        const __m128i hi = _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 );
+        const __m128i loScaled = toInt32( _mm_mul_ps( _mm_mul_ps( _mm_cvtepi32_ps( lo ), scale ), gain ) );
+        const __m128i hiScaled = toInt32( _mm_mul_ps( _mm_mul_ps( _mm_cvtepi32_ps( hi ), scale ), gain ) );
+        _mm_storeu_si128( p, swap16( _mm_packs_epi32( loScaled, hiScaled ) ) );
+    }
+#endif
+    for( ; i < samples; ++i ) {
+        const qint16 val = clip( fromBigEndian( data + 2*i ) * SCALE_TO_FLOAT * factor );
+        data[2*i]   = val>>8;
+        data[2*i+1] = val;
+    }
+}
+
+
+void K3b::SampleConversion::from8BitTo16BitBe( const char* src, char* dest, qint64 samples )
+{
+    qint64 i = 0;
+#ifdef __SSE2__
+    // (s - 128) * 256 is the signed sample in the high byte and a zero low byte
+    const __m128i sign = _mm_set1_epi8( char( 0x80 ) );
+    const __m128i zero = _mm_setzero_si128();
+    for( ; i + 16 <= samples; i += 16 ) {
+        const __m128i v = _mm_xor_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) ), sign );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dest + 2*i ), _mm_unpacklo_epi8( v, zero ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dest + 2*i + 16 ), _mm_unpackhi_epi8( v, zero ) );
+    }
+#endif
+    for( ; i < samples; ++i ) {
+        dest[2*i]   = char( quint8( src[i] ) ^ 0x80 );
+        dest[2*i+1] = 0;
+    }
+}
+
+
+void K3b::SampleConversion::monoToStereo16( const char* src, char* dest, qint64 samples )
+{
+    qint64 i = 0;
+#ifdef __SSE2__
+    for( ; i + 8 <= samples; i += 8 ) {
+        const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + 2*i ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dest + 4*i ), _mm_unpacklo_epi16( v, v ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dest + 4*i + 16 ), _mm_unpackhi_epi16( v, v ) );
+    }
+#endif
+    for( ; i < samples; ++i ) {
+        dest[4*i] = dest[4*i+2] = src[2*i];
+        dest[4*i+1] = dest[4*i+3] = src[2*i+1];
+    }
+}
+
+
+void K3b::SampleConversion::from16BitLeStereoToFloat( const char* src, float* left, float* right, qint64 frames )
+{
+    qint64 i = 0;
+#ifdef __SSE2__
+    // x86 is little endian, so every 32 bit lane holds the left sample in its lower half
+    const __m128 scale = _mm_set1_ps( SCALE_TO_FLOAT );
+    for( ; i + 4 <= frames; i += 4 ) {
+        const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + 4*i ) );
+        const __m128i l = _mm_srai_epi32( _mm_slli_epi32( v, 16 ), 16 );
+        const __m128i r = _mm_srai_epi32( v, 16 );
+        _mm_storeu_ps( left + i, _mm_mul_ps( _mm_cvtepi32_ps( l ), scale ) );
+        _mm_storeu_ps( right + i, _mm_mul_ps( _mm_cvtepi32_ps( r ), scale ) );
+    }
+#endif
+    for( ; i < frames; ++i ) {
+        left[i] = qint16( ( src[4*i+1] << 8 ) | ( 0x00ff & src[4*i] ) ) * SCALE_TO_FLOAT;
+        right[i] = qint16( ( src[4*i+3] << 8 ) | ( 0x00ff & src[4*i+2] ) ) * SCALE_TO_FLOAT;
+    }
+}
@@ -0,0 +1,70 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_SAMPLE_CONVERSION_H_
+#define _K3B_SAMPLE_CONVERSION_H_
+
+#include "k3b_export.h"
+
+#include <QtGlobal>
+
+
+namespace K3b {
+    /**
+     * Conversion kernels for audio samples shared by the decoders and
+     * the encoders.
+     *
+     * On x86 the kernels process several samples at once with SSE2, on
+     * other platforms plain loops are used. Both produce exactly the same
+     * output. Floats are converted with the current rounding mode like
+     * lrintf does.
+     *
+     * Counts are given in samples, not in bytes. Source and destination
+     * must not overlap unless stated otherwise.
+     */
+    namespace SampleConversion {
+        /**
+         * Swaps the bytes of 16 bit samples in place.
+         */
+        LIBK3B_EXPORT void swapByteOrder16( char* data, qint64 samples );
+
+        /**
+         * Converts 16 bit big endian samples to floats in the range [-1, 1).
+         */
+        LIBK3B_EXPORT void from16BitBeToFloat( const char* src, float* dest, qint64 samples );
+
+        /**
+         * Converts floats to 16 bit big endian samples. Values outside
+         * of the range [-1, 1) are clipped, NaN is converted to 0.
+         */
+        LIBK3B_EXPORT void fromFloatTo16BitBe( const float* src, char* dest, qint64 samples );
+
+        /**
+         * Multiplies 16 bit big endian samples in place by \p factor.
+         * The result is clipped like in fromFloatTo16BitBe().
+         */
+        LIBK3B_EXPORT void applyGain16BitBe( char* data, qint64 samples, float factor );
+
+        /**
+         * Converts unsigned 8 bit samples to 16 bit big endian samples.
+         */
+        LIBK3B_EXPORT void from8BitTo16BitBe( const char* src, char* dest, qint64 samples );
+
+        /**
+         * Duplicates 16 bit mono samples into interleaved stereo samples.
+         * \p dest has to hold 2*samples samples. The byte order is kept.
+         */
+        LIBK3B_EXPORT void monoToStereo16( const char* src, char* dest, qint64 samples );
+
+        /**
+         * Splits interleaved 16 bit little endian stereo samples into
+         * one float buffer per channel.
+         */
+        LIBK3B_EXPORT void from16BitLeStereoToFloat( const char* src, float* left, float* right, qint64 frames );
+    }
+}
+
+#endif
@@ -4,8 +4,11 @@
 */
 
 #include "k3bwavefilewriter.h"
+#include "k3bsampleconversion.h"
 #include <QDebug>
 
+#include <cstring>
+
 K3b::WaveFileWriter::WaveFileWriter()
     : m_outputStream( &m_outputFile )
 {
@@ -85,10 +88,8 @@ void K3b::WaveFileWriter::write( const char* data, int len, Endianess e )
 
             // we need to swap the bytes
             char* buffer = new char[len];
-            for( int i = 0; i < len-1; i+=2 ) {
-                buffer[i] = data[i+1];
-                buffer[i+1] = data[i];
-            }
+            ::memcpy( buffer, data, len );
+            K3b::SampleConversion::swapByteOrder16( buffer, len/2 );
             m_outputStream.writeRawData( buffer, len );
 
             delete [] buffer;
@@ -0,0 +1,199 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bwaveformpeaks.h"
+
+#include <QDataStream>
+
+
+namespace {
+    const quint32 PEAKS_MAGIC = 0x4B335750; // "K3WP"
+    const quint32 PEAKS_VERSION = 1;
+
+    const int FRAMES_PER_SECTOR = 588;
+
+    // every level combines this many values of the level below
+    const int LEVEL_FACTOR = 4;
+    const int LEVEL_SHIFT = 2;
+
+    inline void combine( K3b::WaveformPeaks::Peak& p, const K3b::WaveformPeaks::Peak& other )
+    {
+        p.min = qMin( p.min, other.min );
+        p.max = qMax( p.max, other.max );
+    }
+}
+
+
+K3b::WaveformPeaks::WaveformPeaks()
+{
+    clear();
+}
+
+
+void K3b::WaveformPeaks::clear()
+{
+    m_levels.clear();
+    m_levels.resize( 1 );
+    m_sectorSamples = 0;
+    m_sectorMin = 0;
+    m_sectorMax = 0;
+}
+
+
+void K3b::WaveformPeaks::update( const char* data, qint64 len )
+{
+    // the coarser levels are outdated now
+    m_levels.resize( 1 );
+
+    const qint64 frames = len/4;
+    for( qint64 i = 0; i < frames; ++i ) {
+        for( int c = 0; c < 2; ++c ) {
+            const char* p = data + 4*i + 2*c;
+            const qint16 sample = qint16( ( ( p[0] << 8 ) & 0xff00 ) | ( p[1] & 0x00ff ) );
+            if( m_sectorSamples == 0 && c == 0 ) {
+                m_sectorMin = m_sectorMax = sample;
+            }
+            else {
+                m_sectorMin = qMin( m_sectorMin, sample );
+                m_sectorMax = qMax( m_sectorMax, sample );
+            }
+        }
+
+        if( ++m_sectorSamples == FRAMES_PER_SECTOR )
+            addSectorPeak();
+    }
+}
+
+
+void K3b::WaveformPeaks::addSectorPeak()
+{
+    m_levels[0].append( Peak( qint8( m_sectorMin >> 8 ), qint8( m_sectorMax >> 8 ) ) );
+    m_sectorSamples = 0;
+    m_sectorMin = 0;
+    m_sectorMax = 0;
+}
+
+
+void K3b::WaveformPeaks::appendSilence( int sectors )
+{
+    if( m_sectorSamples > 0 )
+        addSectorPeak();
+    m_levels.resize( 1 );
+
+    if( sectors > 0 )
+        m_levels[0].insert( m_levels[0].size(), sectors, Peak() );
+}
+
+
+void K3b::WaveformPeaks::append( const WaveformPeaks& other, int first, int count )
+{
+    if( m_sectorSamples > 0 )
+        addSectorPeak();
+    m_levels.resize( 1 );
+
+    const QVector<Peak>& src = other.m_levels[0];
+    QVector<Peak>& dest = m_levels[0];
+    dest.reserve( dest.size() + qMax( 0, count ) );
+    for( int i = first; i < first + count; ++i ) {
+        if( i >= 0 && i < src.size() )
+            dest.append( src[i] );
+        else
+            dest.append( Peak() );
+    }
+}
+
+
+void K3b::WaveformPeaks::finish()
+{
+    if( m_sectorSamples > 0 )
+        addSectorPeak();
+
+    m_levels.resize( 1 );
+    while( m_levels.last().size() > LEVEL_FACTOR ) {
+        const QVector<Peak>& below = m_levels.last();
+        QVector<Peak> level( ( below.size() + LEVEL_FACTOR - 1 )/LEVEL_FACTOR );
+        for( int i = 0; i < level.size(); ++i ) {
+            Peak p = below[i*LEVEL_FACTOR];
+            for( int j = i*LEVEL_FACTOR + 1; j < qMin( below.size(), ( i + 1 )*LEVEL_FACTOR ); ++j )
+                combine( p, below[j] );
+            level[i] = p;
+        }
+        m_levels.append( level );
+    }
+}
+
+
+int K3b::WaveformPeaks::sectors() const
+{
+    return m_levels[0].size() + ( m_sectorSamples > 0 ? 1 : 0 );
+}
+
+
+K3b::WaveformPeaks::Peak K3b::WaveformPeaks::peak( int first, int last ) const
+{
+    first = qMax( first, 0 );
+    last = qMin( last, m_levels[0].size() - 1 );
+    if( first > last )
+        return Peak();
+
+    // the coarsest level with buckets not larger than the range. The range
+    // spans at most five of its buckets.
+    const int count = last - first + 1;
+    int level = 0;
+    while( level + 1 < m_levels.size() && ( 1 << ( LEVEL_SHIFT*( level + 1 ) ) ) <= count )
+        ++level;
+
+    const QVector<Peak>& peaks = m_levels[level];
+    const int shift = LEVEL_SHIFT*level;
+    Peak p = peaks[first >> shift];
+    for( int i = ( first >> shift ) + 1; i <= ( last >> shift ); ++i )
+        combine( p, peaks[i] );
+    return p;
+}
+
+
+QByteArray K3b::WaveformPeaks::toByteArray() const
+{
+    const QVector<Peak>& peaks = m_levels[0];
+    QByteArray raw( 2*peaks.size(), Qt::Uninitialized );
+    for( int i = 0; i < peaks.size(); ++i ) {
+        raw[2*i] = char( peaks[i].min );
+        raw[2*i+1] = char( peaks[i].max );
+    }
+
+    QByteArray data;
+    QDataStream s( &data, QIODevice::WriteOnly );
+    s.setVersion( QDataStream::Qt_5_0 );
+    s << PEAKS_MAGIC << PEAKS_VERSION << raw;
+    return data;
+}
+
+
+bool K3b::WaveformPeaks::fromByteArray( const QByteArray& data )
+{
+    QDataStream s( data );
+    s.setVersion( QDataStream::Qt_5_0 );
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray raw;
+    s >> magic >> version >> raw;
+    if( s.status() != QDataStream::Ok ||
+        magic != PEAKS_MAGIC ||
+        version != PEAKS_VERSION ||
+        raw.size() % 2 ) {
+        return false;
+    }
+
+    clear();
+    QVector<Peak>& peaks = m_levels[0];
+    peaks.resize( raw.size()/2 );
+    for( int i = 0; i < peaks.size(); ++i )
+        peaks[i] = Peak( qint8( raw[2*i] ), qint8( raw[2*i+1] ) );
+    finish();
+
+    return true;
+}
@@ -0,0 +1,107 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef _K3B_WAVEFORM_PEAKS_H_
+#define _K3B_WAVEFORM_PEAKS_H_
+
+#include "k3b_export.h"
+
+#include <QByteArray>
+#include <QVector>
+
+
+namespace K3b {
+    /**
+     * The minimum and maximum sample values of CD audio for drawing its
+     * waveform at any zoom level.
+     *
+     * The finest level holds one pair per sector, each further level
+     * combines four pairs of the level below. Thus looking up the peaks
+     * of any range takes at most a handful of lookups, no matter how long
+     * the range is. Both channels are combined and the values are reduced
+     * to 8 bits which is plenty for drawing. The levels take about 2.7
+     * bytes per sector, less than 1 MB for 80 minutes of audio.
+     */
+    class LIBK3B_EXPORT WaveformPeaks
+    {
+    public:
+        struct Peak
+        {
+            Peak() : min( 0 ), max( 0 ) {}
+            Peak( qint8 mi, qint8 ma ) : min( mi ), max( ma ) {}
+
+            qint8 min;
+            qint8 max;
+
+            bool operator==( const Peak& other ) const { return min == other.min && max == other.max; }
+        };
+
+        WaveformPeaks();
+
+        void clear();
+
+        /**
+         * Add 16 bit big endian stereo samples. \p len has to be a multiple of 4.
+         * Call finish() once all data has been added.
+         */
+        void update( const char* data, qint64 len );
+
+        /**
+         * Add \p sectors sectors of silence.
+         */
+        void appendSilence( int sectors );
+
+        /**
+         * Add the sectors [first, first+count) of \p other. Sectors
+         * beyond the end of \p other are added as silence.
+         */
+        void append( const WaveformPeaks& other, int first, int count );
+
+        /**
+         * Completes the last sector and calculates the coarser levels.
+         * Needs to be called before using peak().
+         */
+        void finish();
+
+        /**
+         * The number of sectors, an incomplete last sector included.
+         */
+        int sectors() const;
+
+        /**
+         * The peaks of the sectors [first, last]. The lookup uses the coarsest
+         * level which still has several values in the range. Thus the result
+         * may include up to (last-first) sectors before and after the range,
+         * which is less than one pixel when drawing.
+         */
+        Peak peak( int first, int last ) const;
+
+        /**
+         * The finest level in a compact form for storing it.
+         */
+        QByteArray toByteArray() const;
+
+        /**
+         * \return false if \p data has not been created by toByteArray().
+         */
+        bool fromByteArray( const QByteArray& data );
+
+    private:
+        void addSectorPeak();
+
+        // levels[0] has one peak per sector
+        QVector<QVector<Peak> > m_levels;
+
+        // the sector currently being added to
+        int m_sectorSamples;
+        qint16 m_sectorMin;
+        qint16 m_sectorMax;
+    };
+}
+
+Q_DECLARE_TYPEINFO( K3b::WaveformPeaks::Peak, Q_PRIMITIVE_TYPE );
+
+#endif
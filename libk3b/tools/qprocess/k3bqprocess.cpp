@@ -913,6 +913,26 @@ void K3bQProcess::setFlags( K3bQProcess::ProcessFlags flags )
     d->processFlags = flags;
 }
 
+int K3bQProcess::stdinFd() const
+{
+#ifdef Q_OS_UNIX
+    Q_D(const K3bQProcess);
+    if ( d->processFlags & RawStdin )
+        return d->stdinChannel.pipe[1];
+#endif
+    return -1;
+}
+
+int K3bQProcess::stdoutFd() const
+{
+#ifdef Q_OS_UNIX
+    Q_D(const K3bQProcess);
+    if ( d->processFlags & RawStdout )
+        return d->stdoutChannel.pipe[0];
+#endif
+    return -1;
+}
+
 /*!
     \obsolete
     Returns the read channel mode of the QProcess. This function is
@@ -119,6 +119,18 @@ public:
     ProcessFlags flags() const;
     void setFlags( ProcessFlags flags );
 
+    /**
+     * The file descriptor of the process' stdin in RawStdin mode.
+     * Returns -1 if RawStdin is not set or the process is not running.
+     */
+    int stdinFd() const;
+
+    /**
+     * The file descriptor of the process' stdout in RawStdout mode.
+     * Returns -1 if RawStdout is not set or the process is not running.
+     */
+    int stdoutFd() const;
+
     ::QProcess::ProcessChannel readChannel() const;
     void setReadChannel(::QProcess::ProcessChannel channel);
 
@@ -25,6 +25,7 @@
 #include <qglobal.h>
 #include <QDebug>
 #include <QFile>
+#include <QFileInfo>
 #include <QMutex>
 #include <QStringList>
 
@@ -65,6 +66,10 @@ typedef unsigned char u8;
 #include <sys/cdio.h>
 #endif
 
+#ifdef Q_OS_WIN32
+#include <winioctl.h>
+#endif
+
 #ifdef HAVE_RESMGR
 extern "C" {
 #include <resmgr.h>
@@ -105,6 +110,12 @@ namespace {
         else
             return 3324;
     }
+
+    // what K3b read at once before the limits were determined
+    const int DEFAULT_MAX_TRANSFER_LENGTH = 128*2048;
+
+    // keeps the read buffers reasonable with systems reporting no real limit
+    const int MAX_TRANSFER_LENGTH = 4*1024*1024;
 }
 
 class K3b::Device::Device::Private
@@ -113,7 +124,10 @@ public:
     Private()
         : deviceHandle(HANDLE_DEFAULT_VALUE),
           openedReadWrite(false),
-          burnfree(false) {
+          burnfree(false),
+          maxTransferLength(DEFAULT_MAX_TRANSFER_LENGTH),
+          systemMaxTransferLength(DEFAULT_MAX_TRANSFER_LENGTH),
+          transport(0) {
     }
 
     Solid::Device solidDevice;
@@ -141,6 +155,11 @@ public:
     bool openedReadWrite;
     bool burnfree;
 
+    int maxTransferLength;
+    int systemMaxTransferLength;
+
+    ScsiTransport* transport;
+
     QMutex mutex;
     QMutex openCloseMutex;
 };
@@ -256,9 +275,24 @@ K3b::Device::Device::Device( const Solid::Device& dev )
 }
 
 
+K3b::Device::Device::Device( const QString& name, ScsiTransport* transport )
+{
+    d = new Private;
+    d->transport = transport;
+    d->blockDevice = name;
+    d->writeModes = {};
+    d->maxWriteSpeed = 0;
+    d->maxReadSpeed = 0;
+    d->burnfree = false;
+    d->dvdMinusTestwrite = true;
+    d->bufferSize = 0;
+}
+
+
 K3b::Device::Device::~Device()
 {
     close();
+    delete d->transport;
     delete d;
 }
 
@@ -305,6 +339,18 @@ int K3b::Device::Device::bufferSize() const
 }
 
 
+int K3b::Device::Device::maxTransferLength() const
+{
+    return d->maxTransferLength;
+}
+
+
+int K3b::Device::Device::maxReadSectors( int sectorSize ) const
+{
+    return qMax( 1, d->maxTransferLength / qMax( 1, sectorSize ) );
+}
+
+
 QString K3b::Device::Device::blockDeviceName() const
 {
     return d->blockDevice;
@@ -335,6 +381,18 @@ void K3b::Device::Device::setMaxWriteSpeed( int s )
 }
 
 
+void K3b::Device::Device::setMaxTransferLength( int bytes )
+{
+    d->maxTransferLength = qBound( 2048, bytes, MAX_TRANSFER_LENGTH );
+}
+
+
+int K3b::Device::Device::systemMaxTransferLength() const
+{
+    return d->systemMaxTransferLength;
+}
+
+
 Solid::Device K3b::Device::Device::solidDevice() const
 {
     return d->solidDevice;
@@ -343,6 +401,10 @@ Solid::Device K3b::Device::Device::solidDevice() const
 
 Solid::StorageAccess* K3b::Device::Device::solidStorage() const
 {
+     // simulated devices are unknown to Solid
+     if( !d->solidDevice.isValid() )
+         return nullptr;
+
      QList<Solid::Device> storages = Solid::Device::listFromType( Solid::DeviceInterface::StorageAccess, d->solidDevice.udi() );
      if( storages.isEmpty() )
          return nullptr;
@@ -351,6 +413,12 @@ Solid::StorageAccess* K3b::Device::Device::solidStorage() const
 }
 
 
+K3b::Device::ScsiTransport* K3b::Device::Device::scsiTransport() const
+{
+    return d->transport;
+}
+
+
 bool K3b::Device::Device::init( bool bCheckWritingModes )
 {
     qDebug() << "(K3b::Device::Device) " << blockDeviceName() << ": init()";
@@ -426,6 +494,9 @@ bool K3b::Device::Device::init( bool bCheckWritingModes )
     //
     checkForAncientWriters();
 
+    d->maxTransferLength = d->systemMaxTransferLength = determineMaxTransferLength();
+    qDebug() << "(K3b::Device::Device) " << blockDeviceName() << ": max transfer length: " << d->maxTransferLength;
+
     //
     // If it can be written it can also be read
     //
@@ -439,6 +510,10 @@ bool K3b::Device::Device::init( bool bCheckWritingModes )
 
 bool K3b::Device::Device::furtherInit()
 {
+    // the transport of a simulated device answers the MMC commands only
+    if( d->transport )
+        return true;
+
 #ifdef Q_OS_LINUX
 
     //
@@ -478,6 +553,105 @@ bool K3b::Device::Device::furtherInit()
 }
 
 
+int K3b::Device::Device::determineMaxTransferLength() const
+{
+    qint64 max = MAX_TRANSFER_LENGTH;
+    bool found = false;
+
+    //
+    // The Block Limits VPD page (SPC-4) is rare with optical drives but
+    // if the drive has one we respect it.
+    //
+    unsigned char buf[16];
+    ::memset( buf, 0, sizeof(buf) );
+    ScsiCommand cmd( this );
+    cmd.enableErrorMessages( false );
+    cmd[0] = MMC_INQUIRY;
+    cmd[1] = 0x1;   // EVPD
+    cmd[2] = 0xB0;  // Block Limits
+    cmd[4] = sizeof(buf);
+    cmd[5] = 0;
+    if( cmd.transport( TR_DIR_READ, buf, sizeof(buf) ) == 0 && buf[1] == 0xB0 ) {
+        const qint64 blocks = from4Byte( &buf[8] );
+        if( blocks > 0 ) {
+            max = qMin( max, blocks*2048 );
+            found = true;
+        }
+    }
+
+    // the system limits do not apply to simulated devices
+    if( !d->transport ) {
+#ifdef Q_OS_LINUX
+        //
+        // SG_IO fails with requests larger than the queue allows. Since the
+        // buffer is mapped page by page it also has to fit into the segments.
+        //
+        const QString queue = QString( "/sys/block/%1/queue/" )
+                              .arg( QFileInfo( blockDeviceName() ).canonicalFilePath().section( '/', -1 ) );
+        QFile f( queue + "max_hw_sectors_kb" );
+        if( f.open( QIODevice::ReadOnly ) ) {
+            const qint64 kb = f.readAll().trimmed().toLongLong();
+            if( kb > 0 ) {
+                max = qMin( max, kb*1024 );
+                found = true;
+            }
+            f.close();
+        }
+        f.setFileName( queue + "max_segments" );
+        if( f.open( QIODevice::ReadOnly ) ) {
+            const qint64 segments = f.readAll().trimmed().toLongLong();
+            if( segments > 0 ) {
+                max = qMin( max, segments*::getpagesize() );
+                found = true;
+            }
+        }
+#endif
+#ifdef Q_OS_FREEBSD
+        union ccb* ccb = cam_getccb( handle() );
+        if( ccb ) {
+            ccb->ccb_h.func_code = XPT_PATH_INQ;
+            if( cam_send_ccb( handle(), ccb ) == 0 &&
+                ( ccb->ccb_h.status & CAM_STATUS_MASK ) == CAM_REQ_CMP &&
+                ccb->cpi.maxio > 0 ) {
+                max = qMin<qint64>( max, ccb->cpi.maxio );
+                found = true;
+            }
+            cam_freeccb( ccb );
+        }
+#endif
+#ifdef Q_OS_NETBSD
+        // SCIOCCOMMAND is limited by MAXPHYS, 31 sectors always worked
+        max = qMin<qint64>( max, 31*2048 );
+        found = true;
+#endif
+#ifdef Q_OS_WIN32
+        STORAGE_PROPERTY_QUERY query;
+        ::memset( &query, 0, sizeof(query) );
+        query.PropertyId = StorageAdapterProperty;
+        query.QueryType = PropertyStandardQuery;
+        STORAGE_ADAPTER_DESCRIPTOR adapter;
+        ::memset( &adapter, 0, sizeof(adapter) );
+        DWORD returned = 0;
+        if( DeviceIoControl( handle(), IOCTL_STORAGE_QUERY_PROPERTY,
+                             &query, sizeof(query), &adapter, sizeof(adapter), &returned, NULL ) &&
+            adapter.MaximumTransferLength > 0 ) {
+            max = qMin<qint64>( max, adapter.MaximumTransferLength );
+            // every page of the buffer needs a descriptor
+            if( adapter.MaximumPhysicalPages > 1 )
+                max = qMin<qint64>( max, qint64( adapter.MaximumPhysicalPages - 1 )*4096 );
+            found = true;
+        }
+#endif
+    }
+
+    if( !found )
+        return DEFAULT_MAX_TRANSFER_LENGTH;
+
+    // whole data sectors
+    return qMax( 2048, int( max - max % 2048 ) );
+}
+
+
 void K3b::Device::Device::checkForAncientWriters()
 {
     // TODO: add a boolean which determines if this device is non-MMC so we may warn the user at K3b startup about it
@@ -1759,6 +1933,9 @@ K3b::Device::Device::Handle K3b::Device::Device::handle() const
 
 bool K3b::Device::Device::open( bool write ) const
 {
+    if( d->transport )
+        return true;
+
     if( d->openedReadWrite != write )
         close();
 
@@ -1793,7 +1970,7 @@ void K3b::Device::Device::close() const
 
 bool K3b::Device::Device::isOpen() const
 {
-    return ( d->deviceHandle != HANDLE_DEFAULT_VALUE);
+    return ( d->transport || d->deviceHandle != HANDLE_DEFAULT_VALUE);
 }
 
 
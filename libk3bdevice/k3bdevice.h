@@ -37,6 +37,7 @@ namespace K3b {
     namespace Device
     {
         class Toc;
+        class ScsiTransport;
 
         typedef QVarLengthArray< unsigned char > UByteArray;
 
@@ -74,6 +75,14 @@ namespace K3b {
              */
             Solid::StorageAccess* solidStorage() const;
 
+            /**
+             * \return The transport which executes the commands of a simulated
+             *         device or 0 for real drives.
+             *
+             * \sa DeviceManager::addSimulatedDevice()
+             */
+            ScsiTransport* scsiTransport() const;
+
             /**
              * \deprecated use readCapabilities() and writeCapabilities()
              * The device type.
@@ -208,6 +217,22 @@ namespace K3b {
              */
             int bufferSize() const;
 
+            /**
+             * The largest amount of data the device and the system transfer
+             * with one read command. It is determined once by init() from the
+             * limits of the system and the drive's block limits.
+             *
+             * \return The maximum transfer length in bytes.
+             */
+            int maxTransferLength() const;
+
+            /**
+             * Shortcut for maxTransferLength() / \p sectorSize
+             *
+             * \return The number of sectors to read at once, at least 1.
+             */
+            int maxReadSectors( int sectorSize = 2048 ) const;
+
             /**
              * for SCSI devices this should be something like /dev/scd0 or /dev/sr0
              * for IDE device this should be something like /dev/hdb1
@@ -232,6 +257,11 @@ namespace K3b {
              */
             void setMaxWriteSpeed( int s );
 
+            /**
+             * Use this if the drive rejects reads of maxTransferLength() bytes.
+             */
+            void setMaxTransferLength( int bytes );
+
             /**
              * checks if unit is ready (medium inserted and ready for command)
              *
@@ -506,6 +536,24 @@ namespace K3b {
              */
             bool mechanismStatus( UByteArray& data ) const;
 
+            /**
+             * Polls the media event class of the drive.
+             * Unlike testUnitReady() this does not spin up a drive which
+             * is in standby.
+             *
+             * Refers to the MMC command: GET EVENT STATUS NOTIFICATION
+             *
+             * \param event The oldest pending MediaEvent which is removed
+             *              from the drive's queue.
+             * \param mediumPresent Set if a medium is in the drive.
+             * \param unsupported Set if the command failed because the drive
+             *                    does not support media events, as opposed to
+             *                    a failure which may go away.
+             *
+             * \return false if the media events could not be read.
+             */
+            bool getMediaEventStatus( MediaEvent& event, bool& mediumPresent, bool* unsupported = 0 ) const;
+
             /**
              * Read a single feature.
              * data will be filled with the feature header and the descriptor
@@ -707,6 +755,12 @@ namespace K3b {
              */
             Device( const Solid::Device& dev );
 
+            /**
+             * A simulated device which sends all commands to \p transport.
+             * Takes ownership of \p transport.
+             */
+            Device( const QString& name, ScsiTransport* transport );
+
             /**
              * Determines the device's capabilities. This needs to be called once before
              * using the device.
@@ -736,6 +790,18 @@ namespace K3b {
 
             int getMaxWriteSpeedVia2A() const;
 
+            /**
+             * Asks the system and the drive for the maximum transfer length.
+             * The device needs to be open.
+             */
+            int determineMaxTransferLength() const;
+
+            /**
+             * The transfer length determined by init() before it was
+             * lowered with setMaxTransferLength().
+             */
+            int systemMaxTransferLength() const;
+
             QByteArray mediaId( int mediaType ) const;
 
             class Private;
@@ -663,6 +663,46 @@ bool K3b::Device::Device::mechanismStatus( UByteArray& data ) const
 
 
 
+bool K3b::Device::Device::getMediaEventStatus( MediaEvent& event, bool& mediumPresent, bool* unsupported ) const
+{
+    if( unsupported )
+        *unsupported = false;
+
+    unsigned char data[8];
+    ::memset( data, 0, 8 );
+
+    ScsiCommand cmd( this );
+    cmd.enableErrorMessages( false );
+    cmd[0] = MMC_GET_EVENT_STATUS_NOTIFICATION;
+    cmd[1] = 0x1;   // polled, asynchronous operation is not supported by the drives
+    cmd[4] = 0x10;  // media class
+    cmd[8] = 8;
+    cmd[9] = 0;     // Necessary to set the proper command length
+    if( cmd.transport( TR_DIR_READ, data, 8 ) ) {
+        // drives without GET EVENT STATUS NOTIFICATION reject it as an
+        // ILLEGAL REQUEST, everything else may be a passing problem
+        if( unsupported )
+            *unsupported = ( cmd.senseKey() == 0x5 );
+        return false;
+    }
+
+    //
+    // The NEA bit is set if the drive does not support the requested class.
+    // Some drives return another class instead.
+    //
+    if( data[2] & 0x80 || ( data[2] & 0x07 ) != 0x4 || from2Byte( data ) < 6 ) {
+        qDebug() << "(K3b::Device::Device) " << blockDeviceName() << ": no media event support.";
+        if( unsupported )
+            *unsupported = true;
+        return false;
+    }
+
+    event = MediaEvent( data[4] & 0x0F );
+    mediumPresent = ( data[5] & 0x02 );
+    return true;
+}
+
+
 bool K3b::Device::Device::modeSense(UByteArray& pageData, int page) const
 {
     unsigned char header[2048];
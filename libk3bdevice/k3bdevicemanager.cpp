@@ -10,6 +10,7 @@
 #include "k3bdevice.h"
 #include "k3bdeviceglobals.h"
 #include "k3bscsicommand.h"
+#include "k3bsimulateddrive.h"
 #include "k3bmmc.h"
 
 #include <config-k3b.h>
@@ -27,6 +28,7 @@
 #endif
 
 #include <QDebug>
+#include <QDir>
 #include <QString>
 #include <QStringList>
 #include <QFile>
@@ -167,6 +169,10 @@ K3b::Device::Device* K3b::Device::DeviceManager::findDevice( const QString& devi
 
 K3b::Device::Device* K3b::Device::DeviceManager::findDeviceByUdi( const QString& udi )
 {
+    // simulated devices have no udi
+    if( udi.isEmpty() )
+        return 0;
+
     foreach( Device* dev, d->allDevices ) {
         if ( dev->solidDevice().udi() == udi )
             return dev;
@@ -234,6 +240,22 @@ int K3b::Device::DeviceManager::scanBus()
         }
     }
 
+    const QString simulated = QString::fromLocal8Bit( qgetenv( "K3B_SIMULATED_DRIVES" ) );
+    Q_FOREACH( const QString& image, simulated.split( QDir::listSeparator(), Qt::SkipEmptyParts ) ) {
+        const QString name = QLatin1String( "sim:" ) + image;
+        if( findDevice( name ) )
+            continue;
+
+        SimulatedDrive* drive = new SimulatedDrive();
+        if( !drive->load( image ) ) {
+            qDebug() << "(K3b::Device::DeviceManager) could not load simulated drive image" << image;
+            delete drive;
+        }
+        else if( addSimulatedDevice( drive, name ) ) {
+            ++cnt;
+        }
+    }
+
     return cnt;
 }
 
@@ -311,6 +333,16 @@ bool K3b::Device::DeviceManager::readConfig( const KConfigGroup& c )
             dev->setMaxReadSpeed( list[0].toInt() );
             if( list.count() > 1 )
                 dev->setMaxWriteSpeed( list[1].toInt() );
+
+            // a transfer length which failed before is not tried again
+            // unless the limits of the system changed meanwhile, e.g. with
+            // another kernel or controller
+            const int maxTransferLength = ( list.count() > 3 ? list[2].toInt() : 0 );
+            const int systemMaxTransferLength = ( list.count() > 3 ? list[3].toInt() : 0 );
+            if( maxTransferLength > 0 &&
+                systemMaxTransferLength == dev->systemMaxTransferLength() &&
+                maxTransferLength < dev->maxTransferLength() )
+                dev->setMaxTransferLength( maxTransferLength );
         }
     }
 
@@ -338,7 +370,9 @@ bool K3b::Device::DeviceManager::saveConfig( KConfigGroup c )
         QString configEntryName = dev->vendor() + ' ' + dev->description();
         QStringList list;
         list << QString::number(dev->maxReadSpeed())
-             << QString::number(dev->maxWriteSpeed());
+             << QString::number(dev->maxWriteSpeed())
+             << QString::number(dev->maxTransferLength())
+             << QString::number(dev->systemMaxTransferLength());
 
         c.writeEntry( configEntryName, list );
     }
@@ -363,6 +397,18 @@ K3b::Device::Device* K3b::Device::DeviceManager::addDevice( const Solid::Device&
 }
 
 
+K3b::Device::Device* K3b::Device::DeviceManager::addSimulatedDevice( ScsiTransport* transport, const QString& name )
+{
+    if( findDevice( name ) ) {
+        qDebug() << "(K3b::Device::DeviceManager) dev " << name << " already found";
+        delete transport;
+        return 0;
+    }
+
+    return addDevice( new K3b::Device::Device( name, transport ) );
+}
+
+
 K3b::Device::Device* K3b::Device::DeviceManager::addDevice( K3b::Device::Device* device )
 {
     const QString devicename = device->blockDeviceName();
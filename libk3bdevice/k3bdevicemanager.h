@@ -22,6 +22,7 @@ namespace K3b {
     namespace Device {
 
         class Device;
+        class ScsiTransport;
 
         /**
          * \brief Manages all devices.
@@ -147,6 +148,21 @@ namespace K3b {
              */
             QList<Device*> blueRayWriters() const;
 
+            /**
+             * Adds a simulated device which does not exist in the system. All
+             * commands sent to it are executed by \p transport, for example a
+             * SimulatedDrive. This allows to run the device layer and the jobs
+             * without a real drive.
+             *
+             * The DeviceManager takes ownership of \p transport.
+             *
+             * \param name The block device name of the device.
+             *
+             * \return The device or 0 if it could not be initialized. In that case
+             *         \p transport has been deleted.
+             */
+            Device* addSimulatedDevice( ScsiTransport* transport, const QString& name );
+
             /**
              * Reads the device information from the config file.
              */
@@ -164,6 +180,9 @@ namespace K3b {
             /**
              * Scan the system for devices. Call this to initialize all devices.
              *
+             * The images listed in the environment variable K3B_SIMULATED_DRIVES
+             * are loaded into simulated devices named "sim:<image>".
+             *
              * \return Number of found devices.
              **/
             virtual int scanBus();
@@ -121,6 +121,19 @@ namespace K3b {
         };
         Q_DECLARE_FLAGS( MediaStates, MediaState )
 
+        /**
+         * The media events reported by GET EVENT STATUS NOTIFICATION.
+         */
+        enum MediaEvent {
+            MEDIA_EVENT_NONE = 0x0,           /**< Nothing happened since the last request. */
+            MEDIA_EVENT_EJECT_REQUEST = 0x1,  /**< The user asked to eject the medium. */
+            MEDIA_EVENT_NEW_MEDIA = 0x2,      /**< A medium has been inserted. */
+            MEDIA_EVENT_MEDIA_REMOVAL = 0x3,  /**< The medium has been removed. */
+            MEDIA_EVENT_MEDIA_CHANGED = 0x4,  /**< The medium has been changed by the drive, e.g. a changer. */
+            MEDIA_EVENT_BG_FORMAT_COMPLETE = 0x5,
+            MEDIA_EVENT_BG_FORMAT_RESTART = 0x6
+        };
+
         enum BackGroundFormattingState {
             BG_FORMAT_INVALID = 0x0,
             BG_FORMAT_NONE = 0x1,
@@ -0,0 +1,278 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3breadqueue.h"
+#include "k3bdevice.h"
+
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+
+namespace {
+    class Read10Reader : public K3b::Device::ReadQueue::Reader
+    {
+    public:
+        explicit Read10Reader( K3b::Device::Device* dev )
+            : m_device( dev ) {
+        }
+
+        bool read( unsigned char* buffer, unsigned long sector, unsigned int sectors ) override {
+            return m_device->read10( buffer, sectors*2048, sector, sectors );
+        }
+
+    private:
+        K3b::Device::Device* m_device;
+    };
+}
+
+
+class K3b::Device::ReadQueue::Private : public QThread
+{
+public:
+    enum State {
+        Queued,
+        Reading,
+        Done
+    };
+
+    struct Entry {
+        unsigned long sector;
+        unsigned int sectors;
+        int buffer;
+        State state;
+        bool success;
+    };
+
+    Private( Reader* r, int sectorSize_, int maxSectors_, int depth_ )
+        : reader( r ),
+          sectorSize( sectorSize_ ),
+          maxSectors( qMax( 1, maxSectors_ ) ),
+          depth( qBound( 1, depth_, 8 ) ),
+          completedBuffer( -1 ),
+          stopRequested( false ) {
+        // one more buffer than reads so the caller can process the
+        // completed one while the drive fills the others
+        for( int i = 0; i <= depth; ++i ) {
+            buffers.append( new unsigned char[sectorSize*maxSectors] );
+            freeBuffers.append( i );
+        }
+    }
+
+    ~Private() override {
+        mutex.lock();
+        stopRequested = true;
+        cond.wakeAll();
+        mutex.unlock();
+        wait();
+
+        Q_FOREACH( unsigned char* buffer, buffers ) {
+            delete [] buffer;
+        }
+        delete reader;
+    }
+
+    void run() override {
+        Q_FOREVER {
+            mutex.lock();
+            int index = nextQueued();
+            while( index < 0 && !stopRequested ) {
+                cond.wait( &mutex );
+                index = nextQueued();
+            }
+            if( stopRequested ) {
+                mutex.unlock();
+                break;
+            }
+            Entry& entry = queue[index];
+            entry.state = Reading;
+            const unsigned long sector = entry.sector;
+            const unsigned int sectors = entry.sectors;
+            unsigned char* buffer = buffers[entry.buffer];
+            const int bufferIndex = entry.buffer;
+            mutex.unlock();
+
+            // nobody touches an entry in Reading state
+            const bool success = reader->read( buffer, sector, sectors );
+
+            mutex.lock();
+            for( int i = 0; i < queue.count(); ++i ) {
+                if( queue[i].buffer == bufferIndex ) {
+                    queue[i].state = Done;
+                    queue[i].success = success;
+                    break;
+                }
+            }
+            cond.wakeAll();
+            mutex.unlock();
+        }
+    }
+
+    // call with locked mutex
+    int nextQueued() const {
+        for( int i = 0; i < queue.count(); ++i ) {
+            if( queue[i].state == Queued )
+                return i;
+        }
+        return -1;
+    }
+
+    void releaseCompletedBuffer() {
+        if( completedBuffer >= 0 ) {
+            freeBuffers.append( completedBuffer );
+            completedBuffer = -1;
+        }
+    }
+
+    Reader* reader;
+    int sectorSize;
+    int maxSectors;
+    int depth;
+
+    QVector<unsigned char*> buffers;
+    QList<int> freeBuffers;
+    QList<Entry> queue;
+    int completedBuffer;
+
+    bool stopRequested;
+    QMutex mutex;
+    QWaitCondition cond;
+};
+
+
+K3b::Device::ReadQueue::Reader::~Reader()
+{
+}
+
+
+K3b::Device::ReadQueue::Request::Request()
+    : sector( 0 ),
+      sectors( 0 ),
+      success( false ),
+      data( 0 )
+{
+}
+
+
+K3b::Device::ReadQueue::ReadQueue( Device* dev, int depth )
+    : d( new Private( new Read10Reader( dev ), 2048, dev->maxReadSectors(), depth ) )
+{
+}
+
+
+K3b::Device::ReadQueue::ReadQueue( Reader* reader, int sectorSize, int maxSectors, int depth )
+    : d( new Private( reader, sectorSize, maxSectors, depth ) )
+{
+}
+
+
+K3b::Device::ReadQueue::~ReadQueue()
+{
+    delete d;
+}
+
+
+int K3b::Device::ReadQueue::depth() const
+{
+    return d->depth;
+}
+
+
+int K3b::Device::ReadQueue::sectorSize() const
+{
+    return d->sectorSize;
+}
+
+
+int K3b::Device::ReadQueue::maxSectors() const
+{
+    return d->maxSectors;
+}
+
+
+int K3b::Device::ReadQueue::pending() const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->queue.count();
+}
+
+
+bool K3b::Device::ReadQueue::submit( unsigned long sector, unsigned int sectors )
+{
+    if( sectors == 0 || sectors > (unsigned int)d->maxSectors )
+        return false;
+
+    QMutexLocker locker( &d->mutex );
+
+    if( d->queue.count() >= d->depth || d->freeBuffers.isEmpty() )
+        return false;
+
+    Private::Entry entry;
+    entry.sector = sector;
+    entry.sectors = sectors;
+    entry.buffer = d->freeBuffers.takeFirst();
+    entry.state = Private::Queued;
+    entry.success = false;
+    d->queue.append( entry );
+
+    if( !d->isRunning() )
+        d->start();
+    d->cond.wakeAll();
+
+    return true;
+}
+
+
+bool K3b::Device::ReadQueue::complete( Request& request )
+{
+    QMutexLocker locker( &d->mutex );
+
+    d->releaseCompletedBuffer();
+
+    if( d->queue.isEmpty() )
+        return false;
+
+    while( d->queue.first().state != Private::Done )
+        d->cond.wait( &d->mutex );
+
+    Private::Entry entry = d->queue.takeFirst();
+    d->completedBuffer = entry.buffer;
+
+    request.sector = entry.sector;
+    request.sectors = entry.sectors;
+    request.success = entry.success;
+    request.data = entry.success ? d->buffers[entry.buffer] : 0;
+
+    return true;
+}
+
+
+void K3b::Device::ReadQueue::cancel()
+{
+    QMutexLocker locker( &d->mutex );
+
+    d->releaseCompletedBuffer();
+
+    // drop everything the worker did not start yet
+    for( int i = 0; i < d->queue.count(); ) {
+        if( d->queue[i].state == Private::Reading ) {
+            ++i;
+        }
+        else {
+            d->freeBuffers.append( d->queue[i].buffer );
+            d->queue.removeAt( i );
+        }
+    }
+
+    // only the running read is left
+    while( !d->queue.isEmpty() ) {
+        while( d->queue.first().state == Private::Reading )
+            d->cond.wait( &d->mutex );
+        d->freeBuffers.append( d->queue.takeFirst().buffer );
+    }
+}
@@ -0,0 +1,150 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#ifndef _K3B_READ_QUEUE_H_
+#define _K3B_READ_QUEUE_H_
+
+#include "k3bdevice_export.h"
+
+#include <QtGlobal>
+
+namespace K3b {
+    namespace Device
+    {
+        class Device;
+
+        /**
+         * \brief Reads ahead of the caller with several queued read commands.
+         *
+         * Reading a medium sector range by sector range leaves the drive idle
+         * while the caller writes or checksums the data it just got. The
+         * ReadQueue accepts up to depth() reads which are executed one after
+         * the other by a worker thread so the drive already transfers the next
+         * sectors while the caller processes the completed ones.
+         *
+         * Commands to one device are serialized (see Device::usageLock()) and
+         * most drives only handle one command at a time anyway. Thus a depth of
+         * 2 to 4 is enough to keep the drive busy.
+         *
+         * Reads are completed in the order they were submitted. The data of a
+         * completed read stays valid until the next call to complete() or
+         * cancel().
+         *
+         * \code
+         *   ReadQueue queue( device );
+         *   unsigned long next = first;
+         *   while( first <= last ) {
+         *       while( next <= last ) {
+         *           unsigned int n = qMin<unsigned long>( queue.maxSectors(), last - next + 1 );
+         *           if( !queue.submit( next, n ) )
+         *               break;
+         *           next += n;
+         *       }
+         *       ReadQueue::Request r;
+         *       queue.complete( r );
+         *       if( !r.success )
+         *           break;
+         *       process( r.data, r.sectors );
+         *       first += r.sectors;
+         *   }
+         * \endcode
+         *
+         * ReadQueue is not thread-safe itself. submit(), complete() and cancel()
+         * have to be called from one thread.
+         */
+        class LIBK3BDEVICE_EXPORT ReadQueue
+        {
+        public:
+            /**
+             * Performs the actual reading. Use this to read with other
+             * commands than READ (10), for example READ CD. read() is called
+             * from the worker thread of the queue.
+             */
+            class LIBK3BDEVICE_EXPORT Reader
+            {
+            public:
+                virtual ~Reader();
+
+                /**
+                 * Reads \p sectors sectors starting at \p sector into \p buffer.
+                 */
+                virtual bool read( unsigned char* buffer, unsigned long sector, unsigned int sectors ) = 0;
+            };
+
+            struct Request
+            {
+                Request();
+
+                unsigned long sector;
+                unsigned int sectors;
+                bool success;
+
+                /**
+                 * The read data. Only valid if success is true.
+                 */
+                const unsigned char* data;
+            };
+
+            /**
+             * Creates a queue reading 2048 byte sectors with READ (10). Reads
+             * may be up to Device::maxReadSectors() sectors.
+             */
+            explicit ReadQueue( Device* dev, int depth = 3 );
+
+            /**
+             * Creates a queue reading with \p reader.
+             *
+             * \param reader The reader. ReadQueue takes ownership.
+             * \param sectorSize The size of one sector in bytes.
+             * \param maxSectors The maximum number of sectors per read.
+             */
+            ReadQueue( Reader* reader, int sectorSize, int maxSectors, int depth = 3 );
+
+            /**
+             * Cancels all reads and waits for the running one to finish.
+             */
+            ~ReadQueue();
+
+            int depth() const;
+            int sectorSize() const;
+            int maxSectors() const;
+
+            /**
+             * \return The number of submitted reads which have not been
+             *         completed yet.
+             */
+            int pending() const;
+
+            /**
+             * Queues a read of \p sectors sectors starting at \p sector.
+             *
+             * \return false if depth() reads are pending already or \p sectors
+             *         is not in the range of 1 to maxSectors().
+             */
+            bool submit( unsigned long sector, unsigned int sectors );
+
+            /**
+             * Waits for the oldest pending read to finish.
+             *
+             * \return false if no read is pending.
+             */
+            bool complete( Request& request );
+
+            /**
+             * Drops all pending reads. The read executed by the drive at the
+             * moment is waited for since a command cannot be aborted.
+             */
+            void cancel();
+
+        private:
+            class Private;
+            Private* const d;
+
+            Q_DISABLE_COPY( ReadQueue )
+        };
+    }
+}
+
+#endif
@@ -155,6 +155,7 @@ QString K3b::Device::ScsiCommand::senseKeyToString( int key )
 
 
 void K3b::Device::ScsiCommand::debugError( int command, int errorCode, int senseKey, int asc, int ascq ) {
+    m_senseKey = senseKey;
     if( m_printErrors ) {
         qDebug() << "(K3b::Device::ScsiCommand) failed: " << Qt::endl
                  << "                           command:    " << QString("%1 (%2)")
@@ -168,6 +169,41 @@ void K3b::Device::ScsiCommand::debugError( int command, int errorCode, int sense
 }
 
 
+int K3b::Device::ScsiCommand::transport( ScsiTransport* transport,
+                                         const unsigned char* cdb,
+                                         TransportDirection dir,
+                                         void* data,
+                                         size_t len )
+{
+    SenseData sense;
+
+    m_device->usageLock();
+    bool success = transport->execute( cdb, dir, (unsigned char*)data, len, sense );
+    m_device->usageUnlock();
+
+    if( success )
+        return 0;
+
+    // current error as in the fixed sense data format
+    const int errorCode = 0x70;
+
+    debugError( cdb[0], errorCode, sense.senseKey, sense.asc, sense.ascq );
+
+    int errCode =
+        ((errorCode<<24)      & 0xF000) |
+        ((sense.senseKey<<16) & 0x0F00) |
+        ((sense.asc<<8)       & 0x00F0) |
+        ((sense.ascq)         & 0x000F);
+
+    return( errCode != 0 ? errCode : 1 );
+}
+
+
+K3b::Device::ScsiTransport::~ScsiTransport()
+{
+}
+
+
 
 #ifdef Q_OS_LINUX
 #include "k3bscsicommand_linux.cpp"
@@ -186,7 +222,8 @@ void K3b::Device::ScsiCommand::debugError( int command, int errorCode, int sense
 K3b::Device::ScsiCommand::ScsiCommand( const K3b::Device::Device* dev )
     : d(new Private),
       m_device(dev),
-      m_printErrors(true)
+      m_printErrors(true),
+      m_senseKey(0)
 {
     clear();
 }
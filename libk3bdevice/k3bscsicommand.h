@@ -6,6 +6,7 @@
 #define _K3B_SCSI_COMMAND_H_
 
 #include "k3bdevice.h"
+#include "k3bscsitransport.h"
 
 #include <qglobal.h>
 #include <QString>
@@ -69,12 +70,6 @@ namespace K3b {
 
         QString commandString( const unsigned char& command );
 
-        enum TransportDirection {
-            TR_DIR_NONE,
-            TR_DIR_READ,
-            TR_DIR_WRITE
-        };
-
         class ScsiCommand
         {
         public:
@@ -89,6 +84,12 @@ namespace K3b {
              */
             void enableErrorMessages( bool b ) { m_printErrors = b; }
 
+            /**
+             * \return The sense key reported by the drive for the last
+             *         failed transport() or 0 if none failed yet.
+             */
+            int senseKey() const { return m_senseKey; }
+
             void clear();
 
             unsigned char& operator[]( size_t );
@@ -118,11 +119,22 @@ namespace K3b {
             static QString senseKeyToString( int key );
             void debugError( int command, int errorCode, int senseKey, int asc, int ascq );
 
+            /**
+             * Hands the command to the transport of a simulated device.
+             * Used by the platform implementations of transport().
+             */
+            int transport( ScsiTransport* transport,
+                           const unsigned char* cdb,
+                           TransportDirection dir,
+                           void* data,
+                           size_t len );
+
             class Private;
             Private *d;
             const Device* m_device;
 
             bool m_printErrors;
+            int m_senseKey;
         };
     }
 }
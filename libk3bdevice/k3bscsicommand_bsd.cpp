@@ -63,6 +63,9 @@ int K3b::Device::ScsiCommand::transport( TransportDirection dir,
     if( !m_device )
         return -1;
 
+    if( m_device->scsiTransport() )
+        return transport( m_device->scsiTransport(), d->get_ccb().csio.cdb_io.cdb_bytes, dir, data, len );
+
     m_device->usageLock();
 
     bool needToClose = false;
@@ -45,6 +45,9 @@ int K3b::Device::ScsiCommand::transport( TransportDirection dir,
                                          void* data,
                                          size_t len )
 {
+    if( m_device && m_device->scsiTransport() )
+        return transport( m_device->scsiTransport(), d->cmd.cmd, dir, data, len );
+
     bool needToClose = false;
     int deviceHandle = -1;
     if( m_device ) {
@@ -51,6 +51,9 @@ int K3b::Device::ScsiCommand::transport( TransportDirection dir,
                                        void* data,
                                        size_t len )
 {
+    if( m_device && m_device->scsiTransport() )
+        return transport( m_device->scsiTransport(), d->m_cmd.spt.Cdb, dir, data, len );
+
     bool needToClose = false;
     ULONG returned = 0;
     BOOL status = TRUE;
@@ -0,0 +1,74 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#ifndef _K3B_SCSI_TRANSPORT_H_
+#define _K3B_SCSI_TRANSPORT_H_
+
+#include "k3bdevice_export.h"
+
+#include <stddef.h>
+
+namespace K3b {
+    namespace Device
+    {
+        enum TransportDirection {
+            TR_DIR_NONE,
+            TR_DIR_READ,
+            TR_DIR_WRITE
+        };
+
+        /**
+         * The sense data of a failed command.
+         */
+        struct SenseData
+        {
+            SenseData()
+                : senseKey( 0 ),
+                  asc( 0 ),
+                  ascq( 0 ) {
+            }
+
+            int senseKey;
+            int asc;
+            int ascq;
+        };
+
+        /**
+         * Executes the commands of a Device instead of the operating system.
+         *
+         * Devices with a transport are created with DeviceManager::addSimulatedDevice().
+         * Every ScsiCommand sent to such a device is handed to execute() and never
+         * reaches a real drive.
+         *
+         * \sa SimulatedDrive
+         */
+        class LIBK3BDEVICE_EXPORT ScsiTransport
+        {
+        public:
+            virtual ~ScsiTransport();
+
+            /**
+             * Executes a command.
+             *
+             * \param cdb The 12 bytes of the command descriptor block. Unused
+             *            bytes of shorter commands are 0.
+             * \param data The data buffer of \p len bytes which is filled for
+             *             TR_DIR_READ and read for TR_DIR_WRITE.
+             * \param sense Has to be filled in if the command fails.
+             *
+             * \return true if the command succeeded.
+             *
+             * May be called from several threads at once.
+             */
+            virtual bool execute( const unsigned char* cdb,
+                                  TransportDirection dir,
+                                  unsigned char* data,
+                                  size_t len,
+                                  SenseData& sense ) = 0;
+        };
+    }
+}
+
+#endif
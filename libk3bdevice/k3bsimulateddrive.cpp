@@ -0,0 +1,1405 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "k3bsimulateddrive.h"
+#include "k3bscsicommand.h"
+#include "k3bdeviceglobals.h"
+#include "k3bdevicetypes.h"
+#include "k3bcrc.h"
+#include "k3bmsf.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+
+#include <string.h>
+
+
+namespace {
+    // anything larger does not fit on a CD and is simulated as DVD-ROM
+    const int MAX_CD_SECTORS = 360000;
+
+    const int RAW_SECTOR_SIZE = 2352;
+
+    // the read speed reported in mode page 2A (16x DVD)
+    const int MAX_READ_SPEED = 22160;
+
+    enum SectorFormat {
+        FORMAT_AUDIO,      // 2352 bytes of audio
+        FORMAT_MODE1,      // 2048 bytes of user data
+        FORMAT_MODE1_RAW,  // 2352 bytes
+        FORMAT_MODE2_RAW,  // 2352 bytes
+        FORMAT_MODE2       // 2336 bytes starting with the subheader
+    };
+
+    // the sector types of the READ CD command
+    enum SectorType {
+        SECTOR_CDDA = 1,
+        SECTOR_MODE1 = 2,
+        SECTOR_MODE2 = 3,
+        SECTOR_MODE2_FORM1 = 4,
+        SECTOR_MODE2_FORM2 = 5
+    };
+
+    struct ImageTrack
+    {
+        int file;
+        int fileSector;    // the position of index 1 in the file
+        SectorFormat format;
+        int firstSector;
+        int length;
+        int pregap;        // the sectors of index 0 before firstSector
+    };
+
+    int fileSectorSize( SectorFormat format )
+    {
+        switch( format ) {
+        case FORMAT_MODE1:
+            return 2048;
+        case FORMAT_MODE2:
+            return 2336;
+        default:
+            return RAW_SECTOR_SIZE;
+        }
+    }
+
+    void to2Byte( unsigned char* buf, int value )
+    {
+        buf[0] = value>>8;
+        buf[1] = value;
+    }
+
+    void to4Byte( unsigned char* buf, quint32 value )
+    {
+        buf[0] = value>>24;
+        buf[1] = value>>16;
+        buf[2] = value>>8;
+        buf[3] = value;
+    }
+
+    // splits a cue sheet line into its words, quoted words may contain blanks
+    QStringList cueWords( const QString& line )
+    {
+        QStringList words;
+        QString word;
+        bool quoted = false;
+        bool inWord = false;
+        for( int i = 0; i < line.length(); ++i ) {
+            const QChar c = line[i];
+            if( c == '"' ) {
+                quoted = !quoted;
+                inWord = true;
+            }
+            else if( c.isSpace() && !quoted ) {
+                if( inWord )
+                    words.append( word );
+                word.clear();
+                inWord = false;
+            }
+            else {
+                word.append( c );
+                inWord = true;
+            }
+        }
+        if( inWord )
+            words.append( word );
+        return words;
+    }
+
+    bool parseCueMsf( const QString& s, int& frames )
+    {
+        const QStringList parts = s.split( ':' );
+        if( parts.count() != 3 )
+            return false;
+        bool ok1, ok2, ok3;
+        frames = K3b::Msf( parts[0].toInt( &ok1 ), parts[1].toInt( &ok2 ), parts[2].toInt( &ok3 ) ).lba();
+        return ok1 && ok2 && ok3;
+    }
+}
+
+
+class K3b::Device::SimulatedDrive::Private
+{
+public:
+    Private()
+        : dvd( false ),
+          ejected( false ),
+          pendingEvent( MEDIA_EVENT_NONE ),
+          errorRecovery( 0x20 ),
+          commandLatency( 0 ),
+          sectorLatency( 0 ),
+          maxTransferLength( 0 ),
+          failingReads( 0 ),
+          commandCount( 0 ),
+          sectorsRead( 0 ) {
+    }
+
+    ~Private() {
+        qDeleteAll( files );
+    }
+
+    QList<QFile*> files;
+    QList<ImageTrack> tracks;
+    CdText cdText;
+    bool dvd;
+    bool ejected;
+
+    MediaEvent pendingEvent;
+    int errorRecovery;
+
+    int commandLatency;
+    int sectorLatency;
+    int maxTransferLength;
+    QList<QPair<int, int> > readErrors;
+    int failingReads;
+
+    int commandCount;
+    qint64 sectorsRead;
+
+    mutable QMutex mutex;
+
+    bool loadIso( const QString& filename );
+    bool loadCue( const QString& filename );
+    void clear();
+
+    bool mediumPresent() const { return !tracks.isEmpty() && !ejected; }
+    int totalSectors() const;
+    int trackIndex( int lba ) const;
+    bool hasReadError( int first, int count ) const;
+
+    bool readSector( int lba, unsigned char* raw, SectorFormat& format );
+    int sectorType( SectorFormat format, const unsigned char* raw ) const;
+    Track::DataMode dataMode( const ImageTrack& track );
+    void subQ( int lba, unsigned char* q ) const;
+    int control( int track ) const;
+
+    bool inquiry( const unsigned char* cdb, unsigned char* data, size_t len, SenseData& sense );
+    bool getConfiguration( const unsigned char* cdb, unsigned char* data, size_t len, SenseData& sense );
+    bool modeSense( const unsigned char* cdb, unsigned char* data, size_t len, SenseData& sense );
+    bool modeSelect( unsigned char* data, size_t len );
+    bool readCapacity( unsigned char* data, size_t len );
+    bool readDiscInformation( unsigned char* data, size_t len );
+    bool readTrackInformation( const unsigned char* cdb, unsigned char* data, size_t len, SenseData& sense );
+    bool readToc( const unsigned char* cdb, unsigned char* data, size_t len, SenseData& sense );
+    bool readDiscStructure( const unsigned char* cdb, unsigned char* data, size_t len, SenseData& sense );
+    bool read( int lba, int count, unsigned char* data, size_t len, SenseData& sense );
+    bool readCd( const unsigned char* cdb, int lba, int count, unsigned char* data, size_t len, SenseData& sense );
+    bool getEventStatus( const unsigned char* cdb, unsigned char* data, size_t len );
+    bool startStopUnit( const unsigned char* cdb );
+};
+
+
+namespace {
+    bool fail( K3b::Device::SenseData& sense, int key, int asc, int ascq = 0 )
+    {
+        sense.senseKey = key;
+        sense.asc = asc;
+        sense.ascq = ascq;
+        return false;
+    }
+
+    // copies a reply to the host buffer cut to the allocation length
+    void reply( const QByteArray& r, unsigned char* data, size_t len, size_t allocationLength )
+    {
+        ::memcpy( data, r.constData(), qMin( (size_t)r.size(), qMin( len, allocationLength ) ) );
+    }
+}
+
+
+void K3b::Device::SimulatedDrive::Private::clear()
+{
+    qDeleteAll( files );
+    files.clear();
+    tracks.clear();
+    cdText.clear();
+    dvd = false;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::loadIso( const QString& filename )
+{
+    QFile* file = new QFile( filename );
+    if( !file->open( QIODevice::ReadOnly ) ) {
+        qDebug() << "(K3b::Device::SimulatedDrive) could not open" << filename;
+        delete file;
+        return false;
+    }
+    files.append( file );
+
+    ImageTrack track;
+    track.file = 0;
+    track.fileSector = 0;
+    track.format = FORMAT_MODE1;
+    track.firstSector = 0;
+    track.length = file->size() / 2048;
+    track.pregap = 0;
+
+    if( track.length <= 0 ) {
+        qDebug() << "(K3b::Device::SimulatedDrive)" << filename << "is empty";
+        return false;
+    }
+
+    tracks.append( track );
+    dvd = ( track.length > MAX_CD_SECTORS );
+
+    return true;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::loadCue( const QString& filename )
+{
+    QFile cueFile( filename );
+    if( !cueFile.open( QIODevice::ReadOnly ) ) {
+        qDebug() << "(K3b::Device::SimulatedDrive) could not open" << filename;
+        return false;
+    }
+
+    const QDir dir = QFileInfo( filename ).absoluteDir();
+    QList<int> index0;
+    QList<int> index1;
+    QList<int> fileSectors;
+
+    QTextStream s( &cueFile );
+    while( !s.atEnd() ) {
+        const QStringList words = cueWords( s.readLine() );
+        if( words.isEmpty() )
+            continue;
+
+        const QString keyword = words[0].toUpper();
+
+        if( keyword == "FILE" ) {
+            if( words.count() < 3 || words[2].toUpper() != "BINARY" ) {
+                qDebug() << "(K3b::Device::SimulatedDrive) only BINARY files are supported in" << filename;
+                return false;
+            }
+            QFile* file = new QFile( dir.absoluteFilePath( words[1] ) );
+            if( !file->open( QIODevice::ReadOnly ) ) {
+                qDebug() << "(K3b::Device::SimulatedDrive) could not open" << file->fileName();
+                delete file;
+                return false;
+            }
+            files.append( file );
+            fileSectors.append( -1 );
+        }
+
+        else if( keyword == "TRACK" ) {
+            if( files.isEmpty() || words.count() < 3 )
+                return false;
+
+            ImageTrack track;
+            const QString mode = words[2].toUpper();
+            if( mode == "AUDIO" )
+                track.format = FORMAT_AUDIO;
+            else if( mode == "MODE1/2048" )
+                track.format = FORMAT_MODE1;
+            else if( mode == "MODE1/2352" )
+                track.format = FORMAT_MODE1_RAW;
+            else if( mode == "MODE2/2352" )
+                track.format = FORMAT_MODE2_RAW;
+            else if( mode == "MODE2/2336" )
+                track.format = FORMAT_MODE2;
+            else {
+                qDebug() << "(K3b::Device::SimulatedDrive) unsupported track mode" << mode;
+                return false;
+            }
+
+            track.file = files.count()-1;
+            track.fileSector = -1;
+            track.firstSector = 0;
+            track.length = 0;
+            track.pregap = 0;
+            tracks.append( track );
+            index0.append( -1 );
+            index1.append( -1 );
+
+            // the sector size of a file is the one of its first track
+            if( fileSectors.last() < 0 )
+                fileSectors.last() = files.last()->size() / fileSectorSize( track.format );
+        }
+
+        else if( keyword == "INDEX" ) {
+            int frames = 0;
+            if( tracks.isEmpty() || words.count() < 3 || !parseCueMsf( words[2], frames ) )
+                return false;
+            const int index = words[1].toInt();
+            if( index == 0 )
+                index0.last() = frames;
+            else if( index == 1 )
+                index1.last() = frames;
+        }
+
+        else if( keyword == "TITLE" || keyword == "PERFORMER" || keyword == "SONGWRITER" ) {
+            if( words.count() < 2 )
+                continue;
+            if( tracks.isEmpty() ) {
+                if( keyword == "TITLE" )
+                    cdText.setTitle( words[1] );
+                else if( keyword == "PERFORMER" )
+                    cdText.setPerformer( words[1] );
+                else
+                    cdText.setSongwriter( words[1] );
+            }
+            else {
+                TrackCdText& text = cdText.track( tracks.count()-1 );
+                if( keyword == "TITLE" )
+                    text.setTitle( words[1] );
+                else if( keyword == "PERFORMER" )
+                    text.setPerformer( words[1] );
+                else
+                    text.setSongwriter( words[1] );
+            }
+        }
+    }
+
+    if( tracks.isEmpty() ) {
+        qDebug() << "(K3b::Device::SimulatedDrive) no tracks in" << filename;
+        return false;
+    }
+
+    //
+    // The files are placed one after the other on the disc. Like in the toc
+    // the pregap of a track belongs to the previous track.
+    //
+    int fileStart = 0;
+    for( int i = 0; i < tracks.count(); ++i ) {
+        ImageTrack& track = tracks[i];
+        if( index1[i] < 0 ) {
+            qDebug() << "(K3b::Device::SimulatedDrive) track" << (i+1) << "has no index 1";
+            return false;
+        }
+        if( i > 0 && track.file != tracks[i-1].file )
+            fileStart += fileSectors[tracks[i-1].file];
+
+        track.fileSector = index1[i];
+        track.firstSector = fileStart + index1[i];
+        track.pregap = ( index0[i] >= 0 && index0[i] < index1[i] ? index1[i] - index0[i] : 0 );
+    }
+    const int total = fileStart + fileSectors[tracks.last().file];
+
+    for( int i = 0; i < tracks.count(); ++i ) {
+        const int end = ( i+1 < tracks.count() ? tracks[i+1].firstSector : total );
+        tracks[i].length = end - tracks[i].firstSector;
+        if( tracks[i].length <= 0 ) {
+            qDebug() << "(K3b::Device::SimulatedDrive) track" << (i+1) << "is empty";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+int K3b::Device::SimulatedDrive::Private::totalSectors() const
+{
+    return tracks.isEmpty() ? 0 : tracks.last().firstSector + tracks.last().length;
+}
+
+
+int K3b::Device::SimulatedDrive::Private::trackIndex( int lba ) const
+{
+    for( int i = 0; i < tracks.count(); ++i ) {
+        if( lba >= tracks[i].firstSector && lba < tracks[i].firstSector + tracks[i].length )
+            return i;
+    }
+    return -1;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::hasReadError( int first, int count ) const
+{
+    for( int i = 0; i < readErrors.count(); ++i ) {
+        if( readErrors[i].first < first + count && readErrors[i].first + readErrors[i].second > first )
+            return true;
+    }
+    return false;
+}
+
+
+int K3b::Device::SimulatedDrive::Private::control( int track ) const
+{
+    return ( tracks[track].format == FORMAT_AUDIO ? 0x0 : 0x4 );
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::readSector( int lba, unsigned char* raw, SectorFormat& format )
+{
+    ::memset( raw, 0, RAW_SECTOR_SIZE );
+
+    int i = trackIndex( lba );
+    if( i < 0 )
+        return false;
+
+    // the pregap of the next track is stored with the next track
+    int fileSector = tracks[i].fileSector + lba - tracks[i].firstSector;
+    if( i+1 < tracks.count() && lba >= tracks[i+1].firstSector - tracks[i+1].pregap ) {
+        ++i;
+        fileSector = tracks[i].fileSector - ( tracks[i].firstSector - lba );
+    }
+
+    const ImageTrack& track = tracks[i];
+    format = track.format;
+
+    const int size = fileSectorSize( format );
+    const int pos = ( format == FORMAT_MODE1 || format == FORMAT_MODE2 ? 16 : 0 );
+
+    QFile* file = files[track.file];
+    if( !file->seek( (qint64)fileSector * size ) || file->read( (char*)raw + pos, size ) < 0 )
+        return false;
+
+    if( pos > 0 ) {
+        // sync pattern and header
+        ::memset( raw + 1, 0xFF, 10 );
+        const K3b::Msf msf( lba + 150 );
+        raw[12] = toBcd( msf.minutes() );
+        raw[13] = toBcd( msf.seconds() );
+        raw[14] = toBcd( msf.frames() );
+        raw[15] = ( format == FORMAT_MODE1 ? 1 : 2 );
+    }
+
+    return true;
+}
+
+
+int K3b::Device::SimulatedDrive::Private::sectorType( SectorFormat format, const unsigned char* raw ) const
+{
+    if( format == FORMAT_AUDIO )
+        return SECTOR_CDDA;
+    else if( raw[15] == 2 ) {
+        // XA sectors have two copies of the subheader
+        if( ::memcmp( &raw[16], &raw[20], 4 ) == 0 )
+            return ( raw[18] & 0x20 ? SECTOR_MODE2_FORM2 : SECTOR_MODE2_FORM1 );
+        else
+            return SECTOR_MODE2;
+    }
+    else
+        return SECTOR_MODE1;
+}
+
+
+K3b::Device::Track::DataMode K3b::Device::SimulatedDrive::Private::dataMode( const ImageTrack& track )
+{
+    if( dvd )
+        return Track::DVD;
+
+    unsigned char raw[RAW_SECTOR_SIZE];
+    SectorFormat format;
+    if( !readSector( track.firstSector, raw, format ) )
+        return Track::UNKNOWN;
+
+    switch( sectorType( format, raw ) ) {
+    case SECTOR_MODE1:
+        return Track::MODE1;
+    case SECTOR_MODE2:
+        return Track::MODE2;
+    case SECTOR_MODE2_FORM1:
+        return Track::XA_FORM1;
+    case SECTOR_MODE2_FORM2:
+        return Track::XA_FORM2;
+    default:
+        return Track::UNKNOWN;
+    }
+}
+
+
+void K3b::Device::SimulatedDrive::Private::subQ( int lba, unsigned char* q ) const
+{
+    ::memset( q, 0, 12 );
+
+    int i = trackIndex( lba );
+    if( i < 0 )
+        return;
+
+    int index = 1;
+    int relative = lba - tracks[i].firstSector;
+    if( i+1 < tracks.count() && lba >= tracks[i+1].firstSector - tracks[i+1].pregap ) {
+        // the relative time counts down in the pregap
+        ++i;
+        index = 0;
+        relative = tracks[i].firstSector - lba;
+    }
+
+    const K3b::Msf rel( relative );
+    const K3b::Msf abs( lba + 150 );
+
+    q[0] = ( control( i )<<4 ) | 0x1;
+    q[1] = toBcd( i+1 );
+    q[2] = toBcd( index );
+    q[3] = toBcd( rel.minutes() );
+    q[4] = toBcd( rel.seconds() );
+    q[5] = toBcd( rel.frames() );
+    q[7] = toBcd( abs.minutes() );
+    q[8] = toBcd( abs.seconds() );
+    q[9] = toBcd( abs.frames() );
+
+    // Red Book inverts the CRC bytes
+    const quint16 crc = calcX25( q, 10 );
+    q[10] = ~( crc>>8 );
+    q[11] = ~crc;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::inquiry( const unsigned char* cdb, unsigned char* data, size_t len, SenseData& sense )
+{
+    // the only vital product data is the Block Limits page with the transfer limit
+    if( cdb[1] & 0x1 ) {
+        if( cdb[2] != 0xB0 || maxTransferLength == 0 )
+            return fail( sense, 0x5, 0x24 );
+
+        QByteArray r( 64, 0 );
+        r[0] = 0x05;
+        r[1] = 0xB0;
+        to2Byte( (unsigned char*)r.data() + 2, r.size() - 4 );
+        to4Byte( (unsigned char*)r.data() + 8, maxTransferLength );
+        reply( r, data, len, cdb[4] );
+        return true;
+    }
+
+    QByteArray r( 36, 0 );
+    r[0] = 0x05;   // CD/DVD device
+    r[1] = 0x80;   // removable
+    r[3] = 0x02;
+    r[4] = 36 - 5;
+    ::memcpy( r.data() + 8, "K3b     ", 8 );
+    ::memcpy( r.data() + 16, "Simulated Drive ", 16 );
+    ::memcpy( r.data() + 32, "1.0 ", 4 );
+
+    reply( r, data, len, cdb[4] );
+    return true;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::getConfiguration( const unsigned char* cdb, unsigned char* data, size_t len, SenseData& sense )
+{
+    const int rt = cdb[1] & 0x3;
+    const int start = from2Byte( &cdb[2] );
+    const bool present = mediumPresent();
+    const bool cd = present && !dvd;
+    const int profile = ( present ? ( dvd ? 0x10 : 0x08 ) : 0x00 );
+
+    if( rt == 3 )
+        return fail( sense, 0x5, 0x24 );
+
+    QByteArray r( 8, 0 );
+    to2Byte( (unsigned char*)r.data() + 6, profile );
+
+    // code, current, feature data
+    QList<QPair<int, QPair<bool, QByteArray> > > features;
+
+    QByteArray profiles( 8, 0 );
+    to2Byte( (unsigned char*)profiles.data(), 0x10 );
+    profiles[2] = ( profile == 0x10 ? 0x1 : 0x0 );
+    to2Byte( (unsigned char*)profiles.data() + 4, 0x08 );
+    profiles[6] = ( profile == 0x08 ? 0x1 : 0x0 );
+    features.append( qMakePair( (int)FEATURE_PROFILE_LIST, qMakePair( true, profiles ) ) );
+
+    QByteArray core( 8, 0 );
+    core[3] = 0x01;   // SCSI
+    features.append( qMakePair( (int)FEATURE_CORE, qMakePair( true, core ) ) );
+
+    QByteArray removable( 4, 0 );
+    removable[0] = 0x29;   // tray, eject, lock
+    features.append( qMakePair( (int)FEATURE_REMOVABLE_MEDIA, qMakePair( true, removable ) ) );
+
+    QByteArray cdRead( 4, 0 );
+    cdRead[0] = 0x03;   // C2 flags and CD-Text
+    features.append( qMakePair( (int)FEATURE_CD_READ, qMakePair( cd, cdRead ) ) );
+
+    features.append( qMakePair( (int)FEATURE_DVD_READ, qMakePair( present && dvd, QByteArray( 4, 0 ) ) ) );
+
+    for( int i = 0; i < features.count(); ++i ) {
+        const int code = features[i].first;
+        const bool current = features[i].second.first;
+        const QByteArray& featureData = features[i].second.second;
+
+        if( ( rt == 2 && code != start ) ||
+            code < start ||
+            ( rt == 1 && !current ) )
+            continue;
+
+        QByteArray f( 4, 0 );
+        to2Byte( (unsigned char*)f.data(), code );
+        f[2] = 0x02 | ( current ? 0x1 : 0x0 );   // persistent
+        f[3] = featureData.size();
+        r.append( f );
+        r.append( featureData );
+    }
+
+    to4Byte( (unsigned char*)r.data(), r.size() - 4 );
+
+    reply( r, data, len, from2Byte( &cdb[7] ) );
+    return true;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::modeSense( const unsigned char* cdb, unsigned char* data, size_t len, SenseData& sense )
+{
+    QByteArray page;
+
+    switch( cdb[2] & 0x3F ) {
+    case 0x01:
+        // read/write error recovery
+        page = QByteArray( 12, 0 );
+        page[0] = 0x01;
+        page[1] = 0x0A;
+        page[2] = errorRecovery;
+        page[3] = 0x05;   // read retry count
+        break;
+
+    case 0x2A: {
+        // capabilities
+        page = QByteArray( 28, 0 );
+        unsigned char* p = (unsigned char*)page.data();
+        p[0] = 0x2A;
+        p[1] = 0x1A;
+        p[2] = 0x1F;   // reads CD-R, CD-RW, method 2, DVD-ROM, DVD-R
+        p[4] = 0x71;   // audio play, mode 2 form 1 and 2, multi session
+        p[5] = 0x17;   // CD-DA, accurate stream, R-W sub-channel, C2 pointers
+        p[6] = 0x29;   // tray, eject, lock
+        to2Byte( &p[8], MAX_READ_SPEED );
+        to2Byte( &p[12], 2048 );   // buffer size
+        to2Byte( &p[14], MAX_READ_SPEED );
+        break;
+    }
+
+    default:
+        return fail( sense, 0x5, 0x24 );
+    }
+
+    // header without block descriptors
+    QByteArray r( 8, 0 );
+    r.append( page );
+    to2Byte( (unsigned char*)r.data(), r.size() - 2 );
+
+    reply( r, data, len, from2Byte( &cdb[7] ) );
+    return true;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::modeSelect( unsigned char* data, size_t len )
+{
+    // all pages are accepted but only the error recovery is remembered
+    if( len >= 8+3 && ( data[8] & 0x3F ) == 0x01 )
+        errorRecovery = data[8+2];
+    return true;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::readCapacity( unsigned char* data, size_t len )
+{
+    unsigned char r[8];
+    to4Byte( r, totalSectors() - 1 );
+    to4Byte( &r[4], 2048 );
+    ::memcpy( data, r, qMin( len, sizeof(r) ) );
+    return true;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::readDiscInformation( unsigned char* data, size_t len )
+{
+    QByteArray r( 34, 0 );
+    to2Byte( (unsigned char*)r.data(), r.size() - 2 );
+    r[2] = 0x0E;   // complete disc with complete last session
+    r[3] = 1;      // first track
+    r[4] = 1;      // sessions
+    r[5] = 1;      // first track in last session
+    r[6] = tracks.count();
+    r[8] = ( !dvd && !tracks.isEmpty() && tracks.first().format == FORMAT_MODE2_RAW ? 0x20 : 0x00 );
+    // no lead-in and lead-out of complete media
+    ::memset( r.data() + 16, 0xFF, 8 );
+
+    reply( r, data, len, r.size() );
+    return true;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::readTrackInformation( const unsigned char* cdb, unsigned char* data, size_t len, SenseData& sense )
+{
+    const quint32 value = from4Byte( &cdb[2] );
+
+    int i = -1;
+    switch( cdb[1] & 0x3 ) {
+    case 0:
+        i = trackIndex( value );
+        break;
+    case 1:
+        if( value >= 1 && value <= (quint32)tracks.count() )
+            i = value - 1;
+        break;
+    case 2:
+        if( value == 1 )
+            i = 0;
+        break;
+    }
+
+    if( i < 0 )
+        return fail( sense, 0x5, 0x24 );
+
+    const ImageTrack& track = tracks[i];
+
+    QByteArray r( 36, 0 );
+    unsigned char* p = (unsigned char*)r.data();
+    to2Byte( p, r.size() - 2 );
+    p[2] = i+1;
+    p[3] = 1;   // session
+    p[5] = control( i );
+    if( track.format == FORMAT_AUDIO )
+        p[6] = 0x0F;
+    else if( track.format == FORMAT_MODE1 || track.format == FORMAT_MODE1_RAW )
+        p[6] = 0x01;
+    else
+        p[6] = 0x02;
+    to4Byte( &p[8], track.firstSector );
+    to4Byte( &p[24], track.length );
+    to4Byte( &p[28], track.firstSector + track.length - 1 );
+
+    reply( r, data, len, from2Byte( &cdb[7] ) );
+    return true;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::readToc( const unsigned char* cdb, unsigned char* data, size_t len, SenseData& sense )
+{
+    const bool time = ( cdb[1] & 0x2 );
+    const int format = cdb[2] & 0x0F;
+    const int startTrack = cdb[6];
+
+    QByteArray r( 4, 0 );
+    unsigned char* p = (unsigned char*)r.data();
+
+    switch( format ) {
+    case 0x0:
+    case 0x1: {
+        // formatted toc and session info
+        p[2] = 1;
+        p[3] = ( format == 0x0 ? tracks.count() : 1 );
+
+        QList<int> descriptors;
+        if( format == 0x1 ) {
+            descriptors.append( 0 );
+        }
+        else {
+            if( startTrack > tracks.count() && startTrack != 0xAA )
+                return fail( sense, 0x5, 0x24 );
+            for( int i = qMax( 0, startTrack-1 ); i < tracks.count(); ++i )
+                descriptors.append( i );
+            descriptors.append( tracks.count() );
+        }
+
+        Q_FOREACH( int i, descriptors ) {
+            unsigned char d[8];
+            ::memset( d, 0, 8 );
+            const bool leadOut = ( i == tracks.count() );
+            const int lba = ( leadOut ? totalSectors() : tracks[i].firstSector );
+            d[1] = 0x10 | control( leadOut ? i-1 : i );
+            d[2] = ( leadOut ? 0xAA : i+1 );
+            if( time ) {
+                const K3b::Msf msf( lba + 150 );
+                d[5] = msf.minutes();
+                d[6] = msf.seconds();
+                d[7] = msf.frames();
+            }
+            else {
+                to4Byte( &d[4], lba );
+            }
+            r.append( (const char*)d, 8 );
+        }
+        break;
+    }
+
+    case 0x2: {
+        // raw toc with hex values
+        p[2] = 1;
+        p[3] = 1;
+
+        const int last = tracks.count() - 1;
+        const int discType = ( tracks.first().format == FORMAT_MODE2_RAW ? 0x20 : 0x00 );
+        const K3b::Msf leadOut( totalSectors() + 150 );
+
+        // A0 and A1 carry the first and last track instead of an address
+        QList<int> points;
+        points << 0xA0 << 0xA1 << 0xA2;
+        for( int i = 0; i < tracks.count(); ++i )
+            points << i+1;
+
+        Q_FOREACH( int point, points ) {
+            unsigned char d[11];
+            ::memset( d, 0, 11 );
+            d[0] = 1;
+            d[1] = 0x10 | control( point == 0xA0 ? 0 : point >= 0xA1 ? last : point-1 );
+            d[3] = point;
+            if( point == 0xA0 ) {
+                d[8] = 1;
+                d[9] = discType;
+            }
+            else if( point == 0xA1 ) {
+                d[8] = tracks.count();
+            }
+            else {
+                const K3b::Msf msf( point == 0xA2 ? leadOut : K3b::Msf( tracks[point-1].firstSector + 150 ) );
+                d[8] = msf.minutes();
+                d[9] = msf.seconds();
+                d[10] = msf.frames();
+            }
+            r.append( (const char*)d, 11 );
+        }
+        break;
+    }
+
+    case 0x5:
+        if( cdText.isEmpty() )
+            return fail( sense, 0x5, 0x24 );
+        r = cdText.rawPackData();
+        break;
+
+    default:
+        // no ATIP or PMA on pressed media
+        return fail( sense, 0x5, 0x24 );
+    }
+
+    to2Byte( (unsigned char*)r.data(), r.size() - 2 );
+
+    reply( r, data, len, from2Byte( &cdb[7] ) );
+    return true;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::readDiscStructure( const unsigned char* cdb, unsigned char* data, size_t len, SenseData& sense )
+{
+    if( !dvd || ( cdb[1] & 0xF ) != 0 )
+        return fail( sense, 0x5, 0x30, 0x02 );
+    if( cdb[7] != 0x00 )
+        return fail( sense, 0x5, 0x24 );
+
+    // physical format information of a single layer DVD-ROM
+    QByteArray r( 4 + 2048, 0 );
+    unsigned char* p = (unsigned char*)r.data();
+    to2Byte( p, r.size() - 2 );
+    p[4] = 0x01;   // DVD-ROM, version 1
+    p[5] = 0x02;   // 120mm, 10.08 Mbps
+    p[6] = 0x01;   // single layer, parallel track path, embossed
+    p[7] = 0x10;
+    to4Byte( &p[8], 0x030000 );
+    to4Byte( &p[12], 0x030000 + totalSectors() - 1 );
+
+    reply( r, data, len, from2Byte( &cdb[8] ) );
+    return true;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::read( int lba, int count, unsigned char* data, size_t len, SenseData& sense )
+{
+    if( lba < 0 || lba + count > totalSectors() )
+        return fail( sense, 0x5, 0x21 );
+    if( (size_t)count * 2048 > len )
+        return fail( sense, 0x5, 0x24 );
+    if( hasReadError( lba, count ) )
+        return fail( sense, 0x3, 0x11 );
+
+    unsigned char raw[RAW_SECTOR_SIZE];
+    int sector = lba;
+    while( sector < lba + count ) {
+        const ImageTrack& track = tracks[trackIndex( sector )];
+        unsigned char* buf = data + (size_t)( sector - lba ) * 2048;
+
+        if( track.format == FORMAT_MODE1 ) {
+            // cooked data is read in one go
+            const int n = qMin( lba + count, track.firstSector + track.length ) - sector;
+            QFile* file = files[track.file];
+            const qint64 pos = (qint64)( track.fileSector + sector - track.firstSector ) * 2048;
+            if( !file->seek( pos ) || file->read( (char*)buf, (qint64)n * 2048 ) < 0 )
+                return fail( sense, 0x3, 0x11 );
+            sector += n;
+            continue;
+        }
+
+        SectorFormat format;
+        if( !readSector( sector, raw, format ) )
+            return fail( sense, 0x3, 0x11 );
+
+        switch( sectorType( format, raw ) ) {
+        case SECTOR_MODE1:
+            ::memcpy( buf, raw + 16, 2048 );
+            break;
+        case SECTOR_MODE2_FORM1:
+            ::memcpy( buf, raw + 24, 2048 );
+            break;
+        default:
+            // READ (10) only returns 2048 bytes sectors
+            return fail( sense, 0x5, 0x64 );
+        }
+
+        ++sector;
+    }
+
+    sectorsRead += count;
+    return true;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::readCd( const unsigned char* cdb, int lba, int count, unsigned char* data, size_t len, SenseData& sense )
+{
+    if( dvd )
+        return fail( sense, 0x5, 0x30, 0x02 );
+    if( lba < 0 || lba + count > totalSectors() )
+        return fail( sense, 0x5, 0x21 );
+    if( hasReadError( lba, count ) )
+        return fail( sense, 0x3, 0x11 );
+
+    const int expectedType = ( cdb[1]>>2 ) & 0x7;
+    const int fields = cdb[9] & 0xF8;
+    const int c2 = ( cdb[9]>>1 ) & 0x3;
+    const int subChannel = cdb[10] & 0x7;
+
+    unsigned char raw[RAW_SECTOR_SIZE];
+    size_t pos = 0;
+
+    for( int sector = lba; sector < lba + count; ++sector ) {
+        SectorFormat format;
+        if( !readSector( sector, raw, format ) )
+            return fail( sense, 0x3, 0x11 );
+
+        const int type = sectorType( format, raw );
+        if( expectedType != 0 && expectedType != type )
+            return fail( sense, 0x5, 0x64 );
+
+        // the parts of the raw sector to transfer
+        QList<QPair<int, int> > parts;
+        if( type == SECTOR_CDDA ) {
+            if( fields )
+                parts.append( qMakePair( 0, RAW_SECTOR_SIZE ) );
+        }
+        else {
+            if( fields & 0x80 )
+                parts.append( qMakePair( 0, 12 ) );
+            if( fields & 0x20 )
+                parts.append( qMakePair( 12, 4 ) );
+            if( type == SECTOR_MODE1 ) {
+                if( fields & 0x10 )
+                    parts.append( qMakePair( 16, 2048 ) );
+                if( fields & 0x08 )
+                    parts.append( qMakePair( 2064, 288 ) );
+            }
+            else if( type == SECTOR_MODE2 ) {
+                if( fields & 0x10 )
+                    parts.append( qMakePair( 16, 2336 ) );
+            }
+            else {
+                if( fields & 0x40 )
+                    parts.append( qMakePair( 16, 8 ) );
+                if( type == SECTOR_MODE2_FORM1 ) {
+                    if( fields & 0x10 )
+                        parts.append( qMakePair( 24, 2048 ) );
+                    if( fields & 0x08 )
+                        parts.append( qMakePair( 2072, 280 ) );
+                }
+                else {
+                    if( fields & 0x10 )
+                        parts.append( qMakePair( 24, 2324 ) );
+                    if( fields & 0x08 )
+                        parts.append( qMakePair( 2348, 4 ) );
+                }
+            }
+        }
+
+        size_t size = 0;
+        for( int i = 0; i < parts.count(); ++i )
+            size += parts[i].second;
+        if( c2 == 1 )
+            size += 294;
+        else if( c2 == 2 )
+            size += 296;
+        if( subChannel == 1 || subChannel == 4 )
+            size += 96;
+        else if( subChannel == 2 )
+            size += 16;
+
+        if( pos + size > len )
+            return fail( sense, 0x5, 0x24 );
+
+        for( int i = 0; i < parts.count(); ++i ) {
+            ::memcpy( data + pos, raw + parts[i].first, parts[i].second );
+            pos += parts[i].second;
+        }
+
+        // no C2 errors
+        if( c2 == 1 ) {
+            ::memset( data + pos, 0, 294 );
+            pos += 294;
+        }
+        else if( c2 == 2 ) {
+            ::memset( data + pos, 0, 296 );
+            pos += 296;
+        }
+
+        if( subChannel ) {
+            unsigned char q[12];
+            subQ( sector, q );
+
+            if( subChannel == 2 ) {
+                ::memset( data + pos, 0, 16 );
+                ::memcpy( data + pos, q, 10 );
+                pos += 16;
+            }
+            else {
+                // P is set in the pregap, Q is the only other channel with data
+                const bool pause = ( q[2] == 0 );
+                for( int i = 0; i < 96; ++i ) {
+                    unsigned char b = 0;
+                    if( subChannel == 1 ) {
+                        if( pause )
+                            b |= 0x80;
+                        if( ( q[i/8] >> ( 7 - i%8 ) ) & 0x1 )
+                            b |= 0x40;
+                    }
+                    data[pos+i] = b;
+                }
+                pos += 96;
+            }
+        }
+    }
+
+    sectorsRead += count;
+    return true;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::getEventStatus( const unsigned char* cdb, unsigned char* data, size_t len )
+{
+    QByteArray r( 4, 0 );
+    r[3] = 0x10;   // media class only
+
+    if( cdb[4] & 0x10 ) {
+        r[2] = 0x04;
+        QByteArray event( 4, 0 );
+        event[0] = pendingEvent;
+        event[1] = ( mediumPresent() ? 0x02 : 0x00 );
+        r.append( event );
+        pendingEvent = MEDIA_EVENT_NONE;
+    }
+    else {
+        // no event available
+        r[2] = 0x80;
+    }
+
+    to2Byte( (unsigned char*)r.data(), r.size() - 2 );
+
+    reply( r, data, len, from2Byte( &cdb[7] ) );
+    return true;
+}
+
+
+bool K3b::Device::SimulatedDrive::Private::startStopUnit( const unsigned char* cdb )
+{
+    const bool loej = ( cdb[4] & 0x2 );
+    const bool start = ( cdb[4] & 0x1 );
+
+    if( loej && !tracks.isEmpty() ) {
+        if( !start && !ejected ) {
+            ejected = true;
+            pendingEvent = MEDIA_EVENT_MEDIA_REMOVAL;
+        }
+        else if( start && ejected ) {
+            ejected = false;
+            pendingEvent = MEDIA_EVENT_NEW_MEDIA;
+        }
+    }
+
+    return true;
+}
+
+
+K3b::Device::SimulatedDrive::SimulatedDrive()
+    : d( new Private() )
+{
+}
+
+
+K3b::Device::SimulatedDrive::~SimulatedDrive()
+{
+    delete d;
+}
+
+
+bool K3b::Device::SimulatedDrive::load( const QString& filename )
+{
+    QMutexLocker locker( &d->mutex );
+
+    d->clear();
+    d->ejected = false;
+
+    bool success = false;
+    if( filename.endsWith( QLatin1String( ".cue" ), Qt::CaseInsensitive ) )
+        success = d->loadCue( filename );
+    else
+        success = d->loadIso( filename );
+
+    if( !success ) {
+        d->clear();
+        d->pendingEvent = MEDIA_EVENT_MEDIA_REMOVAL;
+        return false;
+    }
+
+    qDebug() << "(K3b::Device::SimulatedDrive) loaded" << filename << "with" << d->tracks.count()
+             << "tracks and" << d->totalSectors() << "sectors";
+    d->pendingEvent = MEDIA_EVENT_NEW_MEDIA;
+    return true;
+}
+
+
+void K3b::Device::SimulatedDrive::unload()
+{
+    QMutexLocker locker( &d->mutex );
+    d->clear();
+    d->pendingEvent = MEDIA_EVENT_MEDIA_REMOVAL;
+}
+
+
+bool K3b::Device::SimulatedDrive::isLoaded() const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->mediumPresent();
+}
+
+
+K3b::Device::Toc K3b::Device::SimulatedDrive::toc() const
+{
+    QMutexLocker locker( &d->mutex );
+
+    Toc toc;
+    for( int i = 0; i < d->tracks.count(); ++i ) {
+        const ImageTrack& t = d->tracks[i];
+        Track track( t.firstSector,
+                     t.firstSector + t.length - 1,
+                     t.format == FORMAT_AUDIO ? Track::TYPE_AUDIO : Track::TYPE_DATA,
+                     t.format == FORMAT_AUDIO ? Track::UNKNOWN : d->dataMode( t ) );
+        track.setSession( 1 );
+        toc.append( track );
+    }
+    return toc;
+}
+
+
+K3b::Device::CdText K3b::Device::SimulatedDrive::cdText() const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->cdText;
+}
+
+
+void K3b::Device::SimulatedDrive::setCommandLatency( int usecs )
+{
+    QMutexLocker locker( &d->mutex );
+    d->commandLatency = qMax( 0, usecs );
+}
+
+
+void K3b::Device::SimulatedDrive::setSectorLatency( int usecs )
+{
+    QMutexLocker locker( &d->mutex );
+    d->sectorLatency = qMax( 0, usecs );
+}
+
+
+void K3b::Device::SimulatedDrive::setMaxTransferLength( int sectors )
+{
+    QMutexLocker locker( &d->mutex );
+    d->maxTransferLength = qMax( 0, sectors );
+}
+
+
+void K3b::Device::SimulatedDrive::addReadErrors( int first, int count )
+{
+    QMutexLocker locker( &d->mutex );
+    d->readErrors.append( qMakePair( first, count ) );
+}
+
+
+void K3b::Device::SimulatedDrive::clearReadErrors()
+{
+    QMutexLocker locker( &d->mutex );
+    d->readErrors.clear();
+}
+
+
+void K3b::Device::SimulatedDrive::addFailingReads( int count )
+{
+    QMutexLocker locker( &d->mutex );
+    d->failingReads += qMax( 0, count );
+}
+
+
+int K3b::Device::SimulatedDrive::commandCount() const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->commandCount;
+}
+
+
+qint64 K3b::Device::SimulatedDrive::sectorsRead() const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->sectorsRead;
+}
+
+
+void K3b::Device::SimulatedDrive::resetStatistics()
+{
+    QMutexLocker locker( &d->mutex );
+    d->commandCount = 0;
+    d->sectorsRead = 0;
+}
+
+
+bool K3b::Device::SimulatedDrive::execute( const unsigned char* cdb,
+                                           TransportDirection dir,
+                                           unsigned char* data,
+                                           size_t len,
+                                           SenseData& sense )
+{
+    Q_UNUSED( dir );
+
+    QMutexLocker locker( &d->mutex );
+
+    ++d->commandCount;
+
+    int sectors = 0;
+    bool success = false;
+
+    // commands which need a medium
+    switch( cdb[0] ) {
+    case MMC_TEST_UNIT_READY:
+    case MMC_READ_CAPACITY:
+    case MMC_READ_DISC_INFORMATION:
+    case MMC_READ_TRACK_INFORMATION:
+    case MMC_READ_TOC_PMA_ATIP:
+    case MMC_READ_DVD_STRUCTURE:
+    case MMC_READ_10:
+    case MMC_READ_12:
+    case MMC_READ_CD:
+    case MMC_READ_CD_MSF:
+    case MMC_SEEK_10:
+        if( !d->mediumPresent() ) {
+            const int latency = d->commandLatency;
+            locker.unlock();
+            if( latency > 0 )
+                QThread::usleep( latency );
+            return fail( sense, 0x2, 0x3A );
+        }
+        break;
+    }
+
+    switch( cdb[0] ) {
+    case MMC_TEST_UNIT_READY:
+    case MMC_PREVENT_ALLOW_MEDIUM_REMOVAL:
+    case MMC_SET_SPEED:
+    case MMC_SET_STREAMING:
+    case MMC_SET_READ_AHEAD:
+    case MMC_SEEK_10:
+    case MMC_SYNCHRONIZE_CACHE:
+        success = true;
+        break;
+
+    case MMC_INQUIRY:
+        success = d->inquiry( cdb, data, len, sense );
+        break;
+
+    case MMC_GET_CONFIGURATION:
+        success = d->getConfiguration( cdb, data, len, sense );
+        break;
+
+    case MMC_MODE_SENSE:
+        success = d->modeSense( cdb, data, len, sense );
+        break;
+
+    case MMC_MODE_SELECT:
+        success = d->modeSelect( data, len );
+        break;
+
+    case MMC_READ_CAPACITY:
+        success = d->readCapacity( data, len );
+        break;
+
+    case MMC_READ_DISC_INFORMATION:
+        success = d->readDiscInformation( data, len );
+        break;
+
+    case MMC_READ_TRACK_INFORMATION:
+        success = d->readTrackInformation( cdb, data, len, sense );
+        break;
+
+    case MMC_READ_TOC_PMA_ATIP:
+        success = d->readToc( cdb, data, len, sense );
+        break;
+
+    case MMC_READ_DVD_STRUCTURE:
+        success = d->readDiscStructure( cdb, data, len, sense );
+        break;
+
+    case MMC_GET_EVENT_STATUS_NOTIFICATION:
+        success = d->getEventStatus( cdb, data, len );
+        break;
+
+    case MMC_START_STOP_UNIT:
+        success = d->startStopUnit( cdb );
+        break;
+
+    case MMC_READ_10:
+    case MMC_READ_12:
+    case MMC_READ_CD:
+    case MMC_READ_CD_MSF: {
+        int lba = 0;
+        if( cdb[0] == MMC_READ_CD_MSF ) {
+            lba = K3b::Msf( cdb[3], cdb[4], cdb[5] ).lba() - 150;
+            sectors = K3b::Msf( cdb[6], cdb[7], cdb[8] ).lba() - 150 - lba;
+        }
+        else {
+            lba = (int)from4Byte( &cdb[2] );
+            if( cdb[0] == MMC_READ_10 )
+                sectors = from2Byte( &cdb[7] );
+            else if( cdb[0] == MMC_READ_12 )
+                sectors = from4Byte( &cdb[6] );
+            else
+                sectors = ( cdb[6]<<16 | cdb[7]<<8 | cdb[8] );
+        }
+
+        if( d->failingReads > 0 ) {
+            // LOGICAL UNIT IS IN PROCESS OF BECOMING READY
+            --d->failingReads;
+            success = fail( sense, 0x2, 0x04, 0x01 );
+            sectors = 0;
+        }
+        else if( sectors < 0 || ( d->maxTransferLength > 0 && sectors > d->maxTransferLength ) ) {
+            success = fail( sense, 0x5, 0x24 );
+            sectors = 0;
+        }
+        else if( cdb[0] == MMC_READ_10 || cdb[0] == MMC_READ_12 )
+            success = d->read( lba, sectors, data, len, sense );
+        else
+            success = d->readCd( cdb, lba, sectors, data, len, sense );
+        break;
+    }
+
+    default:
+        qDebug() << "(K3b::Device::SimulatedDrive) unsupported command" << commandString( cdb[0] );
+        success = fail( sense, 0x5, 0x20 );
+        break;
+    }
+
+    const int latency = d->commandLatency + sectors * d->sectorLatency;
+    locker.unlock();
+
+    if( latency > 0 )
+        QThread::usleep( latency );
+
+    return success;
+}
@@ -0,0 +1,141 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#ifndef _K3B_SIMULATED_DRIVE_H_
+#define _K3B_SIMULATED_DRIVE_H_
+
+#include "k3bscsitransport.h"
+#include "k3btoc.h"
+#include "k3bcdtext.h"
+#include "k3bdevice_export.h"
+
+#include <QString>
+
+namespace K3b {
+    namespace Device
+    {
+        /**
+         * \brief An MMC drive emulated from an image file.
+         *
+         * The drive answers the commands K3b uses to read media: INQUIRY,
+         * GET CONFIGURATION, MODE SENSE, READ CAPACITY, READ DISC/TRACK
+         * INFORMATION, READ TOC/PMA/ATIP including raw TOC and CD-Text,
+         * READ DISC STRUCTURE, READ (10/12), READ CD (MSF) with sync, headers,
+         * C2 and sub-channel data and GET EVENT STATUS NOTIFICATION. Commands
+         * which only change the state of a real drive like SET SPEED or MODE
+         * SELECT succeed without effect. Writing is not supported.
+         *
+         * Supported images are plain ISO images, which become a single Mode1
+         * track on a CD-ROM or a DVD-ROM depending on their size, and cue
+         * sheets with BINARY files. The TITLE, PERFORMER and SONGWRITER
+         * entries of a cue sheet are reported as CD-Text.
+         *
+         * EDC/ECC bytes of synthesized sectors are 0.
+         *
+         * The drive is used with DeviceManager::addSimulatedDevice() or the
+         * K3B_SIMULATED_DRIVES environment variable.
+         *
+         * \code
+         *   SimulatedDrive* drive = new SimulatedDrive();
+         *   drive->load( "image.cue" );
+         *   drive->setSectorLatency( 50 );
+         *   drive->addReadErrors( 1000, 10 );
+         *   Device* dev = deviceManager->addSimulatedDevice( drive, "sim:test" );
+         * \endcode
+         */
+        class LIBK3BDEVICE_EXPORT SimulatedDrive : public ScsiTransport
+        {
+        public:
+            SimulatedDrive();
+            ~SimulatedDrive() override;
+
+            /**
+             * Loads an image into the drive. A cue sheet is detected by its
+             * suffix, any other file is used as ISO image.
+             *
+             * \return false if the image could not be read. The drive is
+             *         empty in that case.
+             */
+            bool load( const QString& filename );
+
+            /**
+             * Removes the medium from the drive.
+             */
+            void unload();
+
+            bool isLoaded() const;
+
+            /**
+             * \return The toc of the loaded medium.
+             */
+            Toc toc() const;
+
+            /**
+             * \return The CD-Text of the loaded medium.
+             */
+            CdText cdText() const;
+
+            /**
+             * Time every command takes in microseconds. Default is 0.
+             */
+            void setCommandLatency( int usecs );
+
+            /**
+             * Additional time every read sector takes in microseconds.
+             * Default is 0.
+             */
+            void setSectorLatency( int usecs );
+
+            /**
+             * The maximum number of sectors per read command. Reading more
+             * fails with an ILLEGAL REQUEST like a drive does which does not
+             * support the transfer length. A limit is reported in the Block
+             * Limits VPD page. 0, the default, means no limit.
+             */
+            void setMaxTransferLength( int sectors );
+
+            /**
+             * Makes reading the sectors \p first to \p first + \p count - 1
+             * fail with an unrecovered read error.
+             */
+            void addReadErrors( int first, int count = 1 );
+            void clearReadErrors();
+
+            /**
+             * Makes the next \p count read commands fail with NOT READY like
+             * a drive which is still spinning up.
+             */
+            void addFailingReads( int count = 1 );
+
+            /**
+             * \return The number of commands executed since the last
+             *         resetStatistics().
+             */
+            int commandCount() const;
+
+            /**
+             * \return The number of sectors read since the last
+             *         resetStatistics().
+             */
+            qint64 sectorsRead() const;
+
+            void resetStatistics();
+
+            bool execute( const unsigned char* cdb,
+                          TransportDirection dir,
+                          unsigned char* data,
+                          size_t len,
+                          SenseData& sense ) override;
+
+        private:
+            class Private;
+            Private* const d;
+
+            Q_DISABLE_COPY( SimulatedDrive )
+        };
+    }
+}
+
+#endif
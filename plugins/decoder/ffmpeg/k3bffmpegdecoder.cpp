@@ -119,6 +119,19 @@ bool K3bFFMpegDecoder::analyseFileInternal( K3b::Msf& frames, int& samplerate, i
 }
 
 
+QByteArray K3bFFMpegDecoder::analysisData() const
+{
+    return m_type.toUtf8();
+}
+
+
+bool K3bFFMpegDecoder::restoreAnalysisData( const QByteArray& data )
+{
+    m_type = QString::fromUtf8( data );
+    return true;
+}
+
+
 bool K3bFFMpegDecoder::initDecoderInternal()
 {
     if( !m_file )
@@ -47,6 +47,9 @@ protected:
     bool initDecoderInternal() override;
     bool seekInternal( const K3b::Msf& ) override;
 
+    QByteArray analysisData() const override;
+    bool restoreAnalysisData( const QByteArray& data ) override;
+
     int decodeInternal( char* _data, int maxLen ) override;
 
 private:
@@ -17,10 +17,12 @@
 
 #include "k3bmaddecoder.h"
 #include "k3bmad.h"
+#include "k3baudiodecodercache.h"
 #include "k3bplugin_i18n.h"
 
 #include <config-k3b.h>
 
+#include <QDataStream>
 #include <QDebug>
 #include <QString>
 #include <QFile>
@@ -128,6 +130,57 @@ bool K3bMadDecoder::analyseFileInternal( K3b::Msf& frames, int& samplerate, int&
 }
 
 
+QByteArray K3bMadDecoder::analysisData() const
+{
+    QByteArray data;
+    QDataStream s( &data, QIODevice::WriteOnly );
+    s << qint32( d->firstHeader.layer )
+      << qint32( d->firstHeader.mode )
+      << qint32( d->firstHeader.emphasis )
+      << quint32( d->firstHeader.bitrate )
+      << quint32( d->firstHeader.samplerate )
+      << qint32( d->firstHeader.flags )
+      << qint64( d->firstHeader.duration.seconds )
+      << quint64( d->firstHeader.duration.fraction )
+      << d->vbr
+      << K3b::AudioDecoderCache::packSeekIndex( d->seekPositions );
+    return data;
+}
+
+
+bool K3bMadDecoder::restoreAnalysisData( const QByteArray& data )
+{
+    qint32 layer = 0, mode = 0, emphasis = 0, flags = 0;
+    quint32 bitrate = 0, samplerate = 0;
+    qint64 seconds = 0;
+    quint64 fraction = 0;
+    bool vbr = false;
+    QByteArray seekIndex;
+
+    QDataStream s( data );
+    s >> layer >> mode >> emphasis >> bitrate >> samplerate >> flags
+      >> seconds >> fraction >> vbr >> seekIndex;
+    if( s.status() != QDataStream::Ok ||
+        !K3b::AudioDecoderCache::unpackSeekIndex( seekIndex, d->seekPositions ) ||
+        d->seekPositions.isEmpty() )
+        return false;
+
+    // everything countFrames() determines
+    mad_header_init( &d->firstHeader );
+    d->firstHeader.layer = static_cast<mad_layer>( layer );
+    d->firstHeader.mode = static_cast<mad_mode>( mode );
+    d->firstHeader.emphasis = static_cast<mad_emphasis>( emphasis );
+    d->firstHeader.bitrate = bitrate;
+    d->firstHeader.samplerate = samplerate;
+    d->firstHeader.flags = flags;
+    d->firstHeader.duration.seconds = seconds;
+    d->firstHeader.duration.fraction = fraction;
+    d->vbr = vbr;
+
+    return true;
+}
+
+
 bool K3bMadDecoder::initDecoderInternal()
 {
     cleanup();
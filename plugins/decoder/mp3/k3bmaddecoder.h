@@ -53,6 +53,9 @@ protected:
     bool analyseFileInternal( K3b::Msf& frames, int& samplerate, int& ch ) override;
     bool initDecoderInternal() override;
 
+    QByteArray analysisData() const override;
+    bool restoreAnalysisData( const QByteArray& data ) override;
+
     int decodeInternal( char* _data, int maxLen ) override;
  
 private:
@@ -6,6 +6,7 @@
 */
 #include "k3bwavedecoder.h"
 #include "k3bplugin_i18n.h"
+#include "k3bsampleconversion.h"
 
 #include <config-k3b.h>
 
@@ -211,12 +212,7 @@ int K3bWaveDecoder::decodeInternal( char* _data, int maxLen )
             }
 
             // swap bytes
-            char buf;
-            for( int i = 0; i < read; i+=2 ) {
-                buf = _data[i];
-                _data[i] = _data[i+1];
-                _data[i+1] = buf;
-            }
+            K3b::SampleConversion::swapByteOrder16( _data, read/2 );
         }
     }
     else {
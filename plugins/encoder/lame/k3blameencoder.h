@@ -30,6 +30,8 @@ public:
 
     long long fileSize( const QString&, const K3b::Msf& msf ) const override;
 
+    bool isReentrant() const override { return true; }
+
     int pluginSystemVersion() const override { return K3B_PLUGIN_SYSTEM_VERSION; }
 
 private:
@@ -9,6 +9,7 @@
 #include "k3boggvorbisencoderdefaults.h"
 #include "k3bcore.h"
 #include "k3bplugin_i18n.h"
+#include "k3bsampleconversion.h"
 #include <config-k3b.h>
 
 #include <KConfig>
@@ -290,14 +291,10 @@ qint64 K3bOggVorbisEncoder::encodeInternal( const char* data, qint64 len )
     float** buffer = vorbis_analysis_buffer( d->vorbisDspState, len/4 );
 
     // uninterleave samples
-    qint64 i = 0;
-    for( i = 0; i < len/4; ++i ) {
-        buffer[0][i]=( (data[i*4+1]<<8) | (0x00ff&(int)data[i*4]) ) / 32768.f;
-        buffer[1][i]=( (data[i*4+3]<<8) | (0x00ff&(int)data[i*4+2]) ) / 32768.f;
-    }
+    K3b::SampleConversion::from16BitLeStereoToFloat( data, buffer[0], buffer[1], len/4 );
 
     // tell the library how much we actually submitted
-    vorbis_analysis_wrote( d->vorbisDspState, i );
+    vorbis_analysis_wrote( d->vorbisDspState, len/4 );
 
     return flushVorbis();
 }
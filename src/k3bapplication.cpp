@@ -244,7 +244,6 @@ void K3b::Application::Core::init()
     // the default programs handled by K3b::Core
     //
     externalBinManager()->addProgram( new MovixProgram() );
-    externalBinManager()->addProgram( new NormalizeProgram() );
     addTranscodePrograms( externalBinManager() );
     addVcdimagerPrograms( externalBinManager() );
 
@@ -54,7 +54,15 @@ K3b::BurnProgressDialog::BurnProgressDialog( QWidget *parent, bool showSubProgre
 
     m_progressDeviceBuffer = new QProgressBar( m_frameExtraInfo );
     m_frameExtraInfoLayout->addWidget( m_progressDeviceBuffer, 2, 3 );
-    m_frameExtraInfoLayout->addWidget( K3b::StdGuiItems::verticalLine( m_frameExtraInfo ), 1, 1, 2, 1 );
+    m_frameExtraInfoLayout->addWidget( K3b::StdGuiItems::verticalLine( m_frameExtraInfo ), 1, 1, 3, 1 );
+
+    // only shown for jobs which decode audio ahead of the writer
+    m_labelReadAheadBuffer = new QLabel( i18n("Read-ahead buffer:"), m_frameExtraInfo );
+    m_frameExtraInfoLayout->addWidget( m_labelReadAheadBuffer, 3, 2 );
+    m_progressReadAheadBuffer = new QProgressBar( m_frameExtraInfo );
+    m_frameExtraInfoLayout->addWidget( m_progressReadAheadBuffer, 3, 3 );
+    m_labelReadAheadBuffer->hide();
+    m_progressReadAheadBuffer->hide();
 }
 
 K3b::BurnProgressDialog::~BurnProgressDialog()
@@ -78,9 +86,11 @@ void K3b::BurnProgressDialog::setBurnJob( K3b::BurnJob* burnJob )
     if( burnJob ) {
         connect( burnJob, SIGNAL(bufferStatus(int)), this, SLOT(slotBufferStatus(int)) );
         connect( burnJob, SIGNAL(deviceBuffer(int)), this, SLOT(slotDeviceBuffer(int)) );
+        connect( burnJob, SIGNAL(readAheadBufferStatus(int)), this, SLOT(slotReadAheadBufferStatus(int)) );
         connect( burnJob, SIGNAL(writeSpeed(int,K3b::Device::SpeedMultiplicator)), this, SLOT(slotWriteSpeed(int,K3b::Device::SpeedMultiplicator)) );
         connect( burnJob, SIGNAL(burning(bool)), m_progressWritingBuffer, SLOT(setEnabled(bool)) );
         connect( burnJob, SIGNAL(burning(bool)), m_progressDeviceBuffer, SLOT(setEnabled(bool)) );
+        connect( burnJob, SIGNAL(burning(bool)), m_progressReadAheadBuffer, SLOT(setEnabled(bool)) );
         connect( burnJob, SIGNAL(burning(bool)), m_labelWritingSpeed, SLOT(setEnabled(bool)) );
 
         if( burnJob->writer() )
@@ -101,6 +111,7 @@ void K3b::BurnProgressDialog::slotFinished( bool success )
         m_labelWritingSpeed->setEnabled( false );
         m_progressWritingBuffer->setEnabled( false );
         m_progressDeviceBuffer->setEnabled( false );
+        m_progressReadAheadBuffer->setEnabled( false );
     }
 }
 
@@ -119,6 +130,14 @@ void K3b::BurnProgressDialog::slotDeviceBuffer( int b )
 }
 
 
+void K3b::BurnProgressDialog::slotReadAheadBufferStatus( int b )
+{
+    m_labelReadAheadBuffer->show();
+    m_progressReadAheadBuffer->show();
+    m_progressReadAheadBuffer->setValue( b );
+}
+
+
 void K3b::BurnProgressDialog::slotWriteSpeed( int s, K3b::Device::SpeedMultiplicator multiplicator )
 {
     m_labelWritingSpeed->setText( QString("%1 KB/s (%2x)").arg(s).arg(QLocale::system().toString((double)s/(double)multiplicator,'g',2)) );
@@ -34,12 +34,15 @@ namespace K3b {
         void slotWriteSpeed( int, K3b::Device::SpeedMultiplicator );
         void slotBufferStatus( int );
         void slotDeviceBuffer( int );
+        void slotReadAheadBufferStatus( int );
         void slotFinished(bool) override;
 
     protected:
         ThemedLabel* m_labelWriter;
         QProgressBar* m_progressWritingBuffer;
         QProgressBar* m_progressDeviceBuffer;
+        QLabel* m_labelReadAheadBuffer;
+        QProgressBar* m_progressReadAheadBuffer;
         QLabel* m_labelWritingSpeed;
     };
 }
@@ -345,6 +345,8 @@ void K3b::ProjectManager::loadDefaults( K3b::Doc* doc )
             dataDoc->setDataMode( K3b::DataModeAuto );
 
         dataDoc->setVerifyData( c.readEntry( "verify data", false ) );
+        dataDoc->setStopVerifyingOnFirstDifference( c.readEntry( "stop verifying on first difference", false ) );
+        dataDoc->setSaveChecksums( c.readEntry( "save checksums", false ) );
 
         QString s = c.readEntry( "multisession mode" );
         if( s == "none" )
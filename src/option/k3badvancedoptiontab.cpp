@@ -56,13 +56,22 @@ void K3b::AdvancedOptionTab::setupGui()
     m_editWritingBufferSize->setRange( 1, 100 );
     m_editWritingBufferSize->setValue( 4 );
     m_editWritingBufferSize->setSuffix( ' ' + i18n("MB") );
+    QLabel* labelAudioReadAheadBufferSize = new QLabel( i18n("Audio &read-ahead buffer:"), groupWritingApp );
+    m_editAudioReadAheadBufferSize = new QSpinBox( groupWritingApp );
+    m_editAudioReadAheadBufferSize->setRange( 0, 512 );
+    m_editAudioReadAheadBufferSize->setValue( 64 );
+    m_editAudioReadAheadBufferSize->setSuffix( ' ' + i18n("MB") );
+    m_editAudioReadAheadBufferSize->setSpecialValueText( i18n("Disabled") );
+    labelAudioReadAheadBufferSize->setBuddy( m_editAudioReadAheadBufferSize );
     m_checkShowForceGuiElements = new QCheckBox( i18n("Show &advanced GUI elements"), groupWritingApp );
     bufferLayout->addWidget( m_checkBurnfree, 0, 0, 1, 3 );
     bufferLayout->addWidget( m_checkOverburn, 1, 0, 1, 2 );
     bufferLayout->addWidget( m_checkForceUnsafeOperations, 2, 0, 1, 3 );
     bufferLayout->addWidget( m_checkManualWritingBufferSize, 3, 0 );
     bufferLayout->addWidget( m_editWritingBufferSize, 3, 1 );
-    bufferLayout->addWidget( m_checkShowForceGuiElements, 4, 0, 1, 3 );
+    bufferLayout->addWidget( labelAudioReadAheadBufferSize, 4, 0 );
+    bufferLayout->addWidget( m_editAudioReadAheadBufferSize, 4, 1 );
+    bufferLayout->addWidget( m_checkShowForceGuiElements, 5, 0, 1, 3 );
     bufferLayout->setColumnStretch( 2, 1 );
 
     QGroupBox* groupMisc = new QGroupBox( i18n("Miscellaneous"), this );
@@ -122,6 +131,12 @@ void K3b::AdvancedOptionTab::setupGui()
                                                        "<p>If this option is checked the value specified will be used for both "
                                                        "CD and DVD burning.", 4, 32) );
 
+    m_editAudioReadAheadBufferSize->setWhatsThis( i18n("<p>When writing an audio project on-the-fly K3b decodes the "
+                                                       "audio files ahead of time into a buffer of this size. This "
+                                                       "prevents buffer underruns if decoding is slow for a moment, "
+                                                       "for example when seeking in a file."
+                                                       "<p>Large buffers are recommended for high writing speeds.") );
+
     m_checkEject->setWhatsThis( i18n("<p>If this option is checked K3b will not eject the medium once the burn process "
                                      "finishes. This can be helpful in case one leaves the computer after starting the "
                                      "burning and does not want the tray to be open all the time."
@@ -151,6 +166,7 @@ void K3b::AdvancedOptionTab::readSettings()
     m_checkManualWritingBufferSize->setChecked( k3bcore->globalSettings()->useManualBufferSize() );
     if( k3bcore->globalSettings()->useManualBufferSize() )
         m_editWritingBufferSize->setValue( k3bcore->globalSettings()->bufferSize() );
+    m_editAudioReadAheadBufferSize->setValue( k3bcore->globalSettings()->audioReadAheadBufferSize() );
 }
 
 
@@ -166,6 +182,7 @@ void K3b::AdvancedOptionTab::saveSettings()
     k3bcore->globalSettings()->setBurnfree( m_checkBurnfree->isChecked() );
     k3bcore->globalSettings()->setUseManualBufferSize( m_checkManualWritingBufferSize->isChecked() );
     k3bcore->globalSettings()->setBufferSize( m_editWritingBufferSize->value() );
+    k3bcore->globalSettings()->setAudioReadAheadBufferSize( m_editAudioReadAheadBufferSize->value() );
     k3bcore->globalSettings()->setForce( m_checkForceUnsafeOperations->isChecked() );
 }
 
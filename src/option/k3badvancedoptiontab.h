@@ -38,6 +38,7 @@ namespace K3b {
         QCheckBox*    m_checkOverburn;
         QCheckBox*    m_checkManualWritingBufferSize;
         QSpinBox*     m_editWritingBufferSize;
+        QSpinBox*     m_editAudioReadAheadBufferSize;
         QCheckBox*    m_checkShowForceGuiElements;
         QCheckBox*    m_checkForceUnsafeOperations;
     };
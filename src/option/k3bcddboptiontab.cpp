@@ -5,20 +5,33 @@
 */
 
 #include "k3bcddboptiontab.h"
+#include "k3bcddbindex.h"
+#include "k3bcddbimportjob.h"
 
 #include <KCModule>
 #include <KService>
 #include <KLocalizedString>
+#include <KMessageBox>
 #include <KPluginFactory>
 
+#include <QFileDialog>
 #include <QLabel>
 #include <QHBoxLayout>
+#include <QProgressDialog>
+#include <QPushButton>
+#include <QThread>
+#include <QVBoxLayout>
 
 
 K3b::CddbOptionTab::CddbOptionTab( QWidget* parent )
-    : QWidget( parent )
+    : QWidget( parent ),
+      m_importJob( 0 ),
+      m_importProgress( 0 ),
+      m_countThread( 0 ),
+      m_indexCount( 0 ),
+      m_countAgain( false )
 {
-    QHBoxLayout* layout = new QHBoxLayout( this );
+    QVBoxLayout* layout = new QVBoxLayout( this );
     layout->setContentsMargins( 0, 0, 0, 0 );
 
     m_cddbKcm = 0;
@@ -34,11 +47,32 @@ K3b::CddbOptionTab::CddbOptionTab( QWidget* parent )
         label->setAlignment( Qt::AlignCenter );
         layout->addWidget( label );
     }
+
+    m_indexInfoLabel = new QLabel( this );
+    m_importButton = new QPushButton( i18n("Import freedb Dump..."), this );
+    m_importButton->setToolTip( i18n("Add the entries of an unpacked freedb dump to the local index") );
+    connect( m_importButton, SIGNAL(clicked()), this, SLOT(slotImportFreedbDump()) );
+
+    QHBoxLayout* indexLayout = new QHBoxLayout;
+    indexLayout->addWidget( m_indexInfoLabel, 1 );
+    indexLayout->addWidget( m_importButton );
+    layout->addLayout( indexLayout );
+
+    updateIndexInfo();
 }
 
 
 K3b::CddbOptionTab::~CddbOptionTab()
 {
+    if( m_importJob ) {
+        disconnect( m_importJob, 0, this, 0 );
+        m_importJob->cancel();
+        m_importJob->wait();
+    }
+    if( m_countThread ) {
+        m_countThread->wait();
+        delete m_countThread;
+    }
 }
 
 
@@ -58,3 +92,79 @@ void K3b::CddbOptionTab::apply()
 }
 
 
+void K3b::CddbOptionTab::slotImportFreedbDump()
+{
+    const QString path = QFileDialog::getExistingDirectory( this, i18n("Select the Folder of an Unpacked freedb Dump") );
+    if( path.isEmpty() )
+        return;
+
+    m_importJob = new K3b::CDDB::FreedbDumpImportJob( K3b::CDDB::DiscIdIndex::instance(), this );
+    m_importJob->setPath( path );
+
+    m_importProgress = new QProgressDialog( i18n("Importing the freedb dump in %1...", path ), i18n("Cancel"), 0, 100, this );
+    m_importProgress->setWindowModality( Qt::WindowModal );
+    m_importProgress->setMinimumDuration( 0 );
+    m_importProgress->setAutoClose( false );
+    m_importProgress->setAutoReset( false );
+
+    connect( m_importJob, SIGNAL(percent(int)), m_importProgress, SLOT(setValue(int)) );
+    connect( m_importJob, SIGNAL(finished(bool)), this, SLOT(slotImportFinished(bool)) );
+    connect( m_importProgress, SIGNAL(canceled()), m_importJob, SLOT(cancel()) );
+
+    m_importButton->setEnabled( false );
+    m_importJob->start();
+}
+
+
+void K3b::CddbOptionTab::slotImportFinished( bool success )
+{
+    const int imported = m_importJob->imported();
+    const bool canceled = m_importJob->hasBeenCanceled();
+    const QString path = m_importJob->path();
+    m_importJob->deleteLater();
+    m_importJob = 0;
+    m_importProgress->deleteLater();
+    m_importProgress = 0;
+    m_importButton->setEnabled( true );
+
+    if( canceled )
+        KMessageBox::information( this, i18np("The import was canceled after 1 CDDB entry.",
+                                              "The import was canceled after %1 CDDB entries.", imported) );
+    else if( !success )
+        KMessageBox::error( this, i18n("Could not import the freedb dump in %1.", path) );
+    else
+        KMessageBox::information( this, i18np("Imported 1 CDDB entry.", "Imported %1 CDDB entries.", imported) );
+
+    updateIndexInfo();
+}
+
+
+void K3b::CddbOptionTab::updateIndexInfo()
+{
+    if( m_countThread ) {
+        m_countAgain = true;
+        return;
+    }
+
+    m_indexInfoLabel->setText( i18n("Reading the local index...") );
+    m_countThread = QThread::create( [this]() { m_indexCount = K3b::CDDB::DiscIdIndex::instance()->count(); } );
+    connect( m_countThread, SIGNAL(finished()), this, SLOT(slotIndexCounted()) );
+    m_countThread->start();
+}
+
+
+void K3b::CddbOptionTab::slotIndexCounted()
+{
+    m_countThread->wait();
+    delete m_countThread;
+    m_countThread = 0;
+
+    m_indexInfoLabel->setText( i18np("The local index contains 1 CDDB entry.",
+                                     "The local index contains %1 CDDB entries.",
+                                     m_indexCount) );
+
+    if( m_countAgain ) {
+        m_countAgain = false;
+        updateIndexInfo();
+    }
+}
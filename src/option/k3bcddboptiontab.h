@@ -10,8 +10,16 @@
 #include <QWidget>
 
 class KCModule;
+class QLabel;
+class QPushButton;
+class QProgressDialog;
+class QThread;
 
 namespace K3b {
+namespace CDDB {
+    class FreedbDumpImportJob;
+}
+
 class CddbOptionTab : public QWidget
 {
     Q_OBJECT
@@ -24,8 +32,25 @@ public Q_SLOTS:
     void readSettings();
     void apply();
 
+private Q_SLOTS:
+    void slotImportFreedbDump();
+    void slotImportFinished( bool success );
+    void slotIndexCounted();
+
 private:
+    void updateIndexInfo();
+
     KCModule* m_cddbKcm;
+    QLabel* m_indexInfoLabel;
+    QPushButton* m_importButton;
+
+    CDDB::FreedbDumpImportJob* m_importJob;
+    QProgressDialog* m_importProgress;
+
+    // counting the entries reads the whole index, thus it is done in a thread
+    QThread* m_countThread;
+    int m_indexCount;
+    bool m_countAgain;
 };
 }
 
@@ -168,7 +168,8 @@ void K3b::ExternalBinWidget::rescan()
 {
     QApplication::setOverrideCursor( QCursor(Qt::WaitCursor) );
     saveSearchPath();
-    m_manager->search();
+    // the user asked for it, so do not trust the cache
+    m_manager->search( false );
     load();
     QApplication::restoreOverrideCursor();
 }
@@ -20,7 +20,6 @@
 
 #include <KLocalizedString>
 #include <KConfig>
-#include <KMessageBox>
 
 #include <QPoint>
 #include <QStringList>
@@ -51,6 +50,9 @@ K3b::AudioBurnDialog::AudioBurnDialog(K3b::AudioDoc* _doc, QWidget *parent )
               i18np("1 track (%2 minutes)", "%1 tracks (%2 minutes)",
                     m_doc->numOfTracks(),m_doc->length().toString()) );
 
+    m_checkVerify = K3b::StdGuiItems::verifyCheckBox( m_optionGroup );
+    m_optionGroupLayout->addWidget( m_checkVerify );
+
     QSpacerItem* spacer = new QSpacerItem( 20, 20, QSizePolicy::Minimum, QSizePolicy::Expanding );
     m_optionGroupLayout->addItem( spacer );
 
@@ -96,9 +98,6 @@ K3b::AudioBurnDialog::AudioBurnDialog(K3b::AudioDoc* _doc, QWidget *parent )
 
     addPage( advancedTab, i18n("Advanced") );
 
-    connect( m_checkNormalize, SIGNAL(toggled(bool)), this, SLOT(slotNormalizeToggled(bool)) );
-    connect( m_checkCacheImage, SIGNAL(toggled(bool)), this, SLOT(slotCacheImageToggled(bool)) );
-
     // ToolTips
     // -------------------------------------------------------------------------
     m_checkHideFirstTrack->setToolTip( i18n("Hide the first track in the first pregap") );
@@ -140,6 +139,7 @@ void K3b::AudioBurnDialog::saveSettingsToProject()
     m_doc->setTempDir( m_tempDirSelectionWidget->tempPath() );
     m_doc->setHideFirstTrack( m_checkHideFirstTrack->isChecked() );
     m_doc->setNormalize( m_checkNormalize->isChecked() );
+    m_doc->setVerifyData( m_checkVerify->isChecked() );
 
     // -- save Cd-Text ------------------------------------------------
     m_cdtextWidget->save( m_doc );
@@ -159,6 +159,7 @@ void K3b::AudioBurnDialog::readSettingsFromProject()
 
     m_checkHideFirstTrack->setChecked( m_doc->hideFirstTrack() );
     m_checkNormalize->setChecked( m_doc->normalize() );
+    m_checkVerify->setChecked( m_doc->verifyData() );
 
     // read CD-Text ------------------------------------------------------------
     m_cdtextWidget->load( m_doc );
@@ -182,6 +183,7 @@ void K3b::AudioBurnDialog::loadSettings( const KConfigGroup& c )
     m_cdtextWidget->setChecked( c.readEntry( "cd_text", true ) );
     m_checkHideFirstTrack->setChecked( c.readEntry( "hide_first_track", false ) );
     m_checkNormalize->setChecked( c.readEntry( "normalize", false ) );
+    m_checkVerify->setChecked( c.readEntry( "verify data", false ) );
 
     m_comboParanoiaMode->setCurrentIndex( c.readEntry( "paranoia mode", 0 ) );
     m_checkAudioRippingIgnoreReadErrors->setChecked( c.readEntry( "ignore read errors", true ) );
@@ -198,6 +200,7 @@ void K3b::AudioBurnDialog::saveSettings( KConfigGroup c )
     c.writeEntry( "cd_text", m_cdtextWidget->isChecked() );
     c.writeEntry( "hide_first_track", m_checkHideFirstTrack->isChecked() );
     c.writeEntry( "normalize", m_checkNormalize->isChecked() );
+    c.writeEntry( "verify data", m_checkVerify->isChecked() );
 
     c.writeEntry( "paranoia mode", m_comboParanoiaMode->currentText() );
     c.writeEntry( "ignore read errors", m_checkAudioRippingIgnoreReadErrors->isChecked() );
@@ -208,6 +211,13 @@ void K3b::AudioBurnDialog::toggleAll()
 {
     K3b::ProjectBurnDialog::toggleAll();
 
+    if( m_checkSimulate->isChecked() || m_checkOnlyCreateImage->isChecked() ) {
+        m_checkVerify->setChecked(false);
+        m_checkVerify->setEnabled(false);
+    }
+    else
+        m_checkVerify->setEnabled(true);
+
     bool cdrecordOnTheFly = false;
     bool cdrecordCdText = false;
     const K3b::ExternalBin* cdrecordBin = k3bcore->externalBinManager()->binObject("cdrecord");
@@ -273,51 +283,3 @@ void K3b::AudioBurnDialog::showEvent( QShowEvent* e )
 
     K3b::ProjectBurnDialog::showEvent(e);
 }
-
-
-void K3b::AudioBurnDialog::slotNormalizeToggled( bool on )
-{
-    if( on ) {
-        // we are not able to normalize in on-the-fly mode
-        if( !k3bcore->externalBinManager()->foundBin( "normalize" ) ) {
-            KMessageBox::error( this, i18n("<p><b>External program <em>normalize</em> is not installed.</b>"
-                                           "<p>K3b uses <em>normalize</em> (http://normalize.nongnu.org/) "
-                                           "to normalize audio tracks. In order to "
-                                           "use this functionality, please install it first.") );
-            m_checkNormalize->setChecked( false );
-        }
-        else if( !m_checkCacheImage->isChecked() && !m_checkOnlyCreateImage->isChecked() ) {
-            if( KMessageBox::warningYesNo( this, i18n("<p>K3b is not able to normalize audio tracks when burning on-the-fly. "
-                                                      "The external program used for this task only supports normalizing a set "
-                                                      "of audio files."),
-                                           QString(),
-                                           KGuiItem( i18n("Disable normalization") ),
-                                           KGuiItem( i18n("Disable on-the-fly burning") ),
-                                           "audioProjectNormalizeOrOnTheFly" ) == KMessageBox::Yes )
-                m_checkNormalize->setChecked( false );
-            else
-                m_checkCacheImage->setChecked( true );
-        }
-    }
-}
-
-
-void K3b::AudioBurnDialog::slotCacheImageToggled( bool on )
-{
-    if( !on ) {
-        if( m_checkNormalize->isChecked() ) {
-            if( KMessageBox::warningYesNo( this, i18n("<p>K3b is not able to normalize audio tracks when burning on-the-fly. "
-                                                      "The external program used for this task only supports normalizing a set "
-                                                      "of audio files."),
-                                           QString(),
-                                           KGuiItem( i18n("Disable normalization") ),
-                                           KGuiItem( i18n("Disable on-the-fly burning") ),
-                                           "audioProjectNormalizeOrOnTheFly" ) == KMessageBox::Yes )
-                m_checkNormalize->setChecked( false );
-            else
-                m_checkCacheImage->setChecked( true );
-        }
-    }
-}
-
-
@@ -52,8 +52,6 @@ namespace K3b {
          * Reimplemented for internal reasons (shut down the audio player)
          */
         void slotStartClicked() override;
-        void slotCacheImageToggled( bool on );
-        void slotNormalizeToggled( bool on );
 
     private:
         /**
@@ -62,6 +60,7 @@ namespace K3b {
         QGroupBox* m_audioRippingGroup;
         QCheckBox* m_checkHideFirstTrack;
         QCheckBox* m_checkNormalize;
+        QCheckBox* m_checkVerify;
         QCheckBox* m_checkAudioRippingIgnoreReadErrors;
         QSpinBox* m_spinAudioRippingReadRetries;
         QComboBox* m_comboParanoiaMode;
@@ -132,6 +132,8 @@ public:
     Range::List ranges;
     Marker::List markers;
 
+    WaveformPeaks peaks;
+
     int maxMarkers;
     K3b::Msf length;
     int idCnt;
@@ -174,8 +176,9 @@ QSize K3b::AudioEditorWidget::minimumSizeHint() const
 
     int maxWidth = QApplication::desktop()->width()*2/3;
     int wantedWidth = 2*d->margin + 2*frameWidth() + (d->length.totalFrames()/75/60 + 1) * fontMetrics().horizontalAdvance( "000" );
+    int waveformHeight = ( d->peaks.sectors() > 0 ? 48 : 0 );
     return QSize( qMin( maxWidth, wantedWidth ),
-                  2*d->margin + 12 + 6 /*12 for the tickmarks and 6 for the markers */ + fontMetrics().height() + 2*frameWidth() );
+                  2*d->margin + 12 + 6 /*12 for the tickmarks and 6 for the markers */ + fontMetrics().height() + 2*frameWidth() + waveformHeight );
 }
 
 
@@ -200,6 +203,14 @@ const K3b::Msf K3b::AudioEditorWidget::length() const
 }
 
 
+void K3b::AudioEditorWidget::setPeaks( const K3b::WaveformPeaks& peaks )
+{
+    d->peaks = peaks;
+    updateGeometry();
+    update();
+}
+
+
 void K3b::AudioEditorWidget::setSelectedRangeBrush( const QBrush& b )
 {
     d->selectedRangeBrush = b;
@@ -483,6 +494,9 @@ void K3b::AudioEditorWidget::drawAll( QPainter* p, const QRect& drawRect )
     if( Range* selectedRange = getRange( d->selectedRangeId ) )
         drawRange( p, drawRect, *selectedRange );
 
+    if( d->peaks.sectors() > 0 )
+        drawWaveform( p, drawRect );
+
     for( Marker::List::const_iterator it = d->markers.constBegin(); it != d->markers.constEnd(); ++it )
         drawMarker( p, drawRect, *it );
 
@@ -553,6 +567,34 @@ void K3b::AudioEditorWidget::drawRange( QPainter* p, const QRect& drawRect, cons
 }
 
 
+void K3b::AudioEditorWidget::drawWaveform( QPainter* p, const QRect& drawRect )
+{
+    p->save();
+
+    QColor color = palette().color( QPalette::WindowText );
+    color.setAlpha( 160 );
+    p->setPen( color );
+
+    // the area of the ranges
+    const int top = drawRect.top() + 7;
+    const int height = drawRect.height() - 8;
+    const int middle = top + height/2;
+
+    // every column only needs a few lookups regardless of the zoom level
+    const int left = msfToPos( 0 );
+    const int right = msfToPos( d->length-1 );
+    for( int x = left; x <= right; ++x ) {
+        const int first = posToMsf( x ).lba();
+        const int last = qMax( first, posToMsf( x+1 ).lba() - 1 );
+        const WaveformPeaks::Peak peak = d->peaks.peak( first, last );
+        p->drawLine( x, middle - peak.max*height/256,
+                     x, middle - peak.min*height/256 );
+    }
+
+    p->restore();
+}
+
+
 void K3b::AudioEditorWidget::drawMarker( QPainter* p, const QRect& drawRect, const K3b::AudioEditorWidget::Marker& m )
 {
     p->save();
@@ -9,6 +9,7 @@
 #define _K3B_AUDIO_EDITOR_WIDGET_H_
 
 #include "k3bmsf.h"
+#include "k3bwaveformpeaks.h"
 
 #include <QList>
 #include <QMouseEvent>
@@ -37,6 +38,12 @@ public:
 
     const K3b::Msf length() const;
 
+    /**
+     * The waveform drawn behind the markers, one sector per sector of
+     * the length. Use an empty WaveformPeaks object to remove it.
+     */
+    void setPeaks( const K3b::WaveformPeaks& peaks );
+
     /**
      * Add a user editable range.
      * @param startFixed if true the range's start cannot be changed by the user, only with modifyRange
@@ -180,6 +187,7 @@ private:
 
     void drawAll( QPainter*, const QRect& );
     void drawRange( QPainter* p, const QRect&, const Range& r );
+    void drawWaveform( QPainter* p, const QRect& );
     void drawMarker( QPainter* p, const QRect&, const Marker& m );
 
     /**
@@ -7,7 +7,6 @@
 */
 
 #include "k3baudiotrackaddingdialog.h"
-#include "k3baudiofileanalyzerjob.h"
 
 #include "k3baudiodoc.h"
 #include "k3baudiotrack.h"
@@ -23,7 +22,7 @@
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
-#include <QThread>
+#include <QHash>
 #include <QDialogButtonBox>
 #include <QLabel>
 #include <QVBoxLayout>
@@ -59,14 +58,18 @@ K3b::AudioTrackAddingDialog::AudioTrackAddingDialog( const QList<QUrl>& urls,
     layout->addWidget( m_busyWidget );
     layout->addWidget( buttonBox );
 
-    m_analyserJob = new K3b::AudioFileAnalyzerJob( this, this );
-    connect( m_analyserJob, SIGNAL(finished(bool)), this, SLOT(slotAnalysingFinished(bool)) );
+    m_analyzerPool = new K3b::AudioFileAnalyzerPool( this );
+    connect( m_analyzerPool, SIGNAL(analysed(K3b::AudioDecoder*,bool)), this, SLOT(slotAnalysingFinished(K3b::AudioDecoder*,bool)) );
     connect(buttonBox->button(QDialogButtonBox::Cancel), SIGNAL(clicked()), this, SLOT(slotCancelClicked()));
 }
 
 
 K3b::AudioTrackAddingDialog::~AudioTrackAddingDialog()
 {
+    // the dialog may be closed without the cancel button
+    if( !m_pendingFiles.isEmpty() )
+        slotCancelClicked();
+
     QString message;
     if( !m_unreadableFiles.isEmpty() )
         message += QString("<p><b>%1:</b><br>%2")
@@ -79,7 +82,7 @@ K3b::AudioTrackAddingDialog::~AudioTrackAddingDialog()
     if( !m_nonLocalFiles.isEmpty() )
         message += QString("<p><b>%1:</b><br>%2")
                    .arg( i18n("No non-local files supported") )
-                   .arg( m_unreadableFiles.join( "<br>" ) );
+                   .arg( m_nonLocalFiles.join( "<br>" ) );
     if( !m_unsupportedFiles.isEmpty() )
         message += QString("<p><b>%1:</b><br><i>%2</i><br>%3")
                    .arg( i18n("Unable to handle the following files due to an unsupported format" ) )
@@ -111,18 +114,19 @@ void K3b::AudioTrackAddingDialog::addUrls( const QList<QUrl>& urls,
 }
 
 
-void K3b::AudioTrackAddingDialog::slotAddUrls()
+K3b::AudioTrackAddingDialog::PendingFile::PendingFile( const QUrl& url_, const QHash<QString, K3b::AudioDecoder*>& projectDecoders )
+    : url( url_ ),
+      state( Unsupported ),
+      decoder( 0 ),
+      reused( false ),
+      m_projectDecoders( projectDecoders )
 {
-    if( m_bCanceled )
-        return;
+}
 
-    if( m_urls.isEmpty() ) {
-        accept();
-        return;
-    }
 
-    QUrl url = m_urls.first();
-    bool valid = true;
+K3b::AudioDecoder* K3b::AudioTrackAddingDialog::PendingFile::createDecoder( bool& analyse )
+{
+    QUrl audioUrl = url;
 
     if( url.toLocalFile().right(3).toLower() == "cue" ) {
         // see if its a cue file
@@ -130,81 +134,141 @@ void K3b::AudioTrackAddingDialog::slotAddUrls()
         if( parser.isValid() && parser.toc().contentType() == K3b::Device::AUDIO ) {
             if ( parser.imageFileType() == QLatin1String( "bin" ) ) {
                 // no need to analyze -> raw audio data
-                m_doc->importCueFile( url.toLocalFile(), m_trackAfter, 0 );
-                m_urls.erase( m_urls.begin() );
-                QMetaObject::invokeMethod( this, "slotAddUrls", Qt::QueuedConnection );
-                return;
+                state = RawCueFile;
+                return 0;
             }
             else {
                 // remember cue url and set the new audio file url
-                m_cueUrl = url;
-                url = m_urls[0] = QUrl::fromLocalFile( parser.imageFilename() );
+                cueUrl = url;
+                audioUrl = QUrl::fromLocalFile( parser.imageFilename() );
             }
         }
     }
 
-    m_infoLabel->setText( i18n("Analysing file '%1'..." , url.fileName() ) );
+    filename = audioUrl.toLocalFile();
 
-    if( !url.isLocalFile() ) {
-        valid = false;
-        m_nonLocalFiles.append( url.toLocalFile() );
+    QFileInfo fi( filename );
+    if( !fi.exists() ) {
+        state = NotFound;
+        return 0;
     }
-    else {
-        QFileInfo fi( url.toLocalFile() );
-        if( !fi.exists() ) {
-            valid = false;
-            m_notFoundFiles.append( url.toLocalFile() );
-        }
-        else if( !fi.isReadable() ) {
-            valid = false;
-            m_unreadableFiles.append( url.toLocalFile() );
-        }
+    else if( !fi.isReadable() ) {
+        state = Unreadable;
+        return 0;
     }
 
-    if( valid ) {
-        bool reused;
-        K3b::AudioDecoder* dec = m_doc->getDecoderForUrl( url, &reused );
-        if( dec ) {
-            m_analyserJob->setDecoder( dec );
-            if( reused )
-                slotAnalysingFinished( true );
-            else
-                m_analyserJob->start();
-        }
-        else {
-            valid = false;
-            m_unsupportedFiles.append( url.toLocalFile() );
+    // the decoders used by the project already have been analysed (see AudioDoc::getDecoderForUrl)
+    if( m_projectDecoders.contains( filename ) ) {
+        decoder = m_projectDecoders[filename];
+        reused = true;
+        analyse = false;
+    }
+    else if( (decoder = K3b::AudioDecoderFactory::createDecoder( audioUrl )) ) {
+        qDebug() << "(K3b::AudioTrackAddingDialog) using " << decoder->metaObject()->className()
+                 << " for decoding of " << filename;
+        decoder->setFilename( filename );
+    }
+
+    state = decoder ? Supported : Unsupported;
+    return decoder;
+}
+
+
+void K3b::AudioTrackAddingDialog::slotAddUrls()
+{
+    if( m_bCanceled )
+        return;
+
+    // The decoders used by the project. The files are classified in the
+    // threads of the analyzer pool, which must not access the project.
+    QHash<QString, K3b::AudioDecoder*> projectDecoders;
+    for( K3b::AudioTrack* track = m_doc->firstTrack(); track; track = track->next() ) {
+        for( K3b::AudioDataSource* source = track->firstSource(); source; source = source->next() ) {
+            if( K3b::AudioFile* file = dynamic_cast<K3b::AudioFile*>( source ) )
+                projectDecoders.insert( file->decoder()->filename(), file->decoder() );
         }
     }
 
-    // invalid file, next url
-    if( !valid ) {
-        m_urls.erase( m_urls.begin() );
-        QMetaObject::invokeMethod( this, "slotAddUrls", Qt::QueuedConnection );
+    Q_FOREACH( const QUrl& url, m_urls ) {
+        if( !url.isLocalFile() ) {
+            m_nonLocalFiles.append( url.toDisplayString() );
+            continue;
+        }
+
+        PendingFile* file = new PendingFile( url, projectDecoders );
+        m_pendingFiles.enqueue( file );
+        m_analyzerPool->add( file );
     }
+    m_urls.clear();
+
+    if( m_pendingFiles.isEmpty() )
+        accept();
+    else
+        updateInfoLabel();
 }
 
 
-void K3b::AudioTrackAddingDialog::slotAnalysingFinished( bool /*success*/ )
+void K3b::AudioTrackAddingDialog::slotAnalysingFinished( K3b::AudioDecoder* decoder, bool /*success*/ )
 {
-    if( m_bCanceled ) {
-        // We only started the analyser thread in case the decoder was new
-        // thus, we can safely delete it since no other source needs it.
-        delete m_analyserJob->decoder();
+    if( m_bCanceled || m_pendingFiles.isEmpty() )
         return;
+
+    // the pool reports the files in the order they were added
+    PendingFile* file = m_pendingFiles.dequeue();
+
+    switch( file->state ) {
+    case PendingFile::RawCueFile:
+        addFile( *file, 0 );
+        break;
+
+    case PendingFile::Supported:
+        // the decoders of files which appear more than once are shared like in AudioDoc
+        if( !file->reused ) {
+            if( m_newDecoders.contains( file->filename ) ) {
+                delete decoder;
+                decoder = m_newDecoders[file->filename];
+            }
+            else {
+                m_newDecoders.insert( file->filename, decoder );
+            }
+        }
+        addFile( *file, decoder );
+        break;
+
+    case PendingFile::NotFound:
+        m_notFoundFiles.append( file->filename );
+        break;
+
+    case PendingFile::Unreadable:
+        m_unreadableFiles.append( file->filename );
+        break;
+
+    case PendingFile::Unsupported:
+        m_unsupportedFiles.append( file->filename );
+        break;
     }
 
-    QUrl url = m_urls.first();
-    m_urls.erase( m_urls.begin() );
+    delete file;
 
-    if( m_cueUrl.isValid() ) {
+    if( m_pendingFiles.isEmpty() )
+        accept();
+    else
+        updateInfoLabel();
+}
+
+
+void K3b::AudioTrackAddingDialog::addFile( const PendingFile& pendingFile, K3b::AudioDecoder* dec )
+{
+    if( !dec ) {
+        // cue file with raw audio data
+        m_doc->importCueFile( pendingFile.url.toLocalFile(), m_trackAfter, 0 );
+    }
+    else if( pendingFile.cueUrl.isValid() ) {
         // import the cue file
-        m_doc->importCueFile( m_cueUrl.toLocalFile(), m_trackAfter, m_analyserJob->decoder() );
-        m_cueUrl = QUrl();
+        m_doc->importCueFile( pendingFile.cueUrl.toLocalFile(), m_trackAfter, dec );
     }
     else {
         // create the track and source items
-        K3b::AudioDecoder* dec = m_analyserJob->decoder();
         K3b::AudioFile* file = new K3b::AudioFile( dec, m_doc );
         if( m_parentTrack ) {
             if( m_sourceAfter )
@@ -233,16 +297,29 @@ void K3b::AudioTrackAddingDialog::slotAnalysingFinished( bool /*success*/ )
             m_trackAfter = track;
         }
     }
+}
+
 
-    QMetaObject::invokeMethod( this, "slotAddUrls", Qt::QueuedConnection );
+void K3b::AudioTrackAddingDialog::updateInfoLabel()
+{
+    m_infoLabel->setText( i18n("Analysing file '%1'..." , m_pendingFiles.head()->url.fileName() ) );
 }
 
 
 void K3b::AudioTrackAddingDialog::slotCancelClicked()
 {
     m_bCanceled = true;
-    m_analyserJob->cancel();
-    m_analyserJob->wait();
+
+    // Only the decoders created for this dialog may be deleted.
+    // The others are used by the project.
+    // Each file which has not been reported has its own decoder.
+    m_analyzerPool->cancel();
+    Q_FOREACH( PendingFile* file, m_pendingFiles ) {
+        if( file->decoder && !file->reused )
+            delete file->decoder;
+    }
+    qDeleteAll( m_pendingFiles );
+    m_pendingFiles.clear();
 }
 
 
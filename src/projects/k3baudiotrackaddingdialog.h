@@ -6,10 +6,13 @@
 #ifndef _K3B_AUDIO_TRACK_ADDING_DIALOG_H_
 #define _K3B_AUDIO_TRACK_ADDING_DIALOG_H_
 
-#include "k3bjobhandler.h"
+#include "k3baudiofileanalyzerpool.h"
+
 #include <QUrl>
 #include <QStringList>
 #include <QDialog>
+#include <QHash>
+#include <QQueue>
 
 
 class QLabel;
@@ -19,9 +22,9 @@ namespace K3b {
     class AudioTrack;
     class AudioDataSource;
     class AudioDoc;
-    class AudioFileAnalyzerJob;
+    class AudioDecoder;
 
-    class AudioTrackAddingDialog : public QDialog, public JobHandler
+    class AudioTrackAddingDialog : public QDialog
     {
         Q_OBJECT
 
@@ -47,32 +50,49 @@ namespace K3b {
 
     private Q_SLOTS:
         void slotAddUrls();
-        void slotAnalysingFinished( bool );
+        void slotAnalysingFinished( K3b::AudioDecoder*, bool );
         void slotCancelClicked();
 
     private:
         /**
-         * @reimplemented from JobHandler
+         * A file which is added once all files before it have been added.
+         * It is classified and gets its decoder in a worker thread of the
+         * analyzer pool. Its members are only read once it has been reported.
          */
-        Device::MediaType waitForMedium( Device::Device*,
-                                         Device::MediaStates = Device::STATE_EMPTY,
-                                         Device::MediaTypes = Device::MEDIA_WRITABLE_CD,
-                                         const K3b::Msf& = K3b::Msf(),
-                                         const QString& = QString() ) override { return Device::MEDIA_UNKNOWN; }
+        class PendingFile : public AudioFileAnalyzerPool::DecoderCreator
+        {
+        public:
+            enum State {
+                Supported,
+                RawCueFile,
+                NotFound,
+                Unreadable,
+                Unsupported
+            };
 
-        /**
-         * @reimplemented from JobHandler
-         */
-        bool questionYesNo( const QString&,
-                            const QString& = QString(),
-                            const KGuiItem& = KStandardGuiItem::yes(),
-                            const KGuiItem& = KStandardGuiItem::no() ) override { return false; }
+            PendingFile( const QUrl& url, const QHash<QString, AudioDecoder*>& projectDecoders );
 
-        /**
-         * @reimplemented from JobHandler
-         */
-        void blockingInformation( const QString&,
-                                  const QString& = QString() ) override {}
+            AudioDecoder* createDecoder( bool& analyse ) override;
+
+            const QUrl url;
+            QUrl cueUrl;
+            State state;
+
+            // the audio file, differs from url for cue files
+            QString filename;
+
+            // 0 for all but supported files
+            AudioDecoder* decoder;
+
+            // true if the decoder is used by the project already
+            bool reused;
+
+        private:
+            QHash<QString, AudioDecoder*> m_projectDecoders;
+        };
+
+        void addFile( const PendingFile& file, AudioDecoder* decoder );
+        void updateInfoLabel();
 
         BusyWidget* m_busyWidget;
         QLabel* m_infoLabel;
@@ -89,11 +109,14 @@ namespace K3b {
         AudioTrack* m_parentTrack;
         AudioDataSource* m_sourceAfter;
 
-        QUrl m_cueUrl;
+        QQueue<PendingFile*> m_pendingFiles;
+
+        // the decoders created for this dialog which have been added to the project
+        QHash<QString, AudioDecoder*> m_newDecoders;
 
         bool m_bCanceled;
 
-        AudioFileAnalyzerJob* m_analyserJob;
+        AudioFileAnalyzerPool* m_analyzerPool;
     };
 }
 
@@ -6,6 +6,8 @@
 #include "k3baudiotracksplitdialog.h"
 #include "k3baudiotrack.h"
 #include "k3baudioeditorwidget.h"
+#include "k3baudiowaveformloader.h"
+#include "k3bwaveformpeaks.h"
 
 #include "k3bmsf.h"
 #include "k3bmsfedit.h"
@@ -33,6 +35,7 @@ K3b::AudioTrackSplitDialog::AudioTrackSplitDialog( K3b::AudioTrack* track, QWidg
     m_editorWidget = new K3b::AudioEditorWidget( this );
     m_msfEditStart = new K3b::MsfEdit( this );
     m_msfEditEnd = new K3b::MsfEdit( this );
+    m_waveformLoader = new K3b::AudioWaveformLoader( this );
 
     QVBoxLayout* layout = new QVBoxLayout( this );
 
@@ -60,11 +63,14 @@ K3b::AudioTrackSplitDialog::AudioTrackSplitDialog( K3b::AudioTrack* track, QWidg
              this, SLOT(slotMsfEditChanged(K3b::Msf)) );
     connect( m_msfEditEnd, SIGNAL(valueChanged(K3b::Msf)),
              this, SLOT(slotMsfEditChanged(K3b::Msf)) );
+    connect( m_waveformLoader, SIGNAL(finished(bool)),
+             this, SLOT(slotWaveformLoaded(bool)) );
 
     setupActions();
 
     // load the track
     m_editorWidget->setLength( m_track->length() );
+    m_waveformLoader->load( m_track );
 
     // default split
     K3b::Msf mid = m_track->length().lba() / 2;
@@ -85,6 +91,13 @@ K3b::AudioTrackSplitDialog::~AudioTrackSplitDialog()
 }
 
 
+void K3b::AudioTrackSplitDialog::slotWaveformLoaded( bool success )
+{
+    if( success )
+        m_editorWidget->setPeaks( m_waveformLoader->peaks() );
+}
+
+
 void K3b::AudioTrackSplitDialog::setupActions()
 {
     m_popupMenu = new QMenu( this );
@@ -19,6 +19,7 @@ namespace K3b {
 
 class AudioTrack;
 class AudioEditorWidget;
+class AudioWaveformLoader;
 class Msf;
 class MsfEdit;
     
@@ -44,6 +45,7 @@ private Q_SLOTS:
     void slotSplitHere();
     void slotRemoveRange();
     void splitAt( const QPoint& p );
+    void slotWaveformLoaded( bool success );
 
 private:
     void setupActions();
@@ -52,6 +54,7 @@ private:
     MsfEdit* m_msfEditStart;
     MsfEdit* m_msfEditEnd;
     AudioTrack* m_track;
+    AudioWaveformLoader* m_waveformLoader;
     QMenu* m_popupMenu;
     QPoint m_lastClickPosition;
 };
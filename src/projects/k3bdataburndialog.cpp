@@ -59,6 +59,23 @@ K3b::DataBurnDialog::DataBurnDialog(K3b::DataDoc* _doc, QWidget *parent )
     m_checkVerify = K3b::StdGuiItems::verifyCheckBox( m_optionGroup );
     m_optionGroupLayout->addWidget( m_checkVerify );
 
+    m_checkStopVerifying = new QCheckBox( i18n("Stop at the first difference"), m_optionGroup );
+    m_checkStopVerifying->setToolTip( i18n("Stop verifying once the written data differs") );
+    m_checkStopVerifying->setWhatsThis( i18n("<p>If this option is checked K3b stops reading the "
+                                             "written data as soon as it differs from the original "
+                                             "instead of reporting all sectors which differ.") );
+    m_optionGroupLayout->addWidget( m_checkStopVerifying );
+
+    m_checkSaveChecksums = new QCheckBox( i18n("Save checksums with the image"), m_optionGroup );
+    m_checkSaveChecksums->setToolTip( i18n("Save the checksums of the image next to it") );
+    m_checkSaveChecksums->setWhatsThis( i18n("<p>If this option is checked K3b saves the checksums "
+                                             "of the created image in a file next to it. When the "
+                                             "image is written later on these checksums are used to "
+                                             "make sure the image has not changed.") );
+    m_optionGroupLayout->addWidget( m_checkSaveChecksums );
+
+    connect( m_checkVerify, SIGNAL(toggled(bool)), this, SLOT(slotToggleAll()) );
+
     QSpacerItem* spacer = new QSpacerItem( 20, 20, QSizePolicy::Minimum, QSizePolicy::Expanding );
     m_optionGroupLayout->addItem( spacer );
 
@@ -108,6 +125,8 @@ void K3b::DataBurnDialog::saveSettingsToProject()
     ((K3b::DataDoc*)doc())->setDataMode( m_dataModeWidget->dataMode() );
 
     ((K3b::DataDoc*)doc())->setVerifyData( m_checkVerify->isChecked() );
+    ((K3b::DataDoc*)doc())->setStopVerifyingOnFirstDifference( m_checkStopVerifying->isChecked() );
+    ((K3b::DataDoc*)doc())->setSaveChecksums( m_checkSaveChecksums->isChecked() );
 }
 
 
@@ -124,6 +143,8 @@ void K3b::DataBurnDialog::readSettingsFromProject()
         m_tempDirSelectionWidget->setTempPath( K3b::defaultTempPath() + doc()->name() + ".iso" );
 
     m_checkVerify->setChecked( ((K3b::DataDoc*)doc())->verifyData() );
+    m_checkStopVerifying->setChecked( ((K3b::DataDoc*)doc())->stopVerifyingOnFirstDifference() );
+    m_checkSaveChecksums->setChecked( ((K3b::DataDoc*)doc())->saveChecksums() );
 
     m_imageSettingsWidget->load( ((K3b::DataDoc*)doc())->isoOptions() );
 
@@ -203,6 +224,8 @@ void K3b::DataBurnDialog::loadSettings( const KConfigGroup& c )
     m_imageSettingsWidget->load( o );
 
     m_checkVerify->setChecked( c.readEntry( "verify data", false ) );
+    m_checkStopVerifying->setChecked( c.readEntry( "stop verifying on first difference", false ) );
+    m_checkSaveChecksums->setChecked( c.readEntry( "save checksums", false ) );
 
     toggleAll();
 }
@@ -220,6 +243,8 @@ void K3b::DataBurnDialog::saveSettings( KConfigGroup c )
     o.save( c );
 
     c.writeEntry( "verify data", m_checkVerify->isChecked() );
+    c.writeEntry( "stop verifying on first difference", m_checkStopVerifying->isChecked() );
+    c.writeEntry( "save checksums", m_checkSaveChecksums->isChecked() );
 }
 
 
@@ -234,6 +259,9 @@ void K3b::DataBurnDialog::toggleAll()
     else
         m_checkVerify->setEnabled(true);
 
+    m_checkStopVerifying->setEnabled( m_checkVerify->isEnabled() && m_checkVerify->isChecked() );
+    m_checkSaveChecksums->setEnabled( m_checkOnlyCreateImage->isChecked() );
+
     m_comboMultisession->setDisabled( m_checkOnlyCreateImage->isChecked() );
     // we can only select the data mode for CD media
     // IDEA: why not give GUI elements like this a slot that reacts on media changes?
@@ -45,6 +45,8 @@ namespace K3b {
         DataMultiSessionCombobox* m_comboMultisession;
 
         QCheckBox* m_checkVerify;
+        QCheckBox* m_checkStopVerifying;
+        QCheckBox* m_checkSaveChecksums;
 
     protected Q_SLOTS:
         void slotStartClicked() override;
@@ -30,9 +30,9 @@
 #include <KLocalizedString>
 #include <KMessageBox>
 #include <KStandardGuiItem>
-#include <kio/listjob.h>
 
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QList>
 #include <QUrl>
@@ -107,6 +107,7 @@ K3b::DataUrlAddingDialog::DataUrlAddingDialog( DirItem* dir, QWidget* parent )
     grid->addWidget( buttonBox, 2, 0, 1, 2 );
 
     m_dirSizeJob = new K3b::DirSizeJob( this );
+    m_dirSizeJob->setCollectEntries( true );
     connect( m_dirSizeJob, SIGNAL(finished(bool)),
              this, SLOT(slotDirSizeDone(bool)) );
 
@@ -189,11 +190,16 @@ void K3b::DataUrlAddingDialog::slotStartAddUrls()
         }
     }
 
-    slotAddUrls();
-    if( !m_urlQueue.isEmpty() ) {
+    // the dir size job also stats the files for us in the background
+    // which is not worth it for a single file
+    if( m_urls.count() != 1 || !QFileInfo( m_urls.first().toLocalFile() ).isFile() ) {
         m_dirSizeJob->setUrls( m_urls );
         m_dirSizeJob->setFollowSymlinks( m_doc->isoOptions().followSymbolicLinks() );
         m_dirSizeJob->start();
+    }
+
+    slotAddUrls();
+    if( !m_urlQueue.isEmpty() ) {
         exec();
     }
 }
@@ -214,6 +220,33 @@ void K3b::DataUrlAddingDialog::slotAddUrls()
     if( m_bCanceled )
         return;
 
+    // handle as many urls as possible without blocking the GUI
+    QElapsedTimer timer;
+    timer.start();
+    do {
+        addNextUrl();
+    } while( !m_bCanceled && !m_urlQueue.isEmpty() && !timer.hasExpired( 50 ) );
+
+    if( m_bCanceled )
+        return;
+
+    if( m_urlQueue.isEmpty() ) {
+        Q_FOREACH( DirItem* dir, m_newItems.keys() ) {
+            dir->addDataItems( m_newItems[ dir ] );
+        }
+        m_dirSizeJob->cancel();
+        m_progressWidget->setMaximum( 100 );
+        accept();
+    }
+    else {
+        updateProgress();
+        QMetaObject::invokeMethod( this, "slotAddUrls", Qt::QueuedConnection );
+    }
+}
+
+
+void K3b::DataUrlAddingDialog::addNextUrl()
+{
     // add next url
     QUrl url = m_urlQueue.first().first;
     K3b::DirItem* dir = m_urlQueue.first().second;
@@ -234,6 +267,12 @@ void K3b::DataUrlAddingDialog::slotAddUrls()
     bool isDir = false;
     bool isFile = false;
 
+    // use the stat results of the dir size job if it already got here
+    K3b::DirSizeJob::Entry entry;
+    const bool prefetched = url.isLocalFile() && m_dirSizeJob->takeEntry( absoluteFilePath, entry );
+    if( prefetched )
+        statBuf = entry.stat;
+
     ++m_filesHandled;
 
     m_infoLabel->setText( url.toLocalFile() );
@@ -251,7 +290,7 @@ void K3b::DataUrlAddingDialog::slotAddUrls()
         m_nonLocalFiles.append( url.toLocalFile() );
     }
 
-    else if( k3b_lstat( QFile::encodeName(absoluteFilePath), &statBuf ) != 0 ) {
+    else if( !prefetched && k3b_lstat( QFile::encodeName(absoluteFilePath), &statBuf ) != 0 ) {
         valid = false;
         m_notFoundFiles.append( url.toLocalFile() );
     }
@@ -270,12 +309,15 @@ void K3b::DataUrlAddingDialog::slotAddUrls()
         // but we need to know if the symlink points to a directory
         if( isSymLink ) {
             resolved = K3b::resolveLink( absoluteFilePath );
-            k3b_stat( QFile::encodeName(resolved), &resolvedStatBuf );
+            if( prefetched && entry.followedStatValid )
+                resolvedStatBuf = entry.followedStat;
+            else
+                k3b_stat( QFile::encodeName(resolved), &resolvedStatBuf );
             isDir = S_ISDIR(resolvedStatBuf.st_mode);
         }
 
         else {
-            if( ::access( QFile::encodeName( absoluteFilePath ), R_OK ) != 0 ) {
+            if( prefetched ? !entry.readable : ::access( QFile::encodeName( absoluteFilePath ), R_OK ) != 0 ) {
                 valid = false;
                 m_unreadableFiles.append( url.toLocalFile() );
             }
@@ -514,15 +556,14 @@ void K3b::DataUrlAddingDialog::slotAddUrls()
                 dir->addDataItem( newDirItem );
             }
 
-            KIO::ListJob *lj = KIO::listDir(QUrl::fromLocalFile(absoluteFilePath), KIO::HideProgressInfo);
-            KIO::UDSEntryList list;
-            connect(lj, &KIO::ListJob::entries, this, [&](KIO::Job *, const KIO::UDSEntryList &l) { list.append(l); });
-            lj->exec();
-            foreach( const KIO::UDSEntry& entry, list ) {
-                const QString fileName = entry.stringValue( KIO::UDSEntry::UDS_NAME );
-                if (fileName != QStringLiteral(".") && fileName != QStringLiteral("..")) {
-                    m_urlQueue.append( qMakePair( QUrl::fromLocalFile(absoluteFilePath + '/' + fileName ), newDirItem ) );
-                }
+            // the dir size job already listed real dirs, links to dirs have to be listed here
+            QStringList children;
+            if( prefetched && S_ISDIR( entry.stat.st_mode ) )
+                children = entry.children;
+            else
+                children = QDir( absoluteFilePath ).entryList( QDir::AllEntries|QDir::Hidden|QDir::System|QDir::NoDotAndDotDot );
+            Q_FOREACH( const QString& fileName, children ) {
+                m_urlQueue.append( qMakePair( QUrl::fromLocalFile(absoluteFilePath + '/' + fileName ), newDirItem ) );
             }
         }
         else {
@@ -530,18 +571,6 @@ void K3b::DataUrlAddingDialog::slotAddUrls()
         }
     }
 
-    if( m_urlQueue.isEmpty() ) {
-        Q_FOREACH( DirItem* dir, m_newItems.keys() ) {
-            dir->addDataItems( m_newItems[ dir ] );
-        }
-        m_dirSizeJob->cancel();
-        m_progressWidget->setMaximum( 100 );
-        accept();
-    }
-    else {
-        updateProgress();
-        QMetaObject::invokeMethod( this, "slotAddUrls", Qt::QueuedConnection );
-    }
 }
 
 
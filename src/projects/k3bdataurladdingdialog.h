@@ -61,6 +61,8 @@ namespace K3b {
         DataUrlAddingDialog( const QList<QUrl>& urls, DirItem* dir, QWidget* parent = 0 );
         DataUrlAddingDialog( const QList<DataItem*>& items, DirItem* dir, bool copy, QWidget* parent = 0 );
         DataUrlAddingDialog( DirItem* dir, QWidget* parent );
+
+        void addNextUrl();
         bool getNewName( const QString& oldName, DirItem* dir, QString& newName );
         bool addHiddenFiles();
         bool addSystemFiles();
@@ -26,7 +26,6 @@
 
 #include <KConfig>
 #include <KLocalizedString>
-#include <KMessageBox>
 
 #include <QDebug>
 #include <QVariant>
@@ -55,6 +54,10 @@ K3b::MixedBurnDialog::MixedBurnDialog( K3b::MixedDoc* doc, QWidget *parent )
 
     m_checkOnlyCreateImage->hide();
 
+    // there are no checksums of the data track, only the audio tracks are verified
+    m_checkVerify = K3b::StdGuiItems::verifyCheckBox( m_optionGroup );
+    m_optionGroupLayout->addWidget( m_checkVerify );
+
     // create cd-text page
     m_cdtextWidget = new K3b::AudioCdTextWidget( this );
     addPage( m_cdtextWidget, i18n("CD-Text") );
@@ -68,8 +71,6 @@ K3b::MixedBurnDialog::MixedBurnDialog( K3b::MixedDoc* doc, QWidget *parent )
     QSpacerItem* spacer = new QSpacerItem( 20, 20, QSizePolicy::Minimum, QSizePolicy::Expanding );
     m_optionGroupLayout->addItem( spacer );
 
-    connect( m_checkNormalize, SIGNAL(toggled(bool)), this, SLOT(slotNormalizeToggled(bool)) );
-    connect( m_checkCacheImage, SIGNAL(toggled(bool)), this, SLOT(slotCacheImageToggled(bool)) );
     connect( m_writerSelectionWidget, SIGNAL(writingAppChanged(K3b::WritingApp)), this, SLOT(slotToggleAll()) );
     connect( m_writingModeWidget, SIGNAL(writingModeChanged(WritingMode)), this, SLOT(slotToggleAll()) );
 }
@@ -146,6 +147,7 @@ void K3b::MixedBurnDialog::saveSettingsToProject()
     m_cdtextWidget->save( m_doc->audioDoc() );
 
     m_doc->audioDoc()->setNormalize( m_checkNormalize->isChecked() );
+    m_doc->audioDoc()->setVerifyData( m_checkVerify->isChecked() );
 
     // save iso image settings
     K3b::IsoOptions o = m_doc->dataDoc()->isoOptions();
@@ -164,6 +166,7 @@ void K3b::MixedBurnDialog::readSettingsFromProject()
     K3b::ProjectBurnDialog::readSettingsFromProject();
 
     m_checkNormalize->setChecked( m_doc->audioDoc()->normalize() );
+    m_checkVerify->setChecked( m_doc->audioDoc()->verifyData() );
 
     if( !m_doc->tempDir().isEmpty() )
         m_tempDirSelectionWidget->setTempPath( m_doc->tempDir() );
@@ -186,6 +189,7 @@ void K3b::MixedBurnDialog::loadSettings( const KConfigGroup& c )
 
     m_cdtextWidget->setChecked( c.readEntry( "cd_text", false ) );
     m_checkNormalize->setChecked( c.readEntry( "normalize", false ) );
+    m_checkVerify->setChecked( c.readEntry( "verify data", false ) );
 
     // load mixed type
     if( c.readEntry( "mixed_type" ) == "last_track" )
@@ -210,6 +214,7 @@ void K3b::MixedBurnDialog::saveSettings( KConfigGroup c )
 
     c.writeEntry( "cd_text", m_cdtextWidget->isChecked() );
     c.writeEntry( "normalize", m_checkNormalize->isChecked() );
+    c.writeEntry( "verify data", m_checkVerify->isChecked() );
 
     // save mixed type
     switch( m_comboMixedModeType->selectedValue() ) {
@@ -239,6 +244,13 @@ void K3b::MixedBurnDialog::toggleAll()
 {
     K3b::ProjectBurnDialog::toggleAll();
 
+    if( m_checkSimulate->isChecked() ) {
+        m_checkVerify->setChecked(false);
+        m_checkVerify->setEnabled(false);
+    }
+    else
+        m_checkVerify->setEnabled(true);
+
     bool cdrecordOnTheFly = false;
     bool cdrecordCdText = false;
     const K3b::ExternalBin* cdrecordBin = k3bcore->externalBinManager()->binObject("cdrecord");
@@ -268,53 +280,3 @@ void K3b::MixedBurnDialog::toggleAll()
     if( !cdText || m_writingModeWidget->writingMode() == K3b::WritingModeTao  )
         m_cdtextWidget->setChecked( false );
 }
-
-
-void K3b::MixedBurnDialog::slotNormalizeToggled( bool on )
-{
-    if( on ) {
-        // we are not able to normalize in on-the-fly mode
-        if( !k3bcore->externalBinManager()->foundBin( "normalize" ) ) {
-            KMessageBox::error( this, i18n("<p><b>External program <em>normalize</em> is not installed.</b>"
-                                           "<p>K3b uses <em>normalize</em> (http://normalize.nongnu.org/) "
-                                           "to normalize audio tracks. In order to "
-                                           "use this functionality, please install it first.") );
-            m_checkNormalize->setChecked( false );
-        }
-        else if( !m_checkCacheImage->isChecked() && !m_checkOnlyCreateImage->isChecked() ) {
-            if( KMessageBox::warningYesNo( this, i18n("<p>K3b is not able to normalize audio tracks when burning on-the-fly. "
-                                                      "The external program used for this task only supports normalizing a set "
-                                                      "of audio files."),
-                                           QString(),
-                                           KGuiItem( i18n("Disable normalization") ),
-                                           KGuiItem( i18n("Disable on-the-fly burning") ),
-                                           "audioProjectNormalizeOrOnTheFly" ) == KMessageBox::Yes )
-                m_checkNormalize->setChecked( false );
-            else
-                m_checkCacheImage->setChecked( true );
-        }
-    }
-}
-
-
-void K3b::MixedBurnDialog::slotCacheImageToggled( bool on )
-{
-    if( on ) {
-        if( m_checkNormalize->isChecked() ) {
-            if( KMessageBox::warningYesNo( this, i18n("<p>K3b is not able to normalize audio tracks when burning on-the-fly. "
-                                                      "The external program used for this task only supports normalizing a set "
-                                                      "of audio files."),
-                                           QString(),
-                                           KGuiItem( i18n("Disable normalization") ),
-                                           KGuiItem( i18n("Disable on-the-fly burning") ),
-                                           "audioProjectNormalizeOrOnTheFly" ) == KMessageBox::Yes )
-                m_checkNormalize->setChecked( false );
-            else
-                m_checkCacheImage->setChecked( true );
-        }
-    }
-}
-
-
-
-
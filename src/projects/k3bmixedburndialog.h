@@ -45,8 +45,6 @@ namespace K3b {
         void saveSettingsToProject() override;
         void readSettingsFromProject() override;
 
-        void slotCacheImageToggled( bool on );
-        void slotNormalizeToggled( bool on );
 
     private:
         void setupSettingsPage();
@@ -58,6 +56,7 @@ namespace K3b {
         QRadioButton* m_radioMixedTypeSessions;
 
         QCheckBox* m_checkNormalize;
+        QCheckBox* m_checkVerify;
 
         DataModeWidget* m_dataModeWidget;
     };
@@ -22,6 +22,7 @@
 #include "k3baudiocdtrackdrag.h"
 #include "k3bthemedlabel.h"
 #include "k3bcddb.h"
+#include "k3bcddbindex.h"
 #include "k3bmediacache.h"
 #include "k3bmodelutils.h"
 
@@ -518,9 +519,13 @@ bool K3b::AudioCdView::eventFilter( QObject* obj, QEvent* event )
 
 void K3b::AudioCdView::slotSaveCddbLocally()
 {
+    const Device::Toc toc = d->trackModel->medium().toc();
     KCDDB::Client cddbClient;
     cddbClient.config().load();
-    cddbClient.store( d->trackModel->cddbInfo(), CDDB::createTrackOffsetList( d->trackModel->medium().toc() ) );
+    cddbClient.store( d->trackModel->cddbInfo(), CDDB::createTrackOffsetList( toc ) );
+
+    // CDDBJob answers from the index first, the edited entry has to replace the one in there
+    CDDB::DiscIdIndex::instance()->store( toc, d->trackModel->cddbInfo() );
 }
 
 
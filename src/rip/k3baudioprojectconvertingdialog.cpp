@@ -217,6 +217,13 @@ void K3b::AudioProjectConvertingDialog::slotStartClicked()
     if( encoder )
         job.setFileType( m_optionWidget->extension() );
 
+    QLabel* statusLabel = new QLabel( &progressDialog );
+    progressDialog.setExtraInfo( statusLabel );
+    connect( &job, &K3b::MassAudioEncodingJob::pipelineStatus, statusLabel,
+             [statusLabel]( qint64 readingSpeed, qint64 encodingSpeed, int queuedTracks, int bufferFill ) {
+                 statusLabel->setText( K3b::MassAudioEncodingJob::pipelineStatusText( readingSpeed, encodingSpeed, queuedTracks, bufferFill ) );
+             } );
+
     hide();
     progressDialog.startJob(&job);
 
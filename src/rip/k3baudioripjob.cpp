@@ -19,6 +19,8 @@
 
 #include <KLocalizedString>
 
+#include <QSet>
+
 
 namespace K3b {
 
@@ -31,8 +33,12 @@ public:
           neverSkip(false),
           paranoiaLib(0),
           device(0),
-          useIndex0(false) {
+          useIndex0(false),
+          nextSector(-1) {
     }
+
+    long lastSector( int trackIndex ) const;
+
     int paranoiaMode;
     int paranoiaRetries;
     int neverSkip;
@@ -43,9 +49,23 @@ public:
     Device::Device* device;
 
     bool useIndex0;
+
+    // the tracks to rip and the next sector paranoia is going to read,
+    // -1 if it has to be initialized for the next track
+    QSet<int> tracks;
+    long nextSector;
 };
 
 
+long AudioRipJob::Private::lastSector( int trackIndex ) const
+{
+    const Device::Track& tt = toc[trackIndex-1];
+    return ( (useIndex0 && tt.index0() > 0)
+             ? tt.firstSector().lba() + tt.index0().lba() - 1
+             : tt.lastSector().lba() );
+}
+
+
 namespace {
 
 class AudioCdReader : public QIODevice
@@ -62,6 +82,7 @@ protected:
 
 private:
     int m_trackIndex;
+    long m_sectorsLeft;
     AudioRipJob::Private* d;
 };
 
@@ -69,6 +90,7 @@ private:
 AudioCdReader::AudioCdReader( int trackIndex, AudioRipJob::Private* priv, QObject* parent )
     : QIODevice( parent ),
       m_trackIndex( trackIndex ),
+      m_sectorsLeft( 0 ),
       d( priv )
 {
 }
@@ -78,19 +100,29 @@ bool AudioCdReader::open( OpenMode mode )
 {
     if( !mode.testFlag( QIODevice::WriteOnly ) ) {
 
-        const Device::Track& tt = d->toc[m_trackIndex-1];
-
-        long endSec = ( (d->useIndex0 && tt.index0() > 0)
-                        ? tt.firstSector().lba() + tt.index0().lba() - 1
-                        : tt.lastSector().lba() );
-
-        if( d->paranoiaLib->initReading( tt.firstSector().lba(), endSec ) ) {
-            return QIODevice::open( mode );
-        }
-        else {
-            setErrorString( i18n("Error while initializing audio ripping.") );
-            return false;
+        const long startSec = d->toc[m_trackIndex-1].firstSector().lba();
+        const long endSec = d->lastSector( m_trackIndex );
+
+        // Adjacent tracks are ripped in one go. Paranoia keeps its cache
+        // and the drive does not seek back at the start of the next track.
+        if( d->nextSector != startSec ) {
+            long sessionEnd = endSec;
+            for( int i = m_trackIndex + 1;
+                 i <= d->toc.count() && d->tracks.contains( i ) && d->toc[i-1].firstSector().lba() == sessionEnd + 1;
+                 ++i ) {
+                sessionEnd = d->lastSector( i );
+            }
+
+            if( !d->paranoiaLib->initReading( startSec, sessionEnd ) ) {
+                d->nextSector = -1;
+                setErrorString( i18n("Error while initializing audio ripping.") );
+                return false;
+            }
+            d->nextSector = startSec;
         }
+
+        m_sectorsLeft = endSec - startSec + 1;
+        return QIODevice::open( mode | QIODevice::Unbuffered );
     }
     else {
         return false;
@@ -106,7 +138,7 @@ bool AudioCdReader::isSequential() const
 
 qint64 AudioCdReader::size() const
 {
-    return d->toc[m_trackIndex-1].length().audioBytes();
+    return qint64( d->lastSector( m_trackIndex ) - d->toc[m_trackIndex-1].firstSector().lba() + 1 )*CD_FRAMESIZE_RAW;
 }
 
 
@@ -116,23 +148,29 @@ qint64 AudioCdReader::writeData( const char* /*data*/, qint64 /*len*/ )
 }
 
 
-qint64 AudioCdReader::readData( char* data, qint64 /*maxlen*/ )
+qint64 AudioCdReader::readData( char* data, qint64 maxlen )
 {
-    int status = 0;
-    char* buf = d->paranoiaLib->read( &status );
-    if( status == CdparanoiaLib::S_OK ) {
-        if( buf == 0 ) {
+    // never read beyond the track, the rest belongs to the next one
+    qint64 read = 0;
+    while( m_sectorsLeft > 0 && maxlen - read >= CD_FRAMESIZE_RAW ) {
+        int status = 0;
+        char* buf = d->paranoiaLib->read( &status );
+        if( status != CdparanoiaLib::S_OK ) {
+            d->nextSector = -1;
+            setErrorString( i18n("Unrecoverable error while ripping track %1.",m_trackIndex) );
             return -1;
         }
-        else {
-            ::memcpy( data, buf, CD_FRAMESIZE_RAW );
-            return CD_FRAMESIZE_RAW;
+        else if( buf == 0 ) {
+            d->nextSector = -1;
+            return -1;
         }
+
+        ::memcpy( data + read, buf, CD_FRAMESIZE_RAW );
+        read += CD_FRAMESIZE_RAW;
+        --m_sectorsLeft;
+        ++d->nextSector;
     }
-    else {
-        setErrorString( i18n("Unrecoverable error while ripping track %1.",m_trackIndex) );
-        return -1;
-    }
+    return read;
 }
 
 } // namespace
@@ -249,6 +287,10 @@ bool AudioRipJob::init()
     d->paranoiaLib->setNeverSkip( d->neverSkip );
     d->paranoiaLib->setMaxRetries( d->paranoiaRetries );
 
+    const QList<int> tracks = trackList().values();
+    d->tracks = QSet<int>( tracks.begin(), tracks.end() );
+    d->nextSector = -1;
+
 
     if( d->useIndex0 ) {
         emit newSubTask( i18n("Searching index 0 for all tracks") );
@@ -262,6 +304,7 @@ bool AudioRipJob::init()
 
 void AudioRipJob::cleanup()
 {
+    d->nextSector = -1;
     d->paranoiaLib->close();
     d->device->block(false);
 }
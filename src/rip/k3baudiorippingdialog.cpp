@@ -291,6 +291,14 @@ void K3b::AudioRippingDialog::slotStartClicked()
     if( encoder )
         job->setFileType( m_optionWidget->extension() );
 
+    // shows whether reading or encoding limits the speed
+    QLabel* statusLabel = new QLabel( &ripDialog );
+    ripDialog.setExtraInfo( statusLabel );
+    connect( job, &K3b::MassAudioEncodingJob::pipelineStatus, statusLabel,
+             [statusLabel]( qint64 readingSpeed, qint64 encodingSpeed, int queuedTracks, int bufferFill ) {
+                 statusLabel->setText( K3b::MassAudioEncodingJob::pipelineStatusText( readingSpeed, encodingSpeed, queuedTracks, bufferFill ) );
+             } );
+
     hide();
     ripDialog.startJob(job);
 
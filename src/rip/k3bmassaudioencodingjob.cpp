@@ -8,16 +8,25 @@
 #include "k3bmassaudioencodingjob.h"
 #include "k3baudioencoder.h"
 #include "k3bcuefilewriter.h"
+#include "k3breadaheadbuffer.h"
+#include "k3bsampleconversion.h"
 #include "k3bwavefilewriter.h"
 
 #include <KLocalizedString>
+#include <KIO/Global>
 #include <KCDDB/CDInfo>
 
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QIODevice>
+#include <QMutex>
+#include <QQueue>
+#include <QSet>
 #include <QTextStream>
+#include <QThread>
+#include <QWaitCondition>
 
 #include <vector>
 #include <algorithm>
@@ -27,6 +36,39 @@ namespace K3b {
 namespace
 {
 
+    const int BUFFER_SIZE = 64*1024;
+
+    // about 30 seconds of audio per track which is being read or encoded
+    const qint64 TRACK_BUFFER_SIZE = 30*75*2352;
+
+    // the tracks produce big endian samples and the encoders consume little endian
+    void swapByteOrder( char* data, qint64 len )
+    {
+        SampleConversion::swapByteOrder16( data, len/2 );
+    }
+
+    AudioEncoder::MetaData createMetaData( const KCDDB::CDInfo& cddbEntry, int trackIndex, bool singleTrack )
+    {
+        AudioEncoder::MetaData metaData;
+        metaData.insert( AudioEncoder::META_ALBUM_ARTIST, cddbEntry.get( KCDDB::Artist ) );
+        metaData.insert( AudioEncoder::META_ALBUM_TITLE, cddbEntry.get( KCDDB::Title ) );
+        metaData.insert( AudioEncoder::META_ALBUM_COMMENT, cddbEntry.get( KCDDB::Comment ) );
+        metaData.insert( AudioEncoder::META_YEAR, cddbEntry.get( KCDDB::Year ) );
+        metaData.insert( AudioEncoder::META_GENRE, cddbEntry.get( KCDDB::Genre ) );
+        if( singleTrack ) {
+            metaData.insert( AudioEncoder::META_TRACK_NUMBER, QString::number(trackIndex).rightJustified( 2, '0' ) );
+            metaData.insert( AudioEncoder::META_TRACK_ARTIST, cddbEntry.track( trackIndex-1 ).get( KCDDB::Artist ) );
+            metaData.insert( AudioEncoder::META_TRACK_TITLE, cddbEntry.track( trackIndex-1 ).get( KCDDB::Title ) );
+            metaData.insert( AudioEncoder::META_TRACK_COMMENT, cddbEntry.track( trackIndex-1 ).get( KCDDB::Comment ) );
+        }
+        else {
+            metaData.insert( AudioEncoder::META_TRACK_ARTIST, cddbEntry.get( KCDDB::Artist ) );
+            metaData.insert( AudioEncoder::META_TRACK_TITLE, cddbEntry.get( KCDDB::Title ) );
+            metaData.insert( AudioEncoder::META_TRACK_COMMENT, cddbEntry.get( KCDDB::Comment ) );
+        }
+        return metaData;
+    }
+
     struct SortByTrackNumber
     {
         SortByTrackNumber( MassAudioEncodingJob::Tracks const& tracks ) : m_tracks( tracks ) {}
@@ -66,6 +108,16 @@ namespace
 } // namespace
 
 
+/**
+ * A track which is being read and waits to be encoded
+ */
+struct MassAudioEncodingJob::EncodingTask {
+    int trackIndex;
+    QString filename;
+    ReadAheadBuffer* buffer;
+};
+
+
 class MassAudioEncodingJob::Private
 {
 public:
@@ -74,10 +126,18 @@ public:
         bigEndian( be ),
         overallBytesRead( 0 ),
         overallBytesToRead( 0 ),
+        overallBytesEncoded( 0 ),
         encoder( 0 ),
         waveFileWriter( 0 ),
         relativePathInPlaylist( false ),
-        writeCueFile( false )
+        writeCueFile( false ),
+        tasksInProgress( 0 ),
+        readingFinished( false ),
+        encodingFailed( false ),
+        encodingWaitTime( 0 ),
+        readingWaitTime( 0 ),
+        lastStatusRead( 0 ),
+        lastStatusEncoded( 0 )
     {
     }
 
@@ -86,6 +146,7 @@ public:
     QHash<QString,Msf> lengths;
     qint64 overallBytesRead;
     qint64 overallBytesToRead;
+    qint64 overallBytesEncoded;
     AudioEncoder* encoder;
     WaveFileWriter* waveFileWriter;
     QString fileType;
@@ -94,6 +155,26 @@ public:
     QString playlistFilename;
     bool relativePathInPlaylist;
     bool writeCueFile;
+
+    // the pipeline between the reading thread and the encoders,
+    // protected by mutex
+    QQueue<EncodingTask> encodingQueue;
+    QList<ReadAheadBuffer*> buffers;
+    QHash<QString,int> encodedTracks;
+    QSet<QString> startedFiles;
+    QSet<QString> finishedFiles;
+    int tasksInProgress;
+    bool readingFinished;
+    bool encodingFailed;
+    qint64 encodingWaitTime;
+    QMutex mutex;
+    QWaitCondition queueChanged;
+
+    // only used by the reading thread
+    qint64 readingWaitTime;
+    QElapsedTimer statusTimer;
+    qint64 lastStatusRead;
+    qint64 lastStatusEncoded;
 };
 
 
@@ -236,18 +317,38 @@ bool MassAudioEncodingJob::run()
         tasks.push_back( Task(i) );
     std::sort( tasks.begin(), tasks.end(), Task::sort_by_tracknumber );
 
-    bool success = true;
-    QString lastFilename;
-    std::vector<Task>::const_iterator currentTask;
-    for( currentTask = tasks.begin(); success && currentTask != tasks.end(); ++currentTask ) {
-        success = encodeTrack( currentTask->track.value(), currentTask->track.key(), lastFilename );
-        lastFilename = currentTask->track.key();
+    // If every track goes into its own file the tracks can be encoded in
+    // parallel. Otherwise one encoder (or the wave writer) takes all of them.
+    QList<AudioEncoder*> encoders;
+    if( d->encoder && d->encoder->isReentrant() && fileNames.count() == int( tasks.size() ) ) {
+        const int workers = qMin( QThread::idealThreadCount(), int( tasks.size() ) );
+        for( int i = 0; i < workers; ++i ) {
+            AudioEncoder* encoder = d->encoder->createInstance();
+            if( !encoder )
+                break;
+            encoders.append( encoder );
+        }
+        if( encoders.count() < 2 ) {
+            qDeleteAll( encoders );
+            encoders.clear();
+        }
     }
 
-    if( d->encoder )
-        d->encoder->closeFile();
-    if( d->waveFileWriter )
-        d->waveFileWriter->close();
+    QList<EncodingTask> encodingTasks;
+    for( std::vector<Task>::const_iterator it = tasks.begin(); it != tasks.end(); ++it ) {
+        EncodingTask task = { it->track.value(), it->track.key(), 0 };
+        encodingTasks.append( task );
+    }
+
+    bool success = true;
+    if( !encoders.isEmpty() ) {
+        qDebug() << "(K3b::MassAudioEncodingJob) encoding" << tasks.size() << "tracks with" << encoders.count() << "threads";
+        success = encodeTracks( encodingTasks, encoders );
+        qDeleteAll( encoders );
+    }
+    else {
+        success = encodeTracks( encodingTasks, QList<AudioEncoder*>() << d->encoder );
+    }
 
     if( !canceled() && success && !d->playlistFilename.isNull() ) {
         success = success && writePlaylist();
@@ -257,137 +358,358 @@ bool MassAudioEncodingJob::run()
         success = success && writeCueFile();
     }
 
-    if( canceled() ) {
-        if( currentTask != tasks.end() ) {
-            if( QFile::exists( currentTask->track.key() ) ) {
-                QFile::remove( currentTask->track.key() );
-                emit infoMessage( i18n("Removed partial file '%1'.", currentTask->track.key()), K3b::Job::MessageInfo );
-            }
-        }
-
+    if( canceled() )
         success = false;
-    }
-    
+
     cleanup();
     return success;
 }
 
 
-bool K3b::MassAudioEncodingJob::encodeTrack( int trackIndex, const QString& filename, const QString& prevFilename )
+bool MassAudioEncodingJob::encodeTracks( const QList<EncodingTask>& tasks, const QList<AudioEncoder*>& encoders )
 {
-    QScopedPointer<QIODevice> source( createReader( trackIndex ) );
-    if( source.isNull() ) {
-        return false;
-    }
-    
-    QDir dir = QFileInfo( filename ).dir();
-    if( !QDir().mkpath( dir.path() ) ) {
-        emit infoMessage( i18n("Unable to create folder %1",dir.path()), K3b::Job::MessageError );
-        return false;
+    d->encodingQueue.clear();
+    d->encodedTracks.clear();
+    d->startedFiles.clear();
+    d->finishedFiles.clear();
+    d->tasksInProgress = 0;
+    d->overallBytesEncoded = 0;
+    d->readingFinished = false;
+    d->encodingFailed = false;
+    d->readingWaitTime = 0;
+    d->encodingWaitTime = 0;
+    d->lastStatusRead = 0;
+    d->lastStatusEncoded = 0;
+
+    QElapsedTimer runTime;
+    runTime.start();
+    d->statusTimer.start();
+
+    QList<QThread*> threads;
+    Q_FOREACH( AudioEncoder* encoder, encoders ) {
+        QThread* thread = QThread::create( [this, encoder]() { runEncodingWorker( encoder ); } );
+        threads.append( thread );
+        thread->start();
     }
 
-    // Close the previous file if the new filename is different
-    if( prevFilename != filename ) {
-        if( d->encoder )
-            d->encoder->closeFile();
-        if( d->waveFileWriter )
-            d->waveFileWriter->close();
-    }
-
-    // Open the file to write if it is not already opened
-    if( (d->encoder && !d->encoder->isOpen()) ||
-        (d->waveFileWriter && !d->waveFileWriter->isOpen()) ) {
-        bool isOpen = true;
-        if( d->encoder ) {
-            AudioEncoder::MetaData metaData;
-            metaData.insert( AudioEncoder::META_ALBUM_ARTIST, d->cddbEntry.get( KCDDB::Artist ) );
-            metaData.insert( AudioEncoder::META_ALBUM_TITLE, d->cddbEntry.get( KCDDB::Title ) );
-            metaData.insert( AudioEncoder::META_ALBUM_COMMENT, d->cddbEntry.get( KCDDB::Comment ) );
-            metaData.insert( AudioEncoder::META_YEAR, d->cddbEntry.get( KCDDB::Year ) );
-            metaData.insert( AudioEncoder::META_GENRE, d->cddbEntry.get( KCDDB::Genre ) );
-            if( d->tracks.count( filename ) == 1 ) {
-                metaData.insert( AudioEncoder::META_TRACK_NUMBER, QString::number(trackIndex).rightJustified( 2, '0' ) );
-                metaData.insert( AudioEncoder::META_TRACK_ARTIST, d->cddbEntry.track( trackIndex-1 ).get( KCDDB::Artist ) );
-                metaData.insert( AudioEncoder::META_TRACK_TITLE, d->cddbEntry.track( trackIndex-1 ).get( KCDDB::Title ) );
-                metaData.insert( AudioEncoder::META_TRACK_COMMENT, d->cddbEntry.track( trackIndex-1 ).get( KCDDB::Comment ) );
-            }
-            else {
-                metaData.insert( AudioEncoder::META_TRACK_ARTIST, d->cddbEntry.get( KCDDB::Artist ) );
-                metaData.insert( AudioEncoder::META_TRACK_TITLE, d->cddbEntry.get( KCDDB::Title ) );
-                metaData.insert( AudioEncoder::META_TRACK_COMMENT, d->cddbEntry.get( KCDDB::Comment ) );
+    bool success = true;
+    Q_FOREACH( EncodingTask task, tasks ) {
+        {
+            // do not read further ahead than the encoders can take. The track
+            // being read is queued right away, so it can be encoded meanwhile.
+            QElapsedTimer waitTime;
+            waitTime.start();
+            QMutexLocker locker( &d->mutex );
+            while( d->tasksInProgress > encoders.count() && !d->encodingFailed && !canceled() )
+                d->queueChanged.wait( &d->mutex, 100 );
+            d->readingWaitTime += waitTime.elapsed();
+            if( d->encodingFailed || canceled() ) {
+                success = false;
+                break;
             }
 
-            isOpen = d->encoder->openFile( d->fileType, filename, d->lengths[ filename ], metaData );
-            if( !isOpen )
-                emit infoMessage( d->encoder->lastErrorString(), K3b::Job::MessageError );
+            task.buffer = new ReadAheadBuffer( TRACK_BUFFER_SIZE );
+            d->buffers.append( task.buffer );
+            d->encodingQueue.enqueue( task );
+            ++d->tasksInProgress;
+            d->queueChanged.wakeAll();
         }
-        else {
-            isOpen = d->waveFileWriter->open( filename );
+
+        if( !readTrack( task.trackIndex, task.buffer ) ) {
+            success = false;
+            break;
         }
+    }
 
-        if( !isOpen ) {
-            emit infoMessage( i18n("Unable to open '%1' for writing.",filename), K3b::Job::MessageError );
-            return false;
+    d->mutex.lock();
+    d->readingFinished = true;
+    if( !success ) {
+        d->encodingFailed = true;
+        Q_FOREACH( ReadAheadBuffer* buffer, d->buffers )
+            buffer->cancel();
+    }
+    d->queueChanged.wakeAll();
+    d->mutex.unlock();
+
+    Q_FOREACH( QThread* thread, threads ) {
+        thread->wait();
+        delete thread;
+    }
+
+    d->encodingQueue.clear();
+    qDeleteAll( d->buffers );
+    d->buffers.clear();
+
+    Q_FOREACH( const QString& filename, d->startedFiles ) {
+        if( !d->finishedFiles.contains( filename ) )
+            removePartialFile( filename );
+    }
+
+    // tell where the time went: a reader waiting for the encoders means
+    // the processor is the bottleneck, encoders waiting for the reader the source
+    const qint64 elapsed = qMax<qint64>( 1, runTime.elapsed() );
+    qDebug() << "(K3b::MassAudioEncodingJob) read" << d->overallBytesRead << "bytes in" << elapsed << "ms,"
+             << "reading waited" << d->readingWaitTime << "ms for the encoders,"
+             << "the encoders waited" << d->encodingWaitTime/encoders.count() << "ms on average for the source";
+    if( success && !d->encodingFailed && d->readingWaitTime*10 > elapsed ) {
+        emit infoMessage( i18n("Reading waited for the encoders %1% of the time. The processor limited the ripping speed.",
+                               100*d->readingWaitTime/elapsed ),
+                          Job::MessageInfo );
+    }
+
+    return success && !d->encodingFailed;
+}
+
+
+void MassAudioEncodingJob::runEncodingWorker( AudioEncoder* encoder )
+{
+    QString openFilename;
+    forever {
+        EncodingTask task;
+        {
+            QMutexLocker locker( &d->mutex );
+            while( d->encodingQueue.isEmpty() && !d->readingFinished && !d->encodingFailed && !canceled() )
+                d->queueChanged.wait( &d->mutex, 100 );
+            if( d->encodingQueue.isEmpty() || d->encodingFailed || canceled() )
+                break;
+            task = d->encodingQueue.dequeue();
+            d->queueChanged.wakeAll();
+        }
+
+        bool success = true;
+        if( task.filename != openFilename ) {
+            if( !openFilename.isEmpty() )
+                closeFile( encoder );
+            openFilename.clear();
+
+            d->mutex.lock();
+            d->startedFiles.insert( task.filename );
+            d->mutex.unlock();
+
+            success = openFile( encoder, task.trackIndex, task.filename );
+            if( success )
+                openFilename = task.filename;
+        }
+
+        if( success )
+            success = encodeTrackData( encoder, task.trackIndex, task.filename, task.buffer );
+
+        bool fileFinished = false;
+        {
+            QMutexLocker locker( &d->mutex );
+            --d->tasksInProgress;
+            d->queueChanged.wakeAll();
+            if( !success ) {
+                d->encodingFailed = true;
+                break;
+            }
+            fileFinished = ( ++d->encodedTracks[task.filename] == d->tracks.count( task.filename ) );
+        }
+
+        if( fileFinished ) {
+            closeFile( encoder );
+            openFilename.clear();
+
+            QMutexLocker locker( &d->mutex );
+            d->finishedFiles.insert( task.filename );
         }
     }
 
+    // an incomplete file which will be removed
+    if( !openFilename.isEmpty() )
+        closeFile( encoder );
+
+    // the reader might wait for room in a buffer no one will read anymore
+    QMutexLocker locker( &d->mutex );
+    if( d->encodingFailed || canceled() ) {
+        Q_FOREACH( ReadAheadBuffer* buffer, d->buffers )
+            buffer->cancel();
+    }
+}
+
+
+bool MassAudioEncodingJob::readTrack( int trackIndex, ReadAheadBuffer* buffer )
+{
+    QScopedPointer<QIODevice> source( createReader( trackIndex ) );
+    if( source.isNull() ) {
+        return false;
+    }
+
     trackStarted( trackIndex );
 
-    // do the conversion
-    // ----------------------
+    if( !source->open( QIODevice::ReadOnly ) ) {
+        emit infoMessage( source->errorString(), Job::MessageError );
+        return false;
+    }
 
-    char buffer[10*1024];
-    const qint64 bufferLength = 10LL*1024LL;
+    QByteArray data( BUFFER_SIZE, Qt::Uninitialized );
     qint64 readLength = 0;
     qint64 readFile = 0;
+    QElapsedTimer waitTime;
+    while( !canceled() && !source->atEnd() && ( readLength = source->read( data.data(), data.size() ) ) > 0 ) {
+        // a full buffer means the encoder is slower than the source
+        waitTime.start();
+        if( !buffer->write( data.constData(), readLength ) ) {
+            // the encoder failed and reported the error
+            return false;
+        }
+        d->readingWaitTime += waitTime.elapsed();
 
-    if( !source->open( QIODevice::ReadOnly ) ) {
+        readFile += readLength;
+        emit subPercent( 100LL*readFile/source->size() );
+
+        {
+            QMutexLocker locker( &d->mutex );
+            d->overallBytesRead += readLength;
+            emit percent( 50LL*( d->overallBytesRead + d->overallBytesEncoded )/d->overallBytesToRead );
+        }
+
+        emitPipelineStatus( buffer );
+    }
+
+    if( !canceled() && !source->atEnd() ) {
         emit infoMessage( source->errorString(), Job::MessageError );
         return false;
     }
 
-    while( !canceled() && !source->atEnd() && ( readLength = source->read( buffer, bufferLength ) ) > 0 ) {
+    if( canceled() )
+        return false;
 
-        if( d->encoder ) {
+    buffer->close();
+    return true;
+}
 
-            if( d->bigEndian ) {
-                // the tracks produce big endian samples
-                // and encoder encoder consumes little endian
-                // so we need to swap the bytes here
-                char b;
-                for( qint64 i = 0; i < bufferLength-1; i+=2 ) {
-                    b = buffer[i];
-                    buffer[i] = buffer[i+1];
-                    buffer[i+1] = b;
-                }
-            }
 
-            if( d->encoder->encode( buffer, readLength ) < 0 ) {
+bool MassAudioEncodingJob::openFile( AudioEncoder* encoder, int trackIndex, const QString& filename )
+{
+    QDir dir = QFileInfo( filename ).dir();
+    if( !QDir().mkpath( dir.path() ) ) {
+        emit infoMessage( i18n("Unable to create folder %1",dir.path()), K3b::Job::MessageError );
+        return false;
+    }
+
+    bool isOpen = true;
+    if( encoder ) {
+        isOpen = encoder->openFile( d->fileType, filename, d->lengths.value( filename ),
+                                    createMetaData( d->cddbEntry, trackIndex, d->tracks.count( filename ) == 1 ) );
+        if( !isOpen )
+            emit infoMessage( encoder->lastErrorString(), K3b::Job::MessageError );
+    }
+    else {
+        isOpen = d->waveFileWriter->open( filename );
+    }
+
+    if( !isOpen ) {
+        emit infoMessage( i18n("Unable to open '%1' for writing.",filename), K3b::Job::MessageError );
+        return false;
+    }
+
+    return true;
+}
+
+
+void MassAudioEncodingJob::closeFile( AudioEncoder* encoder )
+{
+    if( encoder )
+        encoder->closeFile();
+    else
+        d->waveFileWriter->close();
+}
+
+
+bool MassAudioEncodingJob::encodeTrackData( AudioEncoder* encoder, int trackIndex, const QString& filename, ReadAheadBuffer* buffer )
+{
+    QByteArray data( BUFFER_SIZE, Qt::Uninitialized );
+    qint64 readLength = 0;
+    qint64 waited = 0;
+    QElapsedTimer waitTime;
+    forever {
+        // an empty buffer means the source is slower than the encoder
+        waitTime.start();
+        readLength = buffer->read( data.data(), data.size() );
+        waited += waitTime.elapsed();
+        if( readLength <= 0 || canceled() )
+            break;
+
+        if( encoder ) {
+            if( d->bigEndian )
+                swapByteOrder( data.data(), readLength );
+
+            if( encoder->encode( data.constData(), readLength ) < 0 ) {
                 qDebug() << "error while encoding.";
-                emit infoMessage( d->encoder->lastErrorString(), K3b::Job::MessageError );
+                emit infoMessage( encoder->lastErrorString(), K3b::Job::MessageError );
                 emit infoMessage( i18n("Error while encoding track %1.",trackIndex), K3b::Job::MessageError );
                 return false;
             }
         }
         else {
-            d->waveFileWriter->write( buffer,
+            d->waveFileWriter->write( data.constData(),
                                       readLength,
                                       d->bigEndian ? WaveFileWriter::BigEndian : WaveFileWriter::LittleEndian );
         }
 
-        d->overallBytesRead += readLength;
-        readFile += readLength;
-        emit subPercent( 100LL*readFile/source->size() );
-        emit percent( 100LL*d->overallBytesRead/d->overallBytesToRead );
+        QMutexLocker locker( &d->mutex );
+        d->overallBytesEncoded += readLength;
+        emit percent( 50LL*( d->overallBytesRead + d->overallBytesEncoded )/d->overallBytesToRead );
     }
 
-    if( !canceled() && !source->atEnd() ) {
-        emit infoMessage( source->errorString(), Job::MessageError );
+    d->mutex.lock();
+    d->encodingWaitTime += waited;
+    d->mutex.unlock();
+
+    // a read error has been reported by the reading thread
+    if( canceled() || readLength < 0 )
         return false;
-    }
 
     trackFinished( trackIndex, filename );
-    return source->atEnd();
+    return true;
+}
+
+
+void MassAudioEncodingJob::emitPipelineStatus( ReadAheadBuffer* buffer )
+{
+    const qint64 elapsed = d->statusTimer.elapsed();
+    if( elapsed < 1000 )
+        return;
+
+    qint64 read = 0;
+    qint64 encoded = 0;
+    int queued = 0;
+    {
+        QMutexLocker locker( &d->mutex );
+        read = d->overallBytesRead;
+        encoded = d->overallBytesEncoded;
+        queued = d->encodingQueue.count();
+    }
+
+    emit pipelineStatus( 1000*( read - d->lastStatusRead )/elapsed,
+                         1000*( encoded - d->lastStatusEncoded )/elapsed,
+                         queued,
+                         buffer->fillLevel() );
+
+    d->lastStatusRead = read;
+    d->lastStatusEncoded = encoded;
+    d->statusTimer.restart();
+}
+
+
+QString MassAudioEncodingJob::pipelineStatusText( qint64 readingSpeed, qint64 encodingSpeed, int queuedTracks, int bufferFill )
+{
+    return i18np( "Reading %2/s, encoding %3/s, buffer %4%, 1 track waiting",
+                  "Reading %2/s, encoding %3/s, buffer %4%, %1 tracks waiting",
+                  queuedTracks,
+                  KIO::convertSize( readingSpeed ),
+                  KIO::convertSize( encodingSpeed ),
+                  bufferFill );
+}
+
+
+void MassAudioEncodingJob::removePartialFile( const QString& filename )
+{
+    if( QFile::exists( filename ) ) {
+        QFile::remove( filename );
+        emit infoMessage( i18n("Removed partial file '%1'.", filename), K3b::Job::MessageInfo );
+    }
 }
 
 
@@ -24,7 +24,18 @@ namespace KCDDB {
 
 namespace K3b {
     class AudioEncoder;
-
+    class ReadAheadBuffer;
+
+    /**
+     * Encodes a list of tracks into one or more files.
+     *
+     * The tracks are read one after the other in the job's thread and
+     * handed over to encoding threads through a ring buffer per track.
+     * Thus reading only waits for the encoders if they cannot keep up.
+     * If every track goes into its own file and the encoder is re-entrant
+     * the tracks are encoded in parallel by one encoder instance per CPU
+     * core, otherwise by a single encoding thread.
+     */
     class MassAudioEncodingJob : public ThreadJob
     {
         Q_OBJECT
@@ -79,6 +90,24 @@ namespace K3b {
         
         QString jobDetails() const override;
         QString jobTarget() const override;
+
+        /**
+         * A single line describing the values of pipelineStatus() to be
+         * shown in the progress dialog.
+         */
+        static QString pipelineStatusText( qint64 readingSpeed, qint64 encodingSpeed, int queuedTracks, int bufferFill );
+
+    Q_SIGNALS:
+        /**
+         * Emitted about once a second while reading. Compare the speeds to
+         * see whether the source or the encoders limit the overall speed.
+         *
+         * \param readingSpeed Bytes per second read from the source.
+         * \param encodingSpeed Bytes per second encoded by all encoders together.
+         * \param queuedTracks Tracks waiting for an encoder to become free.
+         * \param bufferFill Fill level of the buffer of the track being read in percent.
+         */
+        void pipelineStatus( qint64 readingSpeed, qint64 encodingSpeed, int queuedTracks, int bufferFill );
         
     protected:
         /**
@@ -115,15 +144,41 @@ namespace K3b {
         virtual void trackFinished( int trackIndex, const QString& filename ) = 0;
         
     private:
+        struct EncodingTask;
+
         bool run() override;
         
         /**
-         * Reads data from source and encode it to provided filename
-         * \param trackIndex 1-based track index
-         * \param filename path to the target file
-         * \param filename path to previously encoded file
+         * Reads all tracks in order and hands them over to one worker thread
+         * per encoder.
+         * \param encoders The encoder instances, one per worker thread.
+         *                 0 stands for the wave file writer.
+         */
+        bool encodeTracks( const QList<EncodingTask>& tasks, const QList<AudioEncoder*>& encoders );
+
+        /**
+         * Encodes the tracks read by encodeTracks() until all
+         * tracks have been encoded.
+         */
+        void runEncodingWorker( AudioEncoder* encoder );
+
+        /**
+         * Reads a track into \p buffer and closes it once the
+         * whole track has been read.
+         */
+        bool readTrack( int trackIndex, ReadAheadBuffer* buffer );
+
+        bool openFile( AudioEncoder* encoder, int trackIndex, const QString& filename );
+        void closeFile( AudioEncoder* encoder );
+
+        /**
+         * Encodes the data read by readTrack() to the file opened with openFile().
          */
-        bool encodeTrack( int trackIndex, const QString& filename, const QString& prevFilename );
+        bool encodeTrackData( AudioEncoder* encoder, int trackIndex, const QString& filename, ReadAheadBuffer* buffer );
+
+        void emitPipelineStatus( ReadAheadBuffer* buffer );
+
+        void removePartialFile( const QString& filename );
 
         /**
          * Writes a playlist file for previously specified tracks
@@ -0,0 +1,249 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bactivepipetest.h"
+#include "k3bactivepipe.h"
+
+#include <QFile>
+#include <QTest>
+
+#include <string.h>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+QTEST_GUILESS_MAIN( ActivePipeTest )
+
+namespace {
+    /**
+     * Looks at all data passed through it and thus needs the buffered copy.
+     */
+    class FilterPipe : public K3b::ActivePipe
+    {
+    public:
+        FilterPipe() : m_filtered( 0 ) {}
+
+        qint64 filtered() const { return m_filtered; }
+
+    protected:
+        bool hasDataFilter() const override { return true; }
+
+        qint64 writeData( const char* data, qint64 max ) override {
+            m_filtered += max;
+            return K3b::ActivePipe::writeData( data, max );
+        }
+
+    private:
+        qint64 m_filtered;
+    };
+
+    /**
+     * A subclass which does not touch the data.
+     */
+    class PlainPipe : public K3b::ActivePipe
+    {
+    };
+
+    /**
+     * Fails after \p size bytes.
+     */
+    class BrokenDevice : public QIODevice
+    {
+    public:
+        explicit BrokenDevice( qint64 size ) : m_left( size ) {}
+
+    protected:
+        qint64 readData( char* data, qint64 max ) override {
+            if( m_left <= 0 ) {
+                setErrorString( "broken device" );
+                return -1;
+            }
+            const qint64 r = qMin( max, m_left );
+            memset( data, 'x', r );
+            m_left -= r;
+            return r;
+        }
+
+        qint64 writeData( const char*, qint64 ) override { return -1; }
+
+    private:
+        qint64 m_left;
+    };
+
+    // the data is available for the next step once the pipe has been closed
+    bool pump( K3b::ActivePipe* pipe, QIODevice* source, QIODevice* sink )
+    {
+        pipe->readFrom( source );
+        pipe->writeTo( sink );
+        if( !pipe->open() )
+            return false;
+        pipe->close();
+        return true;
+    }
+
+    QByteArray readFile( const QString& path )
+    {
+        QFile file( path );
+        if( !file.open( QIODevice::ReadOnly ) )
+            return QByteArray();
+        return file.readAll();
+    }
+
+    K3b::ActivePipe* createPipe( int type )
+    {
+        switch( type ) {
+        case 1:
+            return new PlainPipe();
+        case 2:
+            return new FilterPipe();
+        default:
+            return new K3b::ActivePipe();
+        }
+    }
+}
+
+
+void ActivePipeTest::initTestCase()
+{
+    QVERIFY( m_dir.isValid() );
+
+    m_data.resize( 16*1024*1024 + 4711 );
+    for( int i = 0; i < m_data.size(); ++i )
+        m_data[i] = char( i*7 + i/4096 );
+
+    m_sourcePath = m_dir.filePath( "source" );
+    QFile file( m_sourcePath );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    QCOMPARE( file.write( m_data ), qint64( m_data.size() ) );
+}
+
+
+void ActivePipeTest::testFileToFile_data()
+{
+    QTest::addColumn<int>( "type" );
+    QTest::newRow( "ActivePipe" ) << 0;
+    QTest::newRow( "subclass" ) << 1;
+    QTest::newRow( "data filter" ) << 2;
+}
+
+
+void ActivePipeTest::testFileToFile()
+{
+    QFETCH( int, type );
+
+    QFile source( m_sourcePath );
+    QFile sink( m_dir.filePath( "sink" ) );
+    QVERIFY( source.open( QIODevice::ReadOnly ) );
+    QVERIFY( sink.open( QIODevice::WriteOnly ) );
+
+    K3b::ActivePipe* pipe = createPipe( type );
+    QVERIFY( pump( pipe, &source, &sink ) );
+    sink.close();
+
+    QCOMPARE( pipe->transferError(), QString() );
+    QCOMPARE( pipe->bytesRead(), quint64( m_data.size() ) );
+    QCOMPARE( pipe->bytesWritten(), quint64( m_data.size() ) );
+    if( type == 2 )
+        QCOMPARE( static_cast<FilterPipe*>( pipe )->filtered(), qint64( m_data.size() ) );
+    QVERIFY( readFile( sink.fileName() ) == m_data );
+
+    delete pipe;
+}
+
+
+void ActivePipeTest::testSourcePosition()
+{
+    QFile source( m_sourcePath );
+    QFile sink( m_dir.filePath( "sink" ) );
+    QVERIFY( source.open( QIODevice::ReadOnly ) );
+    QVERIFY( sink.open( QIODevice::WriteOnly ) );
+
+    // buffered data of the QIODevices has to be respected
+    QCOMPARE( source.read( 1000 ), m_data.left( 1000 ) );
+    QCOMPARE( sink.write( "header" ), qint64( 6 ) );
+
+    K3b::ActivePipe pipe;
+    QVERIFY( pump( &pipe, &source, &sink ) );
+    QCOMPARE( source.pos(), qint64( m_data.size() ) );
+    sink.close();
+
+    QVERIFY( readFile( sink.fileName() ) == "header" + m_data.mid( 1000 ) );
+}
+
+
+void ActivePipeTest::testReadError()
+{
+    BrokenDevice source( 100000 );
+    QVERIFY( source.open( QIODevice::ReadOnly|QIODevice::Unbuffered ) );
+    QFile sink( m_dir.filePath( "sink" ) );
+    QVERIFY( sink.open( QIODevice::WriteOnly ) );
+
+    K3b::ActivePipe pipe;
+    QVERIFY( pump( &pipe, &source, &sink ) );
+    QCOMPARE( pipe.transferError(), QString( "broken device" ) );
+    QCOMPARE( pipe.bytesWritten(), quint64( 100000 ) );
+}
+
+
+void ActivePipeTest::testPipeCapacity()
+{
+#ifdef Q_OS_LINUX
+    for( int i = 0; i < 2; ++i ) {
+        int fds[2];
+        QCOMPARE( ::pipe( fds ), 0 );
+        const int capacity = ::fcntl( fds[0], F_GETPIPE_SZ );
+        QVERIFY( capacity > 0 );
+        QCOMPARE( ::write( fds[1], m_data.constData(), 1000 ), ssize_t( 1000 ) );
+        ::close( fds[1] );
+
+        QFile source;
+        QVERIFY( source.open( fds[0], QIODevice::ReadOnly ) );
+        QFile sink( m_dir.filePath( "sink" ) );
+        QVERIFY( sink.open( QIODevice::WriteOnly ) );
+
+        // the default buffer is smaller than the pipe, the second one larger
+        K3b::ActivePipe pipe;
+        if( i == 1 )
+            pipe.setBufferSize( 2*capacity );
+        QVERIFY( pump( &pipe, &source, &sink ) );
+        QCOMPARE( pipe.bytesWritten(), quint64( 1000 ) );
+        if( i == 0 )
+            QCOMPARE( ::fcntl( fds[0], F_GETPIPE_SZ ), capacity );
+        else
+            QVERIFY( ::fcntl( fds[0], F_GETPIPE_SZ ) >= capacity );
+
+        source.close();
+        ::close( fds[0] );
+    }
+#else
+    QSKIP( "Pipe capacities can only be changed on Linux" );
+#endif
+}
+
+
+void ActivePipeTest::benchmarkFileToFile_data()
+{
+    testFileToFile_data();
+}
+
+
+void ActivePipeTest::benchmarkFileToFile()
+{
+    QFETCH( int, type );
+
+    K3b::ActivePipe* pipe = createPipe( type );
+    QBENCHMARK {
+        QFile source( m_sourcePath );
+        QFile sink( m_dir.filePath( "sink" ) );
+        QVERIFY( source.open( QIODevice::ReadOnly ) );
+        QVERIFY( sink.open( QIODevice::WriteOnly ) );
+        QVERIFY( pump( pipe, &source, &sink ) );
+    }
+    QCOMPARE( pipe->bytesWritten(), quint64( m_data.size() ) );
+    delete pipe;
+}
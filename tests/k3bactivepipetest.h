@@ -0,0 +1,31 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_ACTIVE_PIPE_TEST_H
+#define K3B_ACTIVE_PIPE_TEST_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class ActivePipeTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void testFileToFile_data();
+    void testFileToFile();
+    void testSourcePosition();
+    void testReadError();
+    void testPipeCapacity();
+    void benchmarkFileToFile_data();
+    void benchmarkFileToFile();
+private:
+    QTemporaryDir m_dir;
+    QString m_sourcePath;
+    QByteArray m_data;
+};
+
+#endif // K3B_ACTIVE_PIPE_TEST_H
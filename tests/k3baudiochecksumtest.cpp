@@ -0,0 +1,246 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3baudiochecksumtest.h"
+#include "k3baudiochecksum.h"
+#include "k3baudiochecksumreader.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtEndian>
+
+#include <cstring>
+
+QTEST_GUILESS_MAIN( AudioChecksumTest )
+
+namespace {
+    const int SECTOR_SIZE = 2352;
+
+    QByteArray testData( int size )
+    {
+        QByteArray data( size, Qt::Uninitialized );
+        for( int i = 0; i < size; ++i )
+            data[i] = char( ( i * 7 + i / 4099 ) & 0xff );
+        return data;
+    }
+
+    // pseudo random noise, not periodic like testData()
+    QByteArray noise( int size, quint32 seed )
+    {
+        QByteArray data( size, Qt::Uninitialized );
+        for( int i = 0; i < size; ++i ) {
+            seed = seed * 1103515245 + 12345;
+            data[i] = char( seed >> 16 );
+        }
+        return data;
+    }
+
+    QByteArray swapped( const QByteArray& data )
+    {
+        QByteArray result( data );
+        char* p = result.data();
+        for( int i = 0; i + 1 < result.size(); i += 2 )
+            qSwap( p[i], p[i+1] );
+        return result;
+    }
+
+    QByteArray waveHeader( int dataSize )
+    {
+        QByteArray header( 44, '\0' );
+        uchar* h = reinterpret_cast<uchar*>( header.data() );
+        memcpy( h, "RIFF", 4 );
+        qToLittleEndian<quint32>( 36 + dataSize, h+4 );
+        memcpy( h+8, "WAVEfmt ", 8 );
+        qToLittleEndian<quint32>( 16, h+16 );
+        qToLittleEndian<quint16>( 1, h+20 );       // PCM
+        qToLittleEndian<quint16>( 2, h+22 );       // stereo
+        qToLittleEndian<quint32>( 44100, h+24 );
+        qToLittleEndian<quint32>( 44100*4, h+28 );
+        qToLittleEndian<quint16>( 4, h+32 );
+        qToLittleEndian<quint16>( 16, h+34 );
+        memcpy( h+36, "data", 4 );
+        qToLittleEndian<quint32>( dataSize, h+40 );
+        return header;
+    }
+}
+
+AudioChecksumTest::AudioChecksumTest()
+{
+}
+
+void AudioChecksumTest::testCrc32()
+{
+    const QByteArray data = testData( 3*SECTOR_SIZE );
+
+    K3b::AudioChecksum checksum( 3, false, false );
+    QVERIFY( checksum.isValid() );
+    checksum.update( data.constData(), data.size(), K3b::AudioChecksum::LittleEndian );
+    QVERIFY( checksum.isComplete() );
+    QCOMPARE( checksum.crc32(), quint32( 0x2EC34AE2 ) );
+
+    // data beyond the track length is ignored
+    checksum.update( data.constData(), 100, K3b::AudioChecksum::LittleEndian );
+    QCOMPARE( checksum.crc32(), quint32( 0x2EC34AE2 ) );
+}
+
+void AudioChecksumTest::testByteOrder()
+{
+    const QByteArray data = noise( 10*SECTOR_SIZE, 1 );
+
+    K3b::AudioChecksum littleEndian( 10, true, true );
+    littleEndian.update( data.constData(), data.size(), K3b::AudioChecksum::LittleEndian );
+
+    // split samples between the calls
+    const QByteArray bigEndianData = swapped( data );
+    K3b::AudioChecksum bigEndian( 10, true, true );
+    for( int pos = 0; pos < bigEndianData.size(); pos += 7 )
+        bigEndian.update( bigEndianData.constData() + pos, qMin( 7, bigEndianData.size() - pos ), K3b::AudioChecksum::BigEndian );
+
+    QVERIFY( bigEndian.isComplete() );
+    QVERIFY( littleEndian == bigEndian );
+    QCOMPARE( littleEndian.probe(), bigEndian.probe() );
+}
+
+void AudioChecksumTest::testEdgeSkipping()
+{
+    const int sectors = 20;
+    const QByteArray data = noise( sectors*SECTOR_SIZE, 2 );
+    const qint64 samples = sectors*K3b::AudioChecksum::SAMPLES_PER_SECTOR;
+
+    K3b::AudioChecksum checksum( sectors, true, true );
+    checksum.update( data.constData(), data.size(), K3b::AudioChecksum::LittleEndian );
+
+    quint32 accurateRip = 0;
+    for( qint64 i = 5*588 - 1; i < samples - 5*588; ++i )
+        accurateRip += qFromLittleEndian<quint32>( reinterpret_cast<const uchar*>( data.constData() + 4*i ) ) * quint32( i + 1 );
+    QCOMPARE( checksum.accurateRip(), accurateRip );
+
+    // changes in the skipped sectors do not matter
+    QByteArray changed( data );
+    changed[0] = ~changed[0];
+    changed[changed.size()-1] = ~changed[changed.size()-1];
+    K3b::AudioChecksum changedChecksum( sectors, true, true );
+    changedChecksum.update( changed.constData(), changed.size(), K3b::AudioChecksum::LittleEndian );
+    QVERIFY( checksum == changedChecksum );
+
+    // but they do in the middle of the disc
+    K3b::AudioChecksum inner( sectors, false, false );
+    inner.update( data.constData(), data.size(), K3b::AudioChecksum::LittleEndian );
+    K3b::AudioChecksum changedInner( sectors, false, false );
+    changedInner.update( changed.constData(), changed.size(), K3b::AudioChecksum::LittleEndian );
+    QVERIFY( inner != changedInner );
+}
+
+void AudioChecksumTest::testFindProbe()
+{
+    // leading silence is skipped for the probe
+    QByteArray track( 8*SECTOR_SIZE, '\0' );
+    track.append( noise( 4*SECTOR_SIZE, 3 ) );
+
+    K3b::AudioChecksum checksum( 12, false, false );
+    checksum.update( track.constData(), track.size(), K3b::AudioChecksum::LittleEndian );
+    const QByteArray probe = checksum.probe();
+    QCOMPARE( probe.size(), K3b::AudioChecksum::PROBE_SAMPLES*4 );
+    QVERIFY( checksum.probePosition() > 7*588 );
+    QVERIFY( checksum.probePosition() <= 8*588 );
+
+    const qint64 samples = track.size()/4;
+    for( int offset = -700; offset <= 700; offset += 350 ) {
+        QByteArray shifted( 4*samples, '\0' );
+        if( offset >= 0 )
+            memcpy( shifted.data() + 4*offset, track.constData(), track.size() - 4*offset );
+        else
+            memcpy( shifted.data(), track.constData() - 4*offset, track.size() + 4*offset );
+
+        qint64 pos = 0;
+        QVERIFY( K3b::AudioChecksum::findProbe( probe, shifted.constData(), samples, checksum.probePosition(), &pos ) );
+        QCOMPARE( pos, checksum.probePosition() + offset );
+    }
+
+    qint64 pos = 0;
+    QVERIFY( !K3b::AudioChecksum::findProbe( probe, noise( 4*SECTOR_SIZE, 4 ).constData(), 4*588, 0, &pos ) );
+
+    K3b::AudioChecksum silence( 12, false, false );
+    const QByteArray zeros( 12*SECTOR_SIZE, '\0' );
+    silence.update( zeros.constData(), zeros.size(), K3b::AudioChecksum::LittleEndian );
+    QVERIFY( silence.probe().isEmpty() );
+}
+
+void AudioChecksumTest::testReadImage_data()
+{
+    QTest::addColumn<int>( "offset" );
+    QTest::addColumn<bool>( "wave" );
+
+    QTest::newRow( "no offset" ) << 0 << false;
+    QTest::newRow( "positive offset" ) << 667 << false;
+    QTest::newRow( "negative offset" ) << -1164 << false;
+    QTest::newRow( "wave" ) << 102 << true;
+}
+
+void AudioChecksumTest::testReadImage()
+{
+    QFETCH( int, offset );
+    QFETCH( bool, wave );
+
+    // a simulated disc with three tracks
+    const int trackSectors[] = { 40, 25, 30 };
+    QList<QByteArray> tracks;
+    QByteArray disc;
+    for( int i = 0; i < 3; ++i ) {
+        tracks << noise( trackSectors[i]*SECTOR_SIZE, 10 + i );
+        disc.append( tracks[i] );
+    }
+
+    // the written data is shifted by the offset
+    QByteArray image( disc.size(), '\0' );
+    if( offset >= 0 )
+        memcpy( image.data() + 4*offset, disc.constData(), disc.size() - 4*offset );
+    else
+        memcpy( image.data(), disc.constData() - 4*offset, disc.size() + 4*offset );
+
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    QFile file( dir.path() + ( wave ? "/disc.wav" : "/disc.bin" ) );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    if( wave )
+        file.write( waveHeader( image.size() ) );
+    file.write( image );
+    file.close();
+
+    K3b::AudioChecksumReader reader( 0 );
+    reader.setImagePath( file.fileName() );
+    QVERIFY( reader.openSource() );
+
+    int firstSector = 0;
+    for( int i = 0; i < 3; ++i ) {
+        // the reference is calculated from the decoded big endian stream
+        K3b::AudioChecksum reference( trackSectors[i], i == 0, i == 2 );
+        const QByteArray decoded = swapped( tracks[i] );
+        reference.update( decoded.constData(), decoded.size(), K3b::AudioChecksum::BigEndian );
+
+        reader.setTrack( firstSector, reference );
+        if( i == 0 ) {
+            QVERIFY( reader.detectReadOffset() );
+            QVERIFY( reader.readOffsetDetected() );
+            QCOMPARE( reader.readOffset(), offset );
+        }
+        QVERIFY( reader.calculateChecksum() );
+        QVERIFY( reader.checksum() == reference );
+
+        firstSector += trackSectors[i];
+    }
+
+    // a wrong offset is noticed
+    K3b::AudioChecksum reference( trackSectors[1], false, false );
+    reference.update( tracks[1].constData(), tracks[1].size(), K3b::AudioChecksum::LittleEndian );
+    reader.setTrack( trackSectors[0], reference );
+    reader.setReadOffset( offset + 1 );
+    QVERIFY( reader.calculateChecksum() );
+    QVERIFY( reader.checksum() != reference );
+
+    reader.closeSource();
+}
@@ -0,0 +1,26 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_AUDIO_CHECKSUM_TEST_H
+#define K3B_AUDIO_CHECKSUM_TEST_H
+
+#include <QObject>
+
+class AudioChecksumTest : public QObject
+{
+    Q_OBJECT
+public:
+    AudioChecksumTest();
+private slots:
+    void testCrc32();
+    void testByteOrder();
+    void testEdgeSkipping();
+    void testFindProbe();
+    void testReadImage_data();
+    void testReadImage();
+};
+
+#endif // K3B_AUDIO_CHECKSUM_TEST_H
@@ -0,0 +1,154 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3baudiodecodercachetest.h"
+#include "k3baudiodecodercache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( AudioDecoderCacheTest )
+
+namespace {
+    bool writeFile( const QString& filename, const QByteArray& data )
+    {
+        QFile file( filename );
+        return file.open( QIODevice::WriteOnly ) && file.write( data ) == data.size();
+    }
+
+    K3b::AudioDecoderCache::Entry testEntry()
+    {
+        K3b::AudioDecoderCache::Entry entry;
+        entry.length = K3b::Msf( 3, 20, 5 );
+        entry.samplerate = 48000;
+        entry.channels = 1;
+        entry.technicalInfo.insert( "Bitrate", "192 kbps" );
+        entry.metaInfo.insert( 0, "Title" );
+        entry.metaInfo.insert( 1, "Artist" );
+        entry.decoderData = QByteArray( "decoder\0data", 12 );
+        return entry;
+    }
+}
+
+
+AudioDecoderCacheTest::AudioDecoderCacheTest()
+{
+}
+
+
+void AudioDecoderCacheTest::testStoreAndLookup()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString audioFile = dir.filePath( "track.mp3" );
+    QVERIFY( writeFile( audioFile, "some audio" ) );
+
+    K3b::AudioDecoderCache cache( dir.filePath( "cache" ) );
+    K3b::AudioDecoderCache::Entry entry;
+    QVERIFY( !cache.lookup( "Decoder", audioFile, entry ) );
+
+    const K3b::AudioDecoderCache::Entry stored = testEntry();
+    QVERIFY( cache.store( "Decoder", audioFile, stored ) );
+    QVERIFY( cache.lookup( "Decoder", audioFile, entry ) );
+    QCOMPARE( entry.length, stored.length );
+    QCOMPARE( entry.samplerate, stored.samplerate );
+    QCOMPARE( entry.channels, stored.channels );
+    QCOMPARE( entry.technicalInfo, stored.technicalInfo );
+    QCOMPARE( entry.metaInfo, stored.metaInfo );
+    QCOMPARE( entry.decoderData, stored.decoderData );
+
+    cache.remove( "Decoder", audioFile );
+    QVERIFY( !cache.lookup( "Decoder", audioFile, entry ) );
+}
+
+
+void AudioDecoderCacheTest::testStaleEntry()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString audioFile = dir.filePath( "track.ogg" );
+    QVERIFY( writeFile( audioFile, "some audio" ) );
+
+    K3b::AudioDecoderCache cache( dir.filePath( "cache" ) );
+    QVERIFY( cache.store( "Decoder", audioFile, testEntry() ) );
+
+    // a different size invalidates the entry
+    QVERIFY( writeFile( audioFile, "some other audio" ) );
+    K3b::AudioDecoderCache::Entry entry;
+    QVERIFY( !cache.lookup( "Decoder", audioFile, entry ) );
+    QVERIFY( QDir( dir.filePath( "cache" ) ).isEmpty() );
+
+    // a replaced file has another inode
+    QVERIFY( cache.store( "Decoder", audioFile, testEntry() ) );
+    const QString replacement = dir.filePath( "replacement.ogg" );
+    QVERIFY( writeFile( replacement, "some other audio" ) );
+    QVERIFY( QFile::remove( audioFile ) );
+    QVERIFY( QFile::rename( replacement, audioFile ) );
+    QVERIFY( !cache.lookup( "Decoder", audioFile, entry ) );
+
+    // removed files are never found
+    QVERIFY( cache.store( "Decoder", audioFile, testEntry() ) );
+    QVERIFY( QFile::remove( audioFile ) );
+    QVERIFY( !cache.lookup( "Decoder", audioFile, entry ) );
+}
+
+
+void AudioDecoderCacheTest::testDecoderSeparation()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString audioFile = dir.filePath( "track.flac" );
+    QVERIFY( writeFile( audioFile, "some audio" ) );
+
+    K3b::AudioDecoderCache cache( dir.filePath( "cache" ) );
+    QVERIFY( cache.store( "Decoder", audioFile, testEntry() ) );
+
+    K3b::AudioDecoderCache::Entry entry;
+    QVERIFY( !cache.lookup( "OtherDecoder", audioFile, entry ) );
+    QVERIFY( cache.lookup( "Decoder", audioFile, entry ) );
+}
+
+
+void AudioDecoderCacheTest::testSeekIndex()
+{
+    QVector<quint64> positions;
+    quint64 pos = 417;
+    for( int i = 0; i < 1000; ++i ) {
+        positions.append( pos );
+        pos += 417 + ( i % 3 );
+    }
+    // a huge gap
+    positions.append( pos + Q_UINT64_C( 0x100000000 ) );
+
+    const QByteArray packed = K3b::AudioDecoderCache::packSeekIndex( positions );
+    QVERIFY( packed.size() < 2*positions.count() + 8 );
+
+    QVector<quint64> unpacked;
+    QVERIFY( K3b::AudioDecoderCache::unpackSeekIndex( packed, unpacked ) );
+    QCOMPARE( unpacked, positions );
+
+    QVERIFY( K3b::AudioDecoderCache::packSeekIndex( QVector<quint64>() ).isEmpty() );
+    QVERIFY( K3b::AudioDecoderCache::unpackSeekIndex( QByteArray(), unpacked ) );
+    QVERIFY( unpacked.isEmpty() );
+}
+
+
+void AudioDecoderCacheTest::testBrokenSeekIndex()
+{
+    QVector<quint64> positions;
+    positions << 1 << 1000;
+    QByteArray packed = K3b::AudioDecoderCache::packSeekIndex( positions );
+
+    // the last position is cut off
+    packed.chop( 1 );
+    QVector<quint64> unpacked;
+    QVERIFY( !K3b::AudioDecoderCache::unpackSeekIndex( packed, unpacked ) );
+
+    // too many continuation bytes
+    QVERIFY( !K3b::AudioDecoderCache::unpackSeekIndex( QByteArray( 11, char( 0x80 ) ) + '\1', unpacked ) );
+}
@@ -0,0 +1,25 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_AUDIO_DECODER_CACHE_TEST_H
+#define K3B_AUDIO_DECODER_CACHE_TEST_H
+
+#include <QObject>
+
+class AudioDecoderCacheTest : public QObject
+{
+    Q_OBJECT
+public:
+    AudioDecoderCacheTest();
+private slots:
+    void testStoreAndLookup();
+    void testStaleEntry();
+    void testDecoderSeparation();
+    void testSeekIndex();
+    void testBrokenSeekIndex();
+};
+
+#endif // K3B_AUDIO_DECODER_CACHE_TEST_H
@@ -0,0 +1,316 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3baudiodecoderpooltest.h"
+#include "k3baudiodecoderpool.h"
+#include "k3baudiodecoder.h"
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QTest>
+#include <QThread>
+
+QTEST_GUILESS_MAIN( AudioDecoderPoolTest )
+
+namespace {
+    // a file that does not exist is never found in the analysis cache
+    const char* s_filename = "/nonexistent/k3b-decoder-pool-test.wav";
+
+    char byteAt( qint64 pos )
+    {
+        return char( pos % 251 );
+    }
+
+    /**
+     * Decodes a pattern which depends on the position in the file and
+     * counts the seeks the decoder plugin has to do.
+     */
+    class TestDecoder : public K3b::AudioDecoder
+    {
+    public:
+        explicit TestDecoder( const QString& filename = QLatin1String( s_filename ) )
+            : m_pos( 0 ),
+              m_seeks( 0 ) {
+            setFilename( filename );
+        }
+
+        int seeks() const { return m_seeks; }
+
+    protected:
+        bool analyseFileInternal( K3b::Msf& length, int& samplerate, int& channels ) override {
+            length = K3b::Msf( 1, 0, 0 );
+            samplerate = 44100;
+            channels = 2;
+            return true;
+        }
+
+        bool initDecoderInternal() override {
+            m_pos = 0;
+            return true;
+        }
+
+        int decodeInternal( char* data, int maxLen ) override {
+            const int len = int( qMin<qint64>( maxLen, length().audioBytes() - m_pos ) );
+            for( int i = 0; i < len; ++i )
+                data[i] = byteAt( m_pos + i );
+            m_pos += len;
+            return len;
+        }
+
+        bool seekInternal( const K3b::Msf& pos ) override {
+            ++m_seeks;
+            m_pos = pos.audioBytes();
+            return true;
+        }
+
+    private:
+        qint64 m_pos;
+        int m_seeks;
+    };
+
+    class TestPool : public K3b::AudioDecoderPool
+    {
+    public:
+        explicit TestPool( int maxIdleDecoders = 3, int maxTotalIdleDecoders = 8 )
+            : K3b::AudioDecoderPool( maxIdleDecoders, maxTotalIdleDecoders ),
+              m_created( 0 ) {
+        }
+
+        int created() const { return m_created.loadAcquire(); }
+
+    protected:
+        K3b::AudioDecoder* duplicateDecoder( const K3b::AudioDecoder* decoder ) override {
+            m_created.ref();
+            return new TestDecoder( decoder->filename() );
+        }
+
+    private:
+        QAtomicInt m_created;
+    };
+
+    /**
+     * Reads \p len bytes and checks that they are the ones at \p pos.
+     */
+    bool readAt( K3b::AudioDecoder* decoder, qint64 pos, qint64 len )
+    {
+        char buffer[10*2352];
+        while( len > 0 ) {
+            const int read = decoder->decode( buffer, int( qMin<qint64>( sizeof( buffer ), len ) ) );
+            if( read <= 0 )
+                return false;
+            for( int i = 0; i < read; ++i ) {
+                if( buffer[i] != byteAt( pos + i ) )
+                    return false;
+            }
+            pos += read;
+            len -= read;
+        }
+        return true;
+    }
+}
+
+
+void AudioDecoderPoolTest::testReuseAtSamePosition()
+{
+    TestDecoder original;
+    TestPool pool;
+
+    K3b::AudioDecoder* decoder = pool.acquire( &original, 0 );
+    QVERIFY( decoder );
+    QVERIFY( readAt( decoder, 0, 10*2352 ) );
+    pool.release( decoder, 10*2352 );
+    QCOMPARE( pool.idleDecoders( original.filename() ), 1 );
+
+    K3b::AudioDecoder* reused = pool.acquire( &original, 10 );
+    QCOMPARE( reused, decoder );
+    QCOMPARE( pool.created(), 1 );
+    QCOMPARE( pool.idleDecoders( original.filename() ), 0 );
+    QVERIFY( readAt( reused, 10*2352, 5*2352 ) );
+    QCOMPARE( static_cast<TestDecoder*>( reused )->seeks(), 0 );
+
+    delete reused;
+}
+
+
+void AudioDecoderPoolTest::testReuseAtLaterPosition()
+{
+    TestDecoder original;
+    TestPool pool;
+
+    K3b::AudioDecoder* decoder = pool.acquire( &original, 0 );
+    QVERIFY( readAt( decoder, 0, 10*2352 ) );
+    pool.release( decoder, 10*2352 );
+
+    // within the window the decoder decodes up to the position
+    K3b::AudioDecoder* reused = pool.acquire( &original, 100 );
+    QCOMPARE( reused, decoder );
+    QCOMPARE( pool.created(), 1 );
+    QVERIFY( readAt( reused, 100*2352, 5*2352 ) );
+    QCOMPARE( static_cast<TestDecoder*>( reused )->seeks(), 0 );
+    pool.release( reused, 105*2352 );
+
+    // too far ahead a new decoder is as good as a seeking one
+    K3b::AudioDecoder* far = pool.acquire( &original, K3b::Msf( 0, 40, 0 ) );
+    QVERIFY( far );
+    QVERIFY( far != reused );
+    QCOMPARE( pool.created(), 2 );
+    QCOMPARE( pool.idleDecoders( original.filename() ), 1 );
+
+    delete far;
+}
+
+
+void AudioDecoderPoolTest::testSeekBack()
+{
+    TestDecoder original;
+    TestPool pool;
+
+    K3b::AudioDecoder* decoder = pool.acquire( &original, 0 );
+    QVERIFY( readAt( decoder, 0, 100*2352 ) );
+    pool.release( decoder, 100*2352 );
+
+    // the idle decoder keeps its position for a reader continuing there
+    K3b::AudioDecoder* back = pool.acquire( &original, 10 );
+    QVERIFY( back );
+    QVERIFY( back != decoder );
+    QCOMPARE( pool.created(), 2 );
+    QCOMPARE( pool.idleDecoders( original.filename() ), 1 );
+    QVERIFY( readAt( back, 10*2352, 5*2352 ) );
+    pool.release( back, 15*2352 );
+
+    K3b::AudioDecoder* forward = pool.acquire( &original, 100 );
+    QCOMPARE( forward, decoder );
+    QVERIFY( readAt( forward, 100*2352, 5*2352 ) );
+    QCOMPARE( static_cast<TestDecoder*>( forward )->seeks(), 0 );
+
+    delete forward;
+}
+
+
+void AudioDecoderPoolTest::testReleaseWithinSector()
+{
+    TestDecoder original;
+    TestPool pool;
+
+    K3b::AudioDecoder* decoder = pool.acquire( &original, 0 );
+    QVERIFY( readAt( decoder, 0, 10*2352 + 1000 ) );
+    pool.release( decoder, 10*2352 + 1000 );
+
+    // sector 10 has been decoded partly already
+    K3b::AudioDecoder* other = pool.acquire( &original, 10 );
+    QVERIFY( other );
+    QVERIFY( other != decoder );
+    QVERIFY( readAt( other, 10*2352, 2352 ) );
+    QCOMPARE( static_cast<TestDecoder*>( other )->seeks(), 0 );
+    delete other;
+
+    // the next sector can be reached by decoding the rest of sector 10
+    K3b::AudioDecoder* reused = pool.acquire( &original, 11 );
+    QCOMPARE( reused, decoder );
+    QVERIFY( readAt( reused, 11*2352, 5*2352 ) );
+    QCOMPARE( static_cast<TestDecoder*>( reused )->seeks(), 0 );
+
+    delete reused;
+}
+
+
+void AudioDecoderPoolTest::testConcurrentAcquire()
+{
+    TestDecoder original;
+    TestPool pool( 2 );
+
+    QMutex mutex;
+    QSet<K3b::AudioDecoder*> inUse;
+    QAtomicInt failures( 0 );
+
+    QList<QThread*> threads;
+    for( int t = 0; t < 4; ++t ) {
+        threads << QThread::create( [&, t]() {
+            qint64 sector = t*1000;
+            for( int i = 0; i < 20; ++i ) {
+                K3b::AudioDecoder* decoder = pool.acquire( &original, K3b::Msf( int( sector ) ) );
+                if( !decoder ) {
+                    failures.ref();
+                    return;
+                }
+
+                mutex.lock();
+                if( inUse.contains( decoder ) )
+                    failures.ref();
+                inUse.insert( decoder );
+                mutex.unlock();
+
+                if( !readAt( decoder, sector*2352, 20*2352 + 100 ) )
+                    failures.ref();
+
+                mutex.lock();
+                inUse.remove( decoder );
+                mutex.unlock();
+
+                pool.release( decoder, sector*2352 + 20*2352 + 100 );
+                sector += 21;
+            }
+        } );
+    }
+
+    Q_FOREACH( QThread* thread, threads )
+        thread->start();
+    Q_FOREACH( QThread* thread, threads ) {
+        thread->wait();
+        delete thread;
+    }
+
+    QCOMPARE( failures.loadAcquire(), 0 );
+    QVERIFY( pool.idleDecoders( original.filename() ) <= 2 );
+}
+
+
+void AudioDecoderPoolTest::testReleaseUnusable()
+{
+    TestDecoder original;
+    TestPool pool;
+
+    K3b::AudioDecoder* decoder = pool.acquire( &original, 0 );
+    QVERIFY( decoder );
+    pool.release( decoder, original.length().audioBytes(), false );
+    QCOMPARE( pool.idleDecoders( original.filename() ), 0 );
+    QCOMPARE( pool.idleDecoders(), 0 );
+}
+
+
+void AudioDecoderPoolTest::testTotalIdleDecoders()
+{
+    TestPool pool( 2, 3 );
+
+    QList<TestDecoder*> originals;
+    QList<K3b::AudioDecoder*> decoders;
+    for( int i = 0; i < 3; ++i ) {
+        originals << new TestDecoder( QString::fromLatin1( "%1.%2" ).arg( QLatin1String( s_filename ) ).arg( i ) );
+        decoders << pool.acquire( originals[i], 0 ) << pool.acquire( originals[i], 100 );
+    }
+    QVERIFY( !decoders.contains( 0 ) );
+
+    // the decoders released first are deleted, both of the first file among them
+    for( int i = 0; i < decoders.count(); ++i )
+        pool.release( decoders[i], ( i % 2 ? 100 : 0 )*2352 );
+    QCOMPARE( pool.idleDecoders(), 3 );
+    QCOMPARE( pool.idleDecoders( originals[0]->filename() ), 0 );
+    QCOMPARE( pool.idleDecoders( originals[1]->filename() ), 1 );
+    QCOMPARE( pool.idleDecoders( originals[2]->filename() ), 2 );
+
+    // the decoder kept for the second file is the one released last
+    K3b::AudioDecoder* reused = pool.acquire( originals[1], 100 );
+    QCOMPARE( reused, decoders[3] );
+    QCOMPARE( pool.idleDecoders(), 2 );
+
+    pool.remove( originals[2]->filename() );
+    QCOMPARE( pool.idleDecoders(), 0 );
+
+    delete reused;
+    qDeleteAll( originals );
+}
@@ -0,0 +1,25 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_AUDIO_DECODER_POOL_TEST_H
+#define K3B_AUDIO_DECODER_POOL_TEST_H
+
+#include <QObject>
+
+class AudioDecoderPoolTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testReuseAtSamePosition();
+    void testReuseAtLaterPosition();
+    void testSeekBack();
+    void testReleaseWithinSector();
+    void testConcurrentAcquire();
+    void testReleaseUnusable();
+    void testTotalIdleDecoders();
+};
+
+#endif // K3B_AUDIO_DECODER_POOL_TEST_H
@@ -0,0 +1,233 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3baudiofileanalyzerpooltest.h"
+#include "k3baudiofileanalyzerpool.h"
+#include "k3baudiodecoder.h"
+
+#include <QSignalSpy>
+#include <QTest>
+#include <QThread>
+
+QTEST_GUILESS_MAIN( AudioFileAnalyzerPoolTest )
+
+namespace {
+    /**
+     * Pretends to analyse a file which takes \p delay milliseconds.
+     */
+    class TestDecoder : public K3b::AudioDecoder
+    {
+    public:
+        explicit TestDecoder( int delay, bool valid = true )
+            : m_delay( delay ),
+              m_valid( valid ),
+              m_analysed( 0 ) {
+            // a file that does not exist is never found in the analysis cache
+            setFilename( QString( "/nonexistent/k3b-test-%1.wav" ).arg( quintptr( this ) ) );
+        }
+
+        int analysed() const { return m_analysed; }
+
+    protected:
+        bool analyseFileInternal( K3b::Msf& length, int& samplerate, int& channels ) override {
+            QThread::msleep( m_delay );
+            ++m_analysed;
+            length = K3b::Msf( 1, 0, 0 );
+            samplerate = 44100;
+            channels = 2;
+            return m_valid;
+        }
+
+        bool initDecoderInternal() override { return true; }
+        int decodeInternal( char*, int ) override { return 0; }
+
+    private:
+        int m_delay;
+        bool m_valid;
+        int m_analysed;
+    };
+
+    /**
+     * Creates a TestDecoder in the worker thread or returns a given one.
+     */
+    class TestCreator : public K3b::AudioFileAnalyzerPool::DecoderCreator
+    {
+    public:
+        explicit TestCreator( bool create, K3b::AudioDecoder* existing = 0 )
+            : decoder( existing ),
+              m_create( create ),
+              m_thread( 0 ) {
+        }
+
+        K3b::AudioDecoder* createDecoder( bool& analyse ) override {
+            m_thread = QThread::currentThread();
+            if( m_create )
+                decoder = new TestDecoder( 10 );
+            else if( decoder )
+                analyse = false;
+            return decoder;
+        }
+
+        QThread* thread() const { return m_thread; }
+
+        K3b::AudioDecoder* decoder;
+
+    private:
+        bool m_create;
+        QThread* m_thread;
+    };
+}
+
+
+AudioFileAnalyzerPoolTest::AudioFileAnalyzerPoolTest()
+{
+    qRegisterMetaType<K3b::AudioDecoder*>();
+}
+
+
+void AudioFileAnalyzerPoolTest::testOrder()
+{
+    K3b::AudioFileAnalyzerPool pool;
+    pool.setMaxThreads( 4 );
+    QSignalSpy analysedSpy( &pool, SIGNAL(analysed(K3b::AudioDecoder*,bool)) );
+    QSignalSpy finishedSpy( &pool, SIGNAL(finished()) );
+
+    // the first files take the longest, so they finish last
+    QList<TestDecoder*> decoders;
+    for( int i = 0; i < 20; ++i ) {
+        decoders.append( new TestDecoder( 40 - 2*i, i != 7 ) );
+        pool.add( decoders.last() );
+    }
+    QCOMPARE( pool.pending(), 20 );
+
+    QVERIFY( finishedSpy.wait( 5000 ) );
+    QCOMPARE( finishedSpy.count(), 1 );
+    QCOMPARE( analysedSpy.count(), 20 );
+    QCOMPARE( pool.pending(), 0 );
+    for( int i = 0; i < 20; ++i ) {
+        QCOMPARE( analysedSpy[i][0].value<K3b::AudioDecoder*>(), static_cast<K3b::AudioDecoder*>( decoders[i] ) );
+        QCOMPARE( analysedSpy[i][1].toBool(), i != 7 );
+        QCOMPARE( decoders[i]->analysed(), 1 );
+    }
+
+    qDeleteAll( decoders );
+}
+
+
+void AudioFileAnalyzerPoolTest::testWithoutAnalysis()
+{
+    K3b::AudioFileAnalyzerPool pool;
+    pool.setMaxThreads( 2 );
+    QSignalSpy analysedSpy( &pool, SIGNAL(analysed(K3b::AudioDecoder*,bool)) );
+    QSignalSpy finishedSpy( &pool, SIGNAL(finished()) );
+
+    TestDecoder slow( 50 );
+    TestDecoder analysed( 0 );
+    pool.add( &slow );
+    pool.add( 0 );
+    pool.add( &analysed, false );
+
+    QVERIFY( finishedSpy.wait( 5000 ) );
+    QCOMPARE( analysedSpy.count(), 3 );
+    QCOMPARE( analysedSpy[0][0].value<K3b::AudioDecoder*>(), static_cast<K3b::AudioDecoder*>( &slow ) );
+    QCOMPARE( analysedSpy[1][0].value<K3b::AudioDecoder*>(), static_cast<K3b::AudioDecoder*>( 0 ) );
+    QCOMPARE( analysedSpy[2][0].value<K3b::AudioDecoder*>(), static_cast<K3b::AudioDecoder*>( &analysed ) );
+    QCOMPARE( analysed.analysed(), 0 );
+}
+
+
+void AudioFileAnalyzerPoolTest::testCancel()
+{
+    K3b::AudioFileAnalyzerPool pool;
+    pool.setMaxThreads( 2 );
+    QSignalSpy analysedSpy( &pool, SIGNAL(analysed(K3b::AudioDecoder*,bool)) );
+    QSignalSpy finishedSpy( &pool, SIGNAL(finished()) );
+
+    QList<TestDecoder*> decoders;
+    for( int i = 0; i < 100; ++i ) {
+        decoders.append( new TestDecoder( 20 ) );
+        pool.add( decoders.last() );
+    }
+
+    const QList<K3b::AudioDecoder*> pending = pool.cancel();
+    QCOMPARE( pending.count(), 100 );
+    QCOMPARE( pool.pending(), 0 );
+
+    // only the files which were being analysed have been touched
+    int analysed = 0;
+    Q_FOREACH( TestDecoder* decoder, decoders )
+        analysed += decoder->analysed();
+    QVERIFY( analysed <= 2 );
+
+    // nothing is reported after cancelling
+    QTest::qWait( 50 );
+    QCOMPARE( analysedSpy.count(), 0 );
+    QCOMPARE( finishedSpy.count(), 0 );
+
+    qDeleteAll( decoders );
+}
+
+
+void AudioFileAnalyzerPoolTest::testDecoderCreator()
+{
+    K3b::AudioFileAnalyzerPool pool;
+    pool.setMaxThreads( 2 );
+    QSignalSpy analysedSpy( &pool, SIGNAL(analysed(K3b::AudioDecoder*,bool)) );
+    QSignalSpy finishedSpy( &pool, SIGNAL(finished()) );
+
+    TestDecoder existing( 0 );
+    TestCreator created( true );
+    TestCreator none( false );
+    TestCreator reused( false, &existing );
+    pool.add( &created );
+    pool.add( &none );
+    pool.add( &reused );
+
+    QVERIFY( finishedSpy.wait( 5000 ) );
+    QCOMPARE( analysedSpy.count(), 3 );
+    QVERIFY( created.decoder != 0 );
+    QCOMPARE( analysedSpy[0][0].value<K3b::AudioDecoder*>(), created.decoder );
+    QCOMPARE( static_cast<TestDecoder*>( created.decoder )->analysed(), 1 );
+    QCOMPARE( analysedSpy[1][0].value<K3b::AudioDecoder*>(), static_cast<K3b::AudioDecoder*>( 0 ) );
+    QCOMPARE( analysedSpy[2][0].value<K3b::AudioDecoder*>(), static_cast<K3b::AudioDecoder*>( &existing ) );
+    QCOMPARE( existing.analysed(), 0 );
+
+    // the decoders are created off the calling thread
+    QVERIFY( created.thread() != QThread::currentThread() );
+    QVERIFY( none.thread() != QThread::currentThread() );
+
+    delete created.decoder;
+}
+
+
+void AudioFileAnalyzerPoolTest::benchmarkAddFiles_data()
+{
+    QTest::addColumn<int>( "threads" );
+
+    QTest::newRow( "1 thread" ) << 1;
+    QTest::newRow( "ideal thread count" ) << QThread::idealThreadCount();
+}
+
+
+void AudioFileAnalyzerPoolTest::benchmarkAddFiles()
+{
+    QFETCH( int, threads );
+
+    QList<TestDecoder*> decoders;
+    for( int i = 0; i < 500; ++i )
+        decoders.append( new TestDecoder( 1 ) );
+
+    QBENCHMARK {
+        K3b::AudioFileAnalyzerPool pool;
+        pool.setMaxThreads( threads );
+        QSignalSpy finishedSpy( &pool, SIGNAL(finished()) );
+        Q_FOREACH( TestDecoder* decoder, decoders )
+            pool.add( decoder );
+        QVERIFY( finishedSpy.wait( 60000 ) );
+    }
+
+    qDeleteAll( decoders );
+}
@@ -0,0 +1,26 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_AUDIO_FILE_ANALYZER_POOL_TEST_H
+#define K3B_AUDIO_FILE_ANALYZER_POOL_TEST_H
+
+#include <QObject>
+
+class AudioFileAnalyzerPoolTest : public QObject
+{
+    Q_OBJECT
+public:
+    AudioFileAnalyzerPoolTest();
+private slots:
+    void testOrder();
+    void testWithoutAnalysis();
+    void testCancel();
+    void testDecoderCreator();
+    void benchmarkAddFiles_data();
+    void benchmarkAddFiles();
+};
+
+#endif // K3B_AUDIO_FILE_ANALYZER_POOL_TEST_H
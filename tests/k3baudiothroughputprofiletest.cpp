@@ -0,0 +1,135 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3baudiothroughputprofiletest.h"
+#include "k3baudiothroughputprofile.h"
+
+#include <QTemporaryDir>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( AudioThroughputProfileTest )
+
+typedef K3b::AudioThroughputProfile::Segment Segment;
+
+namespace {
+    const qint64 MB = 1024*1024;
+}
+
+
+AudioThroughputProfileTest::AudioThroughputProfileTest()
+{
+}
+
+
+void AudioThroughputProfileTest::testUnlimited()
+{
+    QList<Segment> segments;
+    segments << Segment( 100*MB ) << Segment( 50*MB );
+    QCOMPARE( K3b::AudioThroughputProfile::maxSpeed( segments, 4*MB, 4*MB ), 175*1000 );
+}
+
+
+void AudioThroughputProfileTest::testSlowSource()
+{
+    // 1 MB/s and 4 MB buffered: writing 100 MB may take 4% less time than decoding
+    QList<Segment> segments;
+    segments << Segment( 100*MB, MB );
+    const int speed = K3b::AudioThroughputProfile::maxSpeed( segments, 4*MB, 4*MB );
+    QVERIFY( speed >= 1064 );
+    QVERIFY( speed <= 1065 );
+}
+
+
+void AudioThroughputProfileTest::testStartupTime()
+{
+    // the 4 MB fifo has to last for a second
+    QList<Segment> segments;
+    segments << Segment( 10*MB, 0, 1000 );
+    QCOMPARE( K3b::AudioThroughputProfile::maxSpeed( segments, 4*MB, 4*MB ), 4096 );
+
+    // every source seeks
+    segments << Segment( 10*MB, 0, 1000 );
+    QCOMPARE( K3b::AudioThroughputProfile::maxSpeed( segments, 4*MB, 4*MB ), 4096 );
+}
+
+
+void AudioThroughputProfileTest::testReadAheadBuffer()
+{
+    // a fast file followed by a slow one
+    QList<Segment> segments;
+    segments << Segment( 200*MB, 10*MB ) << Segment( 20*MB, MB );
+
+    const int withoutBuffer = K3b::AudioThroughputProfile::maxSpeed( segments, 4*MB, 4*MB );
+    const int withBuffer = K3b::AudioThroughputProfile::maxSpeed( segments, 4*MB, 68*MB );
+
+    // the slow file is written 20% faster than it is decoded
+    QVERIFY( withoutBuffer >= 1228 );
+    QVERIFY( withoutBuffer <= 1229 );
+
+    // the buffer filled during the fast file covers most of the slow one
+    QVERIFY( withBuffer >= 4505 );
+    QVERIFY( withBuffer <= 4506 );
+}
+
+
+void AudioThroughputProfileTest::testNotSustainable()
+{
+    QList<Segment> segments;
+    segments << Segment( 10*MB, 0, 1000 );
+    QCOMPARE( K3b::AudioThroughputProfile::maxSpeed( segments, 0, 0 ), 0 );
+}
+
+
+void AudioThroughputProfileTest::testPersistence()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString fileName = dir.path() + "/profile/audiothroughput";
+
+    {
+        K3b::AudioThroughputProfile profile( fileName );
+        QVERIFY( profile.needsMeasurement( "K3bFLACDecoder/44100/2" ) );
+
+        profile.addMeasurement( "K3bFLACDecoder/44100/2", 50*MB, 12 );
+        profile.addMeasurement( "K3bMadDecoder/48000/2", 20*MB, 30 );
+        QVERIFY( !profile.needsMeasurement( "K3bFLACDecoder/44100/2" ) );
+        QVERIFY( profile.save() );
+    }
+
+    K3b::AudioThroughputProfile profile( fileName );
+    K3b::AudioThroughputProfile::Entry entry;
+    QVERIFY( profile.lookup( "K3bFLACDecoder/44100/2", entry ) );
+    QCOMPARE( entry.throughput, 50*MB );
+    QCOMPARE( entry.startupTime, 12 );
+    QCOMPARE( entry.measurements, 1 );
+    QVERIFY( profile.lookup( "K3bMadDecoder/48000/2", entry ) );
+    QCOMPARE( entry.throughput, 20*MB );
+    QVERIFY( !profile.needsMeasurement( "K3bMadDecoder/48000/2" ) );
+    QVERIFY( profile.needsMeasurement( "K3bMadDecoder/44100/1" ) );
+}
+
+
+void AudioThroughputProfileTest::testAveraging()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    K3b::AudioThroughputProfile profile( dir.path() + "/audiothroughput" );
+
+    profile.addMeasurement( "raw", 1000, 10 );
+    profile.addMeasurement( "raw", 2000, 20 );
+
+    K3b::AudioThroughputProfile::Entry entry;
+    QVERIFY( profile.lookup( "raw", entry ) );
+    QCOMPARE( entry.throughput, qint64( 1500 ) );
+    QCOMPARE( entry.startupTime, 15 );
+    QCOMPARE( entry.measurements, 2 );
+
+    // old measurements lose weight
+    for( int i = 0; i < 20; ++i )
+        profile.addMeasurement( "raw", 8000, 10 );
+    QVERIFY( profile.lookup( "raw", entry ) );
+    QVERIFY( entry.throughput > 7900 );
+}
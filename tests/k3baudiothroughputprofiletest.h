@@ -0,0 +1,27 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_AUDIO_THROUGHPUT_PROFILE_TEST_H
+#define K3B_AUDIO_THROUGHPUT_PROFILE_TEST_H
+
+#include <QObject>
+
+class AudioThroughputProfileTest : public QObject
+{
+    Q_OBJECT
+public:
+    AudioThroughputProfileTest();
+private slots:
+    void testUnlimited();
+    void testSlowSource();
+    void testStartupTime();
+    void testReadAheadBuffer();
+    void testNotSustainable();
+    void testPersistence();
+    void testAveraging();
+};
+
+#endif // K3B_AUDIO_THROUGHPUT_PROFILE_TEST_H
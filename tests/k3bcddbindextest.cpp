@@ -0,0 +1,278 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bcddbindextest.h"
+#include "k3bcddbindex.h"
+#include "k3btoc.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( CddbIndexTest )
+
+namespace {
+    /**
+     * An audio CD with tracks starting at the given sectors
+     */
+    K3b::Device::Toc createToc( const QList<int>& starts, int length )
+    {
+        K3b::Device::Toc toc;
+        for( int i = 0; i < starts.count(); ++i ) {
+            const int end = ( i+1 < starts.count() ? starts[i+1] : length ) - 1;
+            toc.append( K3b::Device::Track( starts[i], end, K3b::Device::Track::TYPE_AUDIO ) );
+        }
+        return toc;
+    }
+
+    KCDDB::CDInfo createInfo( const K3b::Device::Toc& toc, const QString& title, const QString& category )
+    {
+        KCDDB::CDInfo info;
+        info.set( QLatin1String( "discid" ), QString::number( K3b::CDDB::DiscIdIndex::discId( toc ), 16 ).rightJustified( 8, '0' ) );
+        info.set( KCDDB::Artist, QString( "Artist" ) );
+        info.set( KCDDB::Title, title );
+        info.set( KCDDB::Category, category );
+        for( int i = 0; i < toc.count(); ++i )
+            info.track( i ).set( KCDDB::Title, QString( "Track %1" ).arg( i+1 ) );
+        return info;
+    }
+
+    bool writeFile( const QString& filename, const QByteArray& data )
+    {
+        QFile file( filename );
+        return file.open( QIODevice::WriteOnly ) && file.write( data ) == data.size();
+    }
+
+    const char* s_freedbEntry =
+        "# xmcd\n"
+        "#\n"
+        "# Track frame offsets:\n"
+        "#\t150\n"
+        "#\t15150\n"
+        "#\n"
+        "# Disc length: 402 seconds\n"
+        "#\n"
+        "# Revision: 1\n"
+        "DISCID=06019002\n"
+        "DTITLE=Some Artist / Some Album\n"
+        "DYEAR=1999\n"
+        "DGENRE=Rock\n"
+        "TTITLE0=First\n"
+        "TTITLE1=Second\n"
+        "EXTD=\n"
+        "EXTT0=\n"
+        "EXTT1=\n"
+        "PLAYORDER=\n";
+
+    class TestObserver : public K3b::CDDB::DiscIdIndex::ImportObserver
+    {
+    public:
+        explicit TestObserver( bool cancel )
+            : lastPercent( -1 ),
+              m_cancel( cancel ) {
+        }
+
+        void importProgress( int percent ) override { lastPercent = percent; }
+        bool importCanceled() override { return m_cancel; }
+
+        int lastPercent;
+
+    private:
+        bool m_cancel;
+    };
+}
+
+
+CddbIndexTest::CddbIndexTest()
+{
+}
+
+
+void CddbIndexTest::testDiscId()
+{
+    // offsets 150 and 15150 are at 2 and 202 seconds, the disc is 402 seconds long
+    const K3b::Device::Toc toc = createToc( QList<int>() << 0 << 15000, 30000 );
+    QCOMPARE( K3b::CDDB::DiscIdIndex::discId( toc ), quint32( 0x06019002 ) );
+    QCOMPARE( K3b::CDDB::DiscIdIndex::discId( toc ), toc.discId() );
+
+    const K3b::Device::Toc other = createToc( QList<int>() << 0 << 12345 << 23456 << 34567, 45678 );
+    QCOMPARE( K3b::CDDB::DiscIdIndex::discId( other ), other.discId() );
+}
+
+
+void CddbIndexTest::testStoreAndLookup()
+{
+    QTemporaryDir dir;
+    const QString filename = dir.filePath( "index" );
+    const K3b::Device::Toc toc = createToc( QList<int>() << 0 << 15000, 30000 );
+
+    {
+        K3b::CDDB::DiscIdIndex index( filename );
+        QVERIFY( index.lookup( toc ).isEmpty() );
+        QCOMPARE( index.count(), 0 );
+        QVERIFY( index.store( toc, createInfo( toc, "Album", "rock" ) ) );
+        QCOMPARE( index.count(), 1 );
+
+        const KCDDB::CDInfoList results = index.lookup( toc );
+        QCOMPARE( results.count(), 1 );
+        QCOMPARE( results.first().get( KCDDB::Artist ).toString(), QString( "Artist" ) );
+    }
+
+    // the entry is persistent
+    K3b::CDDB::DiscIdIndex index( filename );
+    const KCDDB::CDInfoList results = index.lookup( toc );
+    QCOMPARE( results.count(), 1 );
+    QCOMPARE( results.first().get( KCDDB::Title ).toString(), QString( "Album" ) );
+    QCOMPARE( results.first().get( KCDDB::Category ).toString(), QString( "rock" ) );
+    QCOMPARE( results.first().track( 1 ).get( KCDDB::Title ).toString(), QString( "Track 2" ) );
+
+    // another disc
+    QVERIFY( index.lookup( createToc( QList<int>() << 0 << 15001, 30000 ) ).isEmpty() );
+}
+
+
+void CddbIndexTest::testReplaceEntry()
+{
+    QTemporaryDir dir;
+    K3b::CDDB::DiscIdIndex index( dir.filePath( "index" ) );
+    const K3b::Device::Toc toc = createToc( QList<int>() << 0 << 15000, 30000 );
+
+    QVERIFY( index.store( toc, createInfo( toc, "Old", "rock" ) ) );
+    QVERIFY( index.store( toc, createInfo( toc, "New", "rock" ) ) );
+    KCDDB::CDInfoList results = index.lookup( toc );
+    QCOMPARE( results.count(), 1 );
+    QCOMPARE( results.first().get( KCDDB::Title ).toString(), QString( "New" ) );
+
+    // entries of other categories are kept
+    QVERIFY( index.store( toc, createInfo( toc, "Other", "misc" ) ) );
+    results = index.lookup( toc );
+    QCOMPARE( results.count(), 2 );
+}
+
+
+void CddbIndexTest::testSharedDiscId()
+{
+    QTemporaryDir dir;
+    K3b::CDDB::DiscIdIndex index( dir.filePath( "index" ) );
+
+    // the same disc id but other track offsets
+    const K3b::Device::Toc toc1 = createToc( QList<int>() << 0 << 15000, 30000 );
+    const K3b::Device::Toc toc2 = createToc( QList<int>() << 0 << 15010, 30000 );
+    QCOMPARE( K3b::CDDB::DiscIdIndex::discId( toc1 ), K3b::CDDB::DiscIdIndex::discId( toc2 ) );
+
+    QVERIFY( index.store( toc1, createInfo( toc1, "One", "rock" ) ) );
+    QVERIFY( index.store( toc2, createInfo( toc2, "Two", "rock" ) ) );
+
+    KCDDB::CDInfoList results = index.lookup( toc1 );
+    QCOMPARE( results.count(), 1 );
+    QCOMPARE( results.first().get( KCDDB::Title ).toString(), QString( "One" ) );
+    results = index.lookup( toc2 );
+    QCOMPARE( results.count(), 1 );
+    QCOMPARE( results.first().get( KCDDB::Title ).toString(), QString( "Two" ) );
+}
+
+
+void CddbIndexTest::testBatchLookup()
+{
+    QTemporaryDir dir;
+    K3b::CDDB::DiscIdIndex index( dir.filePath( "index" ) );
+
+    QList<K3b::Device::Toc> tocs;
+    for( int i = 0; i < 50; ++i ) {
+        tocs.append( createToc( QList<int>() << 0 << 10000 + 100*i, 40000 + 1000*i ) );
+        if( i % 2 == 0 )
+            QVERIFY( index.store( tocs.last(), createInfo( tocs.last(), QString::number( i ), "rock" ) ) );
+    }
+
+    const QList<KCDDB::CDInfoList> results = index.lookup( tocs );
+    QCOMPARE( results.count(), tocs.count() );
+    for( int i = 0; i < tocs.count(); ++i ) {
+        if( i % 2 == 0 ) {
+            QCOMPARE( results[i].count(), 1 );
+            QCOMPARE( results[i].first().get( KCDDB::Title ).toString(), QString::number( i ) );
+        }
+        else {
+            QVERIFY( results[i].isEmpty() );
+        }
+    }
+}
+
+
+void CddbIndexTest::testImportFreedbDump()
+{
+    QTemporaryDir dir;
+    const QString dumpPath = dir.filePath( "dump" );
+    QVERIFY( QDir().mkpath( dumpPath + "/rock" ) );
+    QVERIFY( QDir().mkpath( dumpPath + "/misc" ) );
+    QVERIFY( writeFile( dumpPath + "/rock/06019002", s_freedbEntry ) );
+    QVERIFY( writeFile( dumpPath + "/misc/00000000", "no freedb entry" ) );
+
+    K3b::CDDB::DiscIdIndex index( dir.filePath( "index" ) );
+    QCOMPARE( index.importFreedbDump( dumpPath ), 1 );
+    QCOMPARE( index.importFreedbDump( dir.filePath( "missing" ) ), -1 );
+
+    const K3b::Device::Toc toc = createToc( QList<int>() << 0 << 15000, 30000 );
+    const KCDDB::CDInfoList results = index.lookup( toc );
+    QCOMPARE( results.count(), 1 );
+    QCOMPARE( results.first().get( KCDDB::Artist ).toString(), QString( "Some Artist" ) );
+    QCOMPARE( results.first().get( KCDDB::Title ).toString(), QString( "Some Album" ) );
+    QCOMPARE( results.first().get( KCDDB::Category ).toString(), QString( "rock" ) );
+    QCOMPARE( results.first().track( 1 ).get( KCDDB::Title ).toString(), QString( "Second" ) );
+}
+
+
+void CddbIndexTest::testCancelImport()
+{
+    QTemporaryDir dir;
+    const QString dumpPath = dir.filePath( "dump" );
+    QVERIFY( QDir().mkpath( dumpPath + "/rock" ) );
+    QVERIFY( writeFile( dumpPath + "/rock/06019002", s_freedbEntry ) );
+
+    K3b::CDDB::DiscIdIndex index( dir.filePath( "index" ) );
+    const K3b::Device::Toc toc = createToc( QList<int>() << 0 << 15000, 30000 );
+
+    TestObserver canceling( true );
+    QCOMPARE( index.importFreedbDump( dumpPath, &canceling ), 0 );
+    QCOMPARE( index.count(), 0 );
+    QVERIFY( index.lookup( toc ).isEmpty() );
+
+    TestObserver observer( false );
+    QCOMPARE( index.importFreedbDump( dumpPath, &observer ), 1 );
+    QCOMPARE( observer.lastPercent, 0 );
+    QCOMPARE( index.count(), 1 );
+    QCOMPARE( index.lookup( toc ).count(), 1 );
+}
+
+
+void CddbIndexTest::testIncompleteRecord()
+{
+    QTemporaryDir dir;
+    const QString filename = dir.filePath( "index" );
+    const K3b::Device::Toc toc1 = createToc( QList<int>() << 0 << 15000, 30000 );
+    const K3b::Device::Toc toc2 = createToc( QList<int>() << 0 << 20000, 30000 );
+
+    {
+        K3b::CDDB::DiscIdIndex index( filename );
+        QVERIFY( index.store( toc1, createInfo( toc1, "One", "rock" ) ) );
+    }
+
+    // a record which was not completely written
+    QFile file( filename );
+    QVERIFY( file.open( QIODevice::Append ) );
+    QVERIFY( file.write( QByteArray( "\x01\x02\x03\x04\x00\x00\x10\x00garbage", 15 ) ) == 15 );
+    file.close();
+
+    K3b::CDDB::DiscIdIndex index( filename );
+    QCOMPARE( index.count(), 1 );
+    QCOMPARE( index.lookup( toc1 ).count(), 1 );
+
+    // it is overwritten by the next record
+    QVERIFY( index.store( toc2, createInfo( toc2, "Two", "rock" ) ) );
+    K3b::CDDB::DiscIdIndex reopened( filename );
+    QCOMPARE( reopened.count(), 2 );
+    QCOMPARE( reopened.lookup( toc2 ).count(), 1 );
+}
@@ -0,0 +1,28 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_CDDB_INDEX_TEST_H
+#define K3B_CDDB_INDEX_TEST_H
+
+#include <QObject>
+
+class CddbIndexTest : public QObject
+{
+    Q_OBJECT
+public:
+    CddbIndexTest();
+private slots:
+    void testDiscId();
+    void testStoreAndLookup();
+    void testReplaceEntry();
+    void testSharedDiscId();
+    void testBatchLookup();
+    void testImportFreedbDump();
+    void testCancelImport();
+    void testIncompleteRecord();
+};
+
+#endif // K3B_CDDB_INDEX_TEST_H
@@ -0,0 +1,129 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bchecksumcalculatortest.h"
+#include "k3bchecksumcalculator.h"
+#include "k3bchecksummanifest.h"
+
+#include <QCryptographicHash>
+#include <QTemporaryDir>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( ChecksumCalculatorTest )
+
+namespace {
+    QByteArray testData( int size )
+    {
+        QByteArray data( size, Qt::Uninitialized );
+        for( int i = 0; i < size; ++i )
+            data[i] = char( ( i * 7 + i / 4099 ) & 0xff );
+        return data;
+    }
+}
+
+ChecksumCalculatorTest::ChecksumCalculatorTest()
+{
+}
+
+void ChecksumCalculatorTest::testEmpty()
+{
+    K3b::ChecksumCalculator calculator;
+    calculator.finish();
+    QCOMPARE( calculator.result( K3b::ChecksumPipe::MD5 ),
+              QCryptographicHash::hash( QByteArray(), QCryptographicHash::Md5 ) );
+    QVERIFY( calculator.result( K3b::ChecksumPipe::SHA256 ).isEmpty() );
+}
+
+void ChecksumCalculatorTest::testSeveralDigests_data()
+{
+    QTest::addColumn<int>( "size" );
+    QTest::addColumn<int>( "chunkSize" );
+
+    QTest::newRow( "small" ) << 1000 << 100;
+    QTest::newRow( "one block" ) << 1024*1024 << 2048*10;
+    QTest::newRow( "unaligned chunks" ) << 5*1024*1024 + 17 << 65521;
+    QTest::newRow( "one chunk" ) << 3*1024*1024 + 1 << 3*1024*1024 + 1;
+}
+
+void ChecksumCalculatorTest::testSeveralDigests()
+{
+    QFETCH( int, size );
+    QFETCH( int, chunkSize );
+
+    const QByteArray data = testData( size );
+
+    K3b::ChecksumCalculator calculator( K3b::ChecksumPipe::MD5 | K3b::ChecksumPipe::SHA256 | K3b::ChecksumPipe::SHA512 );
+    for( int pos = 0; pos < size; pos += chunkSize )
+        calculator.addData( data.constData() + pos, qMin( chunkSize, size - pos ) );
+    calculator.finish();
+
+    QCOMPARE( calculator.result( K3b::ChecksumPipe::MD5 ), QCryptographicHash::hash( data, QCryptographicHash::Md5 ) );
+    QCOMPARE( calculator.result( K3b::ChecksumPipe::SHA256 ), QCryptographicHash::hash( data, QCryptographicHash::Sha256 ) );
+    QCOMPARE( calculator.result( K3b::ChecksumPipe::SHA512 ), QCryptographicHash::hash( data, QCryptographicHash::Sha512 ) );
+    QVERIFY( calculator.result( K3b::ChecksumPipe::SHA1 ).isEmpty() );
+}
+
+void ChecksumCalculatorTest::testReset()
+{
+    const QByteArray data = testData( 3*1024*1024 );
+
+    K3b::ChecksumCalculator calculator( K3b::ChecksumPipe::SHA1 );
+    calculator.addData( data.constData(), data.size() );
+    calculator.reset();
+    calculator.addData( data.constData(), 1000 );
+    calculator.finish();
+
+    QCOMPARE( calculator.result( K3b::ChecksumPipe::SHA1 ),
+              QCryptographicHash::hash( data.left( 1000 ), QCryptographicHash::Sha1 ) );
+}
+
+void ChecksumCalculatorTest::testBlockResults()
+{
+    const int blockSize = 512*2048;
+    const QByteArray data = testData( 5*blockSize/2 );
+
+    K3b::ChecksumCalculator calculator( K3b::ChecksumPipe::SHA256 | K3b::ChecksumPipe::MD5 );
+    calculator.setBlockSize( blockSize );
+    for( int pos = 0; pos < data.size(); pos += 10*2048 )
+        calculator.addData( data.constData() + pos, qMin( 10*2048, data.size() - pos ) );
+    calculator.finish();
+
+    // blocks are hashed with the lowest type
+    const QList<QByteArray> blocks = calculator.blockResults();
+    QCOMPARE( blocks.count(), 3 );
+    QCOMPARE( blocks[0], QCryptographicHash::hash( data.mid( 0, blockSize ), QCryptographicHash::Md5 ) );
+    QCOMPARE( blocks[1], QCryptographicHash::hash( data.mid( blockSize, blockSize ), QCryptographicHash::Md5 ) );
+    QCOMPARE( blocks[2], QCryptographicHash::hash( data.mid( 2*blockSize ), QCryptographicHash::Md5 ) );
+    QCOMPARE( calculator.size(), qint64( data.size() ) );
+}
+
+void ChecksumCalculatorTest::testManifestSaveLoad()
+{
+    QList<QByteArray> blocks;
+    blocks << QCryptographicHash::hash( "a", QCryptographicHash::Sha256 )
+           << QCryptographicHash::hash( "b", QCryptographicHash::Sha256 );
+    const K3b::ChecksumManifest manifest( K3b::ChecksumPipe::SHA256, 2048, 3000,
+                                          QCryptographicHash::hash( "ab", QCryptographicHash::Sha256 ).toHex(),
+                                          blocks );
+    QVERIFY( manifest.isValid() );
+
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString filename = K3b::ChecksumManifest::manifestFileName( dir.path() + "/image.iso" );
+    QVERIFY( manifest.save( filename ) );
+
+    const K3b::ChecksumManifest loaded = K3b::ChecksumManifest::load( filename );
+    QVERIFY( loaded.isValid() );
+    QCOMPARE( loaded.type(), K3b::ChecksumPipe::SHA256 );
+    QCOMPARE( loaded.blockSize(), qint64( 2048 ) );
+    QCOMPARE( loaded.size(), qint64( 3000 ) );
+    QCOMPARE( loaded.checksum(), manifest.checksum() );
+    QCOMPARE( loaded.blockChecksums(), blocks );
+
+    // the block count has to match the size
+    QVERIFY( !K3b::ChecksumManifest( K3b::ChecksumPipe::MD5, 2048, 5000, QByteArray(), blocks ).isValid() );
+    QVERIFY( !K3b::ChecksumManifest::load( dir.path() + "/missing" ).isValid() );
+}
@@ -0,0 +1,26 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_CHECKSUM_CALCULATOR_TEST_H
+#define K3B_CHECKSUM_CALCULATOR_TEST_H
+
+#include <QObject>
+
+class ChecksumCalculatorTest : public QObject
+{
+    Q_OBJECT
+public:
+    ChecksumCalculatorTest();
+private slots:
+    void testEmpty();
+    void testSeveralDigests_data();
+    void testSeveralDigests();
+    void testReset();
+    void testBlockResults();
+    void testManifestSaveLoad();
+};
+
+#endif // K3B_CHECKSUM_CALCULATOR_TEST_H
@@ -0,0 +1,211 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bdatadoctest.h"
+#include "k3bdatadoc.h"
+#include "k3bdiritem.h"
+#include "k3bfileitem.h"
+#include "k3bisooptions.h"
+#include "k3bspecialdataitem.h"
+
+#include <QFile>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( DataDocTest )
+
+namespace {
+    void addPrepareFilenamesItems( K3b::DirItem* parent, int dirs, int filesPerDir )
+    {
+        for( int i = 0; i < dirs; ++i ) {
+            K3b::DirItem* dir = new K3b::DirItem( QString( "dir%1" ).arg( i ) );
+            K3b::DirItem::Children items;
+            for( int j = 0; j < filesPerDir; ++j ) {
+                // every tenth name collides after whitespace treatment
+                items.append( new K3b::SpecialDataItem( 2048, j % 10 == 0 ? QString( "IMG %1.JPG" ).arg( j+1 )
+                                                                          : QString( "IMG%1.JPG" ).arg( j ) ) );
+            }
+            dir->addDataItems( items );
+            parent->addDataItem( dir );
+        }
+    }
+
+    // the written names of all items below dir relative to it
+    QStringList writtenNames( K3b::DirItem* dir, const QString& prefix = QString() )
+    {
+        QStringList names;
+        Q_FOREACH( K3b::DataItem* item, dir->children() ) {
+            names.append( prefix + item->writtenName() );
+            if( item->isDir() )
+                names += writtenNames( static_cast<K3b::DirItem*>( item ), names.last() + '/' );
+        }
+        return names;
+    }
+}
+
+DataDocTest::DataDocTest()
+{
+}
+
+
+void DataDocTest::testPrepareFilenames()
+{
+    K3b::DataDoc doc;
+    doc.newDocument();
+
+    K3b::IsoOptions options = doc.isoOptions();
+    options.setCreateJoliet( true );
+    options.setJolietLong( true );
+    options.setWhiteSpaceTreatment( K3b::IsoOptions::strip );
+    doc.setIsoOptions( options );
+
+    K3b::DataItem* item1 = new K3b::SpecialDataItem( 1024, "a b.txt" );
+    K3b::DataItem* item2 = new K3b::SpecialDataItem( 1024, "c.txt" );
+    K3b::DataItem* item3 = new K3b::SpecialDataItem( 1024, "ab.txt" );
+    K3b::DataItem* item4 = new K3b::SpecialDataItem( 1024, "a  b.txt" );
+    K3b::DirItem* dir = new K3b::DirItem( "d i r" );
+    K3b::DataItem* item5 = new K3b::SpecialDataItem( 1024, "ab.txt" );
+    K3b::DataItem* item6 = new K3b::SpecialDataItem( 1024, "a b.txt" );
+    doc.root()->addDataItem( item1 );
+    doc.root()->addDataItem( item2 );
+    doc.root()->addDataItem( item3 );
+    doc.root()->addDataItem( item4 );
+    doc.root()->addDataItem( dir );
+    dir->addDataItem( item5 );
+    dir->addDataItem( item6 );
+
+    doc.prepareFilenames();
+
+    QCOMPARE( item1->writtenName(), QString( "ab1.txt" ) );
+    QCOMPARE( item2->writtenName(), QString( "c.txt" ) );
+    QCOMPARE( item3->writtenName(), QString( "ab2.txt" ) );
+    QCOMPARE( item4->writtenName(), QString( "ab3.txt" ) );
+    QCOMPARE( dir->writtenName(), QString( "dir" ) );
+    QCOMPARE( item5->writtenName(), QString( "ab1.txt" ) );
+    QCOMPARE( item6->writtenName(), QString( "ab2.txt" ) );
+    QVERIFY( !doc.needToCutFilenames() );
+}
+
+
+void DataDocTest::testPrepareFilenamesCutJoliet()
+{
+    K3b::DataDoc doc;
+    doc.newDocument();
+
+    K3b::IsoOptions options = doc.isoOptions();
+    options.setCreateJoliet( true );
+    options.setJolietLong( false );
+    doc.setIsoOptions( options );
+
+    K3b::DirItem* dir = new K3b::DirItem( "dir" );
+    K3b::DataItem* longItem = new K3b::SpecialDataItem( 1024, QString( 70, 'x' ) + ".txt" );
+    K3b::DataItem* shortItem = new K3b::SpecialDataItem( 1024, "short.txt" );
+    doc.root()->addDataItem( dir );
+    doc.root()->addDataItem( shortItem );
+    dir->addDataItem( longItem );
+
+    doc.prepareFilenames();
+
+    QVERIFY( doc.needToCutFilenames() );
+    QCOMPARE( doc.needToCutFilenameItems().count(), 1 );
+    QCOMPARE( doc.needToCutFilenameItems().first(), longItem );
+    QCOMPARE( longItem->writtenName().length(), 64 );
+    QVERIFY( longItem->writtenName().endsWith( ".txt" ) );
+    QCOMPARE( shortItem->writtenName(), QString( "short.txt" ) );
+}
+
+
+void DataDocTest::testFindItemByLocalPath()
+{
+    QTemporaryDir tempDir;
+    QVERIFY( tempDir.isValid() );
+    const QString path1 = tempDir.filePath( "file1" );
+    const QString path2 = tempDir.filePath( "file2" );
+    QFile file1( path1 );
+    QFile file2( path2 );
+    QVERIFY( file1.open( QIODevice::WriteOnly ) );
+    QVERIFY( file2.open( QIODevice::WriteOnly ) );
+    file1.close();
+    file2.close();
+
+    K3b::DataDoc doc;
+    doc.newDocument();
+
+    K3b::DirItem* dir = new K3b::DirItem( "dir" );
+    dir->setLocalPath( tempDir.path() );
+    K3b::FileItem* item1 = new K3b::FileItem( path1, doc );
+    K3b::FileItem* item2 = new K3b::FileItem( path2, doc );
+    K3b::FileItem* item1Copy = new K3b::FileItem( path1, doc, "copy" );
+    dir->addDataItem( item1 );
+    doc.root()->addDataItem( item2 );
+    QVERIFY( doc.findItemByLocalPath( path1 ).isEmpty() );
+
+    // adding a dir indexes its whole subtree
+    doc.root()->addDataItem( dir );
+    QCOMPARE( doc.findItemByLocalPath( tempDir.path() ), QList<K3b::DataItem*>() << dir );
+    QCOMPARE( doc.findItemByLocalPath( path1 ), QList<K3b::DataItem*>() << item1 );
+    QCOMPARE( doc.findItemByLocalPath( tempDir.path() + "/./file2" ), QList<K3b::DataItem*>() << item2 );
+    QCOMPARE( doc.findItemsByLocalId( item1->localId( false ) ), QList<K3b::FileItem*>() << item1 );
+
+    doc.root()->addDataItem( item1Copy );
+    QCOMPARE( doc.findItemByLocalPath( path1 ).count(), 2 );
+    QCOMPARE( doc.findItemsByLocalId( item1->localId( false ) ).count(), 2 );
+
+    doc.removeItem( dir );
+    QCOMPARE( doc.findItemByLocalPath( path1 ), QList<K3b::DataItem*>() << item1Copy );
+    QVERIFY( doc.findItemByLocalPath( tempDir.path() ).isEmpty() );
+
+    K3b::DirItem* other = new K3b::DirItem( "other" );
+    doc.root()->addDataItem( other );
+    doc.moveItem( item2, other );
+    QCOMPARE( doc.findItemByLocalPath( path2 ), QList<K3b::DataItem*>() << item2 );
+
+    const K3b::FileItem::Id id2 = item2->localId( false );
+    doc.clear();
+    QVERIFY( doc.findItemByLocalPath( path1 ).isEmpty() );
+    QVERIFY( doc.findItemsByLocalId( id2 ).isEmpty() );
+}
+
+
+void DataDocTest::benchmarkPrepareFilenames_data()
+{
+    QTest::addColumn<int>( "dirs" );
+    QTest::addColumn<int>( "filesPerDir" );
+    QTest::newRow( "flat 100k items" ) << 1 << 100000;
+    QTest::newRow( "100 dirs with 1k items" ) << 100 << 1000;
+}
+
+
+void DataDocTest::benchmarkPrepareFilenames()
+{
+    QFETCH( int, dirs );
+    QFETCH( int, filesPerDir );
+
+    K3b::DataDoc doc;
+    doc.newDocument();
+    addPrepareFilenamesItems( doc.root(), dirs, filesPerDir );
+
+    // the same items below one directory, which is handled in one thread
+    K3b::DataDoc serialDoc;
+    serialDoc.newDocument();
+    K3b::DirItem* serialRoot = new K3b::DirItem( "serial" );
+    serialDoc.root()->addDataItem( serialRoot );
+    addPrepareFilenamesItems( serialRoot, dirs, filesPerDir );
+
+    K3b::IsoOptions options = doc.isoOptions();
+    options.setCreateJoliet( true );
+    options.setWhiteSpaceTreatment( K3b::IsoOptions::strip );
+    doc.setIsoOptions( options );
+    serialDoc.setIsoOptions( options );
+
+    QBENCHMARK {
+        doc.prepareFilenames();
+    }
+
+    serialDoc.prepareFilenames();
+    QCOMPARE( writtenNames( doc.root() ), writtenNames( serialRoot ) );
+}
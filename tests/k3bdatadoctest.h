@@ -0,0 +1,27 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_DATA_DOC_TEST_H
+#define K3B_DATA_DOC_TEST_H
+
+#include <QObject>
+
+class DataDocTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    DataDocTest();
+
+private slots:
+    void testPrepareFilenames();
+    void testPrepareFilenamesCutJoliet();
+    void testFindItemByLocalPath();
+    void benchmarkPrepareFilenames_data();
+    void benchmarkPrepareFilenames();
+};
+
+#endif // K3B_DATA_DOC_TEST_H
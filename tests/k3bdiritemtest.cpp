@@ -0,0 +1,169 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bdiritemtest.h"
+#include "k3bdatadoc.h"
+#include "k3bdiritem.h"
+#include "k3bspecialdataitem.h"
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN( DirItemTest )
+
+namespace {
+    K3b::DirItem* createSyntheticDir( int count )
+    {
+        K3b::DirItem::Children items;
+        items.reserve( count );
+        for( int i = 0; i < count; ++i ) {
+            items.append( new K3b::SpecialDataItem( 2048, QString( "file%1" ).arg( i ) ) );
+        }
+
+        K3b::DirItem* dir = new K3b::DirItem( "dir" );
+        dir->addDataItems( items );
+        return dir;
+    }
+}
+
+
+DirItemTest::DirItemTest()
+{
+}
+
+
+void DirItemTest::testFind()
+{
+    K3b::DirItem dir( "dir" );
+    K3b::DataItem* file1 = new K3b::SpecialDataItem( 1024, "file1" );
+    K3b::DataItem* file2 = new K3b::SpecialDataItem( 1024, "file2" );
+    dir.addDataItem( file1 );
+    dir.addDataItem( file2 );
+
+    QCOMPARE( dir.find( "file1" ), file1 );
+    QCOMPARE( dir.find( "file2" ), file2 );
+    QVERIFY( dir.find( "file3" ) == 0 );
+    QVERIFY( dir.alreadyInDirectory( "file2" ) );
+}
+
+
+void DirItemTest::testFindAfterRename()
+{
+    K3b::DirItem dir( "dir" );
+    K3b::DataItem* file1 = new K3b::SpecialDataItem( 1024, "file1" );
+    K3b::DataItem* file2 = new K3b::SpecialDataItem( 1024, "file2" );
+    dir.addDataItem( file1 );
+    dir.addDataItem( file2 );
+
+    file1->setK3bName( "renamed" );
+    QVERIFY( dir.find( "file1" ) == 0 );
+    QCOMPARE( dir.find( "renamed" ), file1 );
+
+    // renaming to an existing name is refused
+    file2->setK3bName( "renamed" );
+    QCOMPARE( file2->k3bName(), QString( "file2" ) );
+    QCOMPARE( dir.find( "file2" ), file2 );
+    QCOMPARE( dir.find( "renamed" ), file1 );
+}
+
+
+void DirItemTest::testFindAfterTake()
+{
+    K3b::DirItem dir( "dir" );
+    K3b::DataItem* file1 = new K3b::SpecialDataItem( 1024, "file1" );
+    K3b::DataItem* file2 = new K3b::SpecialDataItem( 1024, "file2" );
+    dir.addDataItem( file1 );
+    dir.addDataItem( file2 );
+
+    QCOMPARE( dir.takeDataItem( file1 ), file1 );
+    QVERIFY( dir.find( "file1" ) == 0 );
+    QCOMPARE( dir.find( "file2" ), file2 );
+
+    // a taken item does not update its former parent anymore
+    file1->setK3bName( "file3" );
+    QVERIFY( dir.find( "file3" ) == 0 );
+    delete file1;
+
+    dir.removeDataItems( 0, 1 );
+    QVERIFY( dir.find( "file2" ) == 0 );
+    QVERIFY( dir.children().isEmpty() );
+}
+
+
+void DirItemTest::testFindAfterMove()
+{
+    K3b::DataDoc doc;
+    doc.newDocument();
+    K3b::DirItem* source = new K3b::DirItem( "source" );
+    K3b::DirItem* target = new K3b::DirItem( "target" );
+    doc.root()->addDataItem( source );
+    doc.root()->addDataItem( target );
+    K3b::DataItem* file = new K3b::SpecialDataItem( 1024, "file" );
+    source->addDataItem( file );
+
+    doc.moveItem( file, target );
+    QVERIFY( source->find( "file" ) == 0 );
+    QCOMPARE( target->find( "file" ), file );
+    QCOMPARE( doc.root()->findByPath( "/target/file" ), file );
+}
+
+
+void DirItemTest::testFindByPath()
+{
+    K3b::DirItem dir( "dir" );
+    QVERIFY( dir.mkdir( "a/b/c" ) );
+    QVERIFY( !dir.mkdir( "a/b" ) );
+
+    K3b::DataItem* c = dir.findByPath( "a/b/c" );
+    QVERIFY( c != 0 );
+    QVERIFY( c->isDir() );
+    QCOMPARE( c->k3bName(), QString( "c" ) );
+    QVERIFY( dir.findByPath( "a/x/c" ) == 0 );
+}
+
+
+void DirItemTest::benchmarkAddItems_data()
+{
+    QTest::addColumn<int>( "count" );
+    QTest::newRow( "100k items" ) << 100000;
+    QTest::newRow( "1M items" ) << 1000000;
+}
+
+
+void DirItemTest::benchmarkAddItems()
+{
+    QFETCH( int, count );
+
+    QBENCHMARK_ONCE {
+        K3b::DataDoc doc;
+        doc.newDocument();
+        K3b::DirItem* dir = new K3b::DirItem( "dir" );
+        doc.root()->addDataItem( dir );
+        for( int i = 0; i < count; ++i ) {
+            dir->addDataItem( new K3b::SpecialDataItem( 2048, QString( "file%1" ).arg( i ) ) );
+        }
+        QCOMPARE( dir->children().size(), count );
+    }
+}
+
+
+void DirItemTest::benchmarkFind_data()
+{
+    benchmarkAddItems_data();
+}
+
+
+void DirItemTest::benchmarkFind()
+{
+    QFETCH( int, count );
+
+    K3b::DirItem* dir = createSyntheticDir( count );
+    QBENCHMARK {
+        for( int i = 0; i < count; i += count/1000 ) {
+            QVERIFY( dir->find( QString( "file%1" ).arg( i ) ) != 0 );
+        }
+    }
+    delete dir;
+}
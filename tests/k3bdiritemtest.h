@@ -0,0 +1,31 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_DIR_ITEM_TEST_H
+#define K3B_DIR_ITEM_TEST_H
+
+#include <QObject>
+
+class DirItemTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    DirItemTest();
+
+private slots:
+    void testFind();
+    void testFindAfterRename();
+    void testFindAfterTake();
+    void testFindAfterMove();
+    void testFindByPath();
+    void benchmarkAddItems_data();
+    void benchmarkAddItems();
+    void benchmarkFind_data();
+    void benchmarkFind();
+};
+
+#endif // K3B_DIR_ITEM_TEST_H
@@ -0,0 +1,163 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bdirsizejobtest.h"
+#include "k3bdirsizejob.h"
+#include "k3bglobals.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( DirSizeJobTest )
+
+namespace {
+    struct Totals {
+        Totals() : size( 0 ), files( 0 ), dirs( 0 ), symlinks( 0 ) {}
+        KIO::filesize_t size;
+        KIO::filesize_t files;
+        KIO::filesize_t dirs;
+        KIO::filesize_t symlinks;
+    };
+
+    /**
+     * Counts like DirSizeJob did before it used several threads.
+     */
+    bool countSerially( const QStringList& l, const QString& dir, bool followSymlinks, Totals& totals )
+    {
+        Q_FOREACH( const QString& name, l ) {
+            const QString path = dir + name;
+            k3b_struct_stat s;
+            if( k3b_lstat( QFile::encodeName( path ), &s ) )
+                return false;
+
+            if( S_ISLNK( s.st_mode ) ) {
+                ++totals.symlinks;
+                if( followSymlinks && k3b_stat( QFile::encodeName( path ), &s ) )
+                    return false;
+            }
+
+            if( S_ISDIR( s.st_mode ) ) {
+                ++totals.dirs;
+                const QStringList children = QDir( path ).entryList( QDir::AllEntries|QDir::Hidden|QDir::System|QDir::NoDotAndDotDot );
+                if( !countSerially( children, path + '/', followSymlinks, totals ) )
+                    return false;
+            }
+            else if( !S_ISLNK( s.st_mode ) ) {
+                ++totals.files;
+                totals.size += s.st_size;
+            }
+        }
+        return true;
+    }
+
+    bool writeFile( const QString& path, int size )
+    {
+        QFile file( path );
+        return file.open( QIODevice::WriteOnly ) && file.write( QByteArray( size, 'x' ) ) == size;
+    }
+
+    bool runJob( K3b::DirSizeJob& job )
+    {
+        QSignalSpy spy( &job, SIGNAL(finished(bool)) );
+        job.start();
+        if( spy.isEmpty() && !spy.wait( 30000 ) )
+            return false;
+        return spy.first().first().toBool();
+    }
+}
+
+
+void DirSizeJobTest::initTestCase()
+{
+    QVERIFY( m_dir.isValid() );
+
+    // enough directories to keep all worker threads busy
+    const QString tree = m_dir.filePath( "tree" );
+    for( int i = 0; i < 20; ++i ) {
+        for( int j = 0; j < 5; ++j ) {
+            const QString dir = QString( "%1/dir%2/sub%3" ).arg( tree ).arg( i ).arg( j );
+            QVERIFY( QDir().mkpath( dir ) );
+            for( int k = 0; k < 10; ++k )
+                QVERIFY( writeFile( QString( "%1/file%2" ).arg( dir ).arg( k ), i*100 + j*10 + k ) );
+        }
+        QVERIFY( writeFile( QString( "%1/dir%2/.hidden" ).arg( tree ).arg( i ), 1000 + i ) );
+    }
+    QVERIFY( QDir().mkpath( tree + "/empty" ) );
+    QVERIFY( QFile::link( tree + "/dir0/sub0/file1", tree + "/dir1/filelink" ) );
+    QVERIFY( QFile::link( tree + "/dir2/sub1", tree + "/dir3/dirlink" ) );
+
+    QVERIFY( writeFile( m_dir.filePath( "single" ), 4711 ) );
+}
+
+
+void DirSizeJobTest::testTotals_data()
+{
+    QTest::addColumn<bool>( "followSymlinks" );
+    QTest::newRow( "symlinks" ) << false;
+    QTest::newRow( "follow symlinks" ) << true;
+}
+
+
+void DirSizeJobTest::testTotals()
+{
+    QFETCH( bool, followSymlinks );
+
+    const QStringList paths = QStringList() << m_dir.filePath( "tree" ) << m_dir.filePath( "single" );
+    Totals expected;
+    QVERIFY( countSerially( paths, QString(), followSymlinks, expected ) );
+    QVERIFY( expected.dirs > 100 );
+
+    K3b::DirSizeJob job;
+    job.setUrls( QList<QUrl>() << QUrl::fromLocalFile( paths[0] ) << QUrl::fromLocalFile( paths[1] ) );
+    job.setFollowSymlinks( followSymlinks );
+    QVERIFY( runJob( job ) );
+
+    QCOMPARE( job.totalSize(), expected.size );
+    QCOMPARE( job.totalFiles(), expected.files );
+    QCOMPARE( job.totalDirs(), expected.dirs );
+    QCOMPARE( job.totalSymlinks(), expected.symlinks );
+}
+
+
+void DirSizeJobTest::testSingleFile()
+{
+    K3b::DirSizeJob job;
+    job.setUrls( QList<QUrl>() << QUrl::fromLocalFile( m_dir.filePath( "single" ) ) );
+    QVERIFY( runJob( job ) );
+
+    QCOMPARE( job.totalSize(), KIO::filesize_t( 4711 ) );
+    QCOMPARE( job.totalFiles(), KIO::filesize_t( 1 ) );
+    QCOMPARE( job.totalDirs(), KIO::filesize_t( 0 ) );
+    QCOMPARE( job.totalSymlinks(), KIO::filesize_t( 0 ) );
+}
+
+
+void DirSizeJobTest::testCollectEntries()
+{
+    const QString tree = m_dir.filePath( "tree" );
+
+    K3b::DirSizeJob job;
+    job.setUrls( QList<QUrl>() << QUrl::fromLocalFile( tree ) );
+    job.setCollectEntries( true );
+    QVERIFY( runJob( job ) );
+
+    K3b::DirSizeJob::Entry entry;
+    QVERIFY( job.takeEntry( tree + "/dir4/sub2", entry ) );
+    QVERIFY( S_ISDIR( entry.stat.st_mode ) );
+    QCOMPARE( entry.children, QDir( tree + "/dir4/sub2" ).entryList( QDir::AllEntries|QDir::Hidden|QDir::System|QDir::NoDotAndDotDot ) );
+
+    QVERIFY( job.takeEntry( tree + "/dir4/sub2/file3", entry ) );
+    QCOMPARE( qint64( entry.stat.st_size ), qint64( 423 ) );
+    QVERIFY( entry.readable );
+    QVERIFY( !job.takeEntry( tree + "/dir4/sub2/file3", entry ) );
+
+    QVERIFY( job.takeEntry( tree + "/dir1/filelink", entry ) );
+    QVERIFY( S_ISLNK( entry.stat.st_mode ) );
+    QVERIFY( entry.followedStatValid );
+    QCOMPARE( qint64( entry.followedStat.st_size ), qint64( 1 ) );
+}
@@ -0,0 +1,26 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_DIR_SIZE_JOB_TEST_H
+#define K3B_DIR_SIZE_JOB_TEST_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class DirSizeJobTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void testTotals_data();
+    void testTotals();
+    void testSingleFile();
+    void testCollectEntries();
+private:
+    QTemporaryDir m_dir;
+};
+
+#endif // K3B_DIR_SIZE_JOB_TEST_H
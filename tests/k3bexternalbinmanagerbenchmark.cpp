@@ -0,0 +1,299 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bexternalbinmanagerbenchmark.h"
+#include "k3bdefaultexternalprograms.h"
+#include "k3bexternalbinmanager.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( ExternalBinManagerBenchmark )
+
+namespace {
+    struct FakeProgram {
+        const char* name;
+        const char* versionLine;
+    };
+
+    const FakeProgram s_programs[] = {
+        { "cdrecord", "Cdrecord-ProDVD-ProBD-Clone 3.02a09 (x86_64-pc-linux-gnu) Copyright (C) 1995-2016 Joerg Schilling" },
+        { "mkisofs", "mkisofs 3.02a09 (x86_64-pc-linux-gnu) Copyright (C) 1993-1997 Eric Youngdale (C) 1997-2016 Joerg Schilling" },
+        { "readcd", "readcd 3.02a09 (x86_64-pc-linux-gnu) Copyright (C) 1987, 1995-2016 Joerg Schilling" },
+        { "cdrdao", "Cdrdao version 1.2.4 - (C) Andreas Mueller <andreas@daneb.de>" },
+        { "growisofs", "* growisofs by <appro@fy.chalmers.se>, version 7.1," },
+        { "cdrskin", "cdrskin 1.5.2 : limited cdrecord compatibility wrapper for libburn" },
+        { 0, 0 }
+    };
+
+    // the time a program needs to start up, like a real one with its libraries
+    const char* s_startupTime = "0.05";
+
+    QString describe( K3b::ExternalBinManager* manager )
+    {
+        QStringList bins;
+        Q_FOREACH( K3b::ExternalProgram* program, manager->programs() ) {
+            Q_FOREACH( const K3b::ExternalBin* bin, program->bins() ) {
+                bins << QString( "%1 %2 %3 %4 [%5]" )
+                    .arg( bin->name() )
+                    .arg( bin->path() )
+                    .arg( bin->version().versionString() )
+                    .arg( bin->copyright() )
+                    .arg( bin->features().join( ',' ) );
+            }
+        }
+        return bins.join( '\n' );
+    }
+}
+
+
+void ExternalBinManagerBenchmark::initTestCase()
+{
+#ifdef Q_OS_WIN
+    QSKIP( "The fake programs are shell scripts" );
+#endif
+    QVERIFY( m_dir.isValid() );
+
+    m_binDir = m_dir.filePath( "bin" );
+    m_logFile = m_dir.filePath( "started.log" );
+    m_cacheFile = m_dir.filePath( "cache/externalbins" );
+    QVERIFY( QDir().mkpath( m_binDir ) );
+
+    for( int i = 0; s_programs[i].name; ++i )
+        QVERIFY( writeProgram( s_programs[i].name, s_programs[i].versionLine ) );
+
+    // do not find the programs installed on this system
+    qputenv( "PATH", QFile::encodeName( m_binDir ) );
+}
+
+
+K3b::ExternalBinManager* ExternalBinManagerBenchmark::createManager() const
+{
+    K3b::ExternalBinManager* manager = new K3b::ExternalBinManager();
+    K3b::addDefaultPrograms( manager );
+    manager->setSearchPath( QStringList() << m_binDir );
+    manager->setCacheFileName( m_cacheFile );
+    return manager;
+}
+
+
+bool ExternalBinManagerBenchmark::writeProgram( const QString& name, const QString& versionLine ) const
+{
+    // a program fails while a file <program>.broken exists
+    const QString script = QString( "sleep %1\n"
+                                    "[ -e \"$0.broken\" ] && exit 1\n"
+                                    "case \"$1\" in\n"
+                                    "    --version|-version)\n"
+                                    "        echo \"%2\"\n"
+                                    "        ;;\n"
+                                    "    *)\n"
+                                    "        echo \"Usage: gracetime -overburn -text -clone -tao cuefile= -udf -joliet-long --overburn --multi\"\n"
+                                    "        ;;\n"
+                                    "esac\n" )
+                           .arg( QLatin1String( s_startupTime ) )
+                           .arg( versionLine );
+    return writeScript( name, script );
+}
+
+
+bool ExternalBinManagerBenchmark::writeScript( const QString& name, const QString& body ) const
+{
+    const QString path = m_binDir + '/' + name;
+    QFile file( path );
+    if( !file.open( QIODevice::WriteOnly ) )
+        return false;
+
+    const QString script = QString( "#!/bin/sh\n"
+                                    "PATH=/bin:/usr/bin\n"
+                                    "echo \"$0 $*\" >> \"%1\"\n" )
+                           .arg( m_logFile ) + body;
+    if( file.write( QFile::encodeName( script ) ) < 0 )
+        return false;
+    file.close();
+
+    return file.setPermissions( QFile::ReadOwner|QFile::WriteOwner|QFile::ExeOwner|
+                                QFile::ReadGroup|QFile::ExeGroup|
+                                QFile::ReadOther|QFile::ExeOther );
+}
+
+
+QStringList ExternalBinManagerBenchmark::startedPrograms() const
+{
+    QStringList programs;
+    QFile file( m_logFile );
+    if( file.open( QIODevice::ReadOnly ) ) {
+        Q_FOREACH( const QByteArray& line, file.readAll().split( '\n' ) ) {
+            const QString program = QFileInfo( QFile::decodeName( line.split( ' ' ).first() ) ).fileName();
+            if( !program.isEmpty() && !programs.contains( program ) )
+                programs.append( program );
+        }
+    }
+    programs.sort();
+    return programs;
+}
+
+
+void ExternalBinManagerBenchmark::clearLog() const
+{
+    QFile::remove( m_logFile );
+}
+
+
+void ExternalBinManagerBenchmark::benchmarkSerialScan()
+{
+    // the search as it was done before, one program after the other
+    K3b::ExternalBinManager* manager = createManager();
+    QBENCHMARK {
+        Q_FOREACH( K3b::ExternalProgram* program, manager->programs() ) {
+            program->clear();
+            program->scan( m_binDir );
+        }
+    }
+    QVERIFY( manager->foundBin( "cdrecord" ) );
+    delete manager;
+}
+
+
+void ExternalBinManagerBenchmark::benchmarkColdSearch()
+{
+    K3b::ExternalBinManager* manager = createManager();
+    QBENCHMARK {
+        QFile::remove( m_cacheFile );
+        manager->search();
+    }
+    QVERIFY( manager->foundBin( "cdrecord" ) );
+    delete manager;
+}
+
+
+void ExternalBinManagerBenchmark::benchmarkWarmSearch()
+{
+    K3b::ExternalBinManager* manager = createManager();
+    manager->search();
+    QBENCHMARK {
+        manager->search();
+    }
+    QVERIFY( manager->foundBin( "cdrecord" ) );
+    delete manager;
+}
+
+
+void ExternalBinManagerBenchmark::testWarmSearchStartsNoProgram()
+{
+    QFile::remove( m_cacheFile );
+    clearLog();
+
+    K3b::ExternalBinManager* cold = createManager();
+    cold->search();
+    QCOMPARE( startedPrograms().count(), 6 );
+    QVERIFY( QFile::exists( m_cacheFile ) );
+
+    clearLog();
+    K3b::ExternalBinManager* warm = createManager();
+    warm->search();
+    QCOMPARE( startedPrograms(), QStringList() );
+
+    QVERIFY( !describe( warm ).isEmpty() );
+    QCOMPARE( describe( warm ), describe( cold ) );
+    QCOMPARE( warm->binObject( "cdrecord" )->version(), K3b::Version( "3.02a09" ) );
+    QVERIFY( warm->binObject( "cdrecord" )->hasFeature( "overburn" ) );
+    QCOMPARE( warm->binObject( "cdrdao" )->version(), K3b::Version( 1, 2, 4 ) );
+
+    delete cold;
+    delete warm;
+}
+
+
+void ExternalBinManagerBenchmark::testChangedProgram()
+{
+    K3b::ExternalBinManager* manager = createManager();
+    manager->search();
+
+    QVERIFY( writeProgram( "readcd", "readcd 3.03 (x86_64-pc-linux-gnu) Copyright (C) 1987, 1995-2016 Joerg Schilling" ) );
+
+    clearLog();
+    manager->search();
+    QCOMPARE( startedPrograms(), QStringList() << "readcd" );
+    QCOMPARE( manager->binObject( "readcd" )->version(), K3b::Version( 3, 3 ) );
+
+    delete manager;
+}
+
+
+void ExternalBinManagerBenchmark::testRescan()
+{
+    K3b::ExternalBinManager* manager = createManager();
+    manager->search();
+
+    clearLog();
+    manager->search( false );
+    QCOMPARE( startedPrograms().count(), 6 );
+    QVERIFY( manager->foundBin( "growisofs" ) );
+
+    delete manager;
+}
+
+
+void ExternalBinManagerBenchmark::testFailedProbeNotCached()
+{
+    QFile::remove( m_cacheFile );
+
+    // e.g. timed out on a busy system
+    QFile broken( m_binDir + "/cdrdao.broken" );
+    QVERIFY( broken.open( QIODevice::WriteOnly ) );
+    broken.close();
+
+    K3b::ExternalBinManager* manager = createManager();
+    manager->search();
+    QVERIFY( !manager->foundBin( "cdrdao" ) );
+    QVERIFY( manager->foundBin( "cdrecord" ) );
+
+    // the program itself did not change
+    QVERIFY( broken.remove() );
+    clearLog();
+    manager->search();
+    QCOMPARE( startedPrograms(), QStringList() << "cdrdao" );
+    QCOMPARE( manager->binObject( "cdrdao" )->version(), K3b::Version( 1, 2, 4 ) );
+
+    clearLog();
+    manager->search();
+    QCOMPARE( startedPrograms(), QStringList() );
+
+    delete manager;
+}
+
+
+void ExternalBinManagerBenchmark::testUncacheableProgram()
+{
+    const QString modDir = m_dir.filePath( "transcode" );
+    QVERIFY( QDir().mkpath( modDir ) );
+    QVERIFY( writeProgram( "transcode", "transcode v1.1.7 (C) 2001-2003 Thomas Oestreich, 2003-2010 Transcode Team" ) );
+    QVERIFY( writeScript( "tcmodinfo", QString( "echo \"%1\"\n" ).arg( modDir ) ) );
+
+    K3b::ExternalBinManager* manager = new K3b::ExternalBinManager();
+    manager->addProgram( new K3b::TranscodeProgram( "transcode" ) );
+    manager->setSearchPath( QStringList() << m_binDir );
+    manager->setCacheFileName( m_cacheFile );
+    manager->search();
+    QVERIFY( manager->foundBin( "transcode" ) );
+    QVERIFY( !manager->binObject( "transcode" )->hasFeature( "lame" ) );
+
+    // a module installed later is found although transcode did not change
+    QFile module( modDir + "/export_lame.so" );
+    QVERIFY( module.open( QIODevice::WriteOnly ) );
+    module.close();
+
+    clearLog();
+    manager->search();
+    QCOMPARE( startedPrograms(), QStringList() << "tcmodinfo" << "transcode" );
+    QVERIFY( manager->binObject( "transcode" )->hasFeature( "lame" ) );
+
+    delete manager;
+    QFile::remove( m_binDir + "/transcode" );
+    QFile::remove( m_binDir + "/tcmodinfo" );
+}
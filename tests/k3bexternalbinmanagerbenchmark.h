@@ -0,0 +1,44 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_EXTERNAL_BINMANAGER_BENCHMARK_H
+#define K3B_EXTERNAL_BINMANAGER_BENCHMARK_H
+
+#include <QObject>
+#include <QStringList>
+#include <QTemporaryDir>
+
+namespace K3b {
+    class ExternalBinManager;
+}
+
+class ExternalBinManagerBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void benchmarkSerialScan();
+    void benchmarkColdSearch();
+    void benchmarkWarmSearch();
+    void testWarmSearchStartsNoProgram();
+    void testChangedProgram();
+    void testRescan();
+    void testFailedProbeNotCached();
+    void testUncacheableProgram();
+private:
+    K3b::ExternalBinManager* createManager() const;
+    bool writeProgram( const QString& name, const QString& versionLine ) const;
+    bool writeScript( const QString& name, const QString& body ) const;
+    QStringList startedPrograms() const;
+    void clearLog() const;
+
+    QTemporaryDir m_dir;
+    QString m_binDir;
+    QString m_logFile;
+    QString m_cacheFile;
+};
+
+#endif // K3B_EXTERNAL_BINMANAGER_BENCHMARK_H
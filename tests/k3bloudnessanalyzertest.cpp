@@ -0,0 +1,159 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bloudnessanalyzertest.h"
+#include "k3bloudnessanalyzer.h"
+
+#include <QTest>
+
+#include <cmath>
+
+QTEST_GUILESS_MAIN( LoudnessAnalyzerTest )
+
+namespace {
+    /**
+     * A 1 kHz sine in both channels as 16 bit big endian stereo samples
+     */
+    QByteArray sine( double dbfs, int seconds )
+    {
+        const double amplitude = std::pow( 10.0, dbfs/20.0 )*32767.0;
+        const int frames = 44100*seconds;
+        QByteArray data( frames*4, '\0' );
+        for( int i = 0; i < frames; ++i ) {
+            const qint16 sample = qint16( std::lrint( amplitude*std::sin( 2.0*M_PI*1000.0*i/44100.0 ) ) );
+            for( int c = 0; c < 2; ++c ) {
+                data[4*i+2*c] = char( sample >> 8 );
+                data[4*i+2*c+1] = char( sample );
+            }
+        }
+        return data;
+    }
+
+    /**
+     * The mean square of a block with the given loudness
+     */
+    float block( double lufs )
+    {
+        return float( std::pow( 10.0, ( lufs + 0.691 )/10.0 ) );
+    }
+}
+
+
+LoudnessAnalyzerTest::LoudnessAnalyzerTest()
+{
+}
+
+
+void LoudnessAnalyzerTest::testSineLoudness_data()
+{
+    QTest::addColumn<double>( "dbfs" );
+
+    QTest::newRow( "-20 dBFS" ) << -20.0;
+    QTest::newRow( "-23 dBFS" ) << -23.0;
+    QTest::newRow( "-33 dBFS" ) << -33.0;
+}
+
+
+void LoudnessAnalyzerTest::testSineLoudness()
+{
+    QFETCH( double, dbfs );
+
+    // a stereo 1 kHz sine has the same loudness in LUFS as its level in dBFS
+    const QByteArray data = sine( dbfs, 10 );
+    K3b::LoudnessAnalyzer analyzer;
+    analyzer.update( data.constData(), data.size() );
+
+    const double loudness = K3b::LoudnessAnalyzer::integratedLoudness( analyzer.blocks() );
+    QVERIFY( qAbs( loudness - dbfs ) < 0.1 );
+    QVERIFY( qAbs( analyzer.peak() - std::pow( 10.0, dbfs/20.0 ) ) < 0.001 );
+}
+
+
+void LoudnessAnalyzerTest::testChunkSize()
+{
+    const QByteArray data = sine( -23.0, 3 );
+
+    K3b::LoudnessAnalyzer whole;
+    whole.update( data.constData(), data.size() );
+
+    // chunks which do not end on block boundaries
+    K3b::LoudnessAnalyzer chunked;
+    for( int pos = 0; pos < data.size(); pos += 4*1234 )
+        chunked.update( data.constData() + pos, qMin( 4*1234, data.size() - pos ) );
+
+    QCOMPARE( chunked.blocks(), whole.blocks() );
+    QCOMPARE( chunked.peak(), whole.peak() );
+
+    chunked.reset();
+    QVERIFY( chunked.blocks().isEmpty() );
+    QCOMPARE( chunked.peak(), 0.0f );
+}
+
+
+void LoudnessAnalyzerTest::testBlockCount()
+{
+    // blocks of 400 ms every 100 ms
+    const QByteArray data = sine( -23.0, 2 );
+    K3b::LoudnessAnalyzer analyzer;
+    analyzer.update( data.constData(), data.size() );
+    QCOMPARE( analyzer.blocks().count(), 17 );
+
+    // less than one block
+    K3b::LoudnessAnalyzer shortAnalyzer;
+    shortAnalyzer.update( data.constData(), 4*44100/10*3 );
+    QVERIFY( shortAnalyzer.blocks().isEmpty() );
+}
+
+
+void LoudnessAnalyzerTest::testSilence()
+{
+    const QByteArray data( 4*44100*2, '\0' );
+    K3b::LoudnessAnalyzer analyzer;
+    analyzer.update( data.constData(), data.size() );
+
+    const double loudness = K3b::LoudnessAnalyzer::integratedLoudness( analyzer.blocks() );
+    QVERIFY( std::isinf( loudness ) && loudness < 0 );
+    QCOMPARE( analyzer.peak(), 0.0f );
+
+    // silence is left alone
+    QCOMPARE( K3b::LoudnessAnalyzer::gain( loudness, analyzer.peak() ), 0.0 );
+    QVERIFY( std::isinf( K3b::LoudnessAnalyzer::integratedLoudness( QVector<float>() ) ) );
+}
+
+
+void LoudnessAnalyzerTest::testGates()
+{
+    QVector<float> blocks;
+    for( int i = 0; i < 10; ++i )
+        blocks << block( -20.0 );
+
+    // below the absolute gate
+    for( int i = 0; i < 50; ++i )
+        blocks << block( -80.0 );
+    QVERIFY( qAbs( K3b::LoudnessAnalyzer::integratedLoudness( blocks ) + 20.0 ) < 0.001 );
+
+    // below the relative gate of about -30 LUFS
+    for( int i = 0; i < 10; ++i )
+        blocks << block( -40.0 );
+    QVERIFY( qAbs( K3b::LoudnessAnalyzer::integratedLoudness( blocks ) + 20.0 ) < 0.001 );
+
+    // above the relative gate and thus part of the loudness
+    for( int i = 0; i < 10; ++i )
+        blocks << block( -25.0 );
+    const double loudness = K3b::LoudnessAnalyzer::integratedLoudness( blocks );
+    QVERIFY( loudness < -20.0 && loudness > -25.0 );
+}
+
+
+void LoudnessAnalyzerTest::testGainLimitedByPeak()
+{
+    QCOMPARE( K3b::LoudnessAnalyzer::gain( -23.0, 0.1f, -18.0 ), 5.0 );
+    QCOMPARE( K3b::LoudnessAnalyzer::gain( -10.0, 1.0f, -18.0 ), -8.0 );
+
+    // the peak at -6 dBFS allows 6 dB only
+    const double gain = K3b::LoudnessAnalyzer::gain( -30.0, 0.5f, -18.0 );
+    QVERIFY( qAbs( gain - 6.0206 ) < 0.001 );
+}
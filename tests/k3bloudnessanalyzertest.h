@@ -0,0 +1,27 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_LOUDNESS_ANALYZER_TEST_H
+#define K3B_LOUDNESS_ANALYZER_TEST_H
+
+#include <QObject>
+
+class LoudnessAnalyzerTest : public QObject
+{
+    Q_OBJECT
+public:
+    LoudnessAnalyzerTest();
+private slots:
+    void testSineLoudness_data();
+    void testSineLoudness();
+    void testChunkSize();
+    void testBlockCount();
+    void testSilence();
+    void testGates();
+    void testGainLimitedByPeak();
+};
+
+#endif // K3B_LOUDNESS_ANALYZER_TEST_H
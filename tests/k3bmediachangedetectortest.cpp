@@ -0,0 +1,258 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bmediachangedetectortest.h"
+#include "k3bmediachangedetector.h"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QTest>
+#include <QThread>
+
+QTEST_GUILESS_MAIN( MediaChangeDetectorTest )
+
+namespace {
+    /**
+     * A drive which is changed by the test
+     */
+    class FakeEventSource : public K3b::MediaChangeDetector::EventSource
+    {
+    public:
+        explicit FakeEventSource( bool supportsEvents )
+            : supportsEvents( supportsEvents ),
+              event( K3b::Device::MEDIA_EVENT_NONE ),
+              present( false ),
+              failures( 0 ) {
+        }
+
+        bool mediaEvent( K3b::Device::MediaEvent& e, bool& mediumPresent, bool& unsupported ) override {
+            eventRequests.ref();
+            unsupported = !supportsEvents;
+            if( !supportsEvents )
+                return false;
+
+            // the drive was busy or the bus has been reset
+            if( failures.fetchAndAddOrdered( -1 ) > 0 )
+                return false;
+
+            // the drive reports every event once
+            e = K3b::Device::MediaEvent( event.fetchAndStoreOrdered( K3b::Device::MEDIA_EVENT_NONE ) );
+            mediumPresent = present.loadAcquire();
+            return true;
+        }
+
+        bool mediumReady() override {
+            readyRequests.ref();
+            return present.loadAcquire();
+        }
+
+        bool supportsEvents;
+        QAtomicInt event;
+        QAtomicInt present;
+        QAtomicInt failures;
+
+        QAtomicInt eventRequests;
+        QAtomicInt readyRequests;
+    };
+
+    // runs waitForChange() in a thread of its own
+    class Waiter : public QThread
+    {
+    public:
+        explicit Waiter( K3b::MediaChangeDetector& d )
+            : detector( d ),
+              result( false ),
+              elapsed( 0 ) {
+        }
+
+        void run() override {
+            QElapsedTimer timer;
+            timer.start();
+            result = detector.waitForChange();
+            elapsed = timer.elapsed();
+        }
+
+        K3b::MediaChangeDetector& detector;
+        bool result;
+        qint64 elapsed;
+    };
+}
+
+
+MediaChangeDetectorTest::MediaChangeDetectorTest()
+{
+}
+
+
+void MediaChangeDetectorTest::testMediaEvents()
+{
+    FakeEventSource* source = new FakeEventSource( true );
+    K3b::MediaChangeDetector detector( source );
+
+    // the first check only reads the state
+    QVERIFY( !detector.check() );
+    QVERIFY( detector.eventsSupported() );
+    QVERIFY( !detector.mediumPresent() );
+
+    source->event = K3b::Device::MEDIA_EVENT_NEW_MEDIA;
+    source->present = 1;
+    QVERIFY( detector.check() );
+    QVERIFY( detector.mediumPresent() );
+    QVERIFY( !detector.check() );
+
+    // a swapped medium is only visible by the event
+    source->event = K3b::Device::MEDIA_EVENT_MEDIA_CHANGED;
+    QVERIFY( detector.check() );
+
+    // the user pressing the eject button changes nothing
+    source->event = K3b::Device::MEDIA_EVENT_EJECT_REQUEST;
+    QVERIFY( !detector.check() );
+
+    // never wake up the drive
+    QCOMPARE( source->readyRequests.loadAcquire(), 0 );
+    QCOMPARE( detector.interval(), 2000 );
+}
+
+
+void MediaChangeDetectorTest::testPresenceWithoutEvent()
+{
+    FakeEventSource* source = new FakeEventSource( true );
+    K3b::MediaChangeDetector detector( source );
+    QVERIFY( !detector.check() );
+
+    // someone else took the event
+    source->present = 1;
+    QVERIFY( detector.check() );
+    source->present = 0;
+    QVERIFY( detector.check() );
+    QVERIFY( !detector.check() );
+}
+
+
+void MediaChangeDetectorTest::testPollingBackOff()
+{
+    FakeEventSource* source = new FakeEventSource( false );
+    K3b::MediaChangeDetector detector( source );
+
+    QVERIFY( !detector.check() );
+    QVERIFY( !detector.eventsSupported() );
+    QCOMPARE( detector.interval(), 2000 );
+
+    QVERIFY( !detector.check() );
+    QCOMPARE( detector.interval(), 4000 );
+    QVERIFY( !detector.check() );
+    QCOMPARE( detector.interval(), 8000 );
+    QVERIFY( !detector.check() );
+    QCOMPARE( detector.interval(), 16000 );
+    QVERIFY( !detector.check() );
+    QCOMPARE( detector.interval(), 16000 );
+
+    source->present = 1;
+    QVERIFY( detector.check() );
+    QCOMPARE( detector.interval(), 2000 );
+
+    // unsupported events are only asked for once
+    QCOMPARE( source->eventRequests.loadAcquire(), 1 );
+    QCOMPARE( source->readyRequests.loadAcquire(), 6 );
+}
+
+
+void MediaChangeDetectorTest::testNotifyWakesWaiter()
+{
+    FakeEventSource* source = new FakeEventSource( true );
+    K3b::MediaChangeDetector detector( source );
+    QVERIFY( !detector.check() );
+
+    Waiter waiter( detector );
+    waiter.start();
+    QThread::msleep( 100 );
+    QVERIFY( waiter.isRunning() );
+
+    // the kernel took the event, still the system tells us
+    detector.notify();
+    QVERIFY( waiter.wait( 5000 ) );
+    QVERIFY( waiter.result );
+    QVERIFY( waiter.elapsed < 1500 );
+
+    // the system is trusted now
+    QCOMPARE( detector.interval(), 30000 );
+}
+
+
+void MediaChangeDetectorTest::testSystemNotifications()
+{
+    FakeEventSource* source = new FakeEventSource( true );
+    K3b::MediaChangeDetector detector( source );
+
+    // the system reports changes before it reported any
+    detector.setSystemNotifications( true );
+    QVERIFY( !detector.check() );
+    QCOMPARE( detector.interval(), 30000 );
+
+    detector.setSystemNotifications( false );
+    QVERIFY( !detector.check() );
+    QCOMPARE( detector.interval(), 2000 );
+}
+
+
+void MediaChangeDetectorTest::testTransientEventFailure()
+{
+    FakeEventSource* source = new FakeEventSource( true );
+    K3b::MediaChangeDetector detector( source );
+    QVERIFY( !detector.check() );
+
+    // a failing request falls back to the presence once
+    source->failures = 1;
+    source->present = 1;
+    QVERIFY( detector.check() );
+    QVERIFY( detector.eventsSupported() );
+    QCOMPARE( source->readyRequests.loadAcquire(), 1 );
+    QCOMPARE( detector.interval(), 2000 );
+
+    source->event = K3b::Device::MEDIA_EVENT_MEDIA_CHANGED;
+    QVERIFY( detector.check() );
+    QCOMPARE( source->readyRequests.loadAcquire(), 1 );
+}
+
+
+void MediaChangeDetectorTest::testRecheck()
+{
+    FakeEventSource* source = new FakeEventSource( true );
+    K3b::MediaChangeDetector detector( source );
+    QVERIFY( !detector.check() );
+
+    Waiter waiter( detector );
+    waiter.start();
+    QThread::msleep( 100 );
+    QVERIFY( waiter.isRunning() );
+
+    // e.g. the medium has been reset
+    detector.recheck();
+    QVERIFY( waiter.wait( 5000 ) );
+    QVERIFY( waiter.result );
+    QVERIFY( waiter.elapsed < 1500 );
+}
+
+
+void MediaChangeDetectorTest::testCancel()
+{
+    FakeEventSource* source = new FakeEventSource( false );
+    K3b::MediaChangeDetector detector( source );
+    QVERIFY( !detector.check() );
+
+    Waiter waiter( detector );
+    waiter.start();
+    QThread::msleep( 100 );
+    detector.cancel();
+    QVERIFY( waiter.wait( 5000 ) );
+    QVERIFY( !waiter.result );
+
+    // stays canceled until reset
+    QVERIFY( !detector.waitForChange() );
+    detector.reset();
+    detector.recheck();
+    QVERIFY( detector.waitForChange() );
+}
@@ -0,0 +1,28 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_MEDIA_CHANGE_DETECTOR_TEST_H
+#define K3B_MEDIA_CHANGE_DETECTOR_TEST_H
+
+#include <QObject>
+
+class MediaChangeDetectorTest : public QObject
+{
+    Q_OBJECT
+public:
+    MediaChangeDetectorTest();
+private slots:
+    void testMediaEvents();
+    void testPresenceWithoutEvent();
+    void testPollingBackOff();
+    void testNotifyWakesWaiter();
+    void testSystemNotifications();
+    void testTransientEventFailure();
+    void testRecheck();
+    void testCancel();
+};
+
+#endif // K3B_MEDIA_CHANGE_DETECTOR_TEST_H
@@ -0,0 +1,183 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3breadaheadbuffertest.h"
+#include "k3breadaheadbuffer.h"
+
+#include <QTest>
+#include <QThread>
+
+QTEST_GUILESS_MAIN( ReadAheadBufferTest )
+
+namespace {
+    char pattern( qint64 pos )
+    {
+        return char( pos*31 + pos/251 );
+    }
+}
+
+
+ReadAheadBufferTest::ReadAheadBufferTest()
+{
+}
+
+
+void ReadAheadBufferTest::testWriteRead()
+{
+    K3b::ReadAheadBuffer buffer( 16 );
+    QCOMPARE( buffer.size(), qint64( 16 ) );
+    QCOMPARE( buffer.available(), qint64( 0 ) );
+    QCOMPARE( buffer.fillLevel(), 0 );
+
+    QVERIFY( buffer.write( "abcdefgh", 8 ) );
+    QCOMPARE( buffer.available(), qint64( 8 ) );
+    QCOMPARE( buffer.fillLevel(), 50 );
+
+    char data[16];
+    QCOMPARE( buffer.read( data, 3 ), qint64( 3 ) );
+    QCOMPARE( QByteArray( data, 3 ), QByteArray( "abc" ) );
+
+    // never blocks if there is data, even less than requested
+    QCOMPARE( buffer.read( data, sizeof(data) ), qint64( 5 ) );
+    QCOMPARE( QByteArray( data, 5 ), QByteArray( "defgh" ) );
+    QCOMPARE( buffer.available(), qint64( 0 ) );
+}
+
+
+void ReadAheadBufferTest::testWrapAround()
+{
+    K3b::ReadAheadBuffer buffer( 10 );
+    char data[10];
+
+    QVERIFY( buffer.write( "0123456", 7 ) );
+    QCOMPARE( buffer.read( data, 5 ), qint64( 5 ) );
+
+    // the write continues at the start of the storage
+    QVERIFY( buffer.write( "789abcde", 8 ) );
+    QCOMPARE( buffer.available(), qint64( 10 ) );
+    QCOMPARE( buffer.fillLevel(), 100 );
+
+    QCOMPARE( buffer.read( data, sizeof(data) ), qint64( 10 ) );
+    QCOMPARE( QByteArray( data, 10 ), QByteArray( "56789abcde" ) );
+}
+
+
+void ReadAheadBufferTest::testClose()
+{
+    K3b::ReadAheadBuffer buffer( 16 );
+    char data[16];
+
+    QVERIFY( buffer.write( "abc", 3 ) );
+    buffer.close();
+
+    // the remaining data can still be read
+    QVERIFY( !buffer.write( "d", 1 ) );
+    QCOMPARE( buffer.read( data, sizeof(data) ), qint64( 3 ) );
+    QCOMPARE( buffer.read( data, sizeof(data) ), qint64( 0 ) );
+    QVERIFY( !buffer.isCanceled() );
+}
+
+
+void ReadAheadBufferTest::testProducerConsumer_data()
+{
+    QTest::addColumn<qint64>( "bufferSize" );
+    QTest::addColumn<int>( "writeSize" );
+    QTest::addColumn<int>( "readSize" );
+
+    QTest::newRow( "small buffer" ) << qint64( 61 ) << 2352 << 1000;
+    QTest::newRow( "sector sized" ) << qint64( 2352*10 ) << 2352*10 << 2352*10;
+    QTest::newRow( "odd sizes" ) << qint64( 65536 ) << 10007 << 3001;
+}
+
+
+void ReadAheadBufferTest::testProducerConsumer()
+{
+    QFETCH( qint64, bufferSize );
+    QFETCH( int, writeSize );
+    QFETCH( int, readSize );
+
+    const qint64 total = 2*1024*1024;
+    K3b::ReadAheadBuffer buffer( bufferSize );
+
+    QThread* producer = QThread::create( [&]() {
+        QByteArray data( writeSize, Qt::Uninitialized );
+        for( qint64 pos = 0; pos < total; ) {
+            const int len = qMin<qint64>( writeSize, total - pos );
+            for( int i = 0; i < len; ++i )
+                data[i] = pattern( pos + i );
+            if( !buffer.write( data.constData(), len ) )
+                return;
+            pos += len;
+        }
+        buffer.close();
+    } );
+    producer->start();
+
+    QByteArray data( readSize, Qt::Uninitialized );
+    qint64 pos = 0;
+    qint64 read = 0;
+    bool match = true;
+    while( ( read = buffer.read( data.data(), readSize ) ) > 0 ) {
+        for( int i = 0; i < read; ++i )
+            match = match && data[i] == pattern( pos + i );
+        pos += read;
+    }
+
+    QVERIFY( producer->wait( 10000 ) );
+    delete producer;
+
+    QCOMPARE( read, qint64( 0 ) );
+    QCOMPARE( pos, total );
+    QVERIFY( match );
+}
+
+
+void ReadAheadBufferTest::testCancelWakesProducer()
+{
+    K3b::ReadAheadBuffer buffer( 4 );
+    QVERIFY( buffer.write( "abcd", 4 ) );
+
+    bool written = true;
+    QThread* producer = QThread::create( [&]() { written = buffer.write( "e", 1 ); } );
+    producer->start();
+
+    // the producer waits for room
+    QVERIFY( !producer->wait( 100 ) );
+
+    buffer.cancel();
+    QVERIFY( producer->wait( 10000 ) );
+    delete producer;
+
+    QVERIFY( !written );
+    QVERIFY( buffer.isCanceled() );
+    QCOMPARE( buffer.available(), qint64( 0 ) );
+
+    char data[4];
+    QCOMPARE( buffer.read( data, sizeof(data) ), qint64( -1 ) );
+}
+
+
+void ReadAheadBufferTest::testCancelWakesConsumer()
+{
+    K3b::ReadAheadBuffer buffer( 4 );
+
+    qint64 read = 0;
+    QThread* consumer = QThread::create( [&]() {
+        char data[4];
+        read = buffer.read( data, sizeof(data) );
+    } );
+    consumer->start();
+
+    // the consumer waits for data
+    QVERIFY( !consumer->wait( 100 ) );
+
+    buffer.cancel();
+    QVERIFY( consumer->wait( 10000 ) );
+    delete consumer;
+
+    QCOMPARE( read, qint64( -1 ) );
+    QVERIFY( !buffer.write( "a", 1 ) );
+}
@@ -0,0 +1,27 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_READ_AHEAD_BUFFER_TEST_H
+#define K3B_READ_AHEAD_BUFFER_TEST_H
+
+#include <QObject>
+
+class ReadAheadBufferTest : public QObject
+{
+    Q_OBJECT
+public:
+    ReadAheadBufferTest();
+private slots:
+    void testWriteRead();
+    void testWrapAround();
+    void testClose();
+    void testProducerConsumer_data();
+    void testProducerConsumer();
+    void testCancelWakesProducer();
+    void testCancelWakesConsumer();
+};
+
+#endif // K3B_READ_AHEAD_BUFFER_TEST_H
@@ -0,0 +1,354 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bsampleconversiontest.h"
+#include "k3bsampleconversion.h"
+
+#include <QTest>
+#include <QVector>
+
+#include <math.h>
+#include <cstring>
+#include <limits>
+
+QTEST_GUILESS_MAIN( SampleConversionTest )
+
+namespace {
+    // one second of CD audio
+    const int BENCHMARK_SAMPLES = 75*588*2;
+
+    //
+    // The scalar implementations the kernels replaced. The kernels
+    // have to produce exactly the same output.
+    //
+
+    void referenceFrom16bitBeSignedToFloat( const char* src, float* dest, int samples )
+    {
+        while( samples ) {
+            samples--;
+            dest[samples] = static_cast<float>( qint16(((src[2*samples]<<8)&0xff00)|(src[2*samples+1]&0x00ff)) / 32768.0 );
+        }
+    }
+
+    void referenceFromFloatTo16BitBeSigned( const float* src, char* dest, int samples )
+    {
+        while( samples ) {
+            samples--;
+
+            float scaled = src[samples] * 32768.0;
+            qint16 val = 0;
+
+            // clipping
+            if( scaled >= ( 1.0 * 0x7FFF ) )
+                val = 32767;
+            else if( scaled <= ( -8.0 * 0x1000 ) )
+                val = -32768;
+            else
+                val = lrintf(scaled);
+
+            dest[2*samples]   = val>>8;
+            dest[2*samples+1] = val;
+        }
+    }
+
+    void referenceFrom8BitTo16BitBeSigned( const char* src, char* dest, int samples )
+    {
+        while( samples ) {
+            samples--;
+
+            float scaled = static_cast<float>(quint8(src[samples])-128) / 128.0 * 32768.0;
+            qint16 val = 0;
+
+            // clipping
+            if( scaled >= ( 1.0 * 0x7FFF ) )
+                val = 32767;
+            else if( scaled <= ( -8.0 * 0x1000 ) )
+                val = -32768;
+            else
+                val = lrintf(scaled);
+
+            dest[2*samples]   = val>>8;
+            dest[2*samples+1] = val;
+        }
+    }
+
+    void referenceSwapByteOrder( char* buffer, int len )
+    {
+        char b;
+        for( int i = 0; i < len-1; i+=2 ) {
+            b = buffer[i];
+            buffer[i] = buffer[i+1];
+            buffer[i+1] = b;
+        }
+    }
+
+    QByteArray noise( int size, quint32 seed = 1 )
+    {
+        QByteArray data( size, Qt::Uninitialized );
+        for( int i = 0; i < size; ++i ) {
+            seed = seed * 1103515245 + 12345;
+            data[i] = char( seed >> 16 );
+        }
+        return data;
+    }
+
+    /**
+     * Floats covering the full range, clipping, rounding ties and special values
+     */
+    QVector<float> floatSamples( int count )
+    {
+        QVector<float> samples( count );
+        quint32 seed = 1;
+        for( int i = 0; i < count; ++i ) {
+            seed = seed * 1103515245 + 12345;
+            const int r = ( seed >> 8 ) & 0xffff;
+            switch( i % 10 ) {
+            case 0:
+                samples[i] = std::numeric_limits<float>::quiet_NaN();
+                break;
+            case 1:
+                samples[i] = ( i % 20 == 1 ) ? std::numeric_limits<float>::infinity() : -std::numeric_limits<float>::infinity();
+                break;
+            case 2:
+                // exactly between two integer values
+                samples[i] = ( r - 32768 + 0.5f ) / 32768.0f;
+                break;
+            case 3:
+                samples[i] = ( r - 32768 ) / 16384.0f;
+                break;
+            case 4:
+                samples[i] = ( i % 20 == 4 ) ? 1.0f : -1.0f;
+                break;
+            default:
+                samples[i] = ( r - 32768 ) / 32768.0f + ( r & 0xff ) / 1e7f;
+                break;
+            }
+        }
+        return samples;
+    }
+
+    void addCounts()
+    {
+        QTest::addColumn<int>( "count" );
+
+        // cover the vector loops and all lengths of the scalar tails
+        for( int count = 0; count <= 40; ++count )
+            QTest::newRow( QByteArray::number( count ).constData() ) << count;
+        QTest::newRow( "one second" ) << BENCHMARK_SAMPLES;
+    }
+
+    void addImplementations()
+    {
+        QTest::addColumn<bool>( "reference" );
+
+        QTest::newRow( "reference" ) << true;
+        QTest::newRow( "kernel" ) << false;
+    }
+}
+
+
+SampleConversionTest::SampleConversionTest()
+{
+}
+
+
+void SampleConversionTest::testSwapByteOrder_data()
+{
+    addCounts();
+}
+
+
+void SampleConversionTest::testSwapByteOrder()
+{
+    QFETCH( int, count );
+
+    QByteArray expected = noise( 2*count );
+    QByteArray result = expected;
+    referenceSwapByteOrder( expected.data(), expected.size() );
+    K3b::SampleConversion::swapByteOrder16( result.data(), count );
+    QCOMPARE( result, expected );
+}
+
+
+void SampleConversionTest::testFrom16BitBeToFloat_data()
+{
+    addCounts();
+}
+
+
+void SampleConversionTest::testFrom16BitBeToFloat()
+{
+    QFETCH( int, count );
+
+    const QByteArray src = noise( 2*count );
+    QVector<float> expected( count );
+    QVector<float> result( count );
+    referenceFrom16bitBeSignedToFloat( src.constData(), expected.data(), count );
+    K3b::SampleConversion::from16BitBeToFloat( src.constData(), result.data(), count );
+    QVERIFY( ::memcmp( result.constData(), expected.constData(), count*sizeof(float) ) == 0 );
+}
+
+
+void SampleConversionTest::testFromFloatTo16BitBe_data()
+{
+    addCounts();
+}
+
+
+void SampleConversionTest::testFromFloatTo16BitBe()
+{
+    QFETCH( int, count );
+
+    const QVector<float> src = floatSamples( count );
+    QByteArray expected( 2*count, '\0' );
+    QByteArray result( 2*count, '\0' );
+    referenceFromFloatTo16BitBeSigned( src.constData(), expected.data(), count );
+    K3b::SampleConversion::fromFloatTo16BitBe( src.constData(), result.data(), count );
+    QCOMPARE( result, expected );
+}
+
+
+void SampleConversionTest::testFrom8BitTo16BitBe_data()
+{
+    addCounts();
+}
+
+
+void SampleConversionTest::testFrom8BitTo16BitBe()
+{
+    QFETCH( int, count );
+
+    const QByteArray src = noise( count );
+    QByteArray expected( 2*count, '\0' );
+    QByteArray result( 2*count, '\0' );
+    referenceFrom8BitTo16BitBeSigned( src.constData(), expected.data(), count );
+    K3b::SampleConversion::from8BitTo16BitBe( src.constData(), result.data(), count );
+    QCOMPARE( result, expected );
+}
+
+
+void SampleConversionTest::testMonoToStereo_data()
+{
+    addCounts();
+}
+
+
+void SampleConversionTest::testMonoToStereo()
+{
+    QFETCH( int, count );
+
+    const QByteArray src = noise( 2*count );
+    QByteArray expected( 4*count, '\0' );
+    for( int i = 0; i < 2*count; i+=2 ) {
+        expected[2*i] = expected[2*i+2] = src[i];
+        expected[2*i+1] = expected[2*i+3] = src[i+1];
+    }
+
+    QByteArray result( 4*count, '\0' );
+    K3b::SampleConversion::monoToStereo16( src.constData(), result.data(), count );
+    QCOMPARE( result, expected );
+}
+
+
+void SampleConversionTest::testFrom16BitLeStereoToFloat_data()
+{
+    addCounts();
+}
+
+
+void SampleConversionTest::testFrom16BitLeStereoToFloat()
+{
+    QFETCH( int, count );
+
+    const QByteArray src = noise( 4*count );
+    const char* data = src.constData();
+    QVector<float> expectedLeft( count );
+    QVector<float> expectedRight( count );
+    for( int i = 0; i < count; ++i ) {
+        expectedLeft[i] = ( (data[i*4+1]<<8) | (0x00ff&(int)data[i*4]) ) / 32768.f;
+        expectedRight[i] = ( (data[i*4+3]<<8) | (0x00ff&(int)data[i*4+2]) ) / 32768.f;
+    }
+
+    QVector<float> left( count );
+    QVector<float> right( count );
+    K3b::SampleConversion::from16BitLeStereoToFloat( data, left.data(), right.data(), count );
+    QVERIFY( ::memcmp( left.constData(), expectedLeft.constData(), count*sizeof(float) ) == 0 );
+    QVERIFY( ::memcmp( right.constData(), expectedRight.constData(), count*sizeof(float) ) == 0 );
+}
+
+
+void SampleConversionTest::benchmarkFromFloatTo16BitBe_data()
+{
+    addImplementations();
+}
+
+
+void SampleConversionTest::benchmarkFromFloatTo16BitBe()
+{
+    QFETCH( bool, reference );
+
+    const QVector<float> src = floatSamples( BENCHMARK_SAMPLES );
+    QByteArray dest( 2*BENCHMARK_SAMPLES, '\0' );
+    if( reference ) {
+        QBENCHMARK {
+            referenceFromFloatTo16BitBeSigned( src.constData(), dest.data(), BENCHMARK_SAMPLES );
+        }
+    }
+    else {
+        QBENCHMARK {
+            K3b::SampleConversion::fromFloatTo16BitBe( src.constData(), dest.data(), BENCHMARK_SAMPLES );
+        }
+    }
+}
+
+
+void SampleConversionTest::benchmarkFrom16BitBeToFloat_data()
+{
+    addImplementations();
+}
+
+
+void SampleConversionTest::benchmarkFrom16BitBeToFloat()
+{
+    QFETCH( bool, reference );
+
+    const QByteArray src = noise( 2*BENCHMARK_SAMPLES );
+    QVector<float> dest( BENCHMARK_SAMPLES );
+    if( reference ) {
+        QBENCHMARK {
+            referenceFrom16bitBeSignedToFloat( src.constData(), dest.data(), BENCHMARK_SAMPLES );
+        }
+    }
+    else {
+        QBENCHMARK {
+            K3b::SampleConversion::from16BitBeToFloat( src.constData(), dest.data(), BENCHMARK_SAMPLES );
+        }
+    }
+}
+
+
+void SampleConversionTest::benchmarkSwapByteOrder_data()
+{
+    addImplementations();
+}
+
+
+void SampleConversionTest::benchmarkSwapByteOrder()
+{
+    QFETCH( bool, reference );
+
+    QByteArray data = noise( 2*BENCHMARK_SAMPLES );
+    if( reference ) {
+        QBENCHMARK {
+            referenceSwapByteOrder( data.data(), data.size() );
+        }
+    }
+    else {
+        QBENCHMARK {
+            K3b::SampleConversion::swapByteOrder16( data.data(), BENCHMARK_SAMPLES );
+        }
+    }
+}
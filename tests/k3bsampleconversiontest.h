@@ -0,0 +1,38 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_SAMPLE_CONVERSION_TEST_H
+#define K3B_SAMPLE_CONVERSION_TEST_H
+
+#include <QObject>
+
+class SampleConversionTest : public QObject
+{
+    Q_OBJECT
+public:
+    SampleConversionTest();
+private slots:
+    void testSwapByteOrder_data();
+    void testSwapByteOrder();
+    void testFrom16BitBeToFloat_data();
+    void testFrom16BitBeToFloat();
+    void testFromFloatTo16BitBe_data();
+    void testFromFloatTo16BitBe();
+    void testFrom8BitTo16BitBe_data();
+    void testFrom8BitTo16BitBe();
+    void testMonoToStereo_data();
+    void testMonoToStereo();
+    void testFrom16BitLeStereoToFloat_data();
+    void testFrom16BitLeStereoToFloat();
+    void benchmarkFromFloatTo16BitBe_data();
+    void benchmarkFromFloatTo16BitBe();
+    void benchmarkFrom16BitBeToFloat_data();
+    void benchmarkFrom16BitBeToFloat();
+    void benchmarkSwapByteOrder_data();
+    void benchmarkSwapByteOrder();
+};
+
+#endif // K3B_SAMPLE_CONVERSION_TEST_H
@@ -0,0 +1,585 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bsimulateddrivebenchmark.h"
+#include "k3bcore.h"
+#include "k3bdatatrackreader.h"
+#include "k3biso9660backend.h"
+#include "k3bmedium.h"
+#include "k3bsimplejobhandler.h"
+#include "k3bverificationjob.h"
+#include "k3bchecksummanifest.h"
+
+#include "k3bcdtext.h"
+#include "k3bdevice.h"
+#include "k3bdevicemanager.h"
+#include "k3bdeviceglobals.h"
+#include "k3bdiskinfo.h"
+#include "k3bmsf.h"
+#include "k3breadqueue.h"
+#include "k3bsimulateddrive.h"
+#include "k3btoc.h"
+
+#include <KConfig>
+#include <KConfigGroup>
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTest>
+#include <QThread>
+
+QTEST_MAIN( SimulatedDriveBenchmark )
+
+namespace {
+    const int ISO_SECTORS = 5000;
+
+    // the bin file has an audio track with 1000 sectors followed by a
+    // Mode1 track with a two seconds pregap and 500 sectors
+    const int AUDIO_SECTORS = 1000;
+    const int PREGAP_SECTORS = 150;
+    const int DATA_SECTORS = 500;
+    const int BIN_SECTORS = AUDIO_SECTORS + PREGAP_SECTORS + DATA_SECTORS;
+
+    const char* s_cueSheet =
+        "TITLE \"Simulated Album\"\n"
+        "PERFORMER \"K3b\"\n"
+        "FILE \"image.bin\" BINARY\n"
+        "  TRACK 01 AUDIO\n"
+        "    TITLE \"First\"\n"
+        "    INDEX 01 00:00:00\n"
+        "  TRACK 02 MODE1/2352\n"
+        "    TITLE \"Second\"\n"
+        "    INDEX 00 00:13:25\n"
+        "    INDEX 01 00:15:25\n";
+
+    QByteArray dataSector( int sector )
+    {
+        QByteArray data( 2048, 0 );
+        for( int i = 0; i < data.size(); ++i )
+            data[i] = ( sector + i ) & 0xFF;
+        return data;
+    }
+
+    QByteArray mode1Sector( int lba, const QByteArray& data )
+    {
+        QByteArray raw( 2352, 0 );
+        for( int i = 1; i < 11; ++i )
+            raw[i] = 0xFF;
+        const K3b::Msf msf( lba + 150 );
+        raw[12] = K3b::Device::toBcd( msf.minutes() );
+        raw[13] = K3b::Device::toBcd( msf.seconds() );
+        raw[14] = K3b::Device::toBcd( msf.frames() );
+        raw[15] = 1;
+        raw.replace( 16, 2048, data );
+        return raw;
+    }
+
+    bool writeFile( const QString& filename, const QByteArray& data )
+    {
+        QFile file( filename );
+        return file.open( QIODevice::WriteOnly ) && file.write( data ) == data.size();
+    }
+
+    QByteArray readFile( const QString& filename )
+    {
+        QFile file( filename );
+        return file.open( QIODevice::ReadOnly ) ? file.readAll() : QByteArray();
+    }
+}
+
+
+SimulatedDriveBenchmark::SimulatedDriveBenchmark()
+    : m_core( 0 ),
+      m_deviceManager( 0 ),
+      m_deviceCount( 0 )
+{
+}
+
+
+void SimulatedDriveBenchmark::initTestCase()
+{
+    QVERIFY( m_dir.isValid() );
+
+    QByteArray iso;
+    for( int i = 0; i < ISO_SECTORS; ++i )
+        iso.append( dataSector( i ) );
+    m_isoPath = m_dir.filePath( "image.iso" );
+    QVERIFY( writeFile( m_isoPath, iso ) );
+
+    QByteArray bin;
+    for( int i = 0; i < AUDIO_SECTORS; ++i )
+        bin.append( QByteArray( 2352, char( i ) ) );
+    for( int i = AUDIO_SECTORS; i < BIN_SECTORS; ++i )
+        bin.append( mode1Sector( i, i < AUDIO_SECTORS + PREGAP_SECTORS ? QByteArray( 2048, 0 ) : dataSector( i ) ) );
+    m_binPath = m_dir.filePath( "image.bin" );
+    QVERIFY( writeFile( m_binPath, bin ) );
+
+    m_cuePath = m_dir.filePath( "image.cue" );
+    QVERIFY( writeFile( m_cuePath, s_cueSheet ) );
+
+    m_core = new K3b::Core( this );
+    m_deviceManager = new K3b::Device::DeviceManager( this );
+}
+
+
+void SimulatedDriveBenchmark::cleanupTestCase()
+{
+    delete m_deviceManager;
+    m_deviceManager = 0;
+}
+
+
+K3b::Device::Device* SimulatedDriveBenchmark::addDevice( const QString& image )
+{
+    K3b::Device::SimulatedDrive* drive = new K3b::Device::SimulatedDrive();
+    if( !drive->load( image ) ) {
+        delete drive;
+        return 0;
+    }
+    return m_deviceManager->addSimulatedDevice( drive, QString( "sim:%1" ).arg( ++m_deviceCount ) );
+}
+
+
+bool SimulatedDriveBenchmark::readTrack( K3b::Device::Device* dev, const QString& imagePath )
+{
+    K3b::SimpleJobHandler handler;
+    K3b::DataTrackReader reader( &handler );
+    reader.setDevice( dev );
+    reader.setSectorSize( K3b::DataTrackReader::MODE1 );
+    reader.setSectorRange( 0, ISO_SECTORS - 1 );
+    reader.setRetries( 0 );
+    reader.setImagePath( imagePath );
+
+    QSignalSpy spy( &reader, SIGNAL(finished(bool)) );
+    reader.start();
+    if( spy.isEmpty() && !spy.wait( 60000 ) )
+        return false;
+    return spy.first().first().toBool();
+}
+
+
+void SimulatedDriveBenchmark::benchmarkDeviceInit()
+{
+    QBENCHMARK {
+        K3b::Device::Device* dev = addDevice( m_isoPath );
+        QVERIFY( dev );
+        QCOMPARE( dev->vendor(), QString( "K3b" ) );
+        QVERIFY( dev->readCapabilities() & K3b::Device::MEDIA_CD_ROM );
+    }
+}
+
+
+void SimulatedDriveBenchmark::benchmarkDiskInfo()
+{
+    K3b::Device::Device* dev = addDevice( m_isoPath );
+    QVERIFY( dev );
+
+    K3b::Device::DiskInfo info;
+    QBENCHMARK {
+        info = dev->diskInfo();
+    }
+
+    QCOMPARE( info.mediaType(), K3b::Device::MEDIA_CD_ROM );
+    QCOMPARE( info.numSessions(), 1 );
+    QCOMPARE( info.diskState(), K3b::Device::STATE_COMPLETE );
+}
+
+
+void SimulatedDriveBenchmark::benchmarkTocAndCdText()
+{
+    K3b::Device::Device* dev = addDevice( m_cuePath );
+    QVERIFY( dev );
+
+    K3b::Device::Toc toc;
+    K3b::Device::CdText cdText;
+    QBENCHMARK {
+        toc = dev->readToc();
+        cdText = dev->readCdText();
+    }
+
+    QCOMPARE( toc.count(), 2 );
+    QCOMPARE( toc[0].type(), K3b::Device::Track::TYPE_AUDIO );
+    QCOMPARE( toc[1].type(), K3b::Device::Track::TYPE_DATA );
+    QCOMPARE( toc[1].firstSector().lba(), AUDIO_SECTORS + PREGAP_SECTORS );
+    QCOMPARE( toc[1].lastSector().lba(), BIN_SECTORS - 1 );
+
+    QCOMPARE( cdText.title(), QString( "Simulated Album" ) );
+    QCOMPARE( cdText.performer(), QString( "K3b" ) );
+    QCOMPARE( cdText.track( 1 ).title(), QString( "Second" ) );
+}
+
+
+void SimulatedDriveBenchmark::benchmarkMediumUpdate()
+{
+    K3b::Device::Device* dev = addDevice( m_isoPath );
+    QVERIFY( dev );
+
+    K3b::Medium medium( dev );
+    QBENCHMARK {
+        medium.update();
+    }
+
+    QCOMPARE( medium.diskInfo().mediaType(), K3b::Device::MEDIA_CD_ROM );
+    QCOMPARE( medium.toc().count(), 1 );
+}
+
+
+void SimulatedDriveBenchmark::benchmarkDataTrackReader()
+{
+    K3b::Device::Device* dev = addDevice( m_isoPath );
+    QVERIFY( dev );
+
+    const QString imagePath = m_dir.filePath( "read.iso" );
+    QBENCHMARK {
+        QVERIFY( readTrack( dev, imagePath ) );
+    }
+
+    QCOMPARE( readFile( imagePath ), readFile( m_isoPath ) );
+}
+
+
+void SimulatedDriveBenchmark::benchmarkVerification()
+{
+    K3b::Device::Device* dev = addDevice( m_isoPath );
+    QVERIFY( dev );
+
+    const QByteArray md5 = QCryptographicHash::hash( readFile( m_isoPath ), QCryptographicHash::Md5 ).toHex();
+
+    QBENCHMARK {
+        K3b::SimpleJobHandler handler;
+        K3b::VerificationJob job( &handler );
+        job.setDevice( dev );
+        job.addTrack( 1, md5, ISO_SECTORS );
+
+        QSignalSpy spy( &job, SIGNAL(finished(bool)) );
+        job.start();
+        QVERIFY( !spy.isEmpty() || spy.wait( 60000 ) );
+        QVERIFY( spy.first().first().toBool() );
+    }
+}
+
+
+void SimulatedDriveBenchmark::testVerification()
+{
+    K3b::Device::Device* dev = addDevice( m_isoPath );
+    QVERIFY( dev );
+
+    const QByteArray iso = readFile( m_isoPath );
+    QList<QByteArray> blocks;
+    const qint64 blockSize = K3b::ChecksumManifest::DEFAULT_BLOCK_SIZE;
+    for( qint64 pos = 0; pos < iso.size(); pos += blockSize )
+        blocks << QCryptographicHash::hash( iso.mid( pos, blockSize ), QCryptographicHash::Md5 );
+    const QByteArray md5 = QCryptographicHash::hash( iso, QCryptographicHash::Md5 ).toHex();
+    const K3b::ChecksumManifest manifest( K3b::ChecksumPipe::MD5, blockSize, iso.size(), md5, blocks );
+    QVERIFY( manifest.isValid() );
+
+    for( int i = 0; i < 3; ++i ) {
+        K3b::SimpleJobHandler handler;
+        K3b::VerificationJob job( &handler );
+        job.setDevice( dev );
+        if( i == 0 )
+            job.addTrack( 1, md5, ISO_SECTORS );
+        else if( i == 1 )
+            job.addTrack( 1, manifest, ISO_SECTORS );
+        else
+            job.addTrack( 1, QByteArray( md5 ).replace( 0, 1, md5[0] == '0' ? "1" : "0" ), ISO_SECTORS );
+
+        QSignalSpy spy( &job, SIGNAL(finished(bool)) );
+        job.start();
+        QVERIFY( !spy.isEmpty() || spy.wait( 60000 ) );
+        QCOMPARE( spy.first().first().toBool(), i < 2 );
+    }
+}
+
+
+void SimulatedDriveBenchmark::benchmarkRawRead()
+{
+    K3b::Device::Device* dev = addDevice( m_cuePath );
+    QVERIFY( dev );
+
+    // the sectors K3b reads when copying a CD in raw mode
+    const int sectorsPerRead = 26;
+    QByteArray raw( sectorsPerRead * 2352, 0 );
+    QByteArray image;
+    QBENCHMARK {
+        image.clear();
+        for( int sector = 0; sector < BIN_SECTORS; sector += sectorsPerRead ) {
+            const int n = qMin( sectorsPerRead, BIN_SECTORS - sector );
+            QVERIFY( dev->readCd( (unsigned char*)raw.data(), n * 2352,
+                                  0, false, sector, n,
+                                  true, true, true, true, true,
+                                  0, 0 ) );
+            image.append( raw.constData(), n * 2352 );
+        }
+    }
+
+    QCOMPARE( image, readFile( m_binPath ) );
+}
+
+
+void SimulatedDriveBenchmark::testReadErrors()
+{
+    K3b::Device::SimulatedDrive* drive = new K3b::Device::SimulatedDrive();
+    QVERIFY( drive->load( m_isoPath ) );
+    drive->addReadErrors( 1000, 10 );
+    K3b::Device::Device* dev = m_deviceManager->addSimulatedDevice( drive, "sim:errors" );
+    QVERIFY( dev );
+
+    unsigned char buffer[2048*16];
+    QVERIFY( dev->read10( buffer, sizeof(buffer), 984, 16 ) );
+    QVERIFY( !dev->read10( buffer, sizeof(buffer), 1000, 16 ) );
+    QVERIFY( !readTrack( dev, m_dir.filePath( "errors.iso" ) ) );
+
+    drive->clearReadErrors();
+    QVERIFY( readTrack( dev, m_dir.filePath( "errors.iso" ) ) );
+}
+
+
+void SimulatedDriveBenchmark::testMaxTransferLength()
+{
+    K3b::Device::SimulatedDrive* drive = new K3b::Device::SimulatedDrive();
+    QVERIFY( drive->load( m_isoPath ) );
+    drive->setMaxTransferLength( 16 );
+    K3b::Device::Device* dev = m_deviceManager->addSimulatedDevice( drive, "sim:transfer" );
+    QVERIFY( dev );
+
+    // reported by the drive's block limits
+    QCOMPARE( dev->maxTransferLength(), 16*2048 );
+    QCOMPARE( dev->maxReadSectors(), 16 );
+
+    unsigned char buffer[2048*32];
+    drive->resetStatistics();
+    QVERIFY( dev->read10( buffer, 2048*16, 0, 16 ) );
+    QVERIFY( !dev->read10( buffer, sizeof(buffer), 0, 32 ) );
+    QCOMPARE( drive->commandCount(), 2 );
+    QCOMPARE( drive->sectorsRead(), qint64( 16 ) );
+    QVERIFY( buffer[0] == 0 && buffer[1] == 1 );
+}
+
+
+void SimulatedDriveBenchmark::testUnreportedTransferLength()
+{
+    K3b::Device::SimulatedDrive* drive = new K3b::Device::SimulatedDrive();
+    QVERIFY( drive->load( m_isoPath ) );
+    K3b::Device::Device* dev = m_deviceManager->addSimulatedDevice( drive, "sim:unreported" );
+    QVERIFY( dev );
+    QVERIFY( dev->maxReadSectors() > 16 );
+
+    // the drive rejects larger reads without saying so
+    drive->setMaxTransferLength( 16 );
+    const QString imagePath = m_dir.filePath( "unreported.iso" );
+    QVERIFY( readTrack( dev, imagePath ) );
+    QCOMPARE( readFile( imagePath ), readFile( m_isoPath ) );
+    QCOMPARE( dev->maxReadSectors(), 16 );
+
+    // the next reads do not try larger transfers again
+    drive->resetStatistics();
+    QVERIFY( readTrack( dev, imagePath ) );
+    QCOMPARE( drive->sectorsRead(), qint64( ISO_SECTORS ) );
+}
+
+
+void SimulatedDriveBenchmark::testTransientTransferFailure()
+{
+    K3b::Device::SimulatedDrive* drive = new K3b::Device::SimulatedDrive();
+    QVERIFY( drive->load( m_isoPath ) );
+    K3b::Device::Device* dev = m_deviceManager->addSimulatedDevice( drive, "sim:transient" );
+    QVERIFY( dev );
+    const int maxReadSectors = dev->maxReadSectors();
+
+    // the drive is not ready for the first read
+    drive->addFailingReads( 1 );
+    const QString imagePath = m_dir.filePath( "transient.iso" );
+    QVERIFY( readTrack( dev, imagePath ) );
+    QCOMPARE( readFile( imagePath ), readFile( m_isoPath ) );
+    QCOMPARE( dev->maxReadSectors(), maxReadSectors );
+}
+
+
+void SimulatedDriveBenchmark::testSavedTransferLength()
+{
+    KConfig config( QString(), KConfig::SimpleConfig );
+    KConfigGroup group( &config, "Devices" );
+
+    {
+        K3b::Device::DeviceManager manager;
+        K3b::Device::SimulatedDrive* drive = new K3b::Device::SimulatedDrive();
+        QVERIFY( drive->load( m_isoPath ) );
+        drive->setMaxTransferLength( 32 );
+        K3b::Device::Device* dev = manager.addSimulatedDevice( drive, "sim:saved" );
+        QVERIFY( dev );
+        dev->setMaxTransferLength( 16*2048 );
+        QVERIFY( manager.saveConfig( group ) );
+    }
+
+    // the same limits as before
+    {
+        K3b::Device::DeviceManager manager;
+        K3b::Device::SimulatedDrive* drive = new K3b::Device::SimulatedDrive();
+        QVERIFY( drive->load( m_isoPath ) );
+        drive->setMaxTransferLength( 32 );
+        K3b::Device::Device* dev = manager.addSimulatedDevice( drive, "sim:saved" );
+        QVERIFY( dev );
+        QVERIFY( manager.readConfig( group ) );
+        QCOMPARE( dev->maxReadSectors(), 16 );
+    }
+
+    // the drive or the system transfers more now
+    {
+        K3b::Device::DeviceManager manager;
+        K3b::Device::SimulatedDrive* drive = new K3b::Device::SimulatedDrive();
+        QVERIFY( drive->load( m_isoPath ) );
+        drive->setMaxTransferLength( 64 );
+        K3b::Device::Device* dev = manager.addSimulatedDevice( drive, "sim:saved" );
+        QVERIFY( dev );
+        QVERIFY( manager.readConfig( group ) );
+        QCOMPARE( dev->maxReadSectors(), 64 );
+    }
+}
+
+
+void SimulatedDriveBenchmark::benchmarkReadQueue_data()
+{
+    QTest::addColumn<int>( "depth" );
+    QTest::newRow( "synchronous" ) << 0;
+    QTest::newRow( "depth 1" ) << 1;
+    QTest::newRow( "depth 2" ) << 2;
+    QTest::newRow( "depth 3" ) << 3;
+    QTest::newRow( "depth 4" ) << 4;
+}
+
+
+void SimulatedDriveBenchmark::benchmarkReadQueue()
+{
+    QFETCH( int, depth );
+
+    // processing a chunk takes as long as reading it
+    const int sectorLatency = 20;
+    K3b::Device::SimulatedDrive* drive = new K3b::Device::SimulatedDrive();
+    QVERIFY( drive->load( m_isoPath ) );
+    drive->setSectorLatency( sectorLatency );
+    drive->setMaxTransferLength( 32 );
+    K3b::Device::Device* dev = m_deviceManager->addSimulatedDevice( drive, QString( "sim:%1" ).arg( ++m_deviceCount ) );
+    QVERIFY( dev );
+
+    const int chunkSectors = dev->maxReadSectors();
+    const unsigned long processingTime = chunkSectors * sectorLatency;
+
+    QCryptographicHash hash( QCryptographicHash::Md5 );
+    QBENCHMARK {
+        hash.reset();
+        if( depth == 0 ) {
+            QByteArray buffer( chunkSectors * 2048, 0 );
+            for( int sector = 0; sector < ISO_SECTORS; sector += chunkSectors ) {
+                const int n = qMin( chunkSectors, ISO_SECTORS - sector );
+                QVERIFY( dev->read10( (unsigned char*)buffer.data(), n * 2048, sector, n ) );
+                hash.addData( buffer.constData(), n * 2048 );
+                QThread::usleep( processingTime );
+            }
+        }
+        else {
+            K3b::Device::ReadQueue queue( dev, depth );
+            int next = 0;
+            for( int sector = 0; sector < ISO_SECTORS; ) {
+                while( next < ISO_SECTORS ) {
+                    const int n = qMin( chunkSectors, ISO_SECTORS - next );
+                    if( !queue.submit( next, n ) )
+                        break;
+                    next += n;
+                }
+
+                K3b::Device::ReadQueue::Request request;
+                QVERIFY( queue.complete( request ) );
+                QVERIFY( request.success );
+                QCOMPARE( request.sector, (unsigned long)sector );
+                hash.addData( (const char*)request.data, request.sectors * 2048 );
+                QThread::usleep( processingTime );
+                sector += request.sectors;
+            }
+        }
+    }
+
+    QCOMPARE( hash.result(), QCryptographicHash::hash( readFile( m_isoPath ), QCryptographicHash::Md5 ) );
+}
+
+
+void SimulatedDriveBenchmark::testIso9660DeviceBackend()
+{
+    K3b::Device::SimulatedDrive* drive = new K3b::Device::SimulatedDrive();
+    QVERIFY( drive->load( m_isoPath ) );
+    drive->setMaxTransferLength( 32 );
+    drive->addReadErrors( 3000 );
+    K3b::Device::Device* dev = m_deviceManager->addSimulatedDevice( drive, "sim:iso9660" );
+    QVERIFY( dev );
+
+    K3b::Iso9660DeviceBackend backend( dev );
+    QVERIFY( backend.open() );
+
+    // a file read front to back in pieces smaller than one queued read
+    QByteArray data( 10 * 2048, 0 );
+    for( int sector = 100; sector < 1100; sector += 10 ) {
+        QCOMPARE( backend.read( sector, data.data(), 10 ), 10 );
+        for( int i = 0; i < 10; ++i )
+            QCOMPARE( data.mid( i * 2048, 2048 ), dataSector( sector + i ) );
+    }
+
+    // random access in between
+    QCOMPARE( backend.read( 16, data.data(), 1 ), 1 );
+    QCOMPARE( data.left( 2048 ), dataSector( 16 ) );
+
+    // the read error is reported for the piece it is in only
+    for( int sector = 2950; sector < 3100; sector += 10 ) {
+        if( sector == 3000 ) {
+            QCOMPARE( backend.read( sector, data.data(), 10 ), -1 );
+        }
+        else {
+            QCOMPARE( backend.read( sector, data.data(), 10 ), 10 );
+            QCOMPARE( data.left( 2048 ), dataSector( sector ) );
+        }
+    }
+
+    // up to the end of the medium, but not beyond
+    for( int sector = ISO_SECTORS - 100; sector < ISO_SECTORS; sector += 10 ) {
+        QCOMPARE( backend.read( sector, data.data(), 10 ), 10 );
+        QCOMPARE( data.mid( 9 * 2048 ), dataSector( sector + 9 ) );
+    }
+    QCOMPARE( backend.read( ISO_SECTORS, data.data(), 1 ), -1 );
+
+    backend.close();
+}
+
+
+void SimulatedDriveBenchmark::testIso9660DeviceBackendRandomAccess()
+{
+    K3b::Device::SimulatedDrive* drive = new K3b::Device::SimulatedDrive();
+    QVERIFY( drive->load( m_isoPath ) );
+    drive->setMaxTransferLength( 32 );
+    K3b::Device::Device* dev = m_deviceManager->addSimulatedDevice( drive, "sim:iso9660random" );
+    QVERIFY( dev );
+
+    K3b::Iso9660DeviceBackend backend( dev );
+    QVERIFY( backend.open() );
+    drive->resetStatistics();
+
+    // directory lookups read a few consecutive sectors here and there
+    QByteArray data( 10 * 2048, 0 );
+    for( int sector = 0; sector < 1000; sector += 100 ) {
+        QCOMPARE( backend.read( sector, data.data(), 1 ), 1 );
+        QCOMPARE( backend.read( sector + 1, data.data(), 2 ), 2 );
+        QCOMPARE( data.mid( 2048, 2048 ), dataSector( sector + 2 ) );
+    }
+    QCOMPARE( drive->sectorsRead(), qint64( 30 ) );
+
+    // a file read front to back is read ahead after the first pieces
+    for( int sector = 2000; sector < 2200; sector += 10 ) {
+        QCOMPARE( backend.read( sector, data.data(), 10 ), 10 );
+        QCOMPARE( data.mid( 9 * 2048 ), dataSector( sector + 9 ) );
+    }
+    QTRY_VERIFY( drive->sectorsRead() > qint64( 30 + 200 ) );
+
+    backend.close();
+}
@@ -0,0 +1,60 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_SIMULATED_DRIVE_BENCHMARK_H
+#define K3B_SIMULATED_DRIVE_BENCHMARK_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+namespace K3b {
+    class Core;
+    namespace Device {
+        class Device;
+        class DeviceManager;
+        class SimulatedDrive;
+    }
+}
+
+class SimulatedDriveBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    SimulatedDriveBenchmark();
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkDeviceInit();
+    void benchmarkDiskInfo();
+    void benchmarkTocAndCdText();
+    void benchmarkMediumUpdate();
+    void benchmarkDataTrackReader();
+    void benchmarkVerification();
+    void benchmarkRawRead();
+    void testReadErrors();
+    void testVerification();
+    void testMaxTransferLength();
+    void testUnreportedTransferLength();
+    void testTransientTransferFailure();
+    void testSavedTransferLength();
+    void benchmarkReadQueue_data();
+    void benchmarkReadQueue();
+    void testIso9660DeviceBackend();
+    void testIso9660DeviceBackendRandomAccess();
+private:
+    K3b::Device::Device* addDevice( const QString& image );
+    bool readTrack( K3b::Device::Device* dev, const QString& imagePath );
+
+    K3b::Core* m_core;
+    K3b::Device::DeviceManager* m_deviceManager;
+    QTemporaryDir m_dir;
+    QString m_isoPath;
+    QString m_binPath;
+    QString m_cuePath;
+    int m_deviceCount;
+};
+
+#endif // K3B_SIMULATED_DRIVE_BENCHMARK_H
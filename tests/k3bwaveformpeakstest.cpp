@@ -0,0 +1,181 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "k3bwaveformpeakstest.h"
+#include "k3bwaveformpeaks.h"
+
+#include <QRandomGenerator>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( WaveformPeaksTest )
+
+namespace {
+    const int FRAMES_PER_SECTOR = 588;
+
+    /**
+     * 16 bit big endian stereo samples, the left channel rising from
+     * \p min to \p max over one sector, the right one being silent
+     */
+    QByteArray sector( qint16 min, qint16 max )
+    {
+        QByteArray data( FRAMES_PER_SECTOR*4, '\0' );
+        for( int i = 0; i < FRAMES_PER_SECTOR; ++i ) {
+            const qint16 sample = qint16( min + ( int( max ) - int( min ) )*i/( FRAMES_PER_SECTOR - 1 ) );
+            data[4*i] = char( sample >> 8 );
+            data[4*i+1] = char( sample );
+        }
+        return data;
+    }
+
+    K3b::WaveformPeaks::Peak expected( qint16 min, qint16 max )
+    {
+        return K3b::WaveformPeaks::Peak( qint8( qMin<qint16>( min, 0 ) >> 8 ), qint8( qMax<qint16>( max, 0 ) >> 8 ) );
+    }
+}
+
+
+WaveformPeaksTest::WaveformPeaksTest()
+{
+}
+
+
+void WaveformPeaksTest::testSectorPeaks()
+{
+    K3b::WaveformPeaks peaks;
+    peaks.update( sector( -32768, 32767 ).constData(), FRAMES_PER_SECTOR*4 );
+    peaks.update( sector( 256, 512 ).constData(), FRAMES_PER_SECTOR*4 );
+    peaks.update( sector( -1024, -512 ).constData(), FRAMES_PER_SECTOR*4 );
+    peaks.finish();
+
+    QCOMPARE( peaks.sectors(), 3 );
+    QCOMPARE( peaks.peak( 0, 0 ), K3b::WaveformPeaks::Peak( -128, 127 ) );
+    QCOMPARE( peaks.peak( 1, 1 ), expected( 256, 512 ) );
+    QCOMPARE( peaks.peak( 2, 2 ), expected( -1024, -512 ) );
+    QCOMPARE( peaks.peak( 1, 2 ), expected( -1024, 512 ) );
+
+    // out of range
+    QCOMPARE( peaks.peak( 3, 10 ), K3b::WaveformPeaks::Peak() );
+    QCOMPARE( peaks.peak( -5, -1 ), K3b::WaveformPeaks::Peak() );
+}
+
+
+void WaveformPeaksTest::testRangePeaks()
+{
+    // one known peak per sector
+    const int count = 1000;
+    QVector<K3b::WaveformPeaks::Peak> values( count );
+    K3b::WaveformPeaks peaks;
+    QRandomGenerator random( 42 );
+    for( int i = 0; i < count; ++i ) {
+        const qint16 a = qint16( random.bounded( -32768, 32768 ) );
+        const qint16 b = qint16( random.bounded( -32768, 32768 ) );
+        const qint16 min = qMin( a, b );
+        const qint16 max = qMax( a, b );
+        values[i] = expected( min, max );
+        peaks.update( sector( min, max ).constData(), FRAMES_PER_SECTOR*4 );
+    }
+    peaks.finish();
+    QCOMPARE( peaks.sectors(), count );
+
+    for( int i = 0; i < 200; ++i ) {
+        const int first = random.bounded( count );
+        const int last = first + random.bounded( count - first );
+
+        // the result covers the range and at most (last-first) sectors around it
+        K3b::WaveformPeaks::Peak inner = values[first];
+        for( int j = first + 1; j <= last; ++j ) {
+            inner.min = qMin( inner.min, values[j].min );
+            inner.max = qMax( inner.max, values[j].max );
+        }
+        const int len = last - first;
+        K3b::WaveformPeaks::Peak outer = inner;
+        for( int j = qMax( 0, first - len ); j <= qMin( count - 1, last + len ); ++j ) {
+            outer.min = qMin( outer.min, values[j].min );
+            outer.max = qMax( outer.max, values[j].max );
+        }
+
+        const K3b::WaveformPeaks::Peak p = peaks.peak( first, last );
+        QVERIFY( p.min <= inner.min && p.min >= outer.min );
+        QVERIFY( p.max >= inner.max && p.max <= outer.max );
+    }
+}
+
+
+void WaveformPeaksTest::testIncompleteSector()
+{
+    K3b::WaveformPeaks peaks;
+    const QByteArray data = sector( -4096, 4096 );
+
+    // data in odd chunks
+    peaks.update( data.constData(), 400 );
+    peaks.update( data.constData() + 400, data.size() - 400 );
+    peaks.update( data.constData(), 100*4 );
+    QCOMPARE( peaks.sectors(), 2 );
+
+    peaks.finish();
+    QCOMPARE( peaks.sectors(), 2 );
+    QCOMPARE( peaks.peak( 0, 0 ), expected( -4096, 4096 ) );
+    QCOMPARE( peaks.peak( 1, 1 ).min, qint8( -16 ) );
+}
+
+
+void WaveformPeaksTest::testAppend()
+{
+    K3b::WaveformPeaks file;
+    for( int i = 0; i < 10; ++i )
+        file.update( sector( -256*i, 256*i ).constData(), FRAMES_PER_SECTOR*4 );
+    file.finish();
+
+    K3b::WaveformPeaks track;
+    track.append( file, 8, 4 );
+    track.appendSilence( 3 );
+    track.append( file, 2, 1 );
+    track.finish();
+
+    QCOMPARE( track.sectors(), 8 );
+    QCOMPARE( track.peak( 0, 0 ), expected( -256*8, 256*8 ) );
+    QCOMPARE( track.peak( 1, 1 ), expected( -256*9, 256*9 ) );
+
+    // beyond the end of the file and the silence
+    for( int i = 2; i < 7; ++i )
+        QCOMPARE( track.peak( i, i ), K3b::WaveformPeaks::Peak() );
+
+    QCOMPARE( track.peak( 7, 7 ), expected( -512, 512 ) );
+}
+
+
+void WaveformPeaksTest::testSerialization()
+{
+    K3b::WaveformPeaks peaks;
+    for( int i = 0; i < 100; ++i )
+        peaks.update( sector( -300*i, 200*i ).constData(), FRAMES_PER_SECTOR*4 );
+    peaks.finish();
+
+    K3b::WaveformPeaks loaded;
+    QVERIFY( loaded.fromByteArray( peaks.toByteArray() ) );
+    QCOMPARE( loaded.sectors(), peaks.sectors() );
+    for( int i = 0; i < 100; ++i )
+        QCOMPARE( loaded.peak( i, i ), peaks.peak( i, i ) );
+    QCOMPARE( loaded.peak( 0, 99 ), peaks.peak( 0, 99 ) );
+}
+
+
+void WaveformPeaksTest::testInvalidData()
+{
+    K3b::WaveformPeaks peaks;
+    peaks.appendSilence( 5 );
+    peaks.finish();
+
+    QVERIFY( !peaks.fromByteArray( QByteArray() ) );
+    QVERIFY( !peaks.fromByteArray( QByteArray( "K3b waveform" ) ) );
+
+    // truncated
+    const QByteArray data = peaks.toByteArray();
+    QVERIFY( !peaks.fromByteArray( data.left( data.size() - 1 ) ) );
+
+    // the peaks are unchanged
+    QCOMPARE( peaks.sectors(), 5 );
+}
@@ -0,0 +1,26 @@
+/*
+    SPDX-FileCopyrightText: 2026 The K3b developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef K3B_WAVEFORM_PEAKS_TEST_H
+#define K3B_WAVEFORM_PEAKS_TEST_H
+
+#include <QObject>
+
+class WaveformPeaksTest : public QObject
+{
+    Q_OBJECT
+public:
+    WaveformPeaksTest();
+private slots:
+    void testSectorPeaks();
+    void testRangePeaks();
+    void testIncompleteSector();
+    void testAppend();
+    void testSerialization();
+    void testInvalidData();
+};
+
+#endif // K3B_WAVEFORM_PEAKS_TEST_H